@@ -0,0 +1,264 @@
+/** \file ColumnFile.h
+  *
+  * \brief Columnar binary event files
+  *
+  * \date Oct. 19th, 2026
+  *
+  * A column file stores a fixed set of named, typed fields for every event.
+  * Events are grouped into chunks and every chunk stores each field as one
+  * contiguous block, byte shuffled and (when built with zlib) deflated, so a
+  * reader only has to decode the fields it is interested in. The file layout is
+  *
+  *   header : magic, version, number of columns, then for each column its
+  *            type, number of elements per event and name.
+  *   chunk  : chunk marker, number of events, then for each column its codec,
+  *            decoded size, stored size and the stored bytes.
+  *   footer : end marker and the total number of events.
+  *
+  * All values are written in the byte order of the host.
+*/
+
+#ifndef COLUMNFILE_H
+#define COLUMNFILE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define COLUMN_FILE_MAGIC 0x4C4F4350 // "PCOL"
+#define COLUMN_FILE_VERSION 1
+#define COLUMN_CHUNK_MARKER 0x4B4E4843 // "CHNK"
+#define COLUMN_END_MARKER 0x444E4543 // "CEND"
+
+/// The data types which may be stored in a column.
+enum ColumnType{
+	COLUMN_INT32 = 0,
+	COLUMN_UINT32 = 1,
+	COLUMN_INT64 = 2,
+	COLUMN_UINT64 = 3,
+	COLUMN_FLOAT = 4,
+	COLUMN_DOUBLE = 5
+};
+
+/// The encodings which may be used for a column block.
+enum ColumnCodec{
+	CODEC_RAW = 0, ///< Stored as is.
+	CODEC_SHUFFLE = 1, ///< Byte shuffled.
+	CODEC_SHUFFLE_ZLIB = 2 ///< Byte shuffled and deflated with zlib.
+};
+
+/// Return the size in bytes of a single element of the given type, or zero for an unknown type.
+unsigned int GetColumnTypeSize(const ColumnType &type_);
+
+/// Return the name of the given column type.
+std::string GetColumnTypeName(const ColumnType &type_);
+
+/// Description of a single column.
+struct ColumnInfo{
+	std::string name; ///< Name of the column.
+	ColumnType type; ///< Data type of the elements.
+	unsigned int count; ///< Number of elements per event.
+
+	ColumnInfo() : type(COLUMN_DOUBLE), count(1) { }
+
+	ColumnInfo(const std::string &name_, const ColumnType &type_, const unsigned int &count_) : name(name_), type(type_), count(count_) { }
+
+	/// Return the number of bytes used by this column for one event.
+	unsigned int GetRowSize() const { return GetColumnTypeSize(type)*count; }
+};
+
+/// Writes events to a column file. Values are copied from the registered
+/// addresses on every call to Fill() and chunks are encoded and written to
+/// disk by a background thread.
+class ColumnWriter{
+  public:
+	ColumnWriter();
+
+	~ColumnWriter(){ Close(); }
+
+	/** Register a column. Columns must be added before the file is opened and
+	  * the address must remain valid until the file is closed.
+	  * \param[in] name_ Unique name of the column.
+	  * \param[in] type_ Data type of the elements.
+	  * \param[in] address_ Address of the first element, read on every call to Fill().
+	  * \param[in] count_ Number of consecutive elements per event.
+	  * \return True if the column was added and false otherwise.
+	  */
+	bool AddColumn(const std::string &name_, const ColumnType &type_, const void *address_, const unsigned int &count_=1);
+
+	bool AddColumn(const std::string &name_, const int *address_, const unsigned int &count_=1){ return AddColumn(name_, COLUMN_INT32, address_, count_); }
+
+	bool AddColumn(const std::string &name_, const unsigned int *address_, const unsigned int &count_=1){ return AddColumn(name_, COLUMN_UINT32, address_, count_); }
+
+	bool AddColumn(const std::string &name_, const long long *address_, const unsigned int &count_=1){ return AddColumn(name_, COLUMN_INT64, address_, count_); }
+
+	bool AddColumn(const std::string &name_, const unsigned long long *address_, const unsigned int &count_=1){ return AddColumn(name_, COLUMN_UINT64, address_, count_); }
+
+	bool AddColumn(const std::string &name_, const float *address_, const unsigned int &count_=1){ return AddColumn(name_, COLUMN_FLOAT, address_, count_); }
+
+	bool AddColumn(const std::string &name_, const double *address_, const unsigned int &count_=1){ return AddColumn(name_, COLUMN_DOUBLE, address_, count_); }
+
+	/** Open the output file, write the schema and start the writer thread.
+	  * \param[in] filename_ Path of the output file.
+	  * \param[in] rowsPerChunk_ Number of events in each chunk.
+	  * \param[in] level_ zlib compression level, zero disables deflating.
+	  * \return True if the file was opened and false otherwise.
+	  */
+	bool Open(const std::string &filename_, const unsigned int &rowsPerChunk_=4096, const int &level_=1);
+
+	/// Return true if the file is open.
+	bool IsOpen(){ return output.is_open(); }
+
+	/// Copy the current values of all columns into the file as a new event.
+	void Fill();
+
+	/** Hand the buffered events to the writer thread as a short chunk, so they
+	  * reach the file even if it is never closed. Files which were not closed
+	  * have no footer, but their chunks are still read by ColumnReader.
+	  */
+	void Flush();
+
+	/// Write any buffered events and the footer, stop the writer thread and close the file.
+	void Close();
+
+	/// Return the number of registered columns.
+	size_t GetNumColumns(){ return columns.size(); }
+
+	/// Return the number of events filled.
+	unsigned long long GetEntries(){ return numEntries; }
+
+	/// Return the number of bytes written to the file.
+	unsigned long long GetBytesWritten(){ return bytesWritten; }
+
+  private:
+	/// A block of events waiting to be written.
+	struct Chunk{
+		unsigned int numRows;
+		std::vector<std::vector<char> > data;
+	};
+
+	std::vector<ColumnInfo> columns; /// Description of all columns.
+	std::vector<const void *> addresses; /// Address of the values of each column.
+
+	std::ofstream output; /// The output file.
+	std::string filename; /// Path of the output file.
+	unsigned int rowsPerChunk; /// Number of events in each chunk.
+	int level; /// zlib compression level.
+	unsigned long long numEntries; /// Number of events filled.
+	std::atomic<unsigned long long> bytesWritten; /// Number of bytes written to the file. Updated by the writer thread.
+	std::atomic<bool> writeError; /// Set by the writer thread if a write fails.
+
+	Chunk *current; /// The chunk which is currently being filled.
+
+	std::thread worker; /// Thread which encodes and writes the chunks.
+	std::mutex queueLock; /// Protects the queue and the stop flag.
+	std::condition_variable queueCond; /// Signals a change of the queue.
+	std::deque<Chunk *> queue; /// Chunks waiting to be written.
+	bool stopWorker; /// Set to tell the writer thread to finish.
+
+	/// Return a new chunk with space for rowsPerChunk events.
+	Chunk *NewChunk();
+
+	/// Hand the current chunk to the writer thread, waiting while too many chunks are queued.
+	void QueueChunk();
+
+	/// The loop of the writer thread.
+	void WriterLoop();
+
+	/// Encode a chunk and write it to the file. Only called from the writer thread.
+	bool WriteChunk(Chunk *chunk_, std::vector<char> &shuffled_, std::vector<char> &compressed_);
+};
+
+/// Reads a column file chunk by chunk. Columns which are not active are
+/// skipped on disk without being decoded.
+class ColumnReader{
+  public:
+	ColumnReader() : numEntries(0), chunkRows(0), dataStart(0) { }
+
+	~ColumnReader(){ Close(); }
+
+	/** Open a column file and read its schema.
+	  * \param[in] filename_ Path of the input file.
+	  * \return True if the file is a valid column file and false otherwise.
+	  */
+	bool Open(const std::string &filename_);
+
+	/// Return true if the file is open.
+	bool IsOpen(){ return input.is_open(); }
+
+	/// Close the file.
+	void Close();
+
+	/// Return the number of columns in the file.
+	size_t GetNumColumns(){ return columns.size(); }
+
+	/// Return the description of a column.
+	const ColumnInfo &GetColumn(const size_t &index_){ return columns.at(index_); }
+
+	/// Return the index of the named column or -1 if it does not exist.
+	int FindColumn(const std::string &name_);
+
+	/** Select whether a column is decoded by ReadChunk(). All columns are active by default.
+	  * \param[in] index_ Index of the column.
+	  * \param[in] active_ True if the column should be decoded.
+	  */
+	void SetActive(const size_t &index_, const bool &active_);
+
+	/// Deactivate all columns except the named ones. Return false if any name is unknown.
+	bool SetActiveColumns(const std::vector<std::string> &names_);
+
+	/// Return the total number of events in the file, or zero if the file was not closed properly.
+	unsigned long long GetEntries(){ return numEntries; }
+
+	/// Go back to the first chunk of the file.
+	bool Rewind();
+
+	/** Read and decode the next chunk.
+	  * \return True if a chunk was read and false at the end of the file or on error.
+	  */
+	bool ReadChunk();
+
+	/// Return the number of events in the current chunk.
+	unsigned int GetChunkRows(){ return chunkRows; }
+
+	/** Return a pointer to the decoded values of a column in the current chunk.
+	  * The values of event i start at element i*count of the column.
+	  * \return Pointer to the values or NULL if the column is not active.
+	  */
+	const void *GetData(const size_t &index_);
+
+	/// Return a single value of the current chunk converted to a double.
+	double GetValue(const size_t &index_, const unsigned int &row_, const unsigned int &element_=0);
+
+	/// Append all values of a column in the current chunk to a vector, converted to double.
+	bool GetValues(const size_t &index_, std::vector<double> &values_);
+
+  private:
+	std::ifstream input; /// The input file.
+	std::vector<ColumnInfo> columns; /// Description of all columns.
+	std::vector<bool> active; /// True for each column that is decoded.
+	std::vector<std::vector<char> > data; /// Decoded values of each column in the current chunk.
+	std::vector<char> stored; /// Scratch space for the stored bytes.
+	std::vector<char> shuffled; /// Scratch space for inflated bytes.
+
+	unsigned long long numEntries; /// Total number of events in the file.
+	unsigned int chunkRows; /// Number of events in the current chunk.
+	std::streampos dataStart; /// Position of the first chunk.
+};
+
+/** Append the events of several column files with the same columns to a new
+  * file, e.g. the outputs of the workers of a run list. The inputs are
+  * read one chunk at a time.
+  * \param[in] inputs_ Paths of the input files, in the order their events are written.
+  * \param[in] output_ Path of the output file.
+  * \param[out] error_ Description of the problem if the merge fails.
+  * \return True upon success and false otherwise.
+  */
+bool MergeColumnFiles(const std::vector<std::string> &inputs_, const std::string &output_, std::string &error_);
+
+#endif
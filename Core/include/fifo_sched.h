@@ -0,0 +1,110 @@
+/** \file fifo_sched.h
+  *
+  * \brief Decides when poll2 checks and reads the module FIFOs
+  *
+  * \date Oct. 19th, 2026
+  *
+  * Instead of checking the fill level of every module in a tight loop, poll2
+  * follows the rate at which each FIFO fills, sleeps until the first module is
+  * expected to reach its read threshold and only then checks the modules
+  * again. The threshold of each module is lowered from the configured one
+  * when its rate is low, so that a spill is read at least once per maximum
+  * latency, and when its rate is high, so that the words still free above the
+  * threshold last longer than the overflow margin.
+*/
+
+#ifndef FIFO_SCHED_H
+#define FIFO_SCHED_H
+
+#include <stddef.h>
+
+#include <vector>
+
+/// Fill level and rate of the FIFO of one module.
+struct FifoState{
+	double words; ///< Number of words found at the last check.
+	double time; ///< Time of the last check or read in seconds.
+	double rate; ///< Running average of the fill rate in words per second.
+
+	FifoState() : words(0), time(-1), rate(0) { }
+};
+
+/// Predicts when the module FIFOs reach their read thresholds.
+class FifoScheduler{
+  public:
+	/** Constructor.
+	  * \param[in] fifoLength_ Length of the module FIFOs in words.
+	  * \param[in] minWords_ Smallest number of words worth reading.
+	  */
+	FifoScheduler(const size_t &fifoLength_, const size_t &minWords_);
+
+	/// Set the number of modules and forget all measured rates.
+	void SetNumModules(const size_t &numMods_);
+
+	/// Set the configured read threshold in words, the highest threshold used.
+	void SetThreshold(const size_t &words_){ threshold = words_; }
+
+	/// Set the longest time in seconds a word may wait in a FIFO at low rates.
+	void SetMaxLatency(const double &seconds_){ maxLatency = seconds_; }
+
+	/// Set the time in seconds the words free above the threshold must last at high rates.
+	void SetOverflowMargin(const double &seconds_){ overflowMargin = seconds_; }
+
+	/// Set the shortest and longest sleep between two checks in seconds.
+	void SetWaitLimits(const double &min_, const double &max_){ minWait = min_; maxWait = max_; }
+
+	/** Record the number of words found in the FIFO of a module.
+	  * \param[in] mod_ The module number.
+	  * \param[in] words_ The number of words in the FIFO.
+	  * \param[in] time_ The time of the check in seconds.
+	  */
+	void Check(const size_t &mod_, const size_t &words_, const double &time_);
+
+	/** Record that the FIFO of a module was read out.
+	  * \param[in] mod_ The module number.
+	  * \param[in] time_ The time the read started in seconds.
+	  */
+	void Drained(const size_t &mod_, const double &time_);
+
+	/// Return true if any module reached its threshold at the last check.
+	bool ShouldRead() const;
+
+	/** Return the time to sleep before the next check, so that the first
+	  * module is checked shortly before it is expected to reach its threshold.
+	  * \param[in] time_ The current time in seconds.
+	  * \return The time to sleep in seconds.
+	  */
+	double GetWait(const double &time_) const;
+
+	/// Return the current read threshold of a module in words.
+	size_t GetThreshold(const size_t &mod_) const;
+
+	/// Return the measured fill rate of a module in words per second.
+	double GetRate(const size_t &mod_) const { return (mod_ < states.size() ? states[mod_].rate : 0); }
+
+	/// Return the number of checks made.
+	unsigned long GetNumChecks() const { return numChecks; }
+
+	/// Return the configured read threshold in words.
+	size_t GetConfiguredThreshold() const { return threshold; }
+
+	/// Return the longest time in seconds a word may wait in a FIFO.
+	double GetMaxLatency() const { return maxLatency; }
+
+	/// Return the time in seconds the words free above the threshold must last.
+	double GetOverflowMargin() const { return overflowMargin; }
+
+  private:
+	size_t fifoLength; ///< Length of the module FIFOs in words.
+	size_t minWords; ///< Smallest number of words worth reading.
+	size_t threshold; ///< The configured read threshold in words.
+	double maxLatency; ///< Longest time a word may wait in a FIFO in seconds.
+	double overflowMargin; ///< Time the words free above the threshold must last in seconds.
+	double minWait; ///< Shortest sleep between two checks in seconds.
+	double maxWait; ///< Longest sleep between two checks in seconds.
+	unsigned long numChecks; ///< Number of module checks made.
+
+	std::vector<FifoState> states; ///< The fill level and rate of each module.
+};
+
+#endif
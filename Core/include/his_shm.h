@@ -0,0 +1,172 @@
+/** \file his_shm.h
+  *
+  * \brief Live histograms of a running scan in shared memory
+  *
+  * \date Oct. 19th, 2026
+  *
+  * This file contains the layout of the shared memory segment in which a scan
+  * publishes the current contents of all of its histograms, and the classes
+  * used to write and sample it. The segment starts with a header, followed by
+  * a directory with one entry per histogram and the histogram cells, which
+  * use the same layout as the .his file. Every histogram has its own sequence
+  * lock, so the scan never waits on a viewer and viewers may copy any
+  * histogram at any time without touching the disk.
+*/
+
+#ifndef HIS_SHM_H
+#define HIS_SHM_H
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#define HIS_SHM_DEFAULT_NAME "/utkscan_his"
+#define HIS_SHM_MAGIC 0x4D534850 // "PHSM"
+#define HIS_SHM_VERSION 1
+
+/// Description of a single histogram in the directory of the segment.
+struct HisShmEntry{
+	unsigned int sequence; ///< Sequence lock counter. Odd while the histogram is being written, advances by two with every update.
+	unsigned int hisID; ///< The DAMM id of the histogram.
+	unsigned short hisDim; ///< Number of dimensions.
+	unsigned short halfWords; ///< Number of half-words (2 bytes) per cell, 1 or 2.
+	unsigned short scaled[4]; ///< Number of bins along each axis.
+	unsigned short minc[4]; ///< Minimum channel number along each axis.
+	unsigned short maxc[4]; ///< Maximum channel number along each axis.
+	unsigned int numBins; ///< Total number of cells.
+	unsigned long long offset; ///< Location of the first cell, in bytes from the start of the data.
+	char title[44]; ///< The title of the histogram.
+};
+
+/// The header at the start of the segment.
+struct HisShmHeader{
+	unsigned int magic; ///< Always HIS_SHM_MAGIC once the segment is initialized.
+	unsigned int version; ///< The layout version of the segment.
+	unsigned int closed; ///< Set to non-zero when the publishing scan exits.
+	unsigned int writerPid; ///< Process id of the publishing scan.
+	unsigned int numHis; ///< Number of entries in the directory.
+	unsigned int reserved; ///< Unused, keeps the following members aligned.
+	unsigned long long directoryOffset; ///< Location of the directory, in bytes from the start of the segment.
+	unsigned long long dataOffset; ///< Location of the histogram cells, in bytes from the start of the segment.
+	unsigned long long dataSize; ///< Size of the histogram cells in bytes.
+	char description[128]; ///< Description of the scan, e.g. the output filename.
+};
+
+/// Owns the histogram segment in shared memory and publishes fills to it.
+class HisShmPublisher{
+  public:
+	HisShmPublisher() : fd(-1), header(NULL), directory(NULL), data(NULL), size(0) { }
+
+	~HisShmPublisher(){ Close(); }
+
+	/** Create a new segment, replacing any segment left with the same name.
+	  * The histogram cells are only backed by memory once they are written.
+	  * \param[in] numHis_ Number of histograms in the directory.
+	  * \param[in] dataSize_ Size of the histogram cells in bytes.
+	  * \param[in] description_ Description of the scan.
+	  * \param[in] name_ Name of the shared memory object.
+	  * \return True if the segment is mapped and false otherwise.
+	  */
+	bool Open(unsigned int numHis_, unsigned long long dataSize_, const std::string &description_, const char *name_=HIS_SHM_DEFAULT_NAME);
+
+	/// Return true if the segment is mapped.
+	bool IsOpen(){ return (header != NULL); }
+
+	/// Return a directory entry, to be filled in before calling Activate().
+	HisShmEntry *GetEntry(unsigned int index_){ return &directory[index_]; }
+
+	/// Mark the segment as valid once all of the directory entries are set.
+	void Activate();
+
+	/// Add weight_ to a cell of a histogram.
+	void Add(HisShmEntry *entry_, unsigned int bin_, unsigned int weight_){
+		BeginWrite(entry_);
+		if(entry_->halfWords == 2){ ((unsigned int *)(data + entry_->offset))[bin_] += weight_; }
+		else{ ((unsigned short *)(data + entry_->offset))[bin_] += (unsigned short)weight_; }
+		EndWrite(entry_);
+	}
+
+	/// Set all cells of a histogram to zero.
+	void Zero(HisShmEntry *entry_);
+
+	/// Flag the segment as closed, unmap and remove it. Viewers which still have it mapped keep the final contents.
+	void Close();
+
+  private:
+	int fd; /// File descriptor of the shared memory object.
+	std::string name; /// Name of the shared memory object.
+	HisShmHeader *header; /// Pointer to the mapped segment.
+	HisShmEntry *directory; /// Pointer to the first directory entry.
+	char *data; /// Pointer to the histogram cells.
+	size_t size; /// Total size of the segment.
+
+	/// Mark a histogram as being written.
+	void BeginWrite(HisShmEntry *entry_){
+		__atomic_store_n(&entry_->sequence, entry_->sequence + 1, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+	}
+
+	/// Mark a histogram as consistent again after a call to BeginWrite().
+	void EndWrite(HisShmEntry *entry_){
+		__atomic_store_n(&entry_->sequence, entry_->sequence + 1, __ATOMIC_RELEASE);
+	}
+};
+
+/// Maps the histogram segment read-only and takes snapshots of single histograms.
+class HisShmReader{
+  public:
+	HisShmReader() : fd(-1), header(NULL), directory(NULL), data(NULL), size(0) { }
+
+	~HisShmReader(){ Close(); }
+
+	/** Map the shared memory segment published by a scan.
+	  * \param[in] name_ Name of the shared memory object.
+	  * \return True if the segment exists and has a valid layout and false otherwise.
+	  */
+	bool Open(const char *name_=HIS_SHM_DEFAULT_NAME);
+
+	/// Return true if the segment is mapped.
+	bool IsOpen(){ return (header != NULL); }
+
+	/// Return true if the publishing scan has closed the segment.
+	bool IsClosed(){ return (header && __atomic_load_n(&header->closed, __ATOMIC_ACQUIRE) != 0); }
+
+	/// Return the header of the segment, or NULL if it is not open.
+	const HisShmHeader *GetHeader(){ return header; }
+
+	/// Return the number of histograms in the directory.
+	unsigned int GetNumHistograms(){ return (header ? header->numHis : 0); }
+
+	/// Return a directory entry.
+	const HisShmEntry *GetEntry(unsigned int index_){ return &directory[index_]; }
+
+	/** Find a histogram in the directory.
+	  * \param[in] hisID_ The DAMM id of the histogram.
+	  * \return The index of the directory entry or -1 if the id is not found.
+	  */
+	int Find(unsigned int hisID_);
+
+	/** Copy the cells of a histogram. The copy is retried while the scan is
+	  * filling the histogram. A histogram which is filled continuously may
+	  * never be copied consistently, in which case the last attempt is kept.
+	  * \param[in] index_ The index of the directory entry.
+	  * \param[out] cells_ The contents of the histogram.
+	  * \param[out] sequence_ The sequence counter of the copy. It only changes when the histogram does.
+	  * \param[in] maxTries_ Maximum number of copy attempts.
+	  * \return True if a consistent snapshot was taken and false otherwise.
+	  */
+	bool Read(unsigned int index_, std::vector<unsigned int> &cells_, unsigned int &sequence_, unsigned int maxTries_=100);
+
+	/// Unmap the segment.
+	void Close();
+
+  private:
+	int fd; /// File descriptor of the shared memory object.
+	const HisShmHeader *header; /// Pointer to the mapped segment.
+	const HisShmEntry *directory; /// Pointer to the first directory entry.
+	const char *data; /// Pointer to the histogram cells.
+	size_t size; /// Total size of the segment.
+};
+
+#endif
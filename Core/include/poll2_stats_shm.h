@@ -0,0 +1,132 @@
+/** \file poll2_stats_shm.h
+  *
+  * \brief Shared memory statistics page for poll2
+  *
+  * \date Oct. 19th, 2026
+  *
+  * This file contains the layout of the statistics page which poll2 publishes
+  * in POSIX shared memory and the classes used to write and sample it. The page
+  * is protected by a sequence lock, so the acquisition thread never waits on a
+  * reader and any number of monitors or scripts may take consistent snapshots
+  * of the page at whatever rate they like.
+*/
+
+#ifndef POLL2_STATS_SHM_H
+#define POLL2_STATS_SHM_H
+
+#include <stddef.h>
+
+#define POLL2_STATS_SHM_NAME "/poll2_stats"
+#define POLL2_STATS_SHM_MAGIC 0x54533250 // "P2ST"
+#define POLL2_STATS_SHM_VERSION 1
+
+#define STATS_PAGE_MAX_MODULES 32
+#define STATS_PAGE_CHAN_PER_MOD 16
+
+/// Statistics of a single pixie16 channel.
+struct StatsPageChannel{
+	double inputCountRate; ///< The XIA module input count rate (Hz).
+	double outputCountRate; ///< The XIA module output count rate (Hz).
+	double eventRate; ///< Rate of events read from the FIFO during the current interval (Hz).
+	unsigned long long eventTotal; ///< Total number of events read from the FIFO.
+};
+
+/// Statistics of a single pixie16 module.
+struct StatsPageModule{
+	double dataRate; ///< Data rate of the current interval (B/s).
+	unsigned long long dataTotal; ///< Total number of bytes read from the FIFO.
+	unsigned int fifoWords; ///< Number of words in the external FIFO at the last read.
+	unsigned int partialWords; ///< Number of words of partial events held over to the next spill.
+	StatsPageChannel chan[STATS_PAGE_CHAN_PER_MOD];
+};
+
+/// The complete statistics page as it is laid out in shared memory.
+struct StatsPage{
+	unsigned int magic; ///< Always POLL2_STATS_SHM_MAGIC once the page is initialized.
+	unsigned int version; ///< The layout version of the page.
+	unsigned int sequence; ///< Sequence lock counter. Odd while the page is being written.
+	unsigned int numCards; ///< Number of modules in the system.
+	unsigned int closed; ///< Set to non-zero when the publishing poll2 exits.
+	unsigned int writerPid; ///< Process id of the publishing poll2.
+
+	unsigned long long updateCount; ///< Number of times the page has been published.
+	unsigned long long numSpills; ///< Number of spills read since the stats were cleared.
+
+	double totalTime; ///< Total run time (s).
+	double intervalTime; ///< Length of the current rate interval (s).
+	double dataRate; ///< Total data rate of the current interval (B/s).
+	double spillTime; ///< Time between the last two FIFO reads (s).
+	double spillWords; ///< Number of words in the last spill.
+	double writeTime; ///< Time spent writing and broadcasting the last spill (s).
+	double fileSize; ///< Size of the current output file (B), zero if no file is open.
+
+	StatsPageModule mod[STATS_PAGE_MAX_MODULES];
+};
+
+/// Owns the statistics page in shared memory and publishes updates to it.
+class StatsPagePublisher{
+  public:
+	StatsPagePublisher() : fd(-1), page(NULL) { }
+
+	~StatsPagePublisher(){ Close(); }
+
+	/** Create (or re-open) the shared memory page and mark it as active.
+	  * \param[in] numCards_ Number of modules to publish.
+	  * \param[in] name_ Name of the shared memory object.
+	  * \return True if the page is mapped and false otherwise.
+	  */
+	bool Open(unsigned int numCards_, const char *name_=POLL2_STATS_SHM_NAME);
+
+	/// Return true if the page is mapped.
+	bool IsOpen(){ return (page != NULL); }
+
+	/** Mark the page as being written. The returned pointer may be modified
+	  * freely until EndWrite() is called.
+	  * \return Pointer to the mapped page or NULL if it is not open.
+	  */
+	StatsPage *BeginWrite();
+
+	/// Mark the page as consistent again after a call to BeginWrite().
+	void EndWrite();
+
+	/// Flag the page as closed and unmap it. The shared memory object is left for readers to notice.
+	void Close();
+
+  private:
+	int fd; /// File descriptor of the shared memory object.
+	StatsPage *page; /// Pointer to the mapped page.
+};
+
+/// Maps the statistics page read-only and takes consistent snapshots of it.
+class StatsPageReader{
+  public:
+	StatsPageReader() : fd(-1), page(NULL) { }
+
+	~StatsPageReader(){ Close(); }
+
+	/** Map the shared memory page published by poll2.
+	  * \param[in] name_ Name of the shared memory object.
+	  * \return True if the page exists and has a valid layout and false otherwise.
+	  */
+	bool Open(const char *name_=POLL2_STATS_SHM_NAME);
+
+	/// Return true if the page is mapped.
+	bool IsOpen(){ return (page != NULL); }
+
+	/** Copy a consistent snapshot of the page. The copy is retried while the
+	  * publisher is in the middle of an update.
+	  * \param[out] snapshot_ The copy of the page.
+	  * \param[in] maxTries_ Maximum number of copy attempts before giving up.
+	  * \return True if a consistent snapshot was taken and false otherwise.
+	  */
+	bool Read(StatsPage &snapshot_, unsigned int maxTries_=1000);
+
+	/// Unmap the page.
+	void Close();
+
+  private:
+	int fd; /// File descriptor of the shared memory object.
+	const StatsPage *page; /// Pointer to the mapped page.
+};
+
+#endif
@@ -0,0 +1,92 @@
+/** \file trace_trim.h
+  *
+  * \brief Cuts the traces of raw pixie16 channel events down to a window
+  *
+  * \date Oct. 19th, 2026
+  *
+  * The analysis only uses the samples around the trigger of a trace, so
+  * poll2 may rewrite the channel events of a spill with every trace cut to a
+  * configurable number of samples before and after the trigger. The trigger
+  * sits at TRACE_DELAY in every trace of a channel, so the same window is cut
+  * from all of them and the trigger stays at a fixed sample of the trimmed
+  * trace (see TraceTrimWindow::GetTrigger). The event and trace length fields
+  * of the headers are updated, so the spill keeps the pixie16 list mode
+  * format and is read like any other.
+*/
+
+#ifndef TRACE_TRIM_H
+#define TRACE_TRIM_H
+
+#include <stddef.h>
+
+#include <vector>
+
+/// The window kept around the trigger of the traces of a channel.
+struct TraceTrimWindow{
+	unsigned int pre; ///< Number of samples kept before the trigger.
+	unsigned int post; ///< Number of samples kept after the trigger.
+	unsigned int trigger; ///< Sample of the untrimmed trace where the trigger is (TRACE_DELAY).
+	bool enabled; ///< True if the traces of the channel are trimmed.
+
+	TraceTrimWindow() : pre(0), post(0), trigger(0), enabled(false) { }
+
+	/// Return the first sample of the untrimmed trace which is kept.
+	unsigned int GetStart() const { return (trigger > pre ? trigger - pre : 0) & ~1u; }
+
+	/// Return the sample of the trimmed trace where the trigger is.
+	unsigned int GetTrigger() const { return trigger - GetStart(); }
+};
+
+/// Rewrites the channel events of a module in place with trimmed traces.
+class TraceTrimmer{
+  public:
+	TraceTrimmer() : numTrimmed(0), wordsRemoved(0) { }
+
+	/** Set the window of a channel. A module or channel of -1 selects all
+	  * modules or channels which are known.
+	  * \param[in] mod_ The module number, or -1 for all modules.
+	  * \param[in] chan_ The channel number, or -1 for all channels.
+	  * \param[in] pre_ Number of samples kept before the trigger.
+	  * \param[in] post_ Number of samples kept after the trigger.
+	  * \param[in] numMods_ Number of modules in the system, used for a module of -1.
+	  */
+	void SetWindow(int mod_, int chan_, unsigned int pre_, unsigned int post_, unsigned int numMods_);
+
+	/** Set the position of the trigger in the untrimmed traces of a channel.
+	  * \param[in] mod_ The module number.
+	  * \param[in] chan_ The channel number.
+	  * \param[in] trigger_ The trace delay of the channel in samples.
+	  */
+	void SetTrigger(unsigned int mod_, unsigned int chan_, unsigned int trigger_);
+
+	/// Stop trimming the traces of all channels.
+	void Disable();
+
+	/// Return true if the traces of any channel are trimmed.
+	bool IsEnabled() const;
+
+	/// Return the window of a channel.
+	TraceTrimWindow GetWindow(unsigned int mod_, unsigned int chan_) const;
+
+	/** Trim the traces of the complete channel events of a module.
+	  * \param[in,out] data_ Pointer to the first channel event.
+	  * \param[in] nWords_ Number of words of channel events.
+	  * \param[in] mod_ The module number the events were read from.
+	  * \return The number of words left after trimming.
+	  */
+	size_t Trim(unsigned int *data_, size_t nWords_, unsigned int mod_);
+
+	/// Return the number of traces which were cut.
+	unsigned long long GetNumTrimmed() const { return numTrimmed; }
+
+	/// Return the number of words removed from the data stream.
+	unsigned long long GetWordsRemoved() const { return wordsRemoved; }
+
+  private:
+	std::vector<TraceTrimWindow> windows; /// Windows indexed by 16 * module + channel.
+
+	unsigned long long numTrimmed; /// Number of traces which were cut.
+	unsigned long long wordsRemoved; /// Number of words removed from the data stream.
+};
+
+#endif
@@ -0,0 +1,487 @@
+/** \file ColumnFile.cpp
+  *
+  * \brief Columnar binary event files
+  *
+  * \date Oct. 19th, 2026
+*/
+
+#include "ColumnFile.h"
+
+#include <iostream>
+#include <string.h>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+/// Maximum number of filled chunks waiting for the writer thread.
+#define MAX_QUEUED_CHUNKS 4
+
+unsigned int GetColumnTypeSize(const ColumnType &type_){
+	switch(type_){
+		case COLUMN_INT32:
+		case COLUMN_UINT32:
+		case COLUMN_FLOAT:
+			return 4;
+		case COLUMN_INT64:
+		case COLUMN_UINT64:
+		case COLUMN_DOUBLE:
+			return 8;
+	}
+	return 0;
+}
+
+std::string GetColumnTypeName(const ColumnType &type_){
+	switch(type_){
+		case COLUMN_INT32: return "int32";
+		case COLUMN_UINT32: return "uint32";
+		case COLUMN_INT64: return "int64";
+		case COLUMN_UINT64: return "uint64";
+		case COLUMN_FLOAT: return "float";
+		case COLUMN_DOUBLE: return "double";
+	}
+	return "unknown";
+}
+
+/** Group the n'th byte of every element together so that slowly changing
+  * values turn into long runs of similar bytes.
+  */
+static void shuffle(const char *in_, char *out_, size_t numElements_, unsigned int size_){
+	for(size_t i = 0; i < numElements_; i++){
+		for(unsigned int b = 0; b < size_; b++){
+			out_[b*numElements_+i] = in_[i*size_+b];
+		}
+	}
+}
+
+/// Undo shuffle().
+static void unshuffle(const char *in_, char *out_, size_t numElements_, unsigned int size_){
+	for(size_t i = 0; i < numElements_; i++){
+		for(unsigned int b = 0; b < size_; b++){
+			out_[i*size_+b] = in_[b*numElements_+i];
+		}
+	}
+}
+
+/////////////////////////////////////////////////////////////////////
+// class ColumnWriter
+/////////////////////////////////////////////////////////////////////
+
+ColumnWriter::ColumnWriter() : rowsPerChunk(4096), level(1), numEntries(0), bytesWritten(0), writeError(false), current(NULL), stopWorker(false) {
+}
+
+bool ColumnWriter::AddColumn(const std::string &name_, const ColumnType &type_, const void *address_, const unsigned int &count_/*=1*/){
+	if(output.is_open() || !address_ || count_ == 0 || name_.empty() || GetColumnTypeSize(type_) == 0){ return false; }
+
+	for(std::vector<ColumnInfo>::iterator iter = columns.begin(); iter != columns.end(); iter++){
+		if(iter->name == name_){
+			std::cout << " ColumnWriter: Column \"" << name_ << "\" is already defined.\n";
+			return false;
+		}
+	}
+
+	columns.push_back(ColumnInfo(name_, type_, count_));
+	addresses.push_back(address_);
+
+	return true;
+}
+
+bool ColumnWriter::Open(const std::string &filename_, const unsigned int &rowsPerChunk_/*=4096*/, const int &level_/*=1*/){
+	if(output.is_open() || columns.empty()){ return false; }
+
+	output.open(filename_.c_str(), std::ios::binary);
+	if(!output.good()){
+		output.close();
+		return false;
+	}
+
+	filename = filename_;
+	rowsPerChunk = (rowsPerChunk_ > 0 ? rowsPerChunk_ : 1);
+	level = level_;
+	numEntries = 0;
+	writeError = false;
+	stopWorker = false;
+
+	unsigned int header[3] = {COLUMN_FILE_MAGIC, COLUMN_FILE_VERSION, (unsigned int)columns.size()};
+	output.write((char *)header, sizeof(header));
+	bytesWritten = sizeof(header);
+	for(std::vector<ColumnInfo>::iterator iter = columns.begin(); iter != columns.end(); iter++){
+		unsigned int desc[3] = {(unsigned int)iter->type, iter->count, (unsigned int)iter->name.size()};
+		output.write((char *)desc, sizeof(desc));
+		output.write(iter->name.c_str(), iter->name.size());
+		bytesWritten += sizeof(desc) + iter->name.size();
+	}
+
+	current = NewChunk();
+	worker = std::thread(&ColumnWriter::WriterLoop, this);
+
+	return output.good();
+}
+
+void ColumnWriter::Fill(){
+	if(!current){ return; }
+
+	for(size_t i = 0; i < columns.size(); i++){
+		std::vector<char> &block = current->data[i];
+		const char *ptr = (const char *)addresses[i];
+		block.insert(block.end(), ptr, ptr + columns[i].GetRowSize());
+	}
+
+	numEntries++;
+	if(++current->numRows >= rowsPerChunk){ QueueChunk(); }
+}
+
+void ColumnWriter::Flush(){
+	if(current && current->numRows > 0){ QueueChunk(); }
+}
+
+void ColumnWriter::Close(){
+	if(!output.is_open()){ return; }
+
+	if(current && current->numRows > 0){ QueueChunk(); }
+	delete current;
+	current = NULL;
+
+	{
+		std::unique_lock<std::mutex> lock(queueLock);
+		stopWorker = true;
+	}
+	queueCond.notify_all();
+	worker.join();
+
+	unsigned int marker = COLUMN_END_MARKER;
+	output.write((char *)&marker, sizeof(marker));
+	output.write((char *)&numEntries, sizeof(numEntries));
+	bytesWritten += sizeof(marker) + sizeof(numEntries);
+	output.close();
+
+	if(writeError){ std::cout << " ColumnWriter: Failed to write to " << filename << "!\n"; }
+}
+
+ColumnWriter::Chunk *ColumnWriter::NewChunk(){
+	Chunk *chunk = new Chunk;
+	chunk->numRows = 0;
+	chunk->data.resize(columns.size());
+	for(size_t i = 0; i < columns.size(); i++){
+		chunk->data[i].reserve(rowsPerChunk*columns[i].GetRowSize());
+	}
+	return chunk;
+}
+
+void ColumnWriter::QueueChunk(){
+	{
+		std::unique_lock<std::mutex> lock(queueLock);
+		while(queue.size() >= MAX_QUEUED_CHUNKS){ queueCond.wait(lock); }
+		queue.push_back(current);
+	}
+	queueCond.notify_all();
+	current = NewChunk();
+}
+
+void ColumnWriter::WriterLoop(){
+	std::vector<char> shuffled, compressed;
+	while(true){
+		Chunk *chunk = NULL;
+		{
+			std::unique_lock<std::mutex> lock(queueLock);
+			while(queue.empty() && !stopWorker){ queueCond.wait(lock); }
+			if(queue.empty()){ return; }
+			chunk = queue.front();
+			queue.pop_front();
+		}
+		queueCond.notify_all();
+
+		if(!WriteChunk(chunk, shuffled, compressed) || !output.flush().good()){ writeError = true; }
+		delete chunk;
+	}
+}
+
+bool ColumnWriter::WriteChunk(Chunk *chunk_, std::vector<char> &shuffled_, std::vector<char> &compressed_){
+	unsigned int header[2] = {COLUMN_CHUNK_MARKER, chunk_->numRows};
+	output.write((char *)header, sizeof(header));
+	bytesWritten += sizeof(header);
+
+	for(size_t i = 0; i < columns.size(); i++){
+		const std::vector<char> &block = chunk_->data[i];
+		unsigned int size = GetColumnTypeSize(columns[i].type);
+		unsigned int rawBytes = block.size();
+
+		shuffled_.resize(rawBytes);
+		if(rawBytes > 0){ shuffle(&block[0], &shuffled_[0], rawBytes/size, size); }
+
+		unsigned int codec = CODEC_SHUFFLE;
+		const char *stored = (rawBytes > 0 ? &shuffled_[0] : NULL);
+		unsigned int storedBytes = rawBytes;
+
+#ifdef USE_ZLIB
+		if(level > 0 && rawBytes > 0){
+			uLongf destLen = compressBound(rawBytes);
+			compressed_.resize(destLen);
+			if(compress2((Bytef *)&compressed_[0], &destLen, (const Bytef *)&shuffled_[0], rawBytes, level) == Z_OK && destLen < rawBytes){
+				codec = CODEC_SHUFFLE_ZLIB;
+				stored = &compressed_[0];
+				storedBytes = destLen;
+			}
+		}
+#endif
+
+		unsigned int desc[3] = {codec, rawBytes, storedBytes};
+		output.write((char *)desc, sizeof(desc));
+		if(storedBytes > 0){ output.write(stored, storedBytes); }
+		bytesWritten += sizeof(desc) + storedBytes;
+	}
+
+	return output.good();
+}
+
+/////////////////////////////////////////////////////////////////////
+// class ColumnReader
+/////////////////////////////////////////////////////////////////////
+
+bool ColumnReader::Open(const std::string &filename_){
+	if(input.is_open()){ return false; }
+
+	input.open(filename_.c_str(), std::ios::binary);
+	if(!input.good()){
+		input.close();
+		return false;
+	}
+
+	unsigned int header[3];
+	input.read((char *)header, sizeof(header));
+	if(!input.good() || header[0] != COLUMN_FILE_MAGIC || header[1] != COLUMN_FILE_VERSION){
+		std::cout << " ColumnReader: " << filename_ << " is not a valid column file.\n";
+		Close();
+		return false;
+	}
+
+	columns.clear();
+	for(unsigned int i = 0; i < header[2]; i++){
+		unsigned int desc[3];
+		input.read((char *)desc, sizeof(desc));
+		if(!input.good() || GetColumnTypeSize((ColumnType)desc[0]) == 0 || desc[2] > 1024){
+			std::cout << " ColumnReader: Invalid column description in " << filename_ << ".\n";
+			Close();
+			return false;
+		}
+		std::string name(desc[2], '\0');
+		input.read(&name[0], desc[2]);
+		columns.push_back(ColumnInfo(name, (ColumnType)desc[0], desc[1]));
+	}
+	if(!input.good()){
+		Close();
+		return false;
+	}
+	dataStart = input.tellg();
+
+	active.assign(columns.size(), true);
+	data.assign(columns.size(), std::vector<char>());
+
+	// Read the footer if the file was closed properly.
+	numEntries = 0;
+	unsigned int marker = 0;
+	unsigned long long entries = 0;
+	input.seekg(-(std::streamoff)(sizeof(marker) + sizeof(entries)), std::ios::end);
+	input.read((char *)&marker, sizeof(marker));
+	input.read((char *)&entries, sizeof(entries));
+	if(input.good() && marker == COLUMN_END_MARKER){ numEntries = entries; }
+
+	return Rewind();
+}
+
+void ColumnReader::Close(){
+	if(input.is_open()){ input.close(); }
+	columns.clear();
+	active.clear();
+	data.clear();
+	numEntries = 0;
+	chunkRows = 0;
+}
+
+int ColumnReader::FindColumn(const std::string &name_){
+	for(size_t i = 0; i < columns.size(); i++){
+		if(columns[i].name == name_){ return (int)i; }
+	}
+	return -1;
+}
+
+void ColumnReader::SetActive(const size_t &index_, const bool &active_){
+	if(index_ >= active.size()){ return; }
+	active[index_] = active_;
+	if(!active_){ std::vector<char>().swap(data[index_]); }
+}
+
+bool ColumnReader::SetActiveColumns(const std::vector<std::string> &names_){
+	bool retval = true;
+	for(size_t i = 0; i < columns.size(); i++){ SetActive(i, false); }
+	for(std::vector<std::string>::const_iterator iter = names_.begin(); iter != names_.end(); iter++){
+		int index = FindColumn(*iter);
+		if(index < 0){
+			std::cout << " ColumnReader: Unknown column \"" << *iter << "\".\n";
+			retval = false;
+			continue;
+		}
+		SetActive(index, true);
+	}
+	return retval;
+}
+
+bool ColumnReader::Rewind(){
+	if(!input.is_open()){ return false; }
+	input.clear();
+	input.seekg(dataStart);
+	chunkRows = 0;
+	return input.good();
+}
+
+bool ColumnReader::ReadChunk(){
+	chunkRows = 0;
+	if(!input.is_open()){ return false; }
+
+	unsigned int header[2];
+	input.read((char *)header, sizeof(header));
+	if(!input.good() || header[0] != COLUMN_CHUNK_MARKER){ return false; }
+
+	for(size_t i = 0; i < columns.size(); i++){
+		unsigned int desc[3];
+		input.read((char *)desc, sizeof(desc));
+		if(!input.good()){ return false; }
+
+		unsigned int codec = desc[0];
+		unsigned int rawBytes = desc[1];
+		unsigned int storedBytes = desc[2];
+		unsigned int size = GetColumnTypeSize(columns[i].type);
+
+		if(rawBytes != (unsigned long long)header[1]*columns[i].GetRowSize()){
+			std::cout << " ColumnReader: Column \"" << columns[i].name << "\" has an invalid size.\n";
+			return false;
+		}
+
+		if(!active[i]){
+			input.seekg(storedBytes, std::ios::cur);
+			continue;
+		}
+
+		data[i].resize(rawBytes);
+		stored.resize(storedBytes);
+		if(storedBytes > 0){ input.read(&stored[0], storedBytes); }
+		if(!input.good()){ return false; }
+		if(rawBytes == 0){ continue; }
+
+		if(codec == CODEC_RAW && storedBytes == rawBytes){
+			memcpy(&data[i][0], &stored[0], rawBytes);
+		}
+		else if(codec == CODEC_SHUFFLE && storedBytes == rawBytes){
+			unshuffle(&stored[0], &data[i][0], rawBytes/size, size);
+		}
+#ifdef USE_ZLIB
+		else if(codec == CODEC_SHUFFLE_ZLIB){
+			shuffled.resize(rawBytes);
+			uLongf destLen = rawBytes;
+			if(uncompress((Bytef *)&shuffled[0], &destLen, (const Bytef *)&stored[0], storedBytes) != Z_OK || destLen != rawBytes){
+				std::cout << " ColumnReader: Failed to inflate column \"" << columns[i].name << "\".\n";
+				return false;
+			}
+			unshuffle(&shuffled[0], &data[i][0], rawBytes/size, size);
+		}
+#endif
+		else{
+			std::cout << " ColumnReader: Unsupported codec " << codec << " for column \"" << columns[i].name << "\".\n";
+			return false;
+		}
+	}
+
+	chunkRows = header[1];
+	return true;
+}
+
+const void *ColumnReader::GetData(const size_t &index_){
+	if(index_ >= columns.size() || !active[index_] || data[index_].empty()){ return NULL; }
+	return &data[index_][0];
+}
+
+double ColumnReader::GetValue(const size_t &index_, const unsigned int &row_, const unsigned int &element_/*=0*/){
+	const char *ptr = (const char *)GetData(index_);
+	if(!ptr || row_ >= chunkRows || element_ >= columns[index_].count){ return 0; }
+
+	size_t offset = (size_t)row_*columns[index_].count + element_;
+	switch(columns[index_].type){
+		case COLUMN_INT32: return ((const int *)ptr)[offset];
+		case COLUMN_UINT32: return ((const unsigned int *)ptr)[offset];
+		case COLUMN_INT64: return ((const long long *)ptr)[offset];
+		case COLUMN_UINT64: return ((const unsigned long long *)ptr)[offset];
+		case COLUMN_FLOAT: return ((const float *)ptr)[offset];
+		case COLUMN_DOUBLE: return ((const double *)ptr)[offset];
+	}
+	return 0;
+}
+
+bool ColumnReader::GetValues(const size_t &index_, std::vector<double> &values_){
+	if(!GetData(index_)){ return false; }
+	unsigned int count = columns[index_].count;
+	values_.reserve(values_.size() + (size_t)chunkRows*count);
+	for(unsigned int row = 0; row < chunkRows; row++){
+		for(unsigned int element = 0; element < count; element++){
+			values_.push_back(GetValue(index_, row, element));
+		}
+	}
+	return true;
+}
+
+bool MergeColumnFiles(const std::vector<std::string> &inputs_, const std::string &output_, std::string &error_){
+	if(inputs_.empty()){
+		error_ = "No input files";
+		return false;
+	}
+
+	// The schema of the first input defines the output.
+	ColumnReader first;
+	if(!first.Open(inputs_.front())){
+		error_ = "Failed to open " + inputs_.front();
+		return false;
+	}
+	std::vector<ColumnInfo> columns;
+	for(size_t i = 0; i < first.GetNumColumns(); i++){ columns.push_back(first.GetColumn(i)); }
+	first.Close();
+
+	// The writer copies one event from these buffers on every Fill().
+	std::vector<std::vector<char> > row(columns.size());
+	ColumnWriter writer;
+	for(size_t i = 0; i < columns.size(); i++){
+		row[i].resize(columns[i].GetRowSize());
+		writer.AddColumn(columns[i].name, columns[i].type, &row[i][0], columns[i].count);
+	}
+	if(!writer.Open(output_)){
+		error_ = "Failed to open " + output_;
+		return false;
+	}
+
+	for(std::vector<std::string>::const_iterator iter = inputs_.begin(); iter != inputs_.end(); iter++){
+		ColumnReader reader;
+		if(!reader.Open(*iter)){
+			error_ = "Failed to open " + *iter;
+			return false;
+		}
+		bool match = (reader.GetNumColumns() == columns.size());
+		for(size_t i = 0; match && i < columns.size(); i++){
+			const ColumnInfo &info = reader.GetColumn(i);
+			match = (info.name == columns[i].name && info.type == columns[i].type && info.count == columns[i].count);
+		}
+		if(!match){
+			error_ = "The columns of " + *iter + " do not match those of " + inputs_.front();
+			return false;
+		}
+
+		while(reader.ReadChunk()){
+			for(unsigned int j = 0; j < reader.GetChunkRows(); j++){
+				for(size_t i = 0; i < columns.size(); i++)
+					memcpy(&row[i][0], (const char *)reader.GetData(i) + j*row[i].size(), row[i].size());
+				writer.Fill();
+			}
+		}
+	}
+
+	writer.Close();
+
+	return true;
+}
@@ -0,0 +1,85 @@
+/** \file fifo_sched.cpp
+  *
+  * \brief Decides when poll2 checks and reads the module FIFOs
+  *
+  * \date Oct. 19th, 2026
+*/
+
+#include "fifo_sched.h"
+
+#define RATE_SMOOTHING 0.3 // Weight of the newest measurement in the running average of the rate.
+#define WAKE_FRACTION 0.8 // Fraction of the predicted time to the threshold which is slept.
+
+FifoScheduler::FifoScheduler(const size_t &fifoLength_, const size_t &minWords_) :
+	fifoLength(fifoLength_),
+	minWords(minWords_),
+	threshold(fifoLength_/2),
+	maxLatency(1.0),
+	overflowMargin(0.02),
+	minWait(50e-6),
+	maxWait(10e-3),
+	numChecks(0)
+{
+}
+
+void FifoScheduler::SetNumModules(const size_t &numMods_){
+	states.assign(numMods_, FifoState());
+	numChecks = 0;
+}
+
+void FifoScheduler::Check(const size_t &mod_, const size_t &words_, const double &time_){
+	if(mod_ >= states.size()){ return; }
+	FifoState &state = states[mod_];
+	numChecks++;
+
+	// A FIFO which emptied without a read (e.g. a new run) says nothing about the rate.
+	double dt = time_ - state.time;
+	if(state.time >= 0 && dt > 0 && words_ >= state.words){
+		double current = (words_ - state.words)/dt;
+		state.rate = RATE_SMOOTHING*current + (1-RATE_SMOOTHING)*state.rate;
+	}
+
+	state.words = words_;
+	state.time = time_;
+}
+
+void FifoScheduler::Drained(const size_t &mod_, const double &time_){
+	if(mod_ >= states.size()){ return; }
+	states[mod_].words = 0;
+	states[mod_].time = time_;
+}
+
+bool FifoScheduler::ShouldRead() const {
+	for(size_t mod = 0; mod < states.size(); mod++){
+		if(states[mod].words >= GetThreshold(mod)){ return true; }
+	}
+	return false;
+}
+
+double FifoScheduler::GetWait(const double &time_) const {
+	double wait = maxWait;
+	for(size_t mod = 0; mod < states.size(); mod++){
+		const FifoState &state = states[mod];
+		if(state.rate <= 0){ continue; }
+
+		// Words expected to have arrived since the last check.
+		double words = state.words + state.rate*(state.time >= 0 ? time_ - state.time : 0);
+		double remaining = (GetThreshold(mod) - words)/state.rate;
+		if(WAKE_FRACTION*remaining < wait){ wait = WAKE_FRACTION*remaining; }
+	}
+	return (wait < minWait ? minWait : wait);
+}
+
+size_t FifoScheduler::GetThreshold(const size_t &mod_) const {
+	double rate = (mod_ < states.size() ? states[mod_].rate : 0);
+	double words = threshold;
+
+	// Read at least once per maximum latency when the module fills slowly.
+	if(rate*maxLatency < words){ words = rate*maxLatency; }
+
+	// Keep enough room above the threshold for the overflow margin when it fills quickly.
+	double room = fifoLength - rate*overflowMargin;
+	if(room < words){ words = room; }
+
+	return (words < minWords ? minWords : (size_t)words);
+}
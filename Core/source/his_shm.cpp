@@ -0,0 +1,191 @@
+/** \file his_shm.cpp
+  *
+  * \brief Live histograms of a running scan in shared memory
+  *
+  * \date Oct. 19th, 2026
+  *
+  * Every histogram in the directory carries its own sequence lock. The
+  * publisher increments the counter before and after every fill, so the
+  * counter is odd while the histogram is inconsistent. Readers copy the cells
+  * and only accept the copy if the counter was even and unchanged across it.
+*/
+
+#include "his_shm.h"
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/////////////////////////////////////////////////////////////////////
+// class HisShmPublisher
+/////////////////////////////////////////////////////////////////////
+
+bool HisShmPublisher::Open(unsigned int numHis_, unsigned long long dataSize_, const std::string &description_, const char *name_/*=HIS_SHM_DEFAULT_NAME*/){
+	if(header){ return true; }
+
+	// A segment left by a scan which did not exit cleanly may have a different
+	// size, readers which still have it mapped keep their copy.
+	shm_unlink(name_);
+	fd = shm_open(name_, O_CREAT | O_EXCL | O_RDWR, 0644);
+	if(fd < 0){ return false; }
+	name = name_;
+
+	size_t directoryOffset = sizeof(HisShmHeader);
+	size_t dataOffset = directoryOffset + numHis_ * sizeof(HisShmEntry);
+	dataOffset = (dataOffset + 63) & ~(size_t)63; // Keep the cells cache line aligned.
+	size = dataOffset + dataSize_;
+
+	// The new object reads as zeros and only uses memory for the pages which are written.
+	if(ftruncate(fd, size) != 0){
+		Close();
+		return false;
+	}
+
+	void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(ptr == MAP_FAILED){
+		Close();
+		return false;
+	}
+	header = (HisShmHeader *)ptr;
+	directory = (HisShmEntry *)((char *)ptr + directoryOffset);
+	data = (char *)ptr + dataOffset;
+
+	header->version = HIS_SHM_VERSION;
+	header->writerPid = (unsigned int)getpid();
+	header->numHis = numHis_;
+	header->directoryOffset = directoryOffset;
+	header->dataOffset = dataOffset;
+	header->dataSize = dataSize_;
+	strncpy(header->description, description_.c_str(), sizeof(header->description) - 1);
+
+	return true;
+}
+
+void HisShmPublisher::Activate(){
+	if(!header){ return; }
+	__atomic_store_n(&header->magic, HIS_SHM_MAGIC, __ATOMIC_RELEASE);
+}
+
+void HisShmPublisher::Zero(HisShmEntry *entry_){
+	if(!header){ return; }
+	BeginWrite(entry_);
+	memset(data + entry_->offset, 0, (size_t)entry_->numBins * entry_->halfWords * 2);
+	EndWrite(entry_);
+}
+
+void HisShmPublisher::Close(){
+	if(header){
+		__atomic_store_n(&header->closed, 1, __ATOMIC_RELEASE);
+		munmap(header, size);
+		header = NULL;
+		directory = NULL;
+		data = NULL;
+	}
+	if(fd >= 0){
+		close(fd);
+		fd = -1;
+		shm_unlink(name.c_str());
+	}
+}
+
+/////////////////////////////////////////////////////////////////////
+// class HisShmReader
+/////////////////////////////////////////////////////////////////////
+
+bool HisShmReader::Open(const char *name_/*=HIS_SHM_DEFAULT_NAME*/){
+	if(header){ return true; }
+
+	fd = shm_open(name_, O_RDONLY, 0);
+	if(fd < 0){ return false; }
+
+	struct stat info;
+	if(fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(HisShmHeader)){
+		Close();
+		return false;
+	}
+	size = info.st_size;
+
+	void *ptr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	if(ptr == MAP_FAILED){
+		size = 0;
+		Close();
+		return false;
+	}
+	header = (const HisShmHeader *)ptr;
+
+	// The directory is only complete once the magic number is set.
+	if(__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != HIS_SHM_MAGIC || header->version != HIS_SHM_VERSION ||
+	   header->directoryOffset + (unsigned long long)header->numHis * sizeof(HisShmEntry) > size ||
+	   header->dataOffset + header->dataSize > size){
+		Close();
+		return false;
+	}
+	directory = (const HisShmEntry *)((const char *)ptr + header->directoryOffset);
+	data = (const char *)ptr + header->dataOffset;
+
+	return true;
+}
+
+int HisShmReader::Find(unsigned int hisID_){
+	if(!header){ return -1; }
+
+	// The directory is sorted by histogram id.
+	unsigned int low = 0, high = header->numHis;
+	while(low < high){
+		unsigned int mid = (low + high) / 2;
+		if(directory[mid].hisID < hisID_){ low = mid + 1; }
+		else{ high = mid; }
+	}
+	if(low < header->numHis && directory[low].hisID == hisID_){ return (int)low; }
+	return -1;
+}
+
+bool HisShmReader::Read(unsigned int index_, std::vector<unsigned int> &cells_, unsigned int &sequence_, unsigned int maxTries_/*=100*/){
+	if(!header || index_ >= header->numHis){ return false; }
+
+	const HisShmEntry *entry = &directory[index_];
+	size_t cellSize = entry->halfWords * 2;
+	size_t numBytes = (size_t)entry->numBins * cellSize;
+	if((cellSize != 2 && cellSize != 4) || numBytes == 0 || entry->offset + numBytes > header->dataSize){ return false; }
+
+	std::vector<char> buffer(numBytes);
+	bool consistent = false;
+	for(unsigned int attempt = 0; attempt < maxTries_ && !consistent; attempt++){
+		unsigned int before = __atomic_load_n(&entry->sequence, __ATOMIC_ACQUIRE);
+		if((before & 1) && attempt + 1 < maxTries_){ // The scan is in the middle of a fill.
+			usleep(1);
+			continue;
+		}
+
+		memcpy(&buffer[0], data + entry->offset, numBytes);
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		sequence_ = __atomic_load_n(&entry->sequence, __ATOMIC_RELAXED);
+		consistent = (!(before & 1) && sequence_ == before);
+	}
+
+	cells_.resize(entry->numBins);
+	if(cellSize == 4){ memcpy(&cells_[0], &buffer[0], numBytes); }
+	else{
+		const unsigned short *sval = (const unsigned short *)&buffer[0];
+		for(size_t i = 0; i < entry->numBins; i++){ cells_[i] = sval[i]; }
+	}
+
+	return consistent;
+}
+
+void HisShmReader::Close(){
+	if(header){
+		munmap((void *)header, size);
+		header = NULL;
+		directory = NULL;
+		data = NULL;
+	}
+	if(fd >= 0){
+		close(fd);
+		fd = -1;
+	}
+	size = 0;
+}
@@ -0,0 +1,153 @@
+/** \file poll2_stats_shm.cpp
+  *
+  * \brief Shared memory statistics page for poll2
+  *
+  * \date Oct. 19th, 2026
+  *
+  * The page is guarded by a sequence lock. The publisher increments the
+  * sequence counter before and after every update, so the counter is odd
+  * while the page is inconsistent. Readers copy the page and only accept the
+  * copy if the counter was even and unchanged across the copy.
+*/
+
+#include "poll2_stats_shm.h"
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/////////////////////////////////////////////////////////////////////
+// class StatsPagePublisher
+/////////////////////////////////////////////////////////////////////
+
+bool StatsPagePublisher::Open(unsigned int numCards_, const char *name_/*=POLL2_STATS_SHM_NAME*/){
+	if(page){ return true; }
+
+	fd = shm_open(name_, O_CREAT | O_RDWR, 0644);
+	if(fd < 0){ return false; }
+
+	if(ftruncate(fd, sizeof(StatsPage)) != 0){
+		close(fd);
+		fd = -1;
+		return false;
+	}
+
+	void *ptr = mmap(NULL, sizeof(StatsPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(ptr == MAP_FAILED){
+		close(fd);
+		fd = -1;
+		return false;
+	}
+	page = (StatsPage *)ptr;
+
+	// Keep the sequence counter from any previous publisher so that a reader
+	// which is mid-copy across a restart still detects the change.
+	unsigned int seq = __atomic_load_n(&page->sequence, __ATOMIC_RELAXED);
+	__atomic_store_n(&page->sequence, seq | 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	memset((char *)page + offsetof(StatsPage, numCards), 0, sizeof(StatsPage) - offsetof(StatsPage, numCards));
+	page->magic = POLL2_STATS_SHM_MAGIC;
+	page->version = POLL2_STATS_SHM_VERSION;
+	page->numCards = (numCards_ < STATS_PAGE_MAX_MODULES ? numCards_ : STATS_PAGE_MAX_MODULES);
+	page->writerPid = (unsigned int)getpid();
+
+	__atomic_store_n(&page->sequence, (seq | 1) + 1, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+StatsPage *StatsPagePublisher::BeginWrite(){
+	if(!page){ return NULL; }
+	__atomic_store_n(&page->sequence, page->sequence + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	return page;
+}
+
+void StatsPagePublisher::EndWrite(){
+	if(!page){ return; }
+	page->updateCount++;
+	__atomic_store_n(&page->sequence, page->sequence + 1, __ATOMIC_RELEASE);
+}
+
+void StatsPagePublisher::Close(){
+	if(page){
+		BeginWrite();
+		page->closed = 1;
+		EndWrite();
+		munmap(page, sizeof(StatsPage));
+		page = NULL;
+	}
+	if(fd >= 0){
+		close(fd);
+		fd = -1;
+	}
+}
+
+/////////////////////////////////////////////////////////////////////
+// class StatsPageReader
+/////////////////////////////////////////////////////////////////////
+
+bool StatsPageReader::Open(const char *name_/*=POLL2_STATS_SHM_NAME*/){
+	if(page){ return true; }
+
+	fd = shm_open(name_, O_RDONLY, 0);
+	if(fd < 0){ return false; }
+
+	struct stat info;
+	if(fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(StatsPage)){
+		close(fd);
+		fd = -1;
+		return false;
+	}
+
+	void *ptr = mmap(NULL, sizeof(StatsPage), PROT_READ, MAP_SHARED, fd, 0);
+	if(ptr == MAP_FAILED){
+		close(fd);
+		fd = -1;
+		return false;
+	}
+	page = (const StatsPage *)ptr;
+
+	if(page->magic != POLL2_STATS_SHM_MAGIC || page->version != POLL2_STATS_SHM_VERSION){
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+bool StatsPageReader::Read(StatsPage &snapshot_, unsigned int maxTries_/*=1000*/){
+	if(!page){ return false; }
+
+	for(unsigned int attempt = 0; attempt < maxTries_; attempt++){
+		unsigned int before = __atomic_load_n(&page->sequence, __ATOMIC_ACQUIRE);
+		if(before & 1){ // The publisher is in the middle of an update.
+			usleep(10);
+			continue;
+		}
+
+		memcpy(&snapshot_, (const void *)page, sizeof(StatsPage));
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if(__atomic_load_n(&page->sequence, __ATOMIC_RELAXED) == before){
+			if(snapshot_.numCards > STATS_PAGE_MAX_MODULES){ snapshot_.numCards = STATS_PAGE_MAX_MODULES; }
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void StatsPageReader::Close(){
+	if(page){
+		munmap((void *)page, sizeof(StatsPage));
+		page = NULL;
+	}
+	if(fd >= 0){
+		close(fd);
+		fd = -1;
+	}
+}
@@ -0,0 +1,110 @@
+/** \file trace_trim.cpp
+  *
+  * \brief Cuts the traces of raw pixie16 channel events down to a window
+  *
+  * \date Oct. 19th, 2026
+  *
+  * The window always starts on an even sample and has an even length, so the
+  * kept samples are copied as whole words without repacking. The window does
+  * not depend on the trace, so the trigger is at the same sample of every
+  * trimmed trace of a channel.
+*/
+
+#include "trace_trim.h"
+
+#include <string.h>
+
+#define TRIM_CHAN_PER_MOD 16
+#define TRIM_EVENT_LENGTH_MASK 0x1FFE0000
+#define TRIM_TRACE_LENGTH_MASK 0x7FFF0000
+
+void TraceTrimmer::SetWindow(int mod_, int chan_, unsigned int pre_, unsigned int post_, unsigned int numMods_){
+	unsigned int firstMod = (mod_ < 0 ? 0 : mod_);
+	unsigned int lastMod = (mod_ < 0 ? numMods_ : mod_ + 1);
+	unsigned int firstChan = (chan_ < 0 ? 0 : chan_);
+	unsigned int lastChan = (chan_ < 0 ? TRIM_CHAN_PER_MOD : chan_ + 1);
+	if(firstChan >= TRIM_CHAN_PER_MOD || lastMod <= firstMod){ return; }
+
+	if(windows.size() < lastMod * TRIM_CHAN_PER_MOD){ windows.resize(lastMod * TRIM_CHAN_PER_MOD); }
+	for(unsigned int mod = firstMod; mod < lastMod; mod++){
+		for(unsigned int chan = firstChan; chan < lastChan; chan++){
+			TraceTrimWindow &window = windows[mod * TRIM_CHAN_PER_MOD + chan];
+			window.pre = pre_;
+			window.post = post_;
+			window.enabled = true;
+		}
+	}
+}
+
+void TraceTrimmer::SetTrigger(unsigned int mod_, unsigned int chan_, unsigned int trigger_){
+	if(chan_ >= TRIM_CHAN_PER_MOD){ return; }
+	if(windows.size() < (mod_ + 1) * TRIM_CHAN_PER_MOD){ windows.resize((mod_ + 1) * TRIM_CHAN_PER_MOD); }
+	windows[mod_ * TRIM_CHAN_PER_MOD + chan_].trigger = trigger_;
+}
+
+void TraceTrimmer::Disable(){
+	windows.clear();
+}
+
+bool TraceTrimmer::IsEnabled() const {
+	for(std::vector<TraceTrimWindow>::const_iterator iter = windows.begin(); iter != windows.end(); iter++){
+		if(iter->enabled){ return true; }
+	}
+	return false;
+}
+
+TraceTrimWindow TraceTrimmer::GetWindow(unsigned int mod_, unsigned int chan_) const {
+	unsigned int index = mod_ * TRIM_CHAN_PER_MOD + chan_;
+	if(chan_ >= TRIM_CHAN_PER_MOD || index >= windows.size()){ return TraceTrimWindow(); }
+	return windows[index];
+}
+
+size_t TraceTrimmer::Trim(unsigned int *data_, size_t nWords_, unsigned int mod_){
+	size_t firstIndex = mod_ * TRIM_CHAN_PER_MOD;
+	if(firstIndex >= windows.size()){ return nWords_; }
+
+	// Events are only ever moved towards the start of the buffer.
+	size_t in = 0, out = 0;
+	while(in < nWords_){
+		unsigned int headerLength = (data_[in] & 0x0001F000) >> 12;
+		unsigned int eventLength = (data_[in] & TRIM_EVENT_LENGTH_MASK) >> 17;
+		if(eventLength == 0 || eventLength < headerLength || headerLength < 4 || in + eventLength > nWords_){ break; }
+
+		unsigned int traceLength = (data_[in + 3] & TRIM_TRACE_LENGTH_MASK) >> 16;
+		const TraceTrimWindow &window = windows[firstIndex + (data_[in] & 0xF)];
+
+		size_t start = 0, stop = traceLength;
+		if(window.enabled && traceLength > 0 && headerLength + traceLength / 2 == eventLength){
+			start = window.GetStart();
+			if(start > traceLength){ start = traceLength; }
+			if(window.trigger + window.post + 1 < traceLength){ stop = (window.trigger + window.post + 2) & ~(size_t)1; }
+			if(stop < start){ stop = start; }
+		}
+
+		if(stop - start >= traceLength){ // Nothing to cut.
+			if(out != in){ memmove(&data_[out], &data_[in], eventLength * sizeof(unsigned int)); }
+			in += eventLength;
+			out += eventLength;
+			continue;
+		}
+
+		unsigned int newLength = stop - start;
+		memmove(&data_[out], &data_[in], headerLength * sizeof(unsigned int));
+		memmove(&data_[out + headerLength], &data_[in + headerLength + start / 2], (newLength / 2) * sizeof(unsigned int));
+		data_[out] = (data_[out] & ~TRIM_EVENT_LENGTH_MASK) | ((headerLength + newLength / 2) << 17);
+		data_[out + 3] = (data_[out + 3] & ~TRIM_TRACE_LENGTH_MASK) | (newLength << 16);
+
+		numTrimmed++;
+		wordsRemoved += (traceLength - newLength) / 2;
+		in += eventLength;
+		out += headerLength + newLength / 2;
+	}
+
+	// Anything which could not be parsed is kept as it is.
+	if(in < nWords_){
+		if(out != in){ memmove(&data_[out], &data_[in], (nWords_ - in) * sizeof(unsigned int)); }
+		out += nWords_ - in;
+	}
+
+	return out;
+}
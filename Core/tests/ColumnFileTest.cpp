@@ -0,0 +1,135 @@
+/** \file ColumnFileTest.cpp
+  * \brief Write a column file and check that every value reads back unchanged.
+  * \date Oct. 19th, 2026
+  */
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "ColumnFile.h"
+#include "TestCheck.h"
+
+#define NUM_ROWS 10000 // Spans several chunks and leaves a partial last chunk.
+#define ROWS_PER_CHUNK 4096
+
+int main(int argc, char *argv[]){
+	std::string fname = "ColumnFileTest." + std::to_string(getpid()) + ".col";
+
+	int id;
+	unsigned long long stamp;
+	double energy;
+	float qdc[4];
+
+	ColumnWriter writer;
+	check(writer.AddColumn("id", &id), "AddColumn(id)");
+	check(writer.AddColumn("stamp", &stamp), "AddColumn(stamp)");
+	check(writer.AddColumn("energy", &energy), "AddColumn(energy)");
+	check(writer.AddColumn("qdc", qdc, 4), "AddColumn(qdc)");
+	check(!writer.AddColumn("id", &id), "AddColumn rejects a duplicate name");
+	check(writer.Open(fname, ROWS_PER_CHUNK), "Open for writing");
+
+	for(int i = 0; i < NUM_ROWS; i++){
+		id = i - NUM_ROWS/2;
+		stamp = 0x100000000ULL*i + 7;
+		energy = 0.25*i;
+		for(int j = 0; j < 4; j++){ qdc[j] = i + 0.5f*j; }
+		writer.Fill();
+	}
+	writer.Close();
+	check(writer.GetEntries() == NUM_ROWS, "GetEntries after writing");
+	check(writer.GetBytesWritten() > 0, "GetBytesWritten");
+
+	ColumnReader reader;
+	check(reader.Open(fname), "Open for reading");
+	check(reader.GetNumColumns() == 4, "number of columns");
+	check(reader.GetEntries() == NUM_ROWS, "number of entries");
+
+	int idCol = reader.FindColumn("id");
+	int stampCol = reader.FindColumn("stamp");
+	int energyCol = reader.FindColumn("energy");
+	int qdcCol = reader.FindColumn("qdc");
+	check(idCol >= 0 && stampCol >= 0 && energyCol >= 0 && qdcCol >= 0, "FindColumn");
+	check(reader.FindColumn("missing") < 0, "FindColumn of an unknown name");
+	if(failures > 0){ return check_result(argv[0]); }
+	check(reader.GetColumn(qdcCol).type == COLUMN_FLOAT && reader.GetColumn(qdcCol).count == 4, "schema of qdc");
+
+	// Read everything back.
+	int row = 0;
+	int numChunks = 0;
+	bool values = true;
+	while(reader.ReadChunk()){
+		numChunks++;
+		const int *ids = (const int *)reader.GetData(idCol);
+		const unsigned long long *stamps = (const unsigned long long *)reader.GetData(stampCol);
+		const double *energies = (const double *)reader.GetData(energyCol);
+		const float *qdcs = (const float *)reader.GetData(qdcCol);
+		for(unsigned int i = 0; i < reader.GetChunkRows(); i++, row++){
+			if(ids[i] != row - NUM_ROWS/2 || stamps[i] != 0x100000000ULL*row + 7 || energies[i] != 0.25*row){ values = false; }
+			for(int j = 0; j < 4; j++){
+				if(qdcs[4*i+j] != row + 0.5f*j){ values = false; }
+			}
+		}
+	}
+	check(values, "values of all columns");
+	check(row == NUM_ROWS, "number of rows read");
+	check(numChunks == (NUM_ROWS + ROWS_PER_CHUNK - 1)/ROWS_PER_CHUNK, "number of chunks");
+
+	// Read a single column after a rewind, the others are skipped.
+	std::vector<std::string> names(1, "energy");
+	check(reader.SetActiveColumns(names), "SetActiveColumns");
+	check(reader.Rewind(), "Rewind");
+	std::vector<double> energies;
+	while(reader.ReadChunk()){
+		check(reader.GetData(idCol) == NULL, "inactive column is not decoded");
+		reader.GetValues(energyCol, energies);
+	}
+	check(energies.size() == NUM_ROWS && energies.back() == 0.25*(NUM_ROWS-1), "values of a single active column");
+
+	reader.Close();
+
+	// Merge the file with itself, as the outputs of two run list workers.
+	std::string merged = "ColumnFileTest." + std::to_string(getpid()) + ".merged.col";
+	std::vector<std::string> parts(2, fname);
+	std::string error;
+	check(MergeColumnFiles(parts, merged, error), "MergeColumnFiles: " + error);
+	check(reader.Open(merged) && reader.GetEntries() == 2*NUM_ROWS, "number of merged entries");
+	idCol = reader.FindColumn("id");
+	row = 0;
+	values = true;
+	while(reader.ReadChunk()){
+		for(unsigned int i = 0; i < reader.GetChunkRows(); i++, row++){
+			if(reader.GetValue(idCol, i) != row % NUM_ROWS - NUM_ROWS/2 || reader.GetValue(qdcCol, i, 3) != row % NUM_ROWS + 1.5){ values = false; }
+		}
+	}
+	check(values && row == 2*NUM_ROWS, "values of the merged file");
+	reader.Close();
+
+	// Flushed events are readable while the file is still open, as after a crash.
+	std::string open = "ColumnFileTest." + std::to_string(getpid()) + ".open.col";
+	ColumnWriter partial;
+	partial.AddColumn("id", &id);
+	check(partial.Open(open, ROWS_PER_CHUNK), "Open for a partial file");
+	for(id = 0; id < 100; id++){ partial.Fill(); }
+	partial.Flush();
+	bool footer = true;
+	row = 0;
+	for(int i = 0; i < 2000 && row != 100; i++){ // The writer thread needs a moment.
+		usleep(1000);
+		if(!reader.Open(open)){ continue; }
+		footer = (reader.GetEntries() != 0);
+		row = 0;
+		while(reader.ReadChunk()){ row += reader.GetChunkRows(); }
+		reader.Close();
+	}
+	check(row == 100 && !footer, "flushed events of an unclosed file");
+	partial.Close();
+
+	remove(open.c_str());
+	remove(merged.c_str());
+	remove(fname.c_str());
+
+	return check_result(argv[0]);
+}
@@ -0,0 +1,96 @@
+/** \file FifoSchedTest.cpp
+  * \brief Check the read thresholds and waits of the FifoScheduler on simulated FIFOs.
+  * \date Oct. 19th, 2026
+  */
+#include <iostream>
+#include <string>
+
+#include "fifo_sched.h"
+#include "TestCheck.h"
+
+#define FIFO_LENGTH 131072 // words
+#define MIN_WORDS 9 // words
+
+/** Fill two FIFOs at constant rates, sleeping for the waits returned by the
+  * scheduler and draining every FIFO when it asks for a read.
+  * \param[in] rate_ The fill rate of the first module (words/s).
+  * \param[out] maxFill_ The highest fill level seen (words).
+  * \param[out] maxLatency_ The longest time between two reads (s).
+  * \return The number of checks per simulated second.
+  */
+double simulate(const double &rate_, double &maxFill_, double &maxLatency_){
+	FifoScheduler sched(FIFO_LENGTH, MIN_WORDS);
+	sched.SetNumModules(2);
+
+	const double duration = 20.0;
+	double rates[2] = {rate_, 0.3*rate_};
+	double words[2] = {0, 0};
+	double time = 0, lastRead = 0;
+
+	maxFill_ = 0;
+	maxLatency_ = 0;
+	while(time < duration){
+		double wait = sched.GetWait(time) + 20e-6; // Include some wake-up jitter.
+		time += wait;
+		for(int mod = 0; mod < 2; mod++){
+			words[mod] += rates[mod]*wait;
+			if(words[mod] > maxFill_){ maxFill_ = words[mod]; }
+			sched.Check(mod, (words[mod] > FIFO_LENGTH ? FIFO_LENGTH : (size_t)words[mod]), time);
+		}
+		if(sched.ShouldRead()){
+			if(time - lastRead > maxLatency_){ maxLatency_ = time - lastRead; }
+			lastRead = time;
+			for(int mod = 0; mod < 2; mod++){
+				if(words[mod] < MIN_WORDS){ continue; }
+				words[mod] = 0;
+				sched.Drained(mod, time);
+			}
+		}
+	}
+
+	return sched.GetNumChecks()/2/duration;
+}
+
+int main(int argc, char *argv[]){
+	FifoScheduler sched(FIFO_LENGTH, MIN_WORDS);
+	sched.SetNumModules(1);
+
+	// Without a rate measurement whatever is in the FIFO is read.
+	check(sched.GetConfiguredThreshold() == FIFO_LENGTH/2, "default threshold");
+	check(sched.GetThreshold(0) == MIN_WORDS, "threshold without a rate");
+	check(sched.GetWait(0) == 10e-3, "default wait");
+	check(!sched.ShouldRead(), "no read of an empty FIFO");
+
+	// A slow module is read at least once per maximum latency.
+	sched.Check(0, 0, 0.0);
+	sched.Check(0, 1000, 1.0);
+	check(sched.GetRate(0) > 0 && sched.GetThreshold(0) < 1000, "threshold of a slow module follows the latency");
+	check(sched.ShouldRead(), "read of a slow module after the latency");
+	sched.Drained(0, 1.0);
+	check(!sched.ShouldRead(), "no read after the FIFO was drained");
+
+	// The threshold never drops below the minimum read.
+	sched.SetNumModules(1);
+	sched.Check(0, 0, 0.0);
+	sched.Check(0, 1, 100.0);
+	check(sched.GetThreshold(0) == MIN_WORDS, "minimum threshold");
+
+	// A fast module leaves room for the overflow margin and is not slept past its threshold.
+	sched.SetNumModules(1);
+	sched.Check(0, 0, 0.0);
+	sched.Check(0, 40000, 0.001);
+	check(sched.GetThreshold(0) < FIFO_LENGTH/2, "threshold of a fast module leaves the overflow margin");
+	check(sched.GetWait(0.001) == 50e-6, "shortest wait for a fast module");
+
+	// Simulated runs, the FIFO must never overflow and slow modules must still be read.
+	double rates[] = {200, 2e4, 5e5, 4e6, 1e7};
+	for(size_t i = 0; i < sizeof(rates)/sizeof(double); i++){
+		double maxFill, maxLatency;
+		double checks = simulate(rates[i], maxFill, maxLatency);
+		std::cout << "  rate " << rates[i] << " words/s: " << checks << " checks/s, max fill " << 100*maxFill/FIFO_LENGTH << "%, max latency " << maxLatency << " s\n";
+		check(maxFill < FIFO_LENGTH, "no overflow at " + std::to_string(rates[i]) + " words/s");
+		check(maxLatency < 1.1, "latency at " + std::to_string(rates[i]) + " words/s");
+	}
+
+	return check_result(argv[0]);
+}
@@ -0,0 +1,35 @@
+/** \file TestCheck.h
+  * \brief The checks shared by the tests run by ctest.
+  * \date Oct. 19th, 2026
+  */
+#ifndef TESTCHECK_H
+#define TESTCHECK_H
+
+#include <iostream>
+#include <string>
+
+/// The number of failed checks of the test.
+static int failures = 0;
+
+/// Count a check, printing what was checked if it failed.
+static inline void check(bool pass_, const std::string &what_){
+	if(!pass_){
+		std::cout << " FAILED: " << what_ << std::endl;
+		failures++;
+	}
+}
+
+/** Print the result of the test.
+  * \param[in] name_ The name of the test, usually argv[0].
+  * \return The exit code of the test, zero if every check passed and one otherwise.
+  */
+static inline int check_result(const char *name_){
+	if(failures > 0){
+		std::cout << name_ << ": " << failures << " checks failed\n";
+		return 1;
+	}
+	std::cout << name_ << ": all checks passed\n";
+	return 0;
+}
+
+#endif
@@ -0,0 +1,93 @@
+/** \file TraceTrimTest.cpp
+  * \brief Trim synthetic channel events and check where the trigger ends up.
+  * \date Oct. 19th, 2026
+  */
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "trace_trim.h"
+#include "TestCheck.h"
+
+#define HEADER_LENGTH 4 // words
+#define TRACE_LENGTH 250 // samples
+#define TRIGGER 100 // samples
+
+/** Append a channel event whose samples count up from zero, with a pulse
+  * which does not sit at the trigger.
+  * \param[out] data_ The buffer the event is appended to.
+  * \param[in] chan_ The channel number.
+  * \param[in] peak_ The sample of the maximum of the pulse.
+  */
+void add_event(std::vector<unsigned int> &data_, unsigned int chan_, unsigned int peak_){
+	unsigned int eventLength = HEADER_LENGTH + TRACE_LENGTH / 2;
+	data_.push_back(chan_ | (HEADER_LENGTH << 12) | (eventLength << 17));
+	data_.push_back(0);
+	data_.push_back(0);
+	data_.push_back(TRACE_LENGTH << 16);
+	for(unsigned int i = 0; i < TRACE_LENGTH; i += 2){
+		unsigned int low = (i == peak_ ? 0x3FFF : i);
+		unsigned int high = (i + 1 == peak_ ? 0x3FFF : i + 1);
+		data_.push_back(low | (high << 16));
+	}
+}
+
+/// Return sample i_ of the trace of the event starting at word first_.
+unsigned int sample(const std::vector<unsigned int> &data_, size_t first_, unsigned int i_){
+	unsigned int word = data_[first_ + HEADER_LENGTH + i_ / 2];
+	return (i_ % 2 == 0 ? word & 0xFFFF : word >> 16);
+}
+
+int main(int argc, char *argv[]){
+	TraceTrimmer trimmer;
+	trimmer.SetWindow(0, -1, 21, 40, 1);
+	for(unsigned int chan = 0; chan < 16; chan++){ trimmer.SetTrigger(0, chan, TRIGGER); }
+
+	TraceTrimWindow window = trimmer.GetWindow(0, 3);
+	check(window.enabled && window.GetStart() % 2 == 0, "window starts on an even sample");
+	check(window.GetStart() + window.GetTrigger() == TRIGGER, "trigger in the trimmed trace");
+
+	// The pulses move around, the cut must not.
+	std::vector<unsigned int> data;
+	add_event(data, 3, 60);
+	add_event(data, 3, 180);
+	add_event(data, 3, TRIGGER + 5);
+	size_t nWords = trimmer.Trim(&data[0], data.size(), 0);
+
+	unsigned int traceLength = (data[3] >> 16) & 0x7FFF;
+	unsigned int eventLength = HEADER_LENGTH + traceLength / 2;
+	check(traceLength % 2 == 0 && traceLength >= window.GetTrigger() + 40 + 1, "trimmed trace length");
+	check(nWords == 3 * eventLength, "trimmed spill length");
+	check(trimmer.GetNumTrimmed() == 3, "number of traces trimmed");
+
+	for(unsigned int event = 0; event < 3; event++){
+		size_t first = event * eventLength;
+		check(((data[first] >> 17) & 0xFFF) == eventLength, "event length of the header");
+		check(((data[first + 3] >> 16) & 0x7FFF) == traceLength, "trace length of the header");
+		for(unsigned int i = 0; i < traceLength; i++){
+			unsigned int expected = window.GetStart() + i;
+			if(sample(data, first, i) != expected && sample(data, first, i) != 0x3FFF){
+				check(false, "samples are cut at a fixed offset from the trigger");
+				break;
+			}
+		}
+		check(sample(data, first, window.GetTrigger()) == TRIGGER, "sample at the trigger");
+	}
+
+	// A window reaching past the end of the trace keeps the rest of it.
+	TraceTrimmer late;
+	late.SetWindow(0, 0, 10, 1000, 1);
+	late.SetTrigger(0, 0, TRIGGER);
+	std::vector<unsigned int> lateData;
+	add_event(lateData, 0, 60);
+	late.Trim(&lateData[0], lateData.size(), 0);
+	check(((lateData[3] >> 16) & 0x7FFF) == TRACE_LENGTH - late.GetWindow(0, 0).GetStart(), "window past the end of the trace");
+	check(sample(lateData, 0, late.GetWindow(0, 0).GetTrigger()) == TRIGGER, "sample at the trigger of a late window");
+
+	// Channels without a window are left alone.
+	std::vector<unsigned int> other;
+	add_event(other, 5, 60);
+	check(late.Trim(&other[0], other.size(), 0) == other.size(), "untrimmed channel");
+
+	return check_result(argv[0]);
+}
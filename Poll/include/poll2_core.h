@@ -18,10 +18,16 @@
 #ifndef POLL2_CORE_H
 #define POLL2_CORE_H
 
+#include <atomic>
+#include <string>
 #include <vector>
 
+#include <pthread.h>
+
 #include "PixieInterface.h"
 #include "hribf_buffers.h"
+#include "trace_trim.h"
+#include "fifo_sched.h"
 #define maxEventSize 4095 // (0x1FFE0000 >> 17)
 
 #define POLL2_CORE_VERSION "1.4.14"
@@ -105,6 +111,8 @@ class Poll{
 	Terminal *poll_term_;
 	///A vector to store the partial events
 	std::vector<word_t> *partialEvents;
+	///The spill buffer, filled from the module FIFOs
+	word_t *fifoData;
 	
 	double startTime; ///Time when the acquistion was started.
 	double lastSpillTime; ///Time when the last spill finished.
@@ -147,6 +155,15 @@ class Poll{
 	bool init; //
 	double runTime; /// Time to run the acquisition, in seconds.
 
+	// Thread placement and scheduling
+	std::vector<int> readout_cpus; /// Cores the run control thread is pinned to, empty for any core.
+	std::vector<int> command_cpus; /// Cores the command thread is pinned to, empty for any core.
+	bool lock_memory; /// Lock the buffers used by the readout into RAM.
+	std::vector<std::pair<void*, size_t> > locked_regions; /// The memory locked by lock_region, unlocked by Close.
+	int rt_priority; /// SCHED_FIFO priority of the run control thread, zero for the normal scheduler.
+	pthread_t run_ctrl_thread; /// The run control thread, set when it starts.
+	std::atomic<unsigned long> run_ctrl_beat; /// Counts the loops of the run control thread, for the watchdog.
+
 	// Options relating to output data file
 	std::string output_directory; /// Set with 'fdir' command
 	std::string filename_prefix; /// Set with 'ouf' command
@@ -169,6 +186,9 @@ class Poll{
 	std::map<chanid_t, PixieInterface::Histogram> histoMap;
 
 	StatsHandler *statsHandler;
+	TraceTrimmer traceTrimmer; /// Cuts the traces to a window around their trigger before the spill is written.
+	FifoScheduler fifoScheduler; /// Decides when to check the FIFOs from the fill rates of the modules.
+	bool busy_poll; /// Check the FIFOs in a loop instead of sleeping until they are expected to fill.
 	static const int statsInterval_ = 3; ///<The amount time between scaler reads in seconds.
 
 	const static std::vector<std::string> runControlCommands_;
@@ -199,6 +219,12 @@ class Poll{
 	/// Display polling threshold.
 	void show_thresh();
 
+	/// Display the trace trimming windows.
+	void show_trim();
+
+	/// Read the trace delays of the trimmed channels from the modules.
+	void update_trim_triggers();
+
 	/// Acquire raw traces from a pixie module.
 	void get_traces(int mod_, int chan_, int thresh_=0);
 
@@ -235,6 +261,12 @@ class Poll{
 	/// Broadcast a data spill onto the network in the classic pacman format.
 	void broadcast_pac_data();
 
+	/// Lock a buffer used by the readout into RAM and remember it for Close. Return false if mlock fails.
+	bool lock_region(void *addr_, const size_t &len_);
+
+	/// Move the run control thread to the SCHED_FIFO scheduler, or back to the normal one.
+	bool set_realtime(const bool &enable_);
+
   public:
   	/// Default constructor.
 	Poll();
@@ -266,7 +298,27 @@ class Poll{
 	
 	void SetNcards(const size_t &n_cards_){ n_cards = n_cards_; }
 	
-	void SetThreshWords(const size_t &thresh_){ threshWords = thresh_; }
+	void SetThreshWords(const size_t &thresh_){ threshWords = thresh_; fifoScheduler.SetThreshold(thresh_); }
+
+	void SetBusyPoll(bool input_=true){ busy_poll = input_; }
+
+	/// Set the longest time in seconds a word may wait in a FIFO when polling adaptively.
+	void SetMaxLatency(const double &seconds_){ fifoScheduler.SetMaxLatency(seconds_); }
+
+	/** Pin the run control thread, which reads the FIFOs and writes and broadcasts
+	  * the spills, to a list of cores given as e.g. "2", "2,3" or "2-3".
+	  * \return True if the list is valid and false otherwise.
+	  */
+	bool SetReadoutCpus(const std::string &list_);
+
+	/** Pin the command thread to a list of cores given as e.g. "0", "0,1" or "0-1".
+	  * \return True if the list is valid and false otherwise.
+	  */
+	bool SetCommandCpus(const std::string &list_);
+
+	void SetLockMemory(bool input_=true){ lock_memory = input_; }
+
+	void SetRealTime(const int &priority_){ rt_priority = priority_; }
 
 	///Set the terminal pointer.
 	void SetTerminal(Terminal *term){ poll_term_ = term; };
@@ -294,6 +346,10 @@ class Poll{
 	
 	size_t GetThreshWords(){ return threshWords; }
 
+	bool GetLockMemory(){ return lock_memory; }
+
+	int GetRealTime(){ return rt_priority; }
+
 	///\brief Prints the information about each module.
 	void PrintModuleInfo();
 	
@@ -302,6 +358,13 @@ class Poll{
 		
 	/// Main acquisition control loop for handling data acq.
 	void RunControl();
+
+	/** Watch the real-time run control thread and return it to the normal scheduler
+	  * while it is stalled or spins on an unpinned core. A readout which spins on the
+	  * cores given by SetReadoutCpus (--cpu, e.g. when busy polling) is left alone, those cores
+	  * are expected to be reserved for it.
+	  */
+	void Watchdog();
 	
 	/// Close the sockets, any open files, and clean up.
 	bool Close();
@@ -324,4 +387,14 @@ std::string pad_string(const std::string &input_, unsigned int length_);
 /// Return a string containing "yes" for value_==true and "no" for value_==false.
 std::string yesno(bool value_);
 
+/** Parse a list of cores such as "2", "2,3" or "4-7".
+  *  \param[in]  list_ The list of cores.
+  *  \param[out] cpus_ The cores in the list, unchanged if the list is invalid.
+  *  \return true if the list is valid and all cores exist and false otherwise.
+  */
+bool parse_cpu_list(const std::string &list_, std::vector<int> &cpus_);
+
+/// Restrict the calling thread to a list of cores. Return false and set errno on failure.
+bool pin_thread(const std::vector<int> &cpus_);
+
 #endif
@@ -5,7 +5,12 @@
 
 #define NUM_CHAN_PER_MOD 16
 
+#include <atomic>
+#include <vector>
+#include <stddef.h>
+
 class Client;
+class StatsPagePublisher;
 
 class StatsHandler{
   public:
@@ -20,6 +25,18 @@ class StatsHandler{
 	///Set the amount of time between scalers dumps in seconds.
 	void SetDumpInterval(double interval) {dumpTime = interval;};
 
+	///Set the minimum amount of time between shared memory page updates in seconds.
+	void SetPublishInterval(double interval) {publishTime = interval;};
+
+	///Set the number of words found in the FIFO of a module and the words held over as partial events.
+	void SetFifoWords(unsigned int mod, unsigned int fifoWords_, unsigned int partialWords_);
+
+	///Set the size of the last spill in words.
+	void SetSpillWords(size_t words) {spillWords = words;};
+
+	///Set the time spent writing and broadcasting the last spill (s) and the current output file size (B).
+	void SetWriteStats(double wtime, double fsize) {writeTime = wtime; fileSize = fsize;};
+
     double GetDataRate(size_t mod);
     
     double GetTotalDataRate();
@@ -34,15 +51,21 @@ class StatsHandler{
 	
 	bool CanSend(){ return is_able_to_send; }
 	
-	///Clear the stats.
+	///Clear the stats. The stats page is refreshed by the next Publish.
 	void Clear();
 	void ClearRates();
 	void ClearTotals();
 
     void Dump();
+
+	///Publish the current counters to the shared memory stats page. The page
+	///has a single writer, so this is only called from the run control thread.
+	void Publish();
 	
   private:
     Client *client; // UDP client for network access
+
+    StatsPagePublisher *page; ///< Shared memory stats page for monitors.
     
     /** number of events for each channel this tick */
     unsigned int **nEventsDelta;
@@ -74,6 +97,18 @@ class StatsHandler{
     /** time between data dumps in seconds */
     double dumpTime;
 
+    double publishTime; ///< Minimum time between stats page updates in seconds.
+    double sincePublish; ///< Time since the last stats page update in seconds.
+    std::atomic<bool> publishPending; ///< Set by Clear, the page is published with the next spill.
+    double lastSpillTime; ///< Time between the last two spills in seconds.
+    unsigned long long numSpills; ///< Number of spills since the stats were cleared.
+    size_t spillWords; ///< Number of words in the last spill.
+    double writeTime; ///< Time spent writing the last spill in seconds.
+    double fileSize; ///< Size of the output file in bytes.
+
+    unsigned int *fifoWords; ///< Words in each module's FIFO at the last read.
+    unsigned int *partialWords; ///< Words held over as partial events for each module.
+
     /** number of cards in the system */
     unsigned int numCards;
 
@@ -1,6 +1,6 @@
 /** \file monitor.cpp
   * 
-  * \brief Receives and decodes rate packets from StatsHandler
+  * \brief Samples and displays the shared memory stats page published by StatsHandler
   * 
   * \author Cory R. Thornsberry
   * 
@@ -16,14 +16,16 @@
 #include <iomanip>
 #include <cmath>
 
-#include "poll2_socket.h"
+#include <unistd.h>
+
+#include "poll2_stats_shm.h"
 
 #define KILOBYTE 1024 // bytes
 #define MEGABYTE 1048576 // bytes
 #define GIGABYTE 1073741824 // bytes
 
 // Return the order of magnitude of a number
-double GetOrder(unsigned int input_, unsigned int &power){
+double GetOrder(unsigned long long input_, unsigned int &power){
 	double test = 1;
 	for(unsigned int i = 0; i < 100; i++){
 		if(input_/test <= 1){ 
@@ -57,7 +59,7 @@ std::string GetChanRateString(double input_){
 	return output;
 }
 
-std::string GetChanTotalString(unsigned int input_){
+std::string GetChanTotalString(unsigned long long input_){
 	std::stringstream stream;
 	unsigned int power = 0;
 	double order = GetOrder(input_, power);
@@ -123,90 +125,63 @@ std::string GetTimeString(double input_){
 	return stream.str();
 }
 
-int main(){
-	const size_t msg_size = 5844;// 5.8 kB of stats data max
+int main(int argc, char *argv[]){
 	const int modColumnWidth = 25;
-	char buffer[msg_size]; 
-	Server poll_server;
-	
-	int num_modules;
-	double time_in_sec;
-	double data_rate;
-	double **rates = NULL;
-	double **inputCountRate = NULL;
-	double **outputCountRate = NULL;
-	unsigned int **totals = NULL;
 	
-	bool first_packet = true;
-	if(poll_server.Init(5556)){
-		std::cout << " Waiting for first stats packet...\n";			
-
-		while(true){
-			std::cout << std::setprecision(2);
+	// Time between page samples (s). The page is updated several times a second by poll2.
+	double interval = 1.0;
+	if(argc > 1){
+		interval = strtod(argv[1], NULL);
+		if(interval <= 0.0){
+			std::cout << " Usage: " << argv[0] << " [refresh interval (s)]\n";
+			return 1;
+		}
+	}
 
-			poll_server.RecvMessage(buffer, msg_size);
-			char *ptr = buffer;
+	StatsPageReader reader;
+	StatsPage page;
+	
+	std::cout << " Waiting for the poll2 stats page " << POLL2_STATS_SHM_NAME << "...\n";
+	while(!reader.Open()){ sleep(1); }
+
+	unsigned long long lastUpdate = 0;
+	while(true){
+		if(!reader.Read(page)){ // The page is being hammered by updates, try again shortly.
+			usleep(1000);
+			continue;
+		}
 
-			if(strcmp(buffer, "$KILL_SOCKET") == 0){
-				std::cout << "  Received KILL_SOCKET flag...\n\n";
-				break;
+		if(page.closed){ // Wait for the next poll2 to publish a new page.
+			std::cout << "  poll2 has closed the stats page, waiting for a new one...\n\n";
+			reader.Close();
+			while(!reader.Open() || !reader.Read(page) || page.closed){
+				reader.Close();
+				sleep(1);
 			}
+			lastUpdate = 0;
+			continue;
+		}
+
+		// Only redraw when the page has changed.
+		if(page.updateCount != lastUpdate){
+			lastUpdate = page.updateCount;
 
 			system("clear");
-			
-			//std::cout << " Received:\t" << recv_bytes << " bytes\n";
-		
-			// Below is the stats packet structure (for N modules)
-			// ---------------------------------------------------
-			// 4 byte total number of pixie modules (N)
-			// 8 byte total time of run (in seconds)
-			// 8 byte total data rate (in B/s)
-			// channel 0, 0 rate
-			// channel 0, 0 total
-			// channel 0, 1 rate
-			// channel 0, 1 total
-			// ...
-			// channel 0, 15 rate
-			// channel 0, 15 total
-			// channel 1, 0 rate
-			// channel 1, 0 total
-			// ...
-			// channel N-1, 15 rate
-			// channel N-1, 15 total
-			memcpy(&num_modules, ptr, 4); ptr += 4;
-
-			if(first_packet){
-				rates = new double*[num_modules];
-				inputCountRate = new double*[num_modules];
-				outputCountRate = new double*[num_modules];
-				totals = new unsigned int*[num_modules];
-				for(int i = 0; i < num_modules; i++){
-					rates[i] = new double[16];
-					inputCountRate[i] = new double[16];
-					outputCountRate[i] = new double[16];
-					totals[i] = new unsigned int[16];
-				}
-				first_packet = false;
-			}
-			
-			memcpy(&time_in_sec, ptr, 8); ptr += 8;
-			memcpy(&data_rate, ptr, 8); ptr += 8;
-			for(int i = 0; i < num_modules; i++){
-				for(int j = 0; j < 16; j++){
-					memcpy(&inputCountRate[i][j], ptr, 8); ptr += 8;
-					memcpy(&outputCountRate[i][j], ptr, 8); ptr += 8;
-					memcpy(&rates[i][j], ptr, 8); ptr += 8;
-					memcpy(&totals[i][j], ptr, 4); ptr += 4;
-				}
-			}
-			
+			std::cout << std::setprecision(2);
+
+			unsigned int num_modules = page.numCards;
+
 			// Display the rate information
-			std::cout << "Run Time: " << GetTimeString(time_in_sec);
+			std::cout << "Run Time: " << GetTimeString(page.totalTime);
 			if (num_modules > 1) std::cout << "\t";
 			else std::cout << "\n";
-			std::cout << "Data Rate: " << GetRateString(data_rate) << std::endl;
+			std::cout << "Data Rate: " << GetRateString(page.dataRate);
+			std::cout << "Spills: " << page.numSpills << "\tLast Spill: " << page.spillWords << " words in " 
+				<< std::fixed << page.spillTime*1E3 << " ms\tWrite: " << page.writeTime*1E3 << " ms\n";
+			std::cout.unsetf(std::ios_base::floatfield);
+			std::cout << std::endl;
 			std::cout << "   ";
-			for(unsigned int i = 0; i < (unsigned int)num_modules; i++){
+			for(unsigned int i = 0; i < num_modules; i++){
 			    std::cout << "|" << std::setw((int)((modColumnWidth-1.+0.5) / 2)) 
 				      << std::setfill('-') << "M" << std::setw(2) 
 				      << std::setfill('0') << i 
@@ -215,29 +190,31 @@ int main(){
 			}
 			std::cout << "|\n";
 				
-			for(unsigned int i = 0; i < 16; i++){
+			for(unsigned int i = 0; i < STATS_PAGE_CHAN_PER_MOD; i++){
 			    std::cout << "C" << std::setw(2) << std:: setfill('0') << i << "|";
-			    for(unsigned int j = 0; j < (unsigned int)num_modules; j++){
-				std::cout << std::setw(5) << std::setfill(' ') << GetChanRateString(inputCountRate[j][i]) << " ";
-				std::cout << std::setw(5) << std::setfill(' ') << GetChanRateString(outputCountRate[j][i]) << " ";
-				std::cout << std::setw(5) << std::setfill(' ') << GetChanRateString(rates[j][i]) << " ";
-				std::cout << std::setw(6) << GetChanTotalString(totals[j][i]) << " ";
+			    for(unsigned int j = 0; j < num_modules; j++){
+				const StatsPageChannel &chan = page.mod[j].chan[i];
+				std::cout << std::setw(5) << std::setfill(' ') << GetChanRateString(chan.inputCountRate) << " ";
+				std::cout << std::setw(5) << std::setfill(' ') << GetChanRateString(chan.outputCountRate) << " ";
+				std::cout << std::setw(5) << std::setfill(' ') << GetChanRateString(chan.eventRate) << " ";
+				std::cout << std::setw(6) << GetChanTotalString(chan.eventTotal) << " ";
 				std::cout << "|";
 			    }
 			    std::cout << "\n";
 			}
+
+			// FIFO fill level of each module at the last read.
+			std::cout << "FIF|";
+			for(unsigned int j = 0; j < num_modules; j++){
+				std::cout << std::setw(modColumnWidth-1) << std::setfill(' ') << page.mod[j].fifoWords << "|";
+			}
+			std::cout << std::endl;
 		}
+
+		usleep((useconds_t)(interval * 1E6));
 	}
-	else{ 
-		std::cout << " Error: Failed to open poll socket 5556!\n";
-		return 1; 
-	}
-	poll_server.Close();
-	
-	if(rates){ delete[] rates; }
-	if(inputCountRate){ delete[] inputCountRate; }
-	if(outputCountRate){ delete[] outputCountRate; }
-	if(totals){ delete[] totals; }
+
+	reader.Close();
 
 	return 0;
 }
@@ -17,6 +17,9 @@
 #include <getopt.h>
 #include <string.h>
 
+#include <sched.h>
+#include <stdlib.h>
+
 #include <sys/stat.h> //For directory manipulation
 
 #include "poll2_core.h"
@@ -33,8 +36,15 @@ void help(const char *progName_){
 	std::cout << "  --rates               | Display module rates in quiet mode (false by defualt)\n";
 	std::cout << "  --thresh (-t) <num>   | Sets FIFO read threshold to num% full (50% by default)\n";
 	std::cout << "  --zero                | Zero clocks on each START_ACQ (false by default)\n";
+	std::cout << "  --busy-poll           | Check the FIFOs in a loop instead of sleeping until they are expected to fill\n";
+	std::cout << "  --latency <sec>       | Read the FIFOs at least this often at low rates (1 s by default)\n";
 	std::cout << "  --debug (-d)          | Set debug mode to true (false by default)\n";
 	std::cout << "  --pacman (-p)         | Use classic poll operation for use with Pacman.\n";
+	std::cout << "  --cpu <list>          | Pin the run control thread (readout, writing, broadcast) to cores, e.g. 2 or 2,3 or 2-3\n";
+	std::cout << "  --cmd-cpu <list>      | Pin the command thread to cores\n";
+	std::cout << "  --mlock               | Lock the spill, partial event and output buffers of the readout into RAM\n";
+	std::cout << "  --rt [priority]       | Run the readout under SCHED_FIFO (priority 50 by default) with a watchdog which\n";
+	std::cout << "                        | demotes it while it stalls, or spins on cores not given with --cpu\n";
 	std::cout << "  --help (-h)           | Display this help dialogue.\n\n";
 }
 	
@@ -46,6 +56,10 @@ void start_cmd_control(Poll *poll_){
 	poll_->CommandControl();
 }
 
+void start_watchdog(Poll *poll_){
+	poll_->Watchdog();
+}
+
 int main(int argc, char *argv[]){
 	// Read the FIFO when it is this full
 	unsigned int threshPercent = 50;
@@ -59,9 +73,15 @@ int main(int argc, char *argv[]){
 		{ "rates", no_argument, NULL, 0 },
 		{ "thresh", required_argument, NULL, 't' },
 		{ "zero", no_argument, NULL, 0 },
+		{ "busy-poll", no_argument, NULL, 0 },
+		{ "latency", required_argument, NULL, 0 },
 		{ "debug", no_argument, NULL, 'd' },
 		{ "pacman", no_argument, NULL, 'p' },
 		{ "help", no_argument, NULL, 'h' },
+		{ "cpu", required_argument, NULL, 0 },
+		{ "cmd-cpu", required_argument, NULL, 0 },
+		{ "mlock", no_argument, NULL, 0 },
+		{ "rt", optional_argument, NULL, 0 },
 		{ "prefix", no_argument, NULL, 0 },
 		{ "?", no_argument, NULL, 0 },
 		{ NULL, no_argument, NULL, 0 }
@@ -119,6 +139,40 @@ int main(int argc, char *argv[]){
 				else if(strcmp("zero", longOpts[idx].name) == 0 ) { // --zero
 					poll.SetZeroClocks();
 				}
+				else if(strcmp("busy-poll", longOpts[idx].name) == 0 ) { // --busy-poll
+					poll.SetBusyPoll();
+				}
+				else if(strcmp("latency", longOpts[idx].name) == 0 ) { // --latency
+					double latency = atof(optarg);
+					if(latency <= 0){
+						std::cout << Display::ErrorStr() << " Invalid FIFO latency (" << optarg << ")!\n";
+						return 1;
+					}
+					poll.SetMaxLatency(latency);
+				}
+				else if(strcmp("cpu", longOpts[idx].name) == 0 ) { // --cpu
+					if(!poll.SetReadoutCpus(optarg)){
+						std::cout << Display::ErrorStr() << " Invalid list of cores (" << optarg << ")!\n";
+						return 1;
+					}
+				}
+				else if(strcmp("cmd-cpu", longOpts[idx].name) == 0 ) { // --cmd-cpu
+					if(!poll.SetCommandCpus(optarg)){
+						std::cout << Display::ErrorStr() << " Invalid list of cores (" << optarg << ")!\n";
+						return 1;
+					}
+				}
+				else if(strcmp("mlock", longOpts[idx].name) == 0 ) { // --mlock
+					poll.SetLockMemory();
+				}
+				else if(strcmp("rt", longOpts[idx].name) == 0 ) { // --rt
+					int priority = (optarg ? atoi(optarg) : 50);
+					if(priority < sched_get_priority_min(SCHED_FIFO) || priority >= sched_get_priority_max(SCHED_FIFO)){
+						std::cout << Display::ErrorStr() << " Invalid SCHED_FIFO priority (" << priority << ")!\n";
+						return 1;
+					}
+					poll.SetRealTime(priority);
+				}
 				break;
 			case '?' :
 				help(argv[0]);
@@ -194,6 +248,14 @@ int main(int argc, char *argv[]){
 	std::thread runctrl(start_run_control, &poll);
 	std::cout << Display::OkayStr() << std::endl;
 
+	// Start the watchdog of the real-time run control thread
+	std::thread watchdog;
+	if(poll.GetRealTime() > 0){
+		std::cout << pad_string("Starting watchdog thread", 49);
+		watchdog = std::thread(start_watchdog, &poll);
+		std::cout << Display::OkayStr() << std::endl;
+	}
+
 	// Start the command control thread. This needs to be the last thing we do to
 	// initialize, so the user cannot enter commands before setup is complete
 	std::cout << pad_string("Starting command thread", 49);
@@ -203,6 +265,7 @@ int main(int argc, char *argv[]){
 	// Synchronize the threads and wait for completion
 	comctrl.join();
 	runctrl.join();
+	if(watchdog.joinable()){ watchdog.join(); }
 
 	// Close the output file, if one is open
 	poll.Close();
@@ -27,10 +27,14 @@
 
 #include <cmath>
 
+#include <errno.h>
+#include <sched.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <fcntl.h>
 
+#include <sys/mman.h>
+
 #include "poll2_core.h"
 #include "poll2_socket.h"
 #include "poll2_stats.h"
@@ -58,6 +62,12 @@
 // Maximum shm packet size (in bytes)
 #define MAX_PKT_DATA (MAX_ORPH_DATA - PKT_HEAD_LEN)
 
+// Seconds without a loop of the real-time run control thread before the watchdog demotes it
+#define WATCHDOG_TIMEOUT 5
+
+// Fraction of the wall time above which the unpinned real-time run control thread is spinning
+#define WATCHDOG_SPIN_LOAD 0.95
+
 /** IsNumeric: Check if an input string is strictly numeric.
   *  \param[in]  input_ String to check.
   *  \param[in]  prefix_ String to print before the error message is printed.
@@ -91,7 +101,7 @@ const std::vector<std::string> Poll::paramControlCommands_ ({"dump", "pread",
 	"toggle_bit", "csr_test", "bit_test", "get_traces"});
 	
 const std::vector<std::string> Poll::pollStatusCommands_ ({"status", "thresh", 
-	"debug", "quiet", "quit", "help", "version"});
+	"trim", "debug", "quiet", "quit", "help", "version"});
 
 MCA_args::MCA_args(){ 
 	mca = NULL;
@@ -166,6 +176,8 @@ void MCA_args::Close(PixieInterface *pif_){
 }
 
 Poll::Poll() : 
+	partialEvents(NULL),
+	fifoData(NULL),
 	// System flags and variables
 	sys_message_head(" POLL: "),
 	kill_all(false), // Set to true when the program is exiting
@@ -192,6 +204,10 @@ Poll::Poll() :
 	pac_mode(false),
 	init(false),
 	runTime(-1.0),
+	// Thread placement and scheduling
+	lock_memory(false),
+	rt_priority(0),
+	run_ctrl_beat(0),
 	// Options relating to output data file
 	output_directory("./"), // Set with 'fdir' command
 	filename_prefix("run"),
@@ -201,7 +217,9 @@ Poll::Poll() :
 	current_file_num(0),
 	// Some pacman stuff
 	udp_sequence(0),
-	total_spill_chunks(0)
+	total_spill_chunks(0),
+	fifoScheduler(EXTERNAL_FIFO_LENGTH, MIN_FIFO_READ),
+	busy_poll(false)
 {
 	pif = new PixieInterface("pixie.cfg");
 	
@@ -286,8 +304,31 @@ bool Poll::Initialize(){
 		client->Init("127.0.0.1", 5555);
 	}
 
-	//Allocate an array of vectors to store partial events from the FIFO.
+	//Allocate an array of vectors to store partial events from the FIFO. The
+	// vectors are given the room for the largest event, so the readout does not allocate.
 	partialEvents = new std::vector<word_t>[n_cards];
+	for(size_t mod = 0; mod < n_cards; mod++){ partialEvents[mod].reserve(maxEventSize); }
+
+	//Allocate the spill buffer, room for a full FIFO and two header words per module.
+	fifoData = new word_t[(EXTERNAL_FIFO_LENGTH + 2) * n_cards];
+
+	//Keep the buffers of the readout in RAM, so it never waits for a page to be brought
+	// back in. Only these are locked, the rest of poll2 (ROOT, the MCA histograms, ...)
+	// may still be paged out. mlock also brings the pages in before the first spill.
+	if(lock_memory){
+		Display::LeaderPrint("Locking readout buffers");
+		bool locked = lock_region(fifoData, (EXTERNAL_FIFO_LENGTH + 2) * n_cards * sizeof(word_t));
+		for(size_t mod = 0; mod < n_cards && locked; mod++){
+			locked = lock_region(partialEvents[mod].data(), partialEvents[mod].capacity() * sizeof(word_t));
+		}
+		if(locked){ locked = lock_region(&AcqBuf, sizeof(AcqBuf)); }
+		if(locked){ locked = lock_region(&output_file, sizeof(output_file)); }
+		if(locked){ std::cout << Display::OkayStr() << std::endl; }
+		else{ std::cout << Display::WarningStr(strerror(errno)) << std::endl; }
+	}
+
+	//Follow the fill rates of the modules to decide when to check their FIFOs.
+	fifoScheduler.SetNumModules(n_cards);
 
 	//Create a stats handler and set the interval.
 	statsHandler = new StatsHandler(n_cards);
@@ -322,9 +363,15 @@ bool Poll::Close(){
 	// Close any open files.
 	if(output_file.IsOpen()) CloseOutputFile();
 
-	//Delete the array of partial event vectors.
+	//Unlock the readout buffers before they are freed.
+	for(size_t i = 0; i < locked_regions.size(); i++){ munlock(locked_regions[i].first, locked_regions[i].second); }
+	locked_regions.clear();
+
+	//Delete the array of partial event vectors and the spill buffer.
 	delete[] partialEvents;
 	partialEvents = NULL;
+	delete[] fifoData;
+	fifoData = NULL;
 
 	delete statsHandler;
 	statsHandler = NULL;
@@ -658,6 +705,7 @@ void Poll::help(){
 	std::cout << "   get_traces <mod> <chan> [threshold]   - Get traces for all channels in a specified module\n";
 	std::cout << "   status              - Display system status information\n";
 	std::cout << "   thresh [threshold]  - Modify or display the current polling threshold.\n";
+	std::cout << "   trim [<mod> <chan> <pre> <post>|off] - Cut traces to pre/post samples around the trigger at TRACE_DELAY (-1 for all)\n";
 	std::cout << "   debug               - Toggle debug mode flag (default=false)\n";
 	std::cout << "   quiet               - Toggle quiet mode flag (default=false)\n";
 	std::cout << "   quit                - Close the program\n";
@@ -770,6 +818,42 @@ void Poll::show_status(){
 void Poll::show_thresh() {
 	float threshPercent = (float) threshWords / EXTERNAL_FIFO_LENGTH * 100;
 	std::cout << sys_message_head << "Polling Threshold = " << threshPercent << "% (" << threshWords << "/" << EXTERNAL_FIFO_LENGTH << ")\n";
+	if (busy_poll) {
+		std::cout << sys_message_head << "Polling the FIFOs in a loop\n";
+		return;
+	}
+	std::cout << sys_message_head << "Adaptive polling, latency <= " << fifoScheduler.GetMaxLatency() << " s, overflow margin " << fifoScheduler.GetOverflowMargin() * 1e3 << " ms\n";
+	for (size_t mod = 0; mod < n_cards; mod++) {
+		std::cout << "   Module " << mod << ": " << humanReadable(fifoScheduler.GetRate(mod) * sizeof(word_t)) << "/s, threshold " << fifoScheduler.GetThreshold(mod) << " words\n";
+	}
+}
+
+void Poll::update_trim_triggers() {
+	for(unsigned int mod = 0; mod < n_cards; mod++){
+		unsigned short revision, adcBits, adcMsps;
+		unsigned int serialNumber;
+		if(!pif->GetModuleInfo(mod, &revision, &serialNumber, &adcBits, &adcMsps)){ continue; }
+		for(unsigned int chan = 0; chan < 16; chan++){
+			double delay; // us
+			if(!traceTrimmer.GetWindow(mod, chan).enabled || !pif->ReadSglChanPar("TRACE_DELAY", delay, mod, chan)){ continue; }
+			traceTrimmer.SetTrigger(mod, chan, (unsigned int)(delay * adcMsps + 0.5));
+		}
+	}
+}
+
+void Poll::show_trim() {
+	if(!traceTrimmer.IsEnabled()){
+		std::cout << sys_message_head << "Trace trimming is off\n";
+		return;
+	}
+	std::cout << sys_message_head << "Trace trimming windows (samples before/after the trigger, trigger sample in the trimmed trace):\n";
+	for(unsigned int mod = 0; mod < n_cards; mod++){
+		for(unsigned int chan = 0; chan < 16; chan++){
+			TraceTrimWindow window = traceTrimmer.GetWindow(mod, chan);
+			if(window.enabled){ std::cout << "   Mod " << mod << " Chan " << chan << " - " << window.pre << "/" << window.post << ", trigger at " << window.GetTrigger() << std::endl; }
+		}
+	}
+	std::cout << "   " << traceTrimmer.GetNumTrimmed() << " traces trimmed, " << humanReadable(4.0 * traceTrimmer.GetWordsRemoved()) << " removed\n";
 }
 
 /// Acquire raw traces from a pixie module.
@@ -837,6 +921,10 @@ void Poll::get_traces(int mod_, int chan_, int thresh_/*=0*/){
 void Poll::CommandControl(){
 	std::string cmd = "", arg;
 
+	if(!command_cpus.empty() && !pin_thread(command_cpus)){
+		std::cout << Display::WarningStr() << " Failed to pin the command thread: " << strerror(errno) << std::endl;
+	}
+
 	while(true){
 		if(kill_all){ // Check if poll has been killed externally (pacman)
 			while(!run_ctrl_exit){ sleep(1); }
@@ -992,6 +1080,38 @@ void Poll::CommandControl(){
 			}
 			show_thresh();
 		}
+		else if(cmd == "trim"){ // Syntax "trim <module> <channel> <pre> <post>" or "trim off"
+			if(p_args > 0){
+				if(acq_running){
+					std::cout << sys_message_head << "Warning! Cannot change the trace trimming while acquisition is running\n";
+					continue;
+				}
+				if(p_args == 1 && arguments.at(0) == "off"){ traceTrimmer.Disable(); }
+				else if(p_args >= 4){
+					if(!IsNumeric(arguments.at(0), sys_message_head, "Invalid module specification")) continue;
+					else if(!IsNumeric(arguments.at(1), sys_message_head, "Invalid channel specification")) continue;
+					else if(!IsNumeric(arguments.at(2), sys_message_head, "Invalid pre-trigger length")) continue;
+					else if(!IsNumeric(arguments.at(3), sys_message_head, "Invalid post-trigger length")) continue;
+					int mod = atoi(arguments.at(0).c_str());
+					int ch = atoi(arguments.at(1).c_str());
+					int pre = atoi(arguments.at(2).c_str());
+					int post = atoi(arguments.at(3).c_str());
+					if(mod >= (int)n_cards || ch > 15 || pre < 0 || post < 0){
+						std::cout << sys_message_head << "Invalid trim window specification\n";
+						continue;
+					}
+					traceTrimmer.SetWindow(mod, ch, pre, post, n_cards);
+					update_trim_triggers();
+				}
+				else{
+					std::cout << sys_message_head << "Invalid number of parameters to trim\n";
+					std::cout << sys_message_head << " -SYNTAX- trim <module> <channel> <pre> <post>\n";
+					std::cout << sys_message_head << " -SYNTAX- trim off\n";
+					continue;
+				}
+			}
+			show_trim();
+		}
 		else if(cmd == "dump"){ // Dump pixie parameters to file
 			std::ofstream ofile;
 			
@@ -1474,7 +1594,18 @@ void Poll::CommandControl(){
 void Poll::RunControl(){
 	time_t acqStartTime;
 	time_t currentTime;
+
+	run_ctrl_thread = pthread_self();
+	if(!readout_cpus.empty() && !pin_thread(readout_cpus)){
+		std::cout << Display::WarningStr() << " Failed to pin the run control thread: " << strerror(errno) << std::endl;
+	}
+	if(rt_priority > 0 && !set_realtime(true)){
+		std::cout << Display::WarningStr() << " Failed to use SCHED_FIFO for the run control thread: " << strerror(errno) << std::endl;
+	}
+
 	while(true){
+		run_ctrl_beat++;
+
 		if(kill_all){ // Supersedes all other commands
 			if(acq_running || mca_args.IsRunning()){ do_stop_acq = true; } // Safety catch
 			else{ break; }
@@ -1546,6 +1677,9 @@ void Poll::RunControl(){
 					}
 				}
 
+				//The trace delays may have changed since the windows were set
+				if(traceTrimmer.IsEnabled()){ update_trim_triggers(); }
+
 				//Start list mode
 				if(pif->StartListModeRun(LIST_MODE_RUN, NEW_RUN)) {
 					time(&acqStartTime);
@@ -1640,8 +1774,14 @@ void Poll::RunControl(){
 	
 		UpdateStatus();
 
-		//Sleep the run control if idle to reduce CPU utilization.
-		if (!acq_running && !do_MCA_run) sleep(1);
+		//Sleep the run control if idle to reduce CPU utilization. The stats page
+		//is otherwise only published after a spill, so refresh it here to let
+		//monitors see that poll2 is alive and any cleared counters. This is the
+		//only thread writing the page.
+		if (!acq_running && !do_MCA_run){
+			statsHandler->Publish();
+			sleep(1);
+		}
 	}
 
 	run_ctrl_exit = true;
@@ -1698,8 +1838,6 @@ void Poll::ReadScalers() {
 	}
 }
 bool Poll::ReadFIFO() {
-	static word_t *fifoData = new word_t[(EXTERNAL_FIFO_LENGTH + 2) * n_cards];
-
 	if (!acq_running) return false;
 
 	//Number of words in the FIFO of each module.
@@ -1707,25 +1845,47 @@ bool Poll::ReadFIFO() {
 	//Iterator to determine which card has the most words.
 	std::vector<word_t>::iterator maxWords;
 
-	//We loop until the FIFO has reached the threshold for any module unless we are stopping and then we skip the loop.
-	for (unsigned int timeout = 0; timeout < POLL_TRIES; timeout++){ 
-		//Check the FIFO size for every module
+	//Whether a module has reached its threshold, and the time its FIFO was checked.
+	bool readFIFO = false;
+	double checkTime = 0;
+
+	if (busy_poll) {
+		//We loop until the FIFO has reached the threshold for any module unless we are stopping and then we skip the loop.
+		for (unsigned int timeout = 0; timeout < POLL_TRIES; timeout++){ 
+			//Check the FIFO size for every module
+			for (unsigned short mod=0; mod < n_cards; mod++) {
+				nWords[mod] = pif->CheckFIFOWords(mod);
+			}
+			//Find the maximum module
+			maxWords = std::max_element(nWords.begin(), nWords.end());
+			if(*maxWords > threshWords){ break; }
+		}
+		readFIFO = (*maxWords > threshWords);
+	}
+	else {
+		//Sleep until the first module is expected to reach its threshold, then check every module once.
+		if (!force_spill && !do_stop_acq) {
+			double wait = fifoScheduler.GetWait(usGetTime(0) * 1e-6);
+			usleep((useconds_t)(wait * 1e6));
+		}
+		checkTime = usGetTime(0) * 1e-6;
 		for (unsigned short mod=0; mod < n_cards; mod++) {
 			nWords[mod] = pif->CheckFIFOWords(mod);
+			fifoScheduler.Check(mod, nWords[mod], checkTime);
 		}
-		//Find the maximum module
-		maxWords = std::max_element(nWords.begin(), nWords.end());
-		if(*maxWords > threshWords){ break; }
+		readFIFO = fifoScheduler.ShouldRead();
 	}
 
 	//We need to read the data out of the FIFO
-	if (*maxWords > threshWords || force_spill) {
+	if (readFIFO || force_spill) {
 		force_spill = false;
 		//Number of data words read from the FIFO
 		size_t dataWords = 0;
 
 		//Loop over each module's FIFO
 		for (unsigned short mod=0;mod < n_cards; mod++) {
+			//Record the FIFO fill level and held over partial event words for the stats page.
+			statsHandler->SetFifoWords(mod, nWords[mod], partialEvents[mod].size());
 
 			//if the module has no words in the FIFO we continue to the next module
 			if (nWords[mod] < MIN_FIFO_READ) {
@@ -1778,6 +1938,9 @@ bool Poll::ReadFIFO() {
 				std::cout << " to buffer position " << dataWords << std::endl;
 			}
 
+			//The words counted at the check are gone, the scheduler measures the rate from here.
+			fifoScheduler.Drained(mod, checkTime);
+
 			//After reading the FIFO and printing a sttus message we can update the number of words to include the partial event.
 			nWords[mod] += partialEvents[mod].size();
 			//Clear the partial event
@@ -1859,6 +2022,9 @@ bool Poll::ReadFIFO() {
 				return false;
 			}
 
+			//Cut the traces of the complete events before the spill is written and broadcast.
+			nWords[mod] = traceTrimmer.Trim(&fifoData[dataWords], nWords[mod], mod);
+
 			//Assign the first injected word of spill to final spill length
 			fifoData[dataWords - 2] = nWords[mod] + 2;
 			//The data should be good so we iterate the position in the storage array.
@@ -1869,6 +2035,7 @@ bool Poll::ReadFIFO() {
 		double spillTime = usGetTime(startTime);
 		double durSpill = spillTime - lastSpillTime;
 		lastSpillTime = spillTime;
+		statsHandler->SetSpillWords(dataWords);
 
 		// Add time to the statsHandler and check if interval has been exceeded.
 		//If exceed interval we read the scalers from the modules and dump the stats.
@@ -1883,11 +2050,102 @@ bool Poll::ReadFIFO() {
 		if (record_data && !pac_mode) write_data(fifoData, dataWords); 
 		broadcast_data(fifoData, dataWords);
 
+		//Report how long the readout thread was held up by the output.
+		statsHandler->SetWriteStats((usGetTime(startTime) - spillTime) * 1e-6, output_file.IsOpen() ? (double)output_file.GetFilesize() : 0.0);
+
 	} //If we had exceeded the threshold or forced a flush
 
 	return true;
 }
 
+bool Poll::SetReadoutCpus(const std::string &list_){
+	return parse_cpu_list(list_, readout_cpus);
+}
+
+bool Poll::SetCommandCpus(const std::string &list_){
+	return parse_cpu_list(list_, command_cpus);
+}
+
+bool Poll::lock_region(void *addr_, const size_t &len_){
+	if(len_ == 0){ return true; }
+	if(mlock(addr_, len_) != 0){ return false; }
+	locked_regions.push_back(std::make_pair(addr_, len_));
+	return true;
+}
+
+bool Poll::set_realtime(const bool &enable_){
+	sched_param param;
+	param.sched_priority = (enable_ ? rt_priority : 0);
+	int retval = pthread_setschedparam(run_ctrl_thread, (enable_ ? SCHED_FIFO : SCHED_OTHER), &param);
+	if(retval != 0){ errno = retval; }
+	return (retval == 0);
+}
+
+void Poll::Watchdog(){
+	//Run above the run control thread, so a runaway readout cannot starve the watchdog.
+	sched_param param;
+	param.sched_priority = std::min(rt_priority + 1, sched_get_priority_max(SCHED_FIFO));
+	pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+
+	unsigned long lastBeat = 0;
+	int stalled = 0;
+	int spinning = 0;
+	bool demoted = false;
+	clockid_t cpuClock;
+	bool haveCpuClock = false;
+	timespec lastCpu, lastWall;
+	while(!run_ctrl_exit){
+		sleep(1);
+
+		//Wait for the run control thread to start.
+		unsigned long beat = run_ctrl_beat;
+		if(beat == 0){ continue; }
+
+		//A readout which loops but never sleeps keeps an unpinned core from every other
+		// thread, so its share of the wall time is followed as well. Readouts pinned to
+		// their own cores are expected to spin there, e.g. when busy polling.
+		double load = 0;
+		if(!haveCpuClock){
+			haveCpuClock = (pthread_getcpuclockid(run_ctrl_thread, &cpuClock) == 0);
+			if(haveCpuClock){
+				clock_gettime(cpuClock, &lastCpu);
+				clock_gettime(CLOCK_MONOTONIC, &lastWall);
+			}
+		}
+		else{
+			timespec cpu, wall;
+			clock_gettime(cpuClock, &cpu);
+			clock_gettime(CLOCK_MONOTONIC, &wall);
+			double wallTime = (wall.tv_sec - lastWall.tv_sec) + 1e-9 * (wall.tv_nsec - lastWall.tv_nsec);
+			if(wallTime > 0){ load = ((cpu.tv_sec - lastCpu.tv_sec) + 1e-9 * (cpu.tv_nsec - lastCpu.tv_nsec)) / wallTime; }
+			lastCpu = cpu;
+			lastWall = wall;
+		}
+		if(readout_cpus.empty() && load > WATCHDOG_SPIN_LOAD){ spinning++; }
+		else{ spinning = 0; }
+
+		if(beat != lastBeat){
+			lastBeat = beat;
+			stalled = 0;
+		}
+		else{ stalled++; }
+
+		if(!demoted && (stalled >= WATCHDOG_TIMEOUT || spinning >= WATCHDOG_TIMEOUT)){
+			//Either the readout hangs, waits on something slow (e.g. a reboot) or spins. In
+			// all cases it must not keep the core from the other threads.
+			if(set_realtime(false)){
+				if(stalled >= WATCHDOG_TIMEOUT){ std::cout << Display::WarningStr() << " Run control thread stalled for " << WATCHDOG_TIMEOUT << " s, moved it to the normal scheduler.\n"; }
+				else{ std::cout << Display::WarningStr() << " Run control thread used the whole core for " << WATCHDOG_TIMEOUT << " s, moved it to the normal scheduler. Pin it with --cpu to let it spin.\n"; }
+				demoted = true;
+			}
+		}
+		else if(demoted && stalled == 0 && spinning == 0 && set_realtime(true)){
+			std::cout << sys_message_head << "Run control thread is looping again, restored SCHED_FIFO.\n";
+			demoted = false;
+		}
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Support Functions
 ///////////////////////////////////////////////////////////////////////////////
@@ -1916,3 +2174,36 @@ std::string yesno(bool value_){
 	if(value_){ return "Yes"; }
 	return "No";
 }
+
+/* Parse a list of cores such as "2", "2,3" or "4-7". */
+bool parse_cpu_list(const std::string &list_, std::vector<int> &cpus_){
+	long numCpus = sysconf(_SC_NPROCESSORS_CONF);
+	std::vector<int> cpus;
+	std::stringstream stream(list_);
+	std::string item;
+	while(std::getline(stream, item, ',')){
+		size_t dash = item.find('-');
+		std::string first = item.substr(0, dash);
+		std::string last = (dash == std::string::npos ? first : item.substr(dash+1));
+		if(first.empty() || last.empty() || !IsNumeric(first) || !IsNumeric(last)){ return false; }
+		int low = atoi(first.c_str());
+		int high = atoi(last.c_str());
+		if(low < 0 || high < low || high >= numCpus){ return false; }
+		for(int cpu = low; cpu <= high; cpu++){ cpus.push_back(cpu); }
+	}
+	if(cpus.empty()){ return false; }
+	cpus_ = cpus;
+	return true;
+}
+
+/* Restrict the calling thread to a list of cores. */
+bool pin_thread(const std::vector<int> &cpus_){
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for(std::vector<int>::const_iterator iter = cpus_.begin(); iter != cpus_.end(); iter++){
+		CPU_SET(*iter, &set);
+	}
+	int retval = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+	if(retval != 0){ errno = retval; }
+	return (retval == 0);
+}
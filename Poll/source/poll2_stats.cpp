@@ -5,6 +5,7 @@
 
 #include "poll2_stats.h"
 #include "poll2_socket.h"
+#include "poll2_stats_shm.h"
 
 StatsHandler::StatsHandler(const size_t nCards){
 
@@ -37,10 +38,24 @@ StatsHandler::StatsHandler(const size_t nCards){
 	// Define all the 1d arrays
 	dataDelta = new size_t[numCards];
 	dataTotal = new size_t[numCards];
+	fifoWords = new unsigned int[numCards];
+	partialWords = new unsigned int[numCards];
+	for(unsigned int i = 0; i < numCards; i++){
+		fifoWords[i] = 0;
+		partialWords[i] = 0;
+	}
 
 	timeElapsed = 0.0;
 	totalTime = 0.0;
 	dumpTime = 3.0; // Minimum of 2 seconds between updates
+	publishTime = 0.25;
+	sincePublish = 0.0;
+	publishPending = false;
+	lastSpillTime = 0.0;
+	numSpills = 0;
+	spillWords = 0;
+	writeTime = 0.0;
+	fileSize = 0.0;
 	
 	is_able_to_send = true;
 
@@ -49,12 +64,20 @@ StatsHandler::StatsHandler(const size_t nCards){
 		is_able_to_send = false;
 	}
 
+	page = new StatsPagePublisher();
+	if(!page->Open(numCards)){
+		std::cout << "Failed to open the shared memory stats page " << POLL2_STATS_SHM_NAME << std::endl;
+	}
+
 	Clear();
 }
 
 StatsHandler::~StatsHandler(){
 	client->SendMessage((char *)"$KILL_SOCKET", 13);
 	client->Close();
+
+	page->Close();
+	delete page;
 	
 	// De-allocate the 2d arrays
 	for(unsigned int i = 0; i < numCards; i++){
@@ -73,6 +96,8 @@ StatsHandler::~StatsHandler(){
 	// De-allocate the 1d arrays
 	delete[] dataDelta;
 	delete[] dataTotal;
+	delete[] fifoWords;
+	delete[] partialWords;
 }
 
 void StatsHandler::AddEvent(unsigned int mod, unsigned int ch, size_t size, int delta_/*=1*/){
@@ -96,6 +121,11 @@ void StatsHandler::AddEvent(unsigned int mod, unsigned int ch, size_t size, int
 bool StatsHandler::AddTime(double dtime) {
 	timeElapsed += dtime;
 	totalTime   += dtime;
+	lastSpillTime = dtime;
+	numSpills++;
+
+	sincePublish += dtime;
+	if(sincePublish >= publishTime || publishPending){ Publish(); }
 
 	return (timeElapsed >= dumpTime);
    
@@ -149,6 +179,50 @@ void StatsHandler::Dump(void){
 	delete[] message;
 }
 
+/** Copy the counters into the shared memory page. This is only a few kB of
+ *	stores so it is cheap enough to do several times a second from the
+ *	acquisition thread, and readers never block it.
+ */
+void StatsHandler::Publish(){
+	sincePublish = 0.0;
+	publishPending = false;
+
+	StatsPage *ptr = page->BeginWrite();
+	if(!ptr){ return; }
+
+	ptr->numSpills = numSpills;
+	ptr->totalTime = totalTime;
+	ptr->intervalTime = timeElapsed;
+	ptr->dataRate = GetTotalDataRate();
+	ptr->spillTime = lastSpillTime;
+	ptr->spillWords = spillWords;
+	ptr->writeTime = writeTime;
+	ptr->fileSize = fileSize;
+
+	for(unsigned int i = 0; i < numCards && i < STATS_PAGE_MAX_MODULES; i++){
+		StatsPageModule &module = ptr->mod[i];
+		module.dataRate = GetDataRate(i);
+		module.dataTotal = dataTotal[i];
+		module.fifoWords = fifoWords[i];
+		module.partialWords = partialWords[i];
+		for(unsigned int j = 0; j < NUM_CHAN_PER_MOD; j++){
+			StatsPageChannel &channel = module.chan[j];
+			channel.inputCountRate = inputCountRate[i][j];
+			channel.outputCountRate = outputCountRate[i][j];
+			channel.eventRate = (timeElapsed > 0 ? nEventsDelta[i][j] / timeElapsed : 0.0);
+			channel.eventTotal = nEventsTotal[i][j];
+		}
+	}
+
+	page->EndWrite();
+}
+
+void StatsHandler::SetFifoWords(unsigned int mod, unsigned int fifoWords_, unsigned int partialWords_){
+	if(mod >= numCards){ return; }
+	fifoWords[mod] = fifoWords_;
+	partialWords[mod] = partialWords_;
+}
+
 double StatsHandler::GetDataRate(size_t mod){
 	if(timeElapsed<=0) return 0;
 	return dataDelta[mod] / timeElapsed;
@@ -191,14 +265,21 @@ void StatsHandler::SetXiaRates(int mod, std::vector<std::pair<double, double> >
 }
 void StatsHandler::ClearTotals(){
 	totalTime = 0;
+	numSpills = 0;
 	for(size_t i=0; i < numCards; i++){
 		for(size_t j = 0; j < NUM_CHAN_PER_MOD; j++){
 			nEventsTotal[i][j] = 0;
 		}
+		dataTotal[i] = 0;
 	}
 }
 
 void StatsHandler::Clear(){
 	ClearRates();
 	ClearTotals();
+
+	//Clear is also called from the command thread when a file is opened or
+	// closed, while the stats page only has one writer. The run control
+	// thread publishes the cleared counters instead.
+	publishPending = true;
 }
@@ -0,0 +1,77 @@
+/** \file ChannelEventBatch.hpp
+ * \brief Analyzes the waveforms of many ChannelEvents with the same trace length at once.
+ * \date Oct. 19th, 2026
+ */
+#ifndef CHANNELEVENTBATCH_HPP
+#define CHANNELEVENTBATCH_HPP
+
+#include <vector>
+
+#include "XiaData.hpp"
+
+/*! \brief A batch of channel events with traces of the same length.
+ *
+ * The traces are copied into tiles of TILE_WIDTH events. Inside a tile the
+ * samples are ordered by sample number first and event second, so the samples
+ * of all events of the tile at one time step are contiguous and a tile fits in
+ * the L1 cache. Each step of the waveform analysis runs its innermost loop over
+ * the events of a tile, which the compiler can vectorize without reordering any
+ * floating point sums. The results are written back into the members of each
+ * ChannelEvent and are the same as those of the ChannelEvent methods. The
+ * batch does not own the events.
+ */
+class ChannelEventBatch{
+public:
+    static const size_t TILE_WIDTH = 16; /// Number of events in a tile.
+
+    /// Default constructor.
+    ChannelEventBatch();
+
+    /// Add an event to the batch. Returns false if its trace is empty or has a different length than the rest of the batch.
+    bool Add(ChannelEvent *event_);
+
+    /// Return the number of events in the batch.
+    size_t GetSize() const { return events.size(); }
+
+    /// Return the number of samples in each trace.
+    size_t GetTraceLength() const { return traceLength; }
+
+    /// Return a baseline corrected sample of an event, only valid after CorrectBaseline().
+    float GetSample(const size_t &index_, const size_t &sample_) const { return samples[Index(index_, sample_)]; }
+
+    /// Return a sample of the cfd waveform of an event, only valid after AnalyzeCFD().
+    float GetCfd(const size_t &index_, const size_t &sample_) const { return cfd[Index(index_, sample_)]; }
+
+    /// Correct the baselines, find the baseline standard deviations and the pulse maxima. Also fills xvals and yvals of each event. Events which are already baseline corrected are not corrected again.
+    void CorrectBaseline();
+
+    /// Find the leading edges of the pulses at a given percentage of pulse maximum.
+    void FindLeadingEdge(const float &thresh_=0.05);
+
+    /// Integrate the baseline corrected traces in the range [start_, stop_].
+    void IntegratePulse(const size_t &start_=0, const size_t &stop_=0);
+
+    /// Perform CFD analysis on the waveforms. Fills cfdvals and cfdCrossing of each event.
+    void AnalyzeCFD(const float &F_=0.5, const size_t &D_=1, const size_t &L_=1);
+
+    /// Remove all events from the batch, keeping the allocated memory.
+    void Clear();
+
+private:
+    size_t traceLength; /// Number of samples in each trace.
+    bool corrected; /// True once the samples have been baseline corrected.
+
+    std::vector<ChannelEvent*> events; /// The events in the batch.
+    std::vector<float> samples; /// Baseline corrected samples, tile after tile.
+    std::vector<float> cfd; /// Cfd waveforms, laid out like the samples.
+
+    /// Return the number of tiles needed for the events in the batch.
+    size_t GetNumTiles() const { return (events.size() + TILE_WIDTH - 1) / TILE_WIDTH; }
+
+    /// Return the position of a sample of an event in the tiled arrays.
+    size_t Index(const size_t &index_, const size_t &sample_) const {
+        return ((index_ / TILE_WIDTH) * traceLength + sample_) * TILE_WIDTH + index_ % TILE_WIDTH;
+    }
+};
+
+#endif
@@ -0,0 +1,102 @@
+/** \file Diagnostics.hpp
+ * \brief Counts the errors found while scanning instead of printing each one.
+ * \date Oct. 19th, 2026
+ */
+#ifndef DIAGNOSTICS_HPP
+#define DIAGNOSTICS_HPP
+
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <time.h>
+
+/*! \brief A registry of diagnostic counters.
+ *
+ * Every kind of error is registered once under a name and gets a code. An
+ * occurrence only increments an atomic counter for the code and the channel,
+ * so a misconfigured channel no longer slows the scan down with console
+ * output. The first few occurrences of each code are kept as samples with
+ * a message, and a summary of the new counts is printed at most once per
+ * interval while scanning. The full summary is available with the 'diag'
+ * command and is printed when the scan exits.
+ */
+class Diagnostics{
+  public:
+	static const unsigned int MAX_CODES = 64; /// Maximum number of registered codes.
+
+	/// Return the only instance of the registry.
+	static Diagnostics *get();
+
+	/// Register a kind of error and return its code. Registering a name again returns the same code.
+	unsigned int Register(const std::string &name_);
+
+	/** Count one occurrence of an error.
+	  * \param[in]  code_ The code returned by Register.
+	  * \param[in]  mod_  The module number, or -1 if not known.
+	  * \param[in]  chan_ The channel number, or -1 if not known.
+	  * \return True if a sample of this occurrence should be recorded with Sample.
+	  */
+	bool Count(const unsigned int &code_, const int &mod_=-1, const int &chan_=-1);
+
+	/// Record a sample message for an occurrence which Count asked for.
+	void Sample(const unsigned int &code_, const int &mod_, const int &chan_, const std::string &msg_);
+
+	/// Count an occurrence and record a sample if needed. Only for rare errors, the message is always built.
+	void Report(const unsigned int &code_, const int &mod_, const int &chan_, const std::string &msg_);
+
+	/// Return the number of occurrences of a code for a channel, or for all channels if mod_ is -1.
+	unsigned long GetCount(const unsigned int &code_, const int &mod_=-1, const int &chan_=-1) const;
+
+	/// Return the number of occurrences of all codes.
+	unsigned long GetTotal() const;
+
+	/// Print the counts of every code with its worst channels and its samples.
+	void Print(std::ostream &out_) const;
+
+	/// Print the counts which changed since the last summary, if the summary interval has passed. Return true if something was printed.
+	bool Poll(std::ostream &out_);
+
+	/// Set the number of samples kept for each code.
+	void SetNumSamples(const unsigned int &num_){ numSamples = num_; }
+
+	/// Set the minimum number of seconds between two summaries printed by Poll.
+	void SetInterval(const time_t &seconds_){ interval = seconds_; }
+
+	/// Reset all counts and remove all samples, keeping the registered codes.
+	void Reset();
+
+  private:
+	/// The counts of one code.
+	struct Counter{
+		std::string name; /// The name of the error.
+		std::atomic<unsigned long> total; /// The number of occurrences on all channels.
+		std::vector<std::atomic<unsigned long> > counts; /// The number of occurrences on each channel, the last one for unknown channels.
+		unsigned long lastTotal; /// The total at the last summary printed by Poll.
+		std::vector<std::string> samples; /// The first messages.
+
+		Counter(const std::string &name_, const size_t &numSlots_);
+	};
+
+	Counter *counters[MAX_CODES]; /// The registered codes.
+	std::atomic<unsigned int> numCodes; /// The number of registered codes.
+
+	unsigned int numSamples; /// The number of samples kept for each code.
+	time_t interval; /// The minimum number of seconds between two summaries.
+	time_t lastSummary; /// The time of the last summary.
+
+	mutable std::mutex lock; /// Protects the registration and the samples.
+
+	/// Private constructor, use get().
+	Diagnostics();
+
+	/// Return the slot of a channel in the counts.
+	static size_t Slot(const int &mod_, const int &chan_);
+
+	/// Return a description of a slot in the counts.
+	static std::string SlotName(const size_t &slot_);
+};
+
+#endif
@@ -0,0 +1,119 @@
+/** \file EventCache.hpp
+ * \brief A file of built raw events, so repeated scans skip the decoding and the event building.
+ * \date Oct. 19th, 2026
+ */
+#ifndef EVENTCACHE_HPP
+#define EVENTCACHE_HPP
+
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+class XiaData;
+
+/*! \brief Writes the raw events built by the Unpacker to a file and reads them back.
+ *
+ * Each event is stored with its start and stop times followed by its hits,
+ * already time ordered. A hit is a fixed record with the decoded XiaData
+ * fields, followed by the onboard qdcs and energy sums only if it has them
+ * and by its trace, with 16 bits per sample when every sample fits. An index
+ * of the offsets of all events is written at the end of the file when it is
+ * closed. For reading, the file is memory mapped and the events are copied
+ * straight into XiaData objects, so a scan of a cache runs at disk speed.
+ * Files which were not closed have no index and can not be read.
+ */
+class EventCache{
+  public:
+	/// Default constructor.
+	EventCache();
+
+	/// Destructor, closes the file.
+	~EventCache();
+
+	/** Create a new cache file for writing, replacing an existing one.
+	  * \param[in]  fname_      The name of the file.
+	  * \param[in]  eventWidth_ The width of the raw events in pixie16 clock ticks.
+	  * \return True if the file was created and false otherwise.
+	  */
+	bool Create(const std::string &fname_, const double &eventWidth_);
+
+	/** Append a raw event to a cache opened with Create.
+	  * \param[in]  startTime_     The start time of the raw event.
+	  * \param[in]  realStartTime_ The time of the first hit of the raw event.
+	  * \param[in]  realStopTime_  The time of the last hit of the raw event.
+	  * \param[in]  rawEvent_      The hits of the raw event.
+	  * \param[in]  subEvent_      The hits of the channels with their own event window.
+	  * \return True if the event was written and false otherwise.
+	  */
+	bool Write(const double &startTime_, const double &realStartTime_, const double &realStopTime_,
+	           const std::deque<XiaData*> &rawEvent_, const std::deque<XiaData*> &subEvent_);
+
+	/** Open a cache file written earlier for reading.
+	  * \param[in]  fname_ The name of the file.
+	  * \return True if the file is a complete cache and false otherwise.
+	  */
+	bool Open(const std::string &fname_);
+
+	/** Read the next event of a cache opened with Open. New XiaData objects
+	  * are appended to the lists and are owned by the caller.
+	  * \param[out] startTime_     The start time of the raw event.
+	  * \param[out] realStartTime_ The time of the first hit of the raw event.
+	  * \param[out] realStopTime_  The time of the last hit of the raw event.
+	  * \param[out] rawEvent_      The hits of the raw event.
+	  * \param[out] subEvent_      The hits of the channels with their own event window.
+	  * \return True if an event was read and false at the end of the file.
+	  */
+	bool Read(double &startTime_, double &realStartTime_, double &realStopTime_,
+	          std::deque<XiaData*> &rawEvent_, std::deque<XiaData*> &subEvent_);
+
+	/// Move to an event of a cache opened with Open. Return false if there is no such event.
+	bool Seek(const uint64_t &event_);
+
+	/// Write the index of a cache opened with Create, and release the file.
+	void Close();
+
+	/// Return true if a cache is open for writing.
+	bool IsWriting() const { return output.is_open(); }
+
+	/// Return true if a cache is open for reading.
+	bool IsReading() const { return (data != NULL); }
+
+	/// Return the number of events in the cache.
+	uint64_t GetNumEvents() const { return numEvents; }
+
+	/// Return the number of the next event which Read returns.
+	uint64_t GetPosition() const { return position; }
+
+	/// Return the width of the raw events in pixie16 clock ticks.
+	double GetEventWidth() const { return eventWidth; }
+
+	/// Return the start time of the first event.
+	double GetFirstTime() const { return firstTime; }
+
+  private:
+	std::string filename; /// The name of the file.
+
+	std::ofstream output; /// The file being written.
+	std::vector<uint64_t> offsets; /// The offset of every event written so far.
+	std::vector<char> record; /// The record of the event being written.
+
+	const char *data; /// The mapped file being read, NULL if none.
+	size_t dataSize; /// The size of the mapped file.
+	const uint64_t *index; /// The index of the mapped file.
+
+	double eventWidth; /// The width of the raw events in pixie16 clock ticks.
+	double firstTime; /// The start time of the first event.
+	uint64_t numEvents; /// The number of events in the cache.
+	uint64_t position; /// The number of the next event to read.
+
+	/// Append the record of a hit to the event record.
+	void AppendHit(const XiaData *event_);
+
+	/// Read the record of a hit starting at an offset and advance the offset. Return NULL if it is damaged.
+	XiaData *ReadHit(uint64_t &offset_, const uint64_t &end_);
+};
+
+#endif
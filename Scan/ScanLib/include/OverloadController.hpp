@@ -0,0 +1,90 @@
+/** \file OverloadController.hpp
+ * \brief Decides how much of the online analysis to shed when the scan falls behind.
+ * \date Oct. 19th, 2026
+ */
+#ifndef OVERLOADCONTROLLER_HPP
+#define OVERLOADCONTROLLER_HPP
+
+#include <atomic>
+
+/*! \brief Adaptive load shedding for scans of spills received from poll2.
+ *
+ * The controller follows the fraction of the wall time spent processing
+ * spills and whether spills queue up or are lost, and steps through a
+ * fixed list of levels. Levels 1 to NUM_ANALYSIS_LEVELS shed parts of the
+ * analysis, what is shed is left to the class derived from ScanInterface.
+ * Each level above those doubles the spill prescale, so only every Nth
+ * received spill is processed. A step up is taken as soon as the scan is
+ * overloaded, a step down only when the load has stayed low enough to
+ * absorb twice the current work, after a hold-off which avoids oscillating
+ * between two levels.
+ *
+ * The getters may be called from any thread. Calls which change the state
+ * (SetEnabled, Accept and Update) have to be serialized by the caller.
+ */
+class OverloadController{
+  public:
+	static const unsigned int NUM_ANALYSIS_LEVELS = 2; /// Number of levels which shed analysis instead of spills.
+	static const unsigned int MAX_LEVEL = NUM_ANALYSIS_LEVELS + 6; /// The highest level, a prescale of 64.
+
+	/// Default constructor.
+	OverloadController();
+
+	/// Enable or disable load shedding. Disabling returns to level zero.
+	void SetEnabled(const bool &enabled_=true);
+
+	/// Return true if load shedding is enabled.
+	bool IsEnabled() const { return enabled; }
+
+	/** Count a received spill and decide whether it is processed.
+	  * \return True if the spill is to be processed and false if it is shed.
+	  */
+	bool Accept();
+
+	/** Update the load after a received spill.
+	  * \param[in]  busy_     The time spent processing the spill in seconds, zero if it was shed.
+	  * \param[in]  interval_ The time since the previous spill was received in seconds.
+	  * \param[in]  backlog_  True if data was lost or was already waiting when the processing ended.
+	  * \return True if the level changed and false otherwise.
+	  */
+	bool Update(const double &busy_, const double &interval_, const bool &backlog_);
+
+	/// Return the current level, zero if nothing is shed.
+	unsigned int GetLevel() const { return level; }
+
+	/// Return the number of analysis levels shed at the current level.
+	unsigned int GetAnalysisLevel() const {
+		unsigned int current = level;
+		return (current < NUM_ANALYSIS_LEVELS ? current : NUM_ANALYSIS_LEVELS);
+	}
+
+	/// Return the current spill prescale, one if every spill is processed.
+	unsigned int GetPrescale() const {
+		unsigned int current = level;
+		return (current > NUM_ANALYSIS_LEVELS ? 1 << (current - NUM_ANALYSIS_LEVELS) : 1);
+	}
+
+	/// Return the average fraction of the wall time spent processing spills.
+	double GetLoad() const { return load; }
+
+	/// Return the number of spills received since the controller was enabled.
+	unsigned long GetNumReceived() const { return numReceived; }
+
+	/// Return the number of spills processed since the controller was enabled.
+	unsigned long GetNumProcessed() const { return numProcessed; }
+
+	/// Return the number of times a backlog was seen since the controller was enabled.
+	unsigned long GetNumBacklogs() const { return numBacklogs; }
+
+  private:
+	std::atomic<bool> enabled; /// True if load shedding is enabled.
+	std::atomic<unsigned int> level; /// The current level.
+	unsigned int holdOff; /// The number of spills to wait before the level may change again.
+	std::atomic<double> load; /// Running average of the fraction of the wall time spent processing.
+
+	std::atomic<unsigned long> numReceived; /// The number of spills received.
+	std::atomic<unsigned long> numProcessed; /// The number of spills processed.
+	std::atomic<unsigned long> numBacklogs; /// The number of times a backlog was seen.
+};
+
+#endif
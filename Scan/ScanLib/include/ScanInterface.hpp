@@ -17,9 +17,12 @@
 #include <sstream>
 #include <vector>
 #include <deque>
+#include <mutex>
 #include <getopt.h>
 
 #include "hribf_buffers.h"
+#include "EventCache.hpp"
+#include "OverloadController.hpp"
 #include "XiaData.hpp"
 
 #define SCAN_VERSION "1.2.29"
@@ -95,6 +98,9 @@ class ScanInterface{
 	
 	/// Return true if dry run mode is enabled.
 	bool DryRunMode(){ return dry_run_mode; }
+
+	/// Return the controller which sheds analysis and spills when the shm readout falls behind.
+	const OverloadController &GetOverload() const { return overload; }
 	
 	/// Return true if shared memory mode is enabled.
 	bool ShmMode(){ return shm_mode; }
@@ -264,6 +270,16 @@ class ScanInterface{
 	  */
 	virtual void Notify(const std::string &code_=""){ }
 
+	/** SpillReceived is called for every spill received in shared memory
+	  * mode while load shedding is enabled, before the spill is processed.
+	  * It may be used to record the prescale applied to the spills and the
+	  * analysis shed at the current level of GetOverload().
+	  * Does nothing useful by default.
+	  * \param[in] processed_ True if the spill is processed and false if it is shed.
+	  * \return Nothing.
+	  */
+	virtual void SpillReceived(const bool &processed_){ }
+
 	/** Return a pointer to the Unpacker object to use for data unpacking.
 	  * If no object has been initialized, create a new one.
 	  * \return Pointer to an Unpacker object.
@@ -280,9 +296,10 @@ class ScanInterface{
 	std::string homeDir; /// Linux user home directory.
 	std::string setup_filename; //!< Configuration file to be opened
 	std::string output_filename; //!< Name of file to be used for output
+	std::string cache_filename; //!< Name of the event cache to write while scanning, if any
 
 	int max_spill_size; /// Maximum size of a spill to read.
-	int file_format; /// Input file format to use (0=.ldf, 1=.pld, 2=.root).
+	int file_format; /// Input file format to use (0=.ldf, 1=.pld, 2=.root, 3=.evc).
 	
 	unsigned long num_spills_recvd; /// The total number of good spills received from either the input file or shared memory.
 	unsigned long file_start_offset; /// The first word in the file at which to start scanning.
@@ -316,6 +333,10 @@ class ScanInterface{
 	DATA_buffer databuff; /// HRIBF DATA buffer handler.
 	EOF_buffer eofbuff; /// HRIBF EOF buffer handler.
 
+	EventCache event_cache; /// Reader of an event cache (.evc) input file.
+	OverloadController overload; /// Sheds analysis and spills when the shm readout falls behind.
+	std::mutex overload_lock; /// Serializes the changes of the overload controller by the scan and command threads.
+
 	Terminal *term; /// ncurses terminal used for displaying output and handling user input.
 
 	/// Start the scan.
@@ -25,6 +25,7 @@
 #endif
 
 class XiaData;
+class EventCache;
 class ScanMain;
 class ScanInterface;
 
@@ -69,6 +70,57 @@ class Unpacker{
 	/// Set the width of events in pixie16 clock ticks.
 	double SetEventWidth(double width_){ return (eventWidth = width_); }
 	
+	/** Only decode the events of a single channel. The events of all other
+	  * channels are stepped over using the event length in their header, so no
+	  * XiaData is ever made for them.
+	  * \param[in]  mod_         The module number, including 100 times the crate number.
+	  * \param[in]  chan_        The channel number.
+	  * \param[in]  buildEvents_ If false the events of a spill are handed to ProcessRawEvent in one raw event, without time sorting or event building.
+	  * \return Nothing.
+	  */
+	void SetChannelSelection(int mod_, int chan_, bool buildEvents_=true);
+	
+	/// Decode the events of all channels and build events again.
+	void ClearChannelSelection(){ SetChannelSelection(-1, -1); }
+	
+	/** Give a channel its own event window. Events of such a channel are
+	  * collected with the raw event whose start time is at most width_ ticks
+	  * before them. Unless the channel is a trigger they go into the sub-event,
+	  * the channel never starts a raw event and its events which do not follow
+	  * a trigger within width_ ticks are dropped as orphans. Events of trigger
+	  * channels go into the raw event itself. Channels without their own window
+	  * use the event width and are triggers.
+	  * \param[in]  mod_     The module number, including 100 times the crate number.
+	  * \param[in]  chan_    The channel number.
+	  * \param[in]  width_   The width of the window in pixie16 clock ticks.
+	  * \param[in]  trigger_ True if events of the channel may start a raw event.
+	  * \return True if the module and channel are valid and false otherwise.
+	  */
+	bool SetChannelWindow(unsigned int mod_, unsigned int chan_, double width_, bool trigger_=false);
+	
+	/// Use the event width for all channels again.
+	void ClearChannelWindows();
+	
+	/// Return the number of events dropped because they did not follow a trigger.
+	unsigned long GetNumOrphans(){ return numOrphans; }
+	
+	/** Write every raw event built from now on to an event cache, which can
+	  * be scanned again without decoding and event building.
+	  * \param[in]  fname_ The name of the cache file, normally with the extension .evc.
+	  * \return True if the cache file was created and false otherwise.
+	  */
+	bool SetCacheOutput(const std::string &fname_);
+	
+	/// Write the index of the event cache and stop writing to it.
+	void CloseCacheOutput();
+	
+	/** Process events read from an event cache instead of a spill.
+	  * \param[in]  cache_     Pointer to an event cache opened for reading.
+	  * \param[in]  numEvents_ The maximum number of events to process.
+	  * \return True if the cache has more events and false otherwise.
+	  */
+	bool ReadCache(EventCache *cache_, const unsigned long &numEvents_);
+	
 	/// Set the address of the scan interface used for file operations.
 	ScanInterface *SetInterface(ScanInterface *interface_){ return (interface = interface_); }
 	
@@ -102,9 +154,14 @@ class Unpacker{
 	
 	bool debug_mode; /// True if debug mode is set.
 	bool running; /// True if the scan is running.
+	
+	int selectMod; /// The only module which is decoded, or -1 for all modules.
+	int selectChan; /// The only channel which is decoded.
+	bool buildEvents; /// False if the events of a spill are processed without time sorting or event building.
 
 	std::vector<std::deque<XiaData*> > eventList; /// The list of all events in a spill.
 	std::deque<XiaData*> rawEvent; /// The list of all events in the event window.
+	std::deque<XiaData*> subEvent; /// The events of non-trigger channels with their own window which belong to the raw event.
 
 	ScanInterface *interface; /// Pointer to an object derived from ScanInterface.
 
@@ -144,6 +201,16 @@ class Unpacker{
 	double realStartTime; /// The time of the first xia event in the raw event.
 	double realStopTime; /// The time of the last xia event in the raw event.
 
+	std::vector<double> channelWidth; /// Event window of each channel, indexed by 16 * module + channel, or -1 for the event width.
+	std::vector<bool> channelTrigger; /// True for the channels which may start a raw event.
+	double maxChannelWidth; /// The widest event window of any channel.
+	unsigned long numOrphans; /// The number of events dropped because they did not follow a trigger.
+
+	std::vector<XiaData*> windowedList; /// The time sorted events of a spill while building windowed events, NULL once taken.
+	size_t windowedNext; /// The first event of windowedList which may not have been taken yet.
+
+	EventCache *cacheOutput; /// The event cache the raw events are written to, NULL if none.
+
 	/** Scan the event list and sort it by timestamp.
 	  * \return Nothing.
 	  */
@@ -155,6 +222,22 @@ class Unpacker{
 	  */
 	bool BuildRawEvent();
 	
+	/** Build a raw event when some channels have their own event window. The
+	  * raw event starts at the earliest trigger. Every event within the window
+	  * of its channel from that time is moved into the raw event, or into the
+	  * sub-event for non-trigger channels with their own window. The spill is
+	  * merged into one time sorted list on the first call, so each event only
+	  * visits the part of the spill within the widest window.
+	  * \return True if a raw event was built and false otherwise.
+	  */
+	bool BuildWindowedEvent();
+	
+	/** Move every event in the event list into the raw event, in the order
+	  * they were read, without time sorting or event building.
+	  * \return True if the event list was not empty and false otherwise.
+	  */
+	bool MoveEventList();
+	
 	/** Push an event into the event list.
 	  * \param[in]  event_ The XiaData to push onto the back of the event list.
 	  * \return True if the XiaData's module number is valid and false otherwise.
@@ -167,7 +250,7 @@ class Unpacker{
 	  */	
 	void ClearEventList();
 
-	/** Clear all events in the raw event list. WARNING! This method will delete all events in the
+	/** Clear all events in the raw event and sub-event lists. WARNING! This method will delete all events in the
 	  * event list. This could cause seg faults if the events are used elsewhere.
 	  * \return Nothing.
 	  */	
@@ -26,6 +26,13 @@ public:
     static const int numQdcs = 8; /// Number of QDCs onboard.
     unsigned int qdcValue[numQdcs]; /// QDCs from onboard.
     
+    /// Indices of the onboard energy filter sums.
+    enum EnergySum {TRAILING_SUM=0, LEADING_SUM=1, GAP_SUM=2};
+    static const int numEnergySums = 3; /// Number of onboard energy filter sums.
+    unsigned int energySums[numEnergySums]; /// Onboard energy filter sums (trailing, leading, gap).
+    float energyBaseline; /// Onboard energy filter baseline, in the same units as the filter output.
+    bool hasEnergySums; /// True if the header contained the onboard energy sums and baseline.
+    
     unsigned int slotNum; ///Slot number
     unsigned int modNum; /// Module number.
     unsigned int chanNum; /// Channel number.
@@ -71,6 +78,9 @@ public:
     /// Return one of the onboard qdc values.
     unsigned int getQdcValue(int id){ return (id < 0 || id >= numQdcs ? -1 : qdcValue[id]); }
     
+    /// Return one of the onboard energy filter sums.
+    unsigned int getEnergySum(int id){ return (id < 0 || id >= numEnergySums ? -1 : energySums[id]); }
+    
     /// Clear all variables.
     void clear();
 };
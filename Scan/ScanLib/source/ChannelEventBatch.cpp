@@ -0,0 +1,209 @@
+/** \file ChannelEventBatch.cpp
+ * \brief Analyzes the waveforms of many ChannelEvents with the same trace length at once.
+ * \date Oct. 19th, 2026
+ */
+#include <cmath>
+
+#include "ChannelEventBatch.hpp"
+
+#define W ChannelEventBatch::TILE_WIDTH
+
+ChannelEventBatch::ChannelEventBatch() : traceLength(0), corrected(false) {
+}
+
+bool ChannelEventBatch::Add(ChannelEvent *event_){
+	if(!event_ || !event_->event || event_->size == 0){ return false; }
+	if(events.empty()){ traceLength = event_->size; }
+	else if(event_->size != traceLength){ return false; }
+	events.push_back(event_);
+	corrected = false;
+	return true;
+}
+
+void ChannelEventBatch::CorrectBaseline(){
+	const size_t numEvents = events.size();
+	if(numEvents == 0){ return; }
+
+	// Unused lanes of the last tile are left at zero.
+	samples.assign(GetNumTiles() * traceLength * W, 0.0);
+
+	const size_t sample_size = (10 <= traceLength ? 10:traceLength);
+	for(size_t tile = 0; tile < GetNumTiles(); tile++){
+		float *block = &samples[tile * traceLength * W];
+		const size_t first = tile * W;
+		const size_t width = (first + W <= numEvents ? W:numEvents - first);
+
+		// Copy the traces of the tile into the block, reading every trace in order.
+		// Events which were already corrected bring their corrected samples.
+		bool done[W] = {false};
+		for(size_t lane = 0; lane < width; lane++){
+			const ChannelEvent *current = events[first + lane];
+			done[lane] = current->baseline_corrected;
+			if(done[lane]){
+				for(size_t i = 0; i < traceLength; i++){
+					block[i * W + lane] = current->yvals[i];
+				}
+				continue;
+			}
+			const int *trace = &current->event->adcTrace[0];
+			for(size_t i = 0; i < traceLength; i++){
+				block[i * W + lane] = (float)trace[i];
+			}
+		}
+
+		// Find the baselines and their standard deviations.
+		float baseline[W] = {0};
+		for(size_t i = 0; i < sample_size; i++){
+			for(size_t lane = 0; lane < W; lane++){
+				baseline[lane] += block[i * W + lane];
+			}
+		}
+		for(size_t lane = 0; lane < W; lane++){
+			baseline[lane] = (done[lane] ? 0.0:baseline[lane]/sample_size);
+		}
+
+		float stddev[W] = {0};
+		for(size_t i = 0; i < sample_size; i++){
+			for(size_t lane = 0; lane < W; lane++){
+				stddev[lane] += (block[i * W + lane] - baseline[lane])*(block[i * W + lane] - baseline[lane]);
+			}
+		}
+
+		// Correct the baselines and find the maximum values and the maximum bins.
+		float maximum[W];
+		unsigned int max_index[W] = {0};
+		for(size_t lane = 0; lane < W; lane++){
+			maximum[lane] = -9999.0;
+		}
+		for(size_t i = 0; i < traceLength; i++){
+			for(size_t lane = 0; lane < W; lane++){
+				const float value = block[i * W + lane] - baseline[lane];
+				const unsigned int larger = -(unsigned int)(value > maximum[lane]); // All bits set if larger.
+				block[i * W + lane] = value;
+				maximum[lane] = (value > maximum[lane] ? value:maximum[lane]);
+				max_index[lane] = (max_index[lane] & ~larger) | ((unsigned int)i & larger);
+			}
+		}
+
+		// Keep the arrays of the events in step with the batch.
+		for(size_t lane = 0; lane < width; lane++){
+			if(done[lane]){ continue; }
+			ChannelEvent *current = events[first + lane];
+			current->baseline = baseline[lane];
+			current->stddev = std::sqrt((1.0/sample_size) * stddev[lane]);
+			current->maximum = maximum[lane];
+			current->max_index = max_index[lane];
+			for(size_t i = 0; i < traceLength; i++){
+				current->xvals[i] = i;
+				current->yvals[i] = block[i * W + lane];
+			}
+			current->baseline_corrected = true;
+		}
+	}
+
+	corrected = true;
+}
+
+void ChannelEventBatch::FindLeadingEdge(const float &thresh_/*=0.05*/){
+	if(!corrected){ CorrectBaseline(); }
+
+	for(size_t evt = 0; evt < events.size(); evt++){
+		ChannelEvent *current = events[evt];
+
+		// Check if this is a valid pulse
+		if(current->maximum <= 0 || current->max_index == 0){ continue; }
+
+		// Only a few samples before the maximum are visited, so the search is done one event at a time.
+		const float threshold = thresh_ * current->maximum;
+		for(size_t index = current->max_index; index > 0; index--){
+			const float value = GetSample(evt, index);
+			if(value <= threshold){
+				// Interpolate between index and index+1.
+				const float next = GetSample(evt, index+1);
+				if(next == value){ current->phase = index+1; }
+				else{ current->phase = index + (threshold - value)/(next - value); }
+				break;
+			}
+		}
+	}
+}
+
+void ChannelEventBatch::IntegratePulse(const size_t &start_/*=0*/, const size_t &stop_/*=0*/){
+	if(!corrected){ CorrectBaseline(); }
+
+	const size_t stop = (stop_ == 0 || stop_ > traceLength ? traceLength:stop_);
+	for(size_t tile = 0; tile < GetNumTiles(); tile++){
+		const float *block = &samples[tile * traceLength * W];
+
+		float qdc[W] = {0};
+		for(size_t i = start_+1; i < stop; i++){ // Integrate using trapezoidal rule.
+			for(size_t lane = 0; lane < W; lane++){
+				qdc[lane] += 0.5*(block[(i-1) * W + lane] + block[i * W + lane]);
+			}
+		}
+
+		for(size_t lane = 0; lane < W && tile * W + lane < events.size(); lane++){
+			events[tile * W + lane]->qdc = qdc[lane];
+		}
+	}
+}
+
+void ChannelEventBatch::AnalyzeCFD(const float &F_/*=0.5*/, const size_t &D_/*=1*/, const size_t &L_/*=1*/){
+	if(!corrected){ CorrectBaseline(); }
+
+	cfd.assign(samples.size(), 0.0);
+	for(size_t tile = 0; tile < GetNumTiles(); tile++){
+		const float *block = &samples[tile * traceLength * W];
+		float *cfdBlock = &cfd[tile * traceLength * W];
+
+		// Compute the cfd waveforms. The terms are added in the same order as
+		// in ChannelEvent::AnalyzeCFD, so the results are identical.
+		float cfdMinimum[W];
+		unsigned int cfdMinIndex[W] = {0};
+		for(size_t lane = 0; lane < W; lane++){
+			cfdMinimum[lane] = 9999;
+		}
+		for(size_t cfdIndex = 0; cfdIndex < traceLength; cfdIndex++){
+			float *cfdSample = &cfdBlock[cfdIndex * W];
+			if(cfdIndex >= L_ + D_ - 1){
+				for(size_t i = 0; i < L_; i++){
+					for(size_t lane = 0; lane < W; lane++){
+						cfdSample[lane] += F_ * block[(cfdIndex - i) * W + lane] - block[(cfdIndex - i - D_) * W + lane];
+					}
+				}
+			}
+			for(size_t lane = 0; lane < W; lane++){
+				const unsigned int smaller = -(unsigned int)(cfdSample[lane] < cfdMinimum[lane]); // All bits set if smaller.
+				cfdMinimum[lane] = (cfdSample[lane] < cfdMinimum[lane] ? cfdSample[lane]:cfdMinimum[lane]);
+				cfdMinIndex[lane] = (cfdMinIndex[lane] & ~smaller) | ((unsigned int)cfdIndex & smaller);
+			}
+		}
+
+		// Find the zero-crossings before the minima and copy the cfd waveforms
+		// into the events, as ChannelEvent::AnalyzeCFD does.
+		for(size_t lane = 0; lane < W && tile * W + lane < events.size(); lane++){
+			ChannelEvent *current = events[tile * W + lane];
+			if(!current->cfdvals){ current->cfdvals = new float[traceLength]; }
+			for(size_t i = 0; i < traceLength; i++){
+				current->cfdvals[i] = cfdBlock[i * W + lane];
+			}
+
+			float cfdCrossing = -9999;
+			for(size_t cfdIndex = cfdMinIndex[lane]; cfdIndex-- > 0;){
+				const float value = cfdBlock[cfdIndex * W + lane];
+				const float next = cfdBlock[(cfdIndex+1) * W + lane];
+				if(value >= 0.0 && next < 0.0){
+					cfdCrossing = cfdIndex - value/(next - value);
+					break;
+				}
+			}
+			current->cfdCrossing = cfdCrossing;
+		}
+	}
+}
+
+void ChannelEventBatch::Clear(){
+	events.clear();
+	traceLength = 0;
+	corrected = false;
+}
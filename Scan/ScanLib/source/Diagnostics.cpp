@@ -0,0 +1,158 @@
+/** \file Diagnostics.cpp
+ * \brief Counts the errors found while scanning instead of printing each one.
+ * \date Oct. 19th, 2026
+ */
+#include <algorithm>
+#include <sstream>
+
+#include "Diagnostics.hpp"
+#include "Unpacker.hpp"
+
+#define NUM_CHANNEL_SLOTS ((MAX_PIXIE_MOD+1)*(MAX_PIXIE_CHAN+1))
+
+Diagnostics::Counter::Counter(const std::string &name_, const size_t &numSlots_) :
+	name(name_),
+	total(0),
+	counts(numSlots_),
+	lastTotal(0)
+{
+	for(size_t i = 0; i < counts.size(); i++){
+		counts[i] = 0;
+	}
+}
+
+Diagnostics::Diagnostics() :
+	numCodes(0),
+	numSamples(5),
+	interval(10),
+	lastSummary(time(NULL))
+{
+	for(unsigned int i = 0; i < MAX_CODES; i++){
+		counters[i] = NULL;
+	}
+}
+
+Diagnostics *Diagnostics::get(){
+	static Diagnostics instance;
+	return &instance;
+}
+
+unsigned int Diagnostics::Register(const std::string &name_){
+	std::lock_guard<std::mutex> guard(lock);
+	for(unsigned int i = 0; i < numCodes; i++){
+		if(counters[i]->name == name_){ return i; }
+	}
+
+	// Codes beyond the maximum share the last one rather than failing in the middle of a scan.
+	if(numCodes == MAX_CODES){ return MAX_CODES-1; }
+
+	counters[numCodes] = new Counter(name_, NUM_CHANNEL_SLOTS+1);
+	return numCodes++;
+}
+
+bool Diagnostics::Count(const unsigned int &code_, const int &mod_/*=-1*/, const int &chan_/*=-1*/){
+	if(code_ >= numCodes){ return false; }
+	Counter *counter = counters[code_];
+	counter->counts[Slot(mod_, chan_)].fetch_add(1, std::memory_order_relaxed);
+	return (counter->total.fetch_add(1, std::memory_order_relaxed) < numSamples);
+}
+
+void Diagnostics::Sample(const unsigned int &code_, const int &mod_, const int &chan_, const std::string &msg_){
+	if(code_ >= numCodes){ return; }
+	std::lock_guard<std::mutex> guard(lock);
+	Counter *counter = counters[code_];
+	if(counter->samples.size() >= numSamples){ return; }
+	counter->samples.push_back(SlotName(Slot(mod_, chan_)) + ": " + msg_);
+}
+
+void Diagnostics::Report(const unsigned int &code_, const int &mod_, const int &chan_, const std::string &msg_){
+	if(Count(code_, mod_, chan_)){ Sample(code_, mod_, chan_, msg_); }
+}
+
+unsigned long Diagnostics::GetCount(const unsigned int &code_, const int &mod_/*=-1*/, const int &chan_/*=-1*/) const {
+	if(code_ >= numCodes){ return 0; }
+	if(mod_ < 0){ return counters[code_]->total.load(std::memory_order_relaxed); }
+	return counters[code_]->counts[Slot(mod_, chan_)].load(std::memory_order_relaxed);
+}
+
+unsigned long Diagnostics::GetTotal() const {
+	unsigned long total = 0;
+	for(unsigned int i = 0; i < numCodes; i++){
+		total += counters[i]->total.load(std::memory_order_relaxed);
+	}
+	return total;
+}
+
+void Diagnostics::Print(std::ostream &out_) const {
+	std::lock_guard<std::mutex> guard(lock);
+	bool empty = true;
+	for(unsigned int i = 0; i < numCodes; i++){
+		const Counter *counter = counters[i];
+		unsigned long total = counter->total.load(std::memory_order_relaxed);
+		if(total == 0){ continue; }
+		empty = false;
+
+		// Sort the channels by their counts and show the worst three.
+		std::vector<std::pair<unsigned long, size_t> > slots;
+		for(size_t slot = 0; slot < counter->counts.size(); slot++){
+			unsigned long count = counter->counts[slot].load(std::memory_order_relaxed);
+			if(count > 0){ slots.push_back(std::make_pair(count, slot)); }
+		}
+		std::sort(slots.rbegin(), slots.rend());
+
+		out_ << " " << counter->name << ": " << total << " in " << slots.size() << " channel(s)";
+		for(size_t j = 0; j < slots.size() && j < 3; j++){
+			out_ << (j == 0 ? " (" : ", ") << SlotName(slots[j].second) << " " << slots[j].first;
+		}
+		out_ << (slots.size() > 3 ? ", ...)\n" : ")\n");
+
+		for(std::vector<std::string>::const_iterator iter = counter->samples.begin(); iter != counter->samples.end(); iter++){
+			out_ << "   " << *iter << "\n";
+		}
+	}
+	if(empty){ out_ << " No errors were counted.\n"; }
+}
+
+bool Diagnostics::Poll(std::ostream &out_){
+	time_t now = time(NULL);
+	if(now - lastSummary < interval){ return false; }
+	lastSummary = now;
+
+	std::stringstream summary;
+	for(unsigned int i = 0; i < numCodes; i++){
+		Counter *counter = counters[i];
+		unsigned long total = counter->total.load(std::memory_order_relaxed);
+		if(total == counter->lastTotal){ continue; }
+		summary << (summary.tellp() > 0 ? ", " : "") << counter->name << " +" << total - counter->lastTotal;
+		counter->lastTotal = total;
+	}
+	if(summary.tellp() <= 0){ return false; }
+
+	out_ << "Diagnostics: " << summary.str() << " (type 'diag' for details)\n";
+	return true;
+}
+
+void Diagnostics::Reset(){
+	std::lock_guard<std::mutex> guard(lock);
+	for(unsigned int i = 0; i < numCodes; i++){
+		Counter *counter = counters[i];
+		counter->total = 0;
+		for(size_t slot = 0; slot < counter->counts.size(); slot++){
+			counter->counts[slot] = 0;
+		}
+		counter->lastTotal = 0;
+		counter->samples.clear();
+	}
+}
+
+size_t Diagnostics::Slot(const int &mod_, const int &chan_){
+	if(mod_ < 0 || chan_ < 0 || mod_ > MAX_PIXIE_MOD || chan_ > MAX_PIXIE_CHAN){ return NUM_CHANNEL_SLOTS; }
+	return mod_*(MAX_PIXIE_CHAN+1) + chan_;
+}
+
+std::string Diagnostics::SlotName(const size_t &slot_){
+	if(slot_ >= NUM_CHANNEL_SLOTS){ return "other"; }
+	std::stringstream stream;
+	stream << slot_/(MAX_PIXIE_CHAN+1) << ":" << slot_%(MAX_PIXIE_CHAN+1);
+	return stream.str();
+}
@@ -0,0 +1,384 @@
+/** \file EventCache.cpp
+ * \brief A file of built raw events, so repeated scans skip the decoding and the event building.
+ * \date Oct. 19th, 2026
+ */
+#include <iostream>
+#include <string.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "EventCache.hpp"
+#include "XiaData.hpp"
+
+#define CACHE_MAGIC "PXEVC001"
+
+/// The header at the start of the file.
+struct CacheHeader{
+	char magic[8]; /// CACHE_MAGIC.
+	uint32_t headerSize; /// The size of this header.
+	uint32_t hitSize; /// The size of a CacheHit.
+	double eventWidth; /// The width of the raw events in pixie16 clock ticks.
+	double firstTime; /// The start time of the first event.
+	uint64_t numEvents; /// The number of events.
+	uint64_t indexOffset; /// The offset of the index, zero until the file is closed.
+	uint64_t reserved[2];
+};
+
+/// The record at the start of each event.
+struct CacheEvent{
+	double startTime; /// The start time of the raw event.
+	double realStartTime; /// The time of the first hit.
+	double realStopTime; /// The time of the last hit.
+	uint32_t numRaw; /// The number of hits in the raw event.
+	uint32_t numSub; /// The number of hits in the sub-event.
+};
+
+/// The fixed part of the record of each hit.
+struct CacheHit{
+	double energy;
+	double time;
+	double eventTime;
+	uint32_t trigTime;
+	uint32_t cfdTime;
+	uint32_t eventTimeLo;
+	uint32_t eventTimeHi;
+	uint32_t modNum;
+	uint16_t chanNum;
+	uint16_t slotNum;
+	uint32_t traceLength;
+	uint32_t flags; /// See HitFlags.
+};
+
+enum HitFlags{
+	HIT_VIRTUAL=0x1, HIT_PILEUP=0x2, HIT_SATURATED=0x4, HIT_CFD_FORCE=0x8, HIT_CFD_SOURCE=0x10,
+	HIT_QDCS=0x20, /// The onboard qdcs follow the hit.
+	HIT_SUMS=0x40, /// The onboard energy sums and baseline follow the hit.
+	HIT_WIDE_TRACE=0x80 /// The trace has 32 bits per sample instead of 16.
+};
+
+/// Return the size rounded up to a multiple of 8 bytes, so every record stays aligned.
+static size_t Pad(const size_t &size_){ return (size_ + 7) & ~((size_t)7); }
+
+EventCache::EventCache() :
+	data(NULL),
+	dataSize(0),
+	index(NULL),
+	eventWidth(0),
+	firstTime(0),
+	numEvents(0),
+	position(0)
+{
+}
+
+EventCache::~EventCache(){
+	Close();
+}
+
+bool EventCache::Create(const std::string &fname_, const double &eventWidth_){
+	Close();
+
+	output.open(fname_.c_str(), std::ios::binary | std::ios::trunc);
+	if(!output.good()){
+		output.close();
+		return false;
+	}
+
+	filename = fname_;
+	eventWidth = eventWidth_;
+	firstTime = 0;
+	numEvents = 0;
+	offsets.clear();
+
+	// The header is written again with the index when the file is closed.
+	CacheHeader header;
+	memset(&header, 0, sizeof(header));
+	output.write((char*)&header, sizeof(header));
+
+	return output.good();
+}
+
+bool EventCache::Write(const double &startTime_, const double &realStartTime_, const double &realStopTime_,
+                       const std::deque<XiaData*> &rawEvent_, const std::deque<XiaData*> &subEvent_){
+	if(!output.is_open()){ return false; }
+
+	CacheEvent event;
+	event.startTime = startTime_;
+	event.realStartTime = realStartTime_;
+	event.realStopTime = realStopTime_;
+	event.numRaw = rawEvent_.size();
+	event.numSub = subEvent_.size();
+
+	record.resize(sizeof(event));
+	memcpy(&record[0], &event, sizeof(event));
+	for(std::deque<XiaData*>::const_iterator iter = rawEvent_.begin(); iter != rawEvent_.end(); iter++){
+		AppendHit(*iter);
+	}
+	for(std::deque<XiaData*>::const_iterator iter = subEvent_.begin(); iter != subEvent_.end(); iter++){
+		AppendHit(*iter);
+	}
+
+	if(numEvents == 0){ firstTime = startTime_; }
+	offsets.push_back(output.tellp());
+	output.write(&record[0], record.size());
+	numEvents++;
+
+	return output.good();
+}
+
+void EventCache::AppendHit(const XiaData *event_){
+	CacheHit hit;
+	hit.energy = event_->energy;
+	hit.time = event_->time;
+	hit.eventTime = event_->eventTime;
+	hit.trigTime = event_->trigTime;
+	hit.cfdTime = event_->cfdTime;
+	hit.eventTimeLo = event_->eventTimeLo;
+	hit.eventTimeHi = event_->eventTimeHi;
+	hit.modNum = event_->modNum;
+	hit.chanNum = event_->chanNum;
+	hit.slotNum = event_->slotNum;
+	hit.traceLength = event_->adcTrace.size();
+
+	hit.flags = 0;
+	if(event_->virtualChannel){ hit.flags |= HIT_VIRTUAL; }
+	if(event_->pileupBit){ hit.flags |= HIT_PILEUP; }
+	if(event_->saturatedBit){ hit.flags |= HIT_SATURATED; }
+	if(event_->cfdForceTrig){ hit.flags |= HIT_CFD_FORCE; }
+	if(event_->cfdTrigSource){ hit.flags |= HIT_CFD_SOURCE; }
+	if(event_->hasEnergySums){ hit.flags |= HIT_SUMS; }
+	for(int i = 0; i < XiaData::numQdcs; i++){
+		if(event_->qdcValue[i] != 0){
+			hit.flags |= HIT_QDCS;
+			break;
+		}
+	}
+	for(std::vector<int>::const_iterator iter = event_->adcTrace.begin(); iter != event_->adcTrace.end(); iter++){
+		if(*iter < 0 || *iter > 0xFFFF){ // Virtual channels may hold the sum of several traces.
+			hit.flags |= HIT_WIDE_TRACE;
+			break;
+		}
+	}
+
+	size_t offset = record.size();
+	size_t size = sizeof(hit);
+	if(hit.flags & HIT_QDCS){ size += sizeof(event_->qdcValue); }
+	if(hit.flags & HIT_SUMS){ size += sizeof(event_->energySums) + sizeof(float); }
+	size += hit.traceLength * (hit.flags & HIT_WIDE_TRACE ? sizeof(int32_t) : sizeof(uint16_t));
+	record.resize(offset + Pad(size), 0);
+
+	char *ptr = &record[offset];
+	memcpy(ptr, &hit, sizeof(hit));
+	ptr += sizeof(hit);
+	if(hit.flags & HIT_QDCS){
+		memcpy(ptr, event_->qdcValue, sizeof(event_->qdcValue));
+		ptr += sizeof(event_->qdcValue);
+	}
+	if(hit.flags & HIT_SUMS){
+		memcpy(ptr, event_->energySums, sizeof(event_->energySums));
+		ptr += sizeof(event_->energySums);
+		memcpy(ptr, &event_->energyBaseline, sizeof(float));
+		ptr += sizeof(float);
+	}
+	if(hit.flags & HIT_WIDE_TRACE){
+		for(size_t i = 0; i < hit.traceLength; i++){
+			int32_t sample = event_->adcTrace[i];
+			memcpy(ptr + i*sizeof(int32_t), &sample, sizeof(int32_t));
+		}
+	}
+	else{
+		for(size_t i = 0; i < hit.traceLength; i++){
+			uint16_t sample = event_->adcTrace[i];
+			memcpy(ptr + i*sizeof(uint16_t), &sample, sizeof(uint16_t));
+		}
+	}
+}
+
+bool EventCache::Open(const std::string &fname_){
+	Close();
+
+	int fd = open(fname_.c_str(), O_RDONLY);
+	if(fd < 0){
+		std::cout << "EventCache: Failed to open cache file '" << fname_ << "'!\n";
+		return false;
+	}
+
+	struct stat info;
+	if(fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(CacheHeader)){
+		std::cout << "EventCache: The file '" << fname_ << "' is too short to be an event cache!\n";
+		close(fd);
+		return false;
+	}
+
+	void *map = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(map == MAP_FAILED){
+		std::cout << "EventCache: Failed to map cache file '" << fname_ << "'!\n";
+		return false;
+	}
+	madvise(map, info.st_size, MADV_SEQUENTIAL);
+
+	data = (const char*)map;
+	dataSize = info.st_size;
+
+	CacheHeader header;
+	memcpy(&header, data, sizeof(header));
+	if(memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) != 0 || header.headerSize != sizeof(CacheHeader) || header.hitSize != sizeof(CacheHit)){
+		std::cout << "EventCache: The file '" << fname_ << "' is not an event cache of this version!\n";
+		Close();
+		return false;
+	}
+	if(header.indexOffset < sizeof(CacheHeader) || header.indexOffset + header.numEvents*sizeof(uint64_t) > dataSize){
+		std::cout << "EventCache: The cache '" << fname_ << "' was not closed and has no index!\n";
+		Close();
+		return false;
+	}
+
+	filename = fname_;
+	eventWidth = header.eventWidth;
+	firstTime = header.firstTime;
+	numEvents = header.numEvents;
+	index = (const uint64_t*)(data + header.indexOffset);
+	position = 0;
+
+	return true;
+}
+
+bool EventCache::Read(double &startTime_, double &realStartTime_, double &realStopTime_,
+                      std::deque<XiaData*> &rawEvent_, std::deque<XiaData*> &subEvent_){
+	if(!data || position >= numEvents){ return false; }
+
+	// The index comes from the file, so it must point between the header and the index in increasing order.
+	uint64_t indexOffset = (const char*)index - data;
+	uint64_t offset = index[position];
+	uint64_t end = (position+1 < numEvents ? index[position+1] : indexOffset);
+	position++;
+
+	CacheEvent event;
+	if(offset < sizeof(CacheHeader) || offset > end || end > indexOffset || end - offset < sizeof(event)){
+		std::cout << "EventCache: The index of event " << position-1 << " of '" << filename << "' is damaged!\n";
+		return false;
+	}
+	memcpy(&event, data + offset, sizeof(event));
+	offset += sizeof(event);
+
+	startTime_ = event.startTime;
+	realStartTime_ = event.realStartTime;
+	realStopTime_ = event.realStopTime;
+
+	for(uint32_t i = 0; i < event.numRaw + event.numSub; i++){
+		XiaData *current = ReadHit(offset, end);
+		if(!current){
+			std::cout << "EventCache: Event " << position-1 << " of '" << filename << "' is damaged!\n";
+			return false;
+		}
+		if(i < event.numRaw){ rawEvent_.push_back(current); }
+		else{ subEvent_.push_back(current); }
+	}
+
+	return true;
+}
+
+XiaData *EventCache::ReadHit(uint64_t &offset_, const uint64_t &end_){
+	CacheHit hit;
+	if(offset_ + sizeof(hit) > end_){ return NULL; }
+	memcpy(&hit, data + offset_, sizeof(hit));
+
+	XiaData *current = new XiaData();
+	size_t size = sizeof(hit);
+	if(hit.flags & HIT_QDCS){ size += sizeof(current->qdcValue); }
+	if(hit.flags & HIT_SUMS){ size += sizeof(current->energySums) + sizeof(float); }
+	size += (uint64_t)hit.traceLength * (hit.flags & HIT_WIDE_TRACE ? sizeof(int32_t) : sizeof(uint16_t));
+	if(offset_ + Pad(size) > end_){
+		delete current;
+		return NULL;
+	}
+
+	current->energy = hit.energy;
+	current->time = hit.time;
+	current->eventTime = hit.eventTime;
+	current->trigTime = hit.trigTime;
+	current->cfdTime = hit.cfdTime;
+	current->eventTimeLo = hit.eventTimeLo;
+	current->eventTimeHi = hit.eventTimeHi;
+	current->modNum = hit.modNum;
+	current->chanNum = hit.chanNum;
+	current->slotNum = hit.slotNum;
+	current->virtualChannel = ((hit.flags & HIT_VIRTUAL) != 0);
+	current->pileupBit = ((hit.flags & HIT_PILEUP) != 0);
+	current->saturatedBit = ((hit.flags & HIT_SATURATED) != 0);
+	current->cfdForceTrig = ((hit.flags & HIT_CFD_FORCE) != 0);
+	current->cfdTrigSource = ((hit.flags & HIT_CFD_SOURCE) != 0);
+
+	const char *ptr = data + offset_ + sizeof(hit);
+	if(hit.flags & HIT_QDCS){
+		memcpy(current->qdcValue, ptr, sizeof(current->qdcValue));
+		ptr += sizeof(current->qdcValue);
+	}
+	if(hit.flags & HIT_SUMS){
+		memcpy(current->energySums, ptr, sizeof(current->energySums));
+		ptr += sizeof(current->energySums);
+		memcpy(&current->energyBaseline, ptr, sizeof(float));
+		ptr += sizeof(float);
+		current->hasEnergySums = true;
+	}
+
+	current->adcTrace.resize(hit.traceLength);
+	if(hit.flags & HIT_WIDE_TRACE){
+		for(size_t i = 0; i < hit.traceLength; i++){
+			int32_t sample;
+			memcpy(&sample, ptr + i*sizeof(int32_t), sizeof(int32_t));
+			current->adcTrace[i] = sample;
+		}
+	}
+	else{
+		const uint16_t *samples = (const uint16_t*)ptr; // Records are 8 byte aligned.
+		for(size_t i = 0; i < hit.traceLength; i++){
+			current->adcTrace[i] = samples[i];
+		}
+	}
+
+	offset_ += Pad(size);
+	return current;
+}
+
+bool EventCache::Seek(const uint64_t &event_){
+	if(!data || event_ > numEvents){ return false; }
+	position = event_;
+	return true;
+}
+
+void EventCache::Close(){
+	if(output.is_open()){
+		CacheHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+		header.headerSize = sizeof(CacheHeader);
+		header.hitSize = sizeof(CacheHit);
+		header.eventWidth = eventWidth;
+		header.firstTime = firstTime;
+		header.numEvents = numEvents;
+		header.indexOffset = output.tellp();
+
+		if(!offsets.empty()){ output.write((char*)&offsets[0], offsets.size()*sizeof(uint64_t)); }
+		output.seekp(0, std::ios::beg);
+		output.write((char*)&header, sizeof(header));
+		if(!output.good()){ std::cout << "EventCache: Failed to write the index of '" << filename << "'!\n"; }
+		output.close();
+
+		offsets.clear();
+		std::vector<uint64_t>().swap(offsets);
+	}
+
+	if(data){
+		munmap((void*)data, dataSize);
+		data = NULL;
+		dataSize = 0;
+		index = NULL;
+	}
+
+	numEvents = 0;
+	position = 0;
+}
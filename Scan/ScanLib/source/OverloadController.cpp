@@ -0,0 +1,69 @@
+/** \file OverloadController.cpp
+ * \brief Decides how much of the online analysis to shed when the scan falls behind.
+ * \date Oct. 19th, 2026
+ */
+#include "OverloadController.hpp"
+
+#define LOAD_SMOOTHING 0.2 // Weight of the newest spill in the running average of the load.
+#define HIGH_LOAD 0.9 // A level up is taken above this load.
+#define BACKLOG_LOAD 0.75 // A level up is taken above this load if a backlog was seen.
+#define LOW_LOAD 0.35 // A level down is taken below this load, so twice the work still fits.
+#define HOLD_OFF_UP 5 // Spills to wait after a level up.
+#define HOLD_OFF_DOWN 20 // Spills to wait after a level down.
+
+OverloadController::OverloadController() :
+	enabled(false),
+	level(0),
+	holdOff(0),
+	load(0),
+	numReceived(0),
+	numProcessed(0),
+	numBacklogs(0)
+{
+}
+
+void OverloadController::SetEnabled(const bool &enabled_/*=true*/){
+	enabled = enabled_;
+	level = 0;
+	holdOff = 0;
+	load = 0;
+	numReceived = 0;
+	numProcessed = 0;
+	numBacklogs = 0;
+}
+
+bool OverloadController::Accept(){
+	bool accept = (!enabled || numReceived % GetPrescale() == 0);
+	numReceived++;
+	if(accept){ numProcessed++; }
+	return accept;
+}
+
+bool OverloadController::Update(const double &busy_, const double &interval_, const bool &backlog_){
+	if(!enabled){ return false; }
+
+	// The first spill has no interval, and a long pause (e.g. between runs) says nothing about the load.
+	if(interval_ > 0 && interval_ < 60){
+		double current = busy_/interval_;
+		load = (numReceived <= 1 ? current : LOAD_SMOOTHING*current + (1-LOAD_SMOOTHING)*load);
+	}
+	if(backlog_){ numBacklogs++; }
+
+	if(holdOff > 0){
+		holdOff--;
+		return false;
+	}
+
+	if(level < MAX_LEVEL && (load > HIGH_LOAD || (backlog_ && load > BACKLOG_LOAD))){
+		level++;
+		holdOff = HOLD_OFF_UP;
+		return true;
+	}
+	else if(level > 0 && !backlog_ && load < LOW_LOAD){
+		level--;
+		holdOff = HOLD_OFF_DOWN;
+		return true;
+	}
+
+	return false;
+}
@@ -10,6 +10,7 @@
  * \author C. R. Thornsberry
  * \date Feb. 12th, 2016
  */
+#include <chrono>
 #include <iostream>
 #include <sstream>
 #include <thread>
@@ -19,13 +20,18 @@
 
 #include <unistd.h>
 #include <getopt.h>
+#include <sys/ioctl.h>
 
+#include "Diagnostics.hpp"
 #include "Unpacker.hpp"
 #include "poll2_socket.h"
 #include "CTerminal.h"
 
 #include "ScanInterface.hpp"
 
+/// Code of the spills lost by the network readout, see Diagnostics.
+static const unsigned int DIAG_LOST_SPILL = Diagnostics::get()->Register("incomplete shm spill");
+
 #ifndef PROG_NAME
 #define PROG_NAME "ScanInterface"
 #endif
@@ -189,10 +195,19 @@ bool ScanInterface::rewind(const unsigned long &offset_/*=0*/){
 		return false;
 	}
 
-	// Move to the first word in the file.
-	std::cout << " Seeking to word no. " << offset_ << " in file\n";
-	input_file.seekg(offset_*4, input_file.beg);
-	std::cout << " Input file is now at " << input_file.tellg() << " bytes\n";
+	if(file_format == 3){ // Event caches are indexed by event.
+		std::cout << " Seeking to event no. " << offset_ << " in file\n";
+		if(!event_cache.Seek(offset_)){
+			std::cout << " The file only has " << event_cache.GetNumEvents() << " events!\n";
+			return false;
+		}
+	}
+	else{
+		// Move to the first word in the file.
+		std::cout << " Seeking to word no. " << offset_ << " in file\n";
+		input_file.seekg(offset_*4, input_file.beg);
+		std::cout << " Input file is now at " << input_file.tellg() << " bytes\n";
+	}
 
 	// Notify that the user has rewound to the start of the file.
 	Notify("REWIND_FILE");
@@ -226,11 +241,15 @@ bool ScanInterface::open_input_file(const std::string &fname_){
 	else if(extension == "pld"){ // Pixie list data file format
 		file_format = 1;
 	}
+	else if(extension == "evc"){ // Event cache of built raw events
+		file_format = 3;
+	}
 	else{
 		std::cout << " ERROR! Invalid file format '" << extension << "'\n";
 		std::cout << "  The current valid data formats are:\n";
 		std::cout << "   ldf - list data format (HRIBF)\n";
 		std::cout << "   pld - pixie list data format\n";
+		std::cout << "   evc - event cache written with --cache\n";
 		return false;
 	}
 
@@ -296,6 +315,20 @@ bool ScanInterface::open_input_file(const std::string &fname_){
 			pldHead.Print();	
 			std::cout << std::endl;
 		}
+		else if(file_format == 3){
+			if(!event_cache.Open(fname_)){
+				input_file.close();
+				file_open = false;
+				return false;
+			}
+
+			// Store the file information for later use.
+			finfo.push_back("Events", (int)event_cache.GetNumEvents());
+			finfo.push_back("Event width", event_cache.GetEventWidth(), "ticks");
+
+			std::cout << " Event cache with " << event_cache.GetNumEvents() << " raw events built with a width of ";
+			std::cout << event_cache.GetEventWidth() << " clock ticks.\n\n";
+		}
 	}
 
 	// Notify that the user has loaded a new file.
@@ -400,6 +433,7 @@ ScanInterface::ScanInterface(Unpacker *core_/*=NULL*/){
 	baseOpts.push_back(optionExt("batch", no_argument, NULL, 'b', "", "Run in batch mode (i.e. with no command line)"));
 	baseOpts.push_back(optionExt("config", required_argument, NULL, 'c',
 								 "<path>", "Specify path to setup to use for scan"));
+	baseOpts.push_back(optionExt("cache", required_argument, NULL, 0, "<filename>", "Write the built raw events to an event cache (.evc) for later scans"));
 	baseOpts.push_back(optionExt("counts", no_argument, NULL, 0, "", "Write all recorded channel counts to a file"));
 	baseOpts.push_back(optionExt("debug", no_argument, NULL, 0, "", "Enable readout debug mode"));
 	baseOpts.push_back(optionExt("dry-run", no_argument, NULL, 0, "", "Extract spills from file, but do no processing"));
@@ -409,6 +443,7 @@ ScanInterface::ScanInterface(Unpacker *core_/*=NULL*/){
 	baseOpts.push_back(optionExt("output", required_argument, NULL, 'o', "<filename>", "Specifies the name of the output file. Default is \"out\""));
 	baseOpts.push_back(optionExt("quiet", no_argument, NULL, 'q', "", "Toggle off verbosity flag"));
 	baseOpts.push_back(optionExt("shm", no_argument, NULL, 's', "", "Enable shared memory readout"));
+	baseOpts.push_back(optionExt("shed", no_argument, NULL, 0, "", "Shed analysis and spills when the shared memory readout falls behind"));
 	baseOpts.push_back(optionExt("version", no_argument, NULL, 'v', "", "Display version information"));
 
 	optstr = "bc:hi:o:qsv";
@@ -459,6 +494,11 @@ void ScanInterface::RunControl(){
 			unsigned int nTotalWords;
 	
 			bool full_spill = false;
+			bool lost_data = false;
+
+			// Arrival time of the previous spill, for the load of the overload controller.
+			std::chrono::steady_clock::time_point last_arrival;
+			bool have_arrival = false;
 		
 			while(true){
 				if(kill_all == true){ 
@@ -476,6 +516,7 @@ void ScanInterface::RunControl(){
 				total_chunks = -1;
 				nTotalWords = 0;
 				full_spill = true;
+				lost_data = false;
 
 				if(!poll_server->Select(dummy)){
 					if(!batch_mode){ term->SetStatus("\033[0;33m[IDLE]\033[0m Waiting for a spill..."); }
@@ -491,6 +532,7 @@ void ScanInterface::RunControl(){
 					if(!poll_server->Select(select_dummy)){ // Server timeout
 						std::cout << msgHeader << "Network timeout before recv full spill!\n";
 						full_spill = false;
+						lost_data = true;
 						break;
 					} 
 
@@ -511,6 +553,7 @@ void ScanInterface::RunControl(){
 					}
 					else if(previous_chunk != current_chunk - 1){ // We missed a spill chunk somewhere
 						if(debug_mode){ std::cout << "debug: Found chunk " << current_chunk << " but expected chunk " << previous_chunk+1 << std::endl; }
+						lost_data = true;
 						break;
 					}
 
@@ -523,6 +566,7 @@ void ScanInterface::RunControl(){
 					}
 					else{ 
 						if(debug_mode){ std::cout << "debug: Abnormally full spill buffer with " << nTotalWords + 2 + nWords << " words!\n"; }
+						lost_data = true;
 						break; 
 					}
 				}
@@ -533,16 +577,50 @@ void ScanInterface::RunControl(){
 				else{ std::cout << "\r" << status.str(); }
 		
 				if(debug_mode){ std::cout << "debug: Retrieved spill of " << nTotalWords << " words (" << nTotalWords*4 << " bytes)\n"; }
+				std::chrono::steady_clock::time_point arrival = std::chrono::steady_clock::now();
 				if(!dry_run_mode && full_spill){ 
-					int word1 = 2, word2 = 9999;
-					memcpy(&data[nTotalWords], (char *)&word1, 4);
-					memcpy(&data[nTotalWords+1], (char *)&word2, 4);
-					core->ReadSpill(data, nTotalWords + 2, is_verbose); 
+					// When overloaded, only every Nth spill is processed.
+					bool process;
+					{
+						std::lock_guard<std::mutex> lock(overload_lock);
+						process = overload.Accept();
+					}
+					if(overload.IsEnabled()){ SpillReceived(process); }
+
+					if(process){
+						int word1 = 2, word2 = 9999;
+						memcpy(&data[nTotalWords], (char *)&word1, 4);
+						memcpy(&data[nTotalWords+1], (char *)&word2, 4);
+						core->ReadSpill(data, nTotalWords + 2, is_verbose); 
+					}
 					IdleTask();
 				}
 			
 				if(!full_spill){ std::cout << msgHeader << "Not processing spill fragment!\n"; }
 				else{ num_spills_recvd++; }
+				if(lost_data){ Diagnostics::get()->Report(DIAG_LOST_SPILL, -1, -1, "Spill chunks were lost by the network readout"); }
+
+				if(overload.IsEnabled()){
+					// The scan is behind if data was lost or the next spill is already waiting.
+					int pending = 0;
+					ioctl(poll_server->Get(), FIONREAD, &pending);
+
+					std::chrono::steady_clock::time_point done = std::chrono::steady_clock::now();
+					double busy = std::chrono::duration<double>(done - arrival).count();
+					double interval = (have_arrival ? std::chrono::duration<double>(arrival - last_arrival).count() : 0);
+					bool changed;
+					{
+						std::lock_guard<std::mutex> lock(overload_lock);
+						changed = overload.Update(busy, interval, lost_data || pending > 0);
+					}
+					if(changed){
+						std::cout << msgHeader << "Load shedding level " << overload.GetLevel() << " (load " << overload.GetLoad();
+						std::cout << ", spill prescale " << overload.GetPrescale() << ")\n";
+						Notify("OVERLOAD_LEVEL");
+					}
+				}
+				last_arrival = arrival;
+				have_arrival = true;
 			}
 		
 			delete[] shm_data;
@@ -677,6 +755,45 @@ void ScanInterface::RunControl(){
 		}
 		else if(file_format == 2){
 		}
+		else if(file_format == 3){
+			bool more_events = true;
+			while(more_events){
+				if(kill_all == true){ 
+					break;
+				}
+				else if(!is_running){
+					IdleTask();
+					usleep(100000); //0.1 seconds
+					continue;
+				}
+
+				std::stringstream status;
+				status << "\033[0;32m" << "[READ] " << "\033[0m" << "event " << event_cache.GetPosition() << " (";
+				status << 100*event_cache.GetPosition()/(event_cache.GetNumEvents() > 0 ? event_cache.GetNumEvents() : 1) << "%)";
+				if(!batch_mode){ term->SetStatus(status.str()); }
+				else{ std::cout << "\r" << status.str(); }
+
+				// The events are read in blocks, so the user can stop the scan in between.
+				if(!dry_run_mode){ 
+					more_events = core->ReadCache(&event_cache, 10000); 
+					IdleTask();
+				}
+				else{ more_events = event_cache.Seek(event_cache.GetPosition() + 10000); }
+				num_spills_recvd++;
+			}
+
+			if(!batch_mode){ term->SetStatus("\033[0;33m[IDLE]\033[0m Finished scanning file."); }
+			else{ std::cout << std::endl << std::endl; }
+		}
+
+		// The event cache is only written for the first pass over a file.
+		core->CloseCacheOutput();
+
+		// Show the errors counted while scanning.
+		if(Diagnostics::get()->GetTotal() > 0){
+			std::cout << msgHeader << "Errors counted while scanning:\n";
+			Diagnostics::get()->Print(std::cout);
+		}
 
 		// Notify that the scan has completed.
 		Notify("SCAN_COMPLETE");
@@ -762,6 +879,8 @@ void ScanInterface::CmdControl(){
 			std::cout << "   file <filename> - Load an input file\n";
 			std::cout << "   rewind [offset] - Rewind to the beginning of the file\n";
 			std::cout << "   sync            - Wait for the current run to finish\n";
+			std::cout << "   diag [reset]    - Show (or reset) the counts of the errors found while scanning\n";
+			std::cout << "   shed [on|off]   - Show (or toggle) the load shedding of the shm readout\n";
 			CmdHelp("   ");
 		}
 		else if(cmd == "run"){ // Start acquisition.
@@ -813,6 +932,28 @@ void ScanInterface::CmdControl(){
 			}
 			else{ std::cout << msgHeader << "Scan is not running.\n"; }
 		}
+		else if(cmd == "diag"){ // Show the diagnostic counters.
+			if(p_args > 0 && arguments.at(0) == "reset"){
+				Diagnostics::get()->Reset();
+				std::cout << msgHeader << "Reset the diagnostic counters.\n";
+			}
+			else{ Diagnostics::get()->Print(std::cout); }
+		}
+		else if(cmd == "shed"){ // Show or toggle the load shedding.
+			if(p_args > 0 && (arguments.at(0) == "on" || arguments.at(0) == "off")){
+				{
+					std::lock_guard<std::mutex> lock(overload_lock);
+					overload.SetEnabled(arguments.at(0) == "on");
+				}
+				std::cout << msgHeader << "Load shedding is " << arguments.at(0) << ".\n";
+				Notify("OVERLOAD_LEVEL");
+			}
+			else if(!overload.IsEnabled()){ std::cout << msgHeader << "Load shedding is off.\n"; }
+			else{
+				std::cout << msgHeader << "Load shedding level " << overload.GetLevel() << ", load " << overload.GetLoad() << ", spill prescale " << overload.GetPrescale() << "\n";
+				std::cout << msgHeader << "Processed " << overload.GetNumProcessed() << " of " << overload.GetNumReceived() << " spills, " << overload.GetNumBacklogs() << " backlogs\n";
+			}
+		}
 		else if(!ExtraCommands(cmd, arguments)){ // Unrecognized command. Send it to a derived object.
 			std::cout << msgHeader << "Unknown command '" << cmd << "'\n";
 		}
@@ -860,6 +1001,12 @@ bool ScanInterface::Setup(int argc, char *argv[]){
 			if(strcmp("config", longOpts[idx].name) == 0) {
 				setup_filename = optarg;
 			}
+			else if(strcmp("cache", longOpts[idx].name) == 0) {
+				cache_filename = optarg;
+			}
+			else if(strcmp("shed", longOpts[idx].name) == 0) {
+				overload.SetEnabled();
+			}
 			else if(strcmp("counts", longOpts[idx].name) == 0) {
 				write_counts = true;
 			} 
@@ -952,6 +1099,13 @@ bool ScanInterface::Setup(int argc, char *argv[]){
 		return false;
 	}
 
+	// Open the event cache once the event width is known, before any raw event is built.
+	if(!cache_filename.empty() && !core->SetCacheOutput(cache_filename)){
+		std::cout << " FATAL ERROR! Failed to create the event cache!\n";
+		std::cout << "\nCleaning up...\n";
+		return false;
+	}
+
 #ifndef USE_HRIBF		
 	if(shm_mode){
 		poll_server = new Server();
@@ -19,9 +19,18 @@
 #include <algorithm>
 #include <limits>
 
+#include "Diagnostics.hpp"
+#include "EventCache.hpp"
 #include "Unpacker.hpp"
 #include "XiaData.hpp"
 
+/// Codes of the errors counted while unpacking, see Diagnostics.
+static const unsigned int DIAG_BAD_PIXIE_ID = Diagnostics::get()->Register("non-physical pixie id");
+static const unsigned int DIAG_TIME_SKIP = Diagnostics::get()->Register("backwards time-skip");
+static const unsigned int DIAG_BAD_HEADER = Diagnostics::get()->Register("unexpected header length");
+static const unsigned int DIAG_BAD_LENGTH = Diagnostics::get()->Register("bad event length");
+static const unsigned int DIAG_BAD_BUFFER = Diagnostics::get()->Register("unknown buffer");
+
 void clearDeque(std::deque<XiaData*> &list){
 	while(!list.empty()){
 		delete list.front();
@@ -43,6 +52,9 @@ void Unpacker::TimeSort(){
   * \return True if the event list is not empty and false otherwise.
   */
 bool Unpacker::BuildRawEvent(){
+	if(!channelWidth.empty())
+		return BuildWindowedEvent();
+
 	if(!rawEvent.empty())
 		ClearRawEvent();
 
@@ -80,7 +92,11 @@ bool Unpacker::BuildRawEvent(){
 			chan = current_event->chanNum;
 	
 			if(mod > MAX_PIXIE_MOD || chan > MAX_PIXIE_CHAN){ // Skip this channel
-				std::cout << "BuildRawEvent: Encountered non-physical Pixie ID (mod = " << mod << ", chan = " << chan << ")\n";
+				if(Diagnostics::get()->Count(DIAG_BAD_PIXIE_ID)){
+					std::stringstream stream;
+					stream << "BuildRawEvent: Encountered non-physical Pixie ID (mod = " << mod << ", chan = " << chan << ")";
+					Diagnostics::get()->Sample(DIAG_BAD_PIXIE_ID, -1, -1, stream.str());
+				}
 				delete current_event;
 				iter->pop_front();
 				continue;
@@ -89,8 +105,11 @@ bool Unpacker::BuildRawEvent(){
 			double currtime = current_event->time;
 
 			// Check for backwards time-skip. This is un-handled currently and needs fixed CRT!!!
-			if(currtime < eventStartTime)
-				std::cout << "BuildRawEvent: Detected backwards time-skip from start=" << eventStartTime << " to " << current_event->time << "???\n";
+			if(currtime < eventStartTime && Diagnostics::get()->Count(DIAG_TIME_SKIP, mod, chan)){
+				std::stringstream stream;
+				stream << "BuildRawEvent: Detected backwards time-skip from start=" << eventStartTime << " to " << current_event->time;
+				Diagnostics::get()->Sample(DIAG_TIME_SKIP, mod, chan, stream.str());
+			}
 
 			// If the time difference between the current and previous event is 
 			// larger than the event width, finalize the current event, otherwise
@@ -124,6 +143,145 @@ bool Unpacker::BuildRawEvent(){
 	return true;
 }	
 
+/** Build a raw event when some channels have their own event window. The
+  * raw event starts at the earliest trigger. Every event within the window
+  * of its channel from that time is moved into the raw event, or into the
+  * sub-event for non-trigger channels with their own window.
+  * \return True if a raw event was built and false otherwise.
+  */
+bool Unpacker::BuildWindowedEvent(){
+	if(!rawEvent.empty() || !subEvent.empty())
+		ClearRawEvent();
+
+	// Merge the spill into one time sorted list the first time through. The
+	// events are taken out of the list by setting them to NULL, so nothing is
+	// erased from the middle of a container.
+	if(!IsEmpty()){
+		windowedList.erase(std::remove(windowedList.begin(), windowedList.end(), (XiaData*)NULL), windowedList.end());
+		windowedNext = 0;
+		for(std::vector<std::deque<XiaData*> >::iterator iter = eventList.begin(); iter != eventList.end(); iter++){
+			windowedList.insert(windowedList.end(), iter->begin(), iter->end());
+			iter->clear();
+		}
+		std::stable_sort(windowedList.begin(), windowedList.end(), &XiaData::compareTime);
+	}
+
+	// Find the earliest trigger, the non-triggers before it are orphans.
+	for(; windowedNext < windowedList.size(); windowedNext++){
+		XiaData *current_event = windowedList[windowedNext];
+		if(!current_event){ continue; }
+
+		unsigned int mod = current_event->modNum;
+		unsigned int chan = current_event->chanNum;
+		if(mod > MAX_PIXIE_MOD || chan > MAX_PIXIE_CHAN){ // Skip this channel
+			if(Diagnostics::get()->Count(DIAG_BAD_PIXIE_ID)){
+				std::stringstream stream;
+				stream << "BuildRawEvent: Encountered non-physical Pixie ID (mod = " << mod << ", chan = " << chan << ")";
+				Diagnostics::get()->Sample(DIAG_BAD_PIXIE_ID, -1, -1, stream.str());
+			}
+		}
+		else if(channelTrigger[mod*(MAX_PIXIE_CHAN+1) + chan]){ break; }
+		else{ numOrphans++; }
+
+		delete current_event;
+		windowedList[windowedNext] = NULL;
+	}
+
+	if(windowedNext >= windowedList.size()){ // Only orphans were left.
+		windowedList.clear();
+		windowedNext = 0;
+		return false;
+	}
+
+	if(numRawEvt == 0){
+		firstTime = windowedList[windowedNext]->time;
+		std::cout << "BuildRawEvent: First event time is " << firstTime << " clock ticks.\n";
+	}
+	eventStartTime = windowedList[windowedNext]->time;
+
+	realStartTime = eventStartTime+eventWidth;
+	realStopTime = eventStartTime;
+
+	// Only the events up to the widest window are visited. Those which are
+	// outside of the window of their own channel stay for a later event.
+	const double lastTime = eventStartTime + std::max(eventWidth, maxChannelWidth);
+	for(size_t index = windowedNext; index < windowedList.size(); index++){
+		XiaData *current_event = windowedList[index];
+		if(!current_event){ continue; }
+
+		double currtime = current_event->time;
+		if(currtime > lastTime){ break; }
+
+		unsigned int mod = current_event->modNum;
+		unsigned int chan = current_event->chanNum;
+		if(mod > MAX_PIXIE_MOD || chan > MAX_PIXIE_CHAN){ // Skip this channel
+			if(Diagnostics::get()->Count(DIAG_BAD_PIXIE_ID)){
+				std::stringstream stream;
+				stream << "BuildRawEvent: Encountered non-physical Pixie ID (mod = " << mod << ", chan = " << chan << ")";
+				Diagnostics::get()->Sample(DIAG_BAD_PIXIE_ID, -1, -1, stream.str());
+			}
+			delete current_event;
+			windowedList[index] = NULL;
+			continue;
+		}
+
+		unsigned int id = mod*(MAX_PIXIE_CHAN+1) + chan;
+		double width = channelWidth[id];
+		if(currtime - eventStartTime > (width < 0 ? eventWidth : width)){ continue; } // Belongs to a later raw event.
+
+		if(currtime < realStartTime)
+			realStartTime = currtime;
+		if(currtime > realStopTime)
+			realStopTime = currtime;
+
+		RawStats(current_event);
+
+		if(width < 0 || channelTrigger[id])
+			rawEvent.push_back(current_event);
+		else
+			subEvent.push_back(current_event);
+		windowedList[index] = NULL;
+	}
+
+	numRawEvt++;
+
+	return true;
+}
+
+/** Move every event in the event list into the raw event, in the order
+  * they were read, without time sorting or event building.
+  * \return True if the event list was not empty and false otherwise.
+  */
+bool Unpacker::MoveEventList(){
+	if(!rawEvent.empty())
+		ClearRawEvent();
+
+	realStartTime = std::numeric_limits<double>::max();
+	realStopTime = 0;
+	for(std::vector<std::deque<XiaData*> >::iterator iter = eventList.begin(); iter != eventList.end(); iter++){
+		while(!iter->empty()){
+			XiaData *current_event = iter->front();
+			iter->pop_front();
+
+			if(current_event->time < realStartTime)
+				realStartTime = current_event->time;
+			if(current_event->time > realStopTime)
+				realStopTime = current_event->time;
+
+			RawStats(current_event);
+			rawEvent.push_back(current_event);
+		}
+	}
+
+	if(rawEvent.empty())
+		return false;
+
+	eventStartTime = realStartTime;
+	numRawEvt++;
+
+	return true;
+}
+
 /** Push an event into the event list.
   * \param[in]  event_ The XiaData to push onto the back of the event list.
   * \return True if the XiaData's module number is valid and false otherwise.
@@ -151,6 +309,11 @@ void Unpacker::ClearEventList(){
 	for(std::vector<std::deque<XiaData*> >::iterator iter = eventList.begin(); iter != eventList.end(); iter++){
 		clearDeque((*iter));
 	}
+	for(std::vector<XiaData*>::iterator iter = windowedList.begin() + windowedNext; iter != windowedList.end(); iter++){
+		delete (*iter);
+	}
+	windowedList.clear();
+	windowedNext = 0;
 }
 
 /** Clear all events in the raw event list. WARNING! This method will delete all events in the
@@ -159,6 +322,7 @@ void Unpacker::ClearEventList(){
   */
 void Unpacker::ClearRawEvent(){
 	clearDeque(rawEvent);
+	clearDeque(subEvent);
 }
 
 /** Get the minimum channel time from the event list.
@@ -205,7 +369,7 @@ void Unpacker::ProcessRawEvent(ScanInterface *addr_/*=NULL*/){
   * later processing.
   * \param[in]  buf    Pointer to an array of unsigned ints containing raw buffer data.
   * \param[out] bufLen The number of words in the buffer.
-  * \return The number of XiaDatas read from the buffer.
+  * \return The number of channel events in the buffer, including those skipped by the channel selection.
   */
 int Unpacker::ReadBuffer(unsigned int *buf, unsigned long &bufLen){						
 	// multiplier for high bits of 48-bit time
@@ -228,8 +392,6 @@ int Unpacker::ReadBuffer(unsigned int *buf, unsigned long &bufLen){
 			return 0;
 		}
 		while( buf < bufStart + bufLen ){
-			XiaData *currentEvt = new XiaData();
-
 			// decoding event data... see pixie16app.c
 			// buf points to the start of channel data
 			unsigned int chanNum      = (buf[0] & 0x0000000F);
@@ -238,10 +400,6 @@ int Unpacker::ReadBuffer(unsigned int *buf, unsigned long &bufLen){
 			unsigned int headerLength = (buf[0] & 0x0001F000) >> 12;
 			unsigned int eventLength  = (buf[0] & 0x1FFE0000) >> 17;
 
-			currentEvt->virtualChannel = ((buf[0] & 0x20000000) != 0);
-			currentEvt->saturatedBit   = ((buf[0] & 0x40000000) != 0);
-			currentEvt->pileupBit      = ((buf[0] & 0x80000000) != 0);
-
 			// Rev. D header lengths not clearly defined in pixie16app_defs
 			//! magic numbers here for now
 			if(headerLength == 1){
@@ -252,9 +410,12 @@ int Unpacker::ReadBuffer(unsigned int *buf, unsigned long &bufLen){
 				continue;
 			}
 			if(headerLength != 4 && headerLength != 8 && headerLength != 12 && headerLength != 16){
-				std::cout << "ReadBuffer: Unexpected header length: " << headerLength << std::endl;
-				std::cout << "ReadBuffer:   Buffer " << modNum << " of length " << bufLen << std::endl;
-				std::cout << "ReadBuffer:   CHAN:SLOT:CRATE " << chanNum << ":" << slotNum << ":" << crateNum << std::endl;
+				if(Diagnostics::get()->Count(DIAG_BAD_HEADER, modNum, chanNum)){
+					std::stringstream stream;
+					stream << "ReadBuffer: Unexpected header length " << headerLength << " in buffer " << modNum << " of length " << bufLen;
+					stream << " (CHAN:SLOT:CRATE " << chanNum << ":" << slotNum << ":" << crateNum << ")";
+					Diagnostics::get()->Sample(DIAG_BAD_HEADER, modNum, chanNum, stream.str());
+				}
 				// advance to next event and continue
 				// buf += EventLength;
 				// continue;
@@ -263,6 +424,20 @@ int Unpacker::ReadBuffer(unsigned int *buf, unsigned long &bufLen){
 				return numEvents;
 			}
 
+			// Step over the channels which are not selected using the header alone.
+			if(selectMod >= 0 && eventLength >= headerLength && 
+			  (modNum + 100 * crateNum != (unsigned int)selectMod || chanNum != (unsigned int)selectChan)){
+				buf += eventLength;
+				numEvents++;
+				continue;
+			}
+
+			XiaData *currentEvt = new XiaData();
+
+			currentEvt->virtualChannel = ((buf[0] & 0x20000000) != 0);
+			currentEvt->saturatedBit   = ((buf[0] & 0x40000000) != 0);
+			currentEvt->pileupBit      = ((buf[0] & 0x80000000) != 0);
+
 			unsigned int lowTime     = buf[1];
 			unsigned int highTime    = buf[2] & 0x0000FFFF;
 			unsigned int cfdTime     = (buf[2] & 0xFFFF0000) >> 16;
@@ -270,8 +445,13 @@ int Unpacker::ReadBuffer(unsigned int *buf, unsigned long &bufLen){
 			unsigned int traceLength = (buf[3] & 0xFFFF0000) >> 16;
 
 			if(headerLength == 8 || headerLength == 16){
-				// Skip the onboard partial sums for now 
-				// trailing, leading, gap, baseline
+				// The onboard partial sums of the energy filter: trailing,
+				// leading, gap and the baseline as an IEEE 754 float.
+				for(int i = 0; i < currentEvt->numEnergySums; i++){
+					currentEvt->energySums[i] = buf[4 + i];
+				}
+				memcpy(&currentEvt->energyBaseline, &buf[7], sizeof(float));
+				currentEvt->hasEnergySums = true;
 			}
 
 			if(headerLength >= 12){
@@ -283,8 +463,13 @@ int Unpacker::ReadBuffer(unsigned int *buf, unsigned long &bufLen){
 
 			// One last check
 			if( traceLength / 2 + headerLength != eventLength ){
-				std::cout << "ReadBuffer: Bad event length (" << eventLength << ") does not correspond with length of header (";
-				std::cout << headerLength << ") and length of trace (" << traceLength << ")" << std::endl;
+				if(Diagnostics::get()->Count(DIAG_BAD_LENGTH, modNum, chanNum)){
+					std::stringstream stream;
+					stream << "ReadBuffer: Bad event length (" << eventLength << ") does not correspond with length of header (";
+					stream << headerLength << ") and length of trace (" << traceLength << ")";
+					Diagnostics::get()->Sample(DIAG_BAD_LENGTH, modNum, chanNum, stream.str());
+				}
+				delete currentEvt;
 				buf += eventLength;
 				continue;
 			}
@@ -345,7 +530,7 @@ int Unpacker::ReadBuffer(unsigned int *buf, unsigned long &bufLen){
 		}
 	} 
 	else{ // if buffer has data
-		std::cout << "ReadBuffer: ERROR IN ReadBuffData, LIST UNKNOWN" << std::endl;
+		Diagnostics::get()->Report(DIAG_BAD_BUFFER, modNum, -1, "ReadBuffer: ERROR IN ReadBuffData, LIST UNKNOWN");
 		return -100;
 	}
 	
@@ -356,6 +541,9 @@ Unpacker::Unpacker() :
 	eventWidth(62), // ~ 500 ns in 8 ns pixie clock ticks.
    debug_mode(false),
 	running(true),
+	selectMod(-1),
+	selectChan(-1),
+	buildEvents(true),
 	interface(NULL),
 	TOTALREAD(1000000), // Maximum number of data words to read.
 	maxWords(131072), // Maximum number of data words for revision D.	
@@ -363,7 +551,11 @@ Unpacker::Unpacker() :
 	firstTime(0),
 	eventStartTime(0),
 	realStartTime(0),
-	realStopTime(0)
+	realStopTime(0),
+	maxChannelWidth(0),
+	numOrphans(0),
+	windowedNext(0),
+	cacheOutput(NULL)
 {
 	for(unsigned int i = 0; i <= MAX_PIXIE_MOD; i++){
 		for(unsigned int j = 0; j <= MAX_PIXIE_CHAN; j++){
@@ -372,8 +564,126 @@ Unpacker::Unpacker() :
 	}
 }
 
+/** Only decode the events of a single channel. The events of all other
+  * channels are stepped over using the event length in their header, so no
+  * XiaData is ever made for them.
+  * \param[in]  mod_         The module number, including 100 times the crate number.
+  * \param[in]  chan_        The channel number.
+  * \param[in]  buildEvents_ If false the events of a spill are handed to ProcessRawEvent in one raw event, without time sorting or event building.
+  * \return Nothing.
+  */
+void Unpacker::SetChannelSelection(int mod_, int chan_, bool buildEvents_/*=true*/){
+	selectMod = (mod_ < 0 || chan_ < 0 ? -1 : mod_);
+	selectChan = chan_;
+	buildEvents = (selectMod < 0 || buildEvents_);
+}
+
+/** Give a channel its own event window. Events of such a channel are
+  * collected in the sub-event of the raw event whose start time is at most
+  * width_ ticks before them, instead of in the raw event itself. Unless the
+  * channel is a trigger it never starts a raw event, its events which do
+  * not follow a trigger within width_ ticks are dropped as orphans. Channels
+  * without their own window use the event width and are triggers.
+  * \param[in]  mod_     The module number, including 100 times the crate number.
+  * \param[in]  chan_    The channel number.
+  * \param[in]  width_   The width of the window in pixie16 clock ticks.
+  * \param[in]  trigger_ True if events of the channel may start a raw event.
+  * \return True if the module and channel are valid and false otherwise.
+  */
+bool Unpacker::SetChannelWindow(unsigned int mod_, unsigned int chan_, double width_, bool trigger_/*=false*/){
+	if(mod_ > MAX_PIXIE_MOD || chan_ > MAX_PIXIE_CHAN || width_ < 0){ return false; }
+	
+	if(channelWidth.empty()){
+		channelWidth.assign((MAX_PIXIE_MOD+1)*(MAX_PIXIE_CHAN+1), -1);
+		channelTrigger.assign((MAX_PIXIE_MOD+1)*(MAX_PIXIE_CHAN+1), true);
+	}
+	
+	unsigned int index = mod_*(MAX_PIXIE_CHAN+1) + chan_;
+	channelWidth[index] = width_;
+	channelTrigger[index] = trigger_;
+	
+	maxChannelWidth = 0;
+	for(std::vector<double>::iterator iter = channelWidth.begin(); iter != channelWidth.end(); iter++){
+		if(*iter > maxChannelWidth){ maxChannelWidth = *iter; }
+	}
+	
+	return true;
+}
+
+/// Use the event width for all channels again.
+void Unpacker::ClearChannelWindows(){
+	channelWidth.clear();
+	channelTrigger.clear();
+	maxChannelWidth = 0;
+}
+
+/** Write every raw event built from now on to an event cache.
+  * \param[in]  fname_ The name of the cache file.
+  * \return True if the cache file was created and false otherwise.
+  */
+bool Unpacker::SetCacheOutput(const std::string &fname_){
+	CloseCacheOutput();
+	cacheOutput = new EventCache();
+	if(!cacheOutput->Create(fname_, eventWidth)){
+		std::cout << "SetCacheOutput: Failed to create event cache '" << fname_ << "'!\n";
+		CloseCacheOutput();
+		return false;
+	}
+	return true;
+}
+
+/// Write the index of the event cache and stop writing to it.
+void Unpacker::CloseCacheOutput(){
+	if(!cacheOutput){ return; }
+	if(cacheOutput->GetNumEvents() > 0){
+		std::cout << "CloseCacheOutput: Wrote " << cacheOutput->GetNumEvents() << " raw events to the event cache.\n";
+	}
+	delete cacheOutput;
+	cacheOutput = NULL;
+}
+
+/** Process events read from an event cache instead of a spill. The events
+  * are handed to ProcessRawEvent exactly as BuildRawEvent built them.
+  * \param[in]  cache_     Pointer to an event cache opened for reading.
+  * \param[in]  numEvents_ The maximum number of events to process.
+  * \return True if the cache has more events and false otherwise.
+  */
+bool Unpacker::ReadCache(EventCache *cache_, const unsigned long &numEvents_){
+	if(!cache_ || !cache_->IsReading()){ return false; }
+
+	if(numRawEvt == 0){
+		firstTime = cache_->GetFirstTime();
+		std::cout << "ReadCache: First event time is " << firstTime << " clock ticks.\n";
+		if(cache_->GetEventWidth() != eventWidth){
+			std::cout << "ReadCache: The events were built with a width of " << cache_->GetEventWidth() << " instead of " << eventWidth << " clock ticks.\n";
+		}
+	}
+
+	for(unsigned long i = 0; i < numEvents_; i++){
+		ClearRawEvent();
+		if(!cache_->Read(eventStartTime, realStartTime, realStopTime, rawEvent, subEvent)){ break; }
+
+		for(std::deque<XiaData*>::iterator iter = rawEvent.begin(); iter != rawEvent.end(); iter++){
+			RawStats(*iter);
+		}
+		for(std::deque<XiaData*>::iterator iter = subEvent.begin(); iter != subEvent.end(); iter++){
+			RawStats(*iter);
+		}
+		numRawEvt++;
+
+		ProcessRawEvent(interface);
+	}
+	ClearRawEvent();
+
+	// Summarize the errors counted since the last summary.
+	Diagnostics::get()->Poll(std::cout);
+
+	return (cache_->GetPosition() < cache_->GetNumEvents());
+}
+
 /// Destructor.
 Unpacker::~Unpacker(){
+	CloseCacheOutput();
 	ClearRawEvent();
 	ClearEventList();
 }
@@ -519,14 +829,23 @@ bool Unpacker::ReadSpill(unsigned int *data, unsigned int nWords, bool is_verbos
 			// Sort the vector of pointers eventlist according to time
 			//double lastTimestamp = (*(eventList.rbegin()))->time;
 
-			// Sort the event list in time
-			TimeSort();
+			if(buildEvents){
+				// Sort the event list in time
+				TimeSort();
+
+				// Once the vector of pointers eventlist is sorted based on time,
+				// begin the event processing in ScanList().
+				// ScanList will also clear the event list for us.
+				while(BuildRawEvent()){
+					// Keep the event for later scans, before processing takes its traces.
+					if(cacheOutput){ cacheOutput->Write(eventStartTime, realStartTime, realStopTime, rawEvent, subEvent); }
 
-			// Once the vector of pointers eventlist is sorted based on time,
-			// begin the event processing in ScanList().
-			// ScanList will also clear the event list for us.
-			while(BuildRawEvent()){
-				// Process the event.
+					// Process the event.
+					ProcessRawEvent(interface);
+				}
+			}
+			else if(MoveEventList()){
+				// Hand the whole spill over at once.
 				ProcessRawEvent(interface);
 			}
 			
@@ -542,6 +861,9 @@ bool Unpacker::ReadSpill(unsigned int *data, unsigned int nWords, bool is_verbos
 			if((evCount % 1000 == 0 || evCount == 1) && theTime != 0){
 				std::cout << std::endl << "ReadSpill: Data read up to poll status time " << ctime(&theTime);
 			}
+
+			// Summarize the errors counted since the last summary.
+			Diagnostics::get()->Poll(std::cout);
 		}
 		else {
 			if(is_verbose){ std::cout << "ReadSpill: Spill split between buffers" << std::endl; }
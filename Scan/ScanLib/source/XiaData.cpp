@@ -21,6 +21,12 @@ XiaData::XiaData(XiaData *other_){
 	for(int i = 0; i < numQdcs; i++){
 		qdcValue[i] = other_->qdcValue[i];
 	}
+	
+	for(int i = 0; i < numEnergySums; i++){
+		energySums[i] = other_->energySums[i];
+	}
+	energyBaseline = other_->energyBaseline;
+	hasEnergySums = other_->hasEnergySums;
 
 	modNum = other_->modNum;
 	chanNum = other_->chanNum;
@@ -62,6 +68,12 @@ void XiaData::clear(){
 	for(int i = 0; i < numQdcs; i++){
 		qdcValue[i] = 0;
 	}
+	
+	for(int i = 0; i < numEnergySums; i++){
+		energySums[i] = 0;
+	}
+	energyBaseline = 0.0;
+	hasEnergySums = false;
 
 	modNum = 0;
 	chanNum = 0;
@@ -110,6 +122,7 @@ ChannelEvent::~ChannelEvent(){
 	if(event){ delete event; }
 	if(xvals){ delete[] xvals; }
 	if(yvals){ delete[] yvals; }
+	if(cfdvals){ delete[] cfdvals; }
 }
 
 float ChannelEvent::CorrectBaseline(){
@@ -220,7 +233,7 @@ float ChannelEvent::AnalyzeCFD(const float &F_/*=0.5*/, const size_t &D_/*=1*/,
 	// Find the zero-crossing.
 	if(cfdMinIndex > 0){
 		// Find the zero-crossing.
-		for(size_t cfdIndex = cfdMinIndex-1; cfdIndex >= 0; cfdIndex--){
+		for(size_t cfdIndex = cfdMinIndex; cfdIndex-- > 0;){
 			if(cfdvals[cfdIndex] >= 0.0 && cfdvals[cfdIndex+1] < 0.0){
 				cfdCrossing = xvals[cfdIndex] - cfdvals[cfdIndex]*(xvals[cfdIndex+1]-xvals[cfdIndex])/(cfdvals[cfdIndex+1]-cfdvals[cfdIndex]);
 				break;
@@ -0,0 +1,82 @@
+/** \file ChannelEventBatchTest.cpp
+  * \brief Check that the batch waveform analysis gives the results of the ChannelEvent methods.
+  * \date Oct. 19th, 2026
+  */
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <math.h>
+
+#include "ChannelEventBatch.hpp"
+#include "XiaData.hpp"
+#include "TestCheck.h"
+
+#define NUM_EVENTS 37 // Leaves a partly filled tile.
+#define TRACE_LENGTH 120 // samples
+
+/// Build an event with a pulse whose height, position and baseline depend on the event number.
+ChannelEvent *make_event(const int &event_){
+	XiaData *data = new XiaData();
+	for(int i = 0; i < TRACE_LENGTH; i++){
+		double t = i - 30 - event_ % 11;
+		double pulse = (t > 0 ? (200.0 + 13*event_)*(exp(-t/12.0) - exp(-t/3.0)) : 0.0);
+		data->adcTrace.push_back(400 + event_ % 5 + (i*7 + event_) % 3 + (int)pulse);
+	}
+	return new ChannelEvent(data);
+}
+
+/// Return true if two floats are the same, or both are missing.
+bool same(const float &lhs_, const float &rhs_){
+	return lhs_ == rhs_ || (isnan(lhs_) && isnan(rhs_));
+}
+
+void compare(const std::string &name_, const float &F_, const size_t &D_, const size_t &L_){
+	std::vector<ChannelEvent*> single, batched;
+	ChannelEventBatch batch;
+	for(int i = 0; i < NUM_EVENTS; i++){
+		single.push_back(make_event(i));
+		batched.push_back(make_event(i));
+
+		single.back()->CorrectBaseline();
+		single.back()->FindLeadingEdge();
+		single.back()->IntegratePulse();
+		single.back()->AnalyzeCFD(F_, D_, L_);
+
+		// Some events were already analyzed before they reach the batch.
+		if(i % 4 == 1){ batched.back()->CorrectBaseline(); }
+		check(batch.Add(batched.back()), name_ + ": add event");
+	}
+
+	batch.CorrectBaseline();
+	batch.FindLeadingEdge();
+	batch.IntegratePulse();
+	batch.AnalyzeCFD(F_, D_, L_);
+
+	for(int i = 0; i < NUM_EVENTS; i++){
+		const ChannelEvent *lhs = single[i], *rhs = batched[i];
+		check(same(lhs->baseline, rhs->baseline) && same(lhs->stddev, rhs->stddev), name_ + ": baseline");
+		check(same(lhs->maximum, rhs->maximum) && lhs->max_index == rhs->max_index, name_ + ": maximum");
+		check(same(lhs->phase, rhs->phase), name_ + ": leading edge");
+		check(same(lhs->qdc, rhs->qdc), name_ + ": qdc");
+		check(same(lhs->cfdCrossing, rhs->cfdCrossing), name_ + ": cfd crossing");
+		check(rhs->cfdvals != NULL, name_ + ": cfd waveform filled");
+		bool equal = (rhs->cfdvals != NULL);
+		for(size_t j = 0; equal && j < TRACE_LENGTH; j++){
+			equal = same(lhs->yvals[j], rhs->yvals[j]) && same(lhs->cfdvals[j], rhs->cfdvals[j]);
+		}
+		check(equal, name_ + ": corrected trace and cfd waveform");
+	}
+
+	for(int i = 0; i < NUM_EVENTS; i++){
+		delete single[i];
+		delete batched[i];
+	}
+}
+
+int main(int argc, char *argv[]){
+	compare("D=1 L=1", 0.5, 1, 1);
+	compare("D=3 L=8", 0.4, 3, 8);
+
+	return check_result(argv[0]);
+}
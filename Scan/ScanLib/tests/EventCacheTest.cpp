@@ -0,0 +1,140 @@
+/** \file EventCacheTest.cpp
+  * \brief Write raw events to an event cache and check that they read back unchanged.
+  * \date Oct. 19th, 2026
+  */
+#include <deque>
+#include <iostream>
+#include <string>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "EventCache.hpp"
+#include "XiaData.hpp"
+#include "TestCheck.h"
+
+#define NUM_EVENTS 500
+
+/// Build a hit whose contents depend on the event and hit numbers.
+XiaData *make_hit(const int &event_, const int &hit_){
+	XiaData *hit = new XiaData();
+	hit->modNum = hit_ % 4;
+	hit->chanNum = (event_ + hit_) % 16;
+	hit->slotNum = hit->modNum + 2;
+	hit->time = 1000.0*event_ + hit_;
+	hit->eventTime = hit->time;
+	hit->eventTimeLo = (unsigned int)hit->time;
+	hit->energy = event_ + 0.5*hit_;
+	hit->cfdTime = event_ % 256;
+	hit->pileupBit = (hit_ == 1);
+	hit->virtualChannel = (event_ % 7 == 0);
+	if(event_ % 3 == 0){ // Onboard qdcs and energy sums.
+		for(int i = 0; i < XiaData::numQdcs; i++){ hit->qdcValue[i] = event_ + i; }
+		for(int i = 0; i < XiaData::numEnergySums; i++){ hit->energySums[i] = 10*hit_ + i; }
+		hit->energyBaseline = 0.25f*event_;
+		hit->hasEnergySums = true;
+	}
+	if(event_ % 2 == 0){ // A trace, with samples too wide for 16 bits in some events.
+		for(int i = 0; i < 50 + event_ % 13; i++){ hit->adcTrace.push_back(event_ % 5 == 0 ? 70000 + i : 400 + i); }
+	}
+	return hit;
+}
+
+/// Return true if two hits hold the same values.
+bool same_hit(const XiaData *lhs_, const XiaData *rhs_){
+	if(lhs_->modNum != rhs_->modNum || lhs_->chanNum != rhs_->chanNum || lhs_->slotNum != rhs_->slotNum ||
+	   lhs_->time != rhs_->time || lhs_->eventTime != rhs_->eventTime || lhs_->eventTimeLo != rhs_->eventTimeLo ||
+	   lhs_->energy != rhs_->energy || lhs_->cfdTime != rhs_->cfdTime || lhs_->pileupBit != rhs_->pileupBit ||
+	   lhs_->virtualChannel != rhs_->virtualChannel || lhs_->hasEnergySums != rhs_->hasEnergySums ||
+	   lhs_->adcTrace != rhs_->adcTrace){ return false; }
+	for(int i = 0; i < XiaData::numQdcs; i++){
+		if(lhs_->qdcValue[i] != rhs_->qdcValue[i]){ return false; }
+	}
+	if(lhs_->hasEnergySums){
+		for(int i = 0; i < XiaData::numEnergySums; i++){
+			if(lhs_->energySums[i] != rhs_->energySums[i]){ return false; }
+		}
+		if(lhs_->energyBaseline != rhs_->energyBaseline){ return false; }
+	}
+	return true;
+}
+
+void clear(std::deque<XiaData*> &list_){
+	for(std::deque<XiaData*>::iterator iter = list_.begin(); iter != list_.end(); iter++){ delete *iter; }
+	list_.clear();
+}
+
+int main(int argc, char *argv[]){
+	std::string fname = "EventCacheTest." + std::to_string(getpid()) + ".evc";
+
+	EventCache writer;
+	check(writer.Create(fname, 100), "Create");
+	for(int i = 0; i < NUM_EVENTS; i++){
+		std::deque<XiaData*> rawEvent, subEvent;
+		for(int j = 0; j < 1 + i % 5; j++){ rawEvent.push_back(make_hit(i, j)); }
+		if(i % 4 == 0){ subEvent.push_back(make_hit(i, 9)); }
+		check(writer.Write(1000.0*i, 1000.0*i, 1000.0*i + 4, rawEvent, subEvent), "Write");
+		clear(rawEvent);
+		clear(subEvent);
+	}
+	writer.Close();
+
+	EventCache reader;
+	check(reader.Open(fname), "Open");
+	check(reader.GetNumEvents() == NUM_EVENTS, "number of events");
+	check(reader.GetEventWidth() == 100, "event width");
+
+	int numRead = 0;
+	bool same = true;
+	double startTime, realStartTime, realStopTime;
+	std::deque<XiaData*> rawEvent, subEvent;
+	while(reader.Read(startTime, realStartTime, realStopTime, rawEvent, subEvent)){
+		int i = numRead++;
+		if(startTime != 1000.0*i || realStopTime != 1000.0*i + 4){ same = false; }
+		if(rawEvent.size() != (size_t)(1 + i % 5) || subEvent.size() != (i % 4 == 0 ? 1u : 0u)){ same = false; }
+		for(size_t j = 0; same && j < rawEvent.size(); j++){
+			XiaData *expected = make_hit(i, j);
+			if(!same_hit(expected, rawEvent[j])){ same = false; }
+			delete expected;
+		}
+		if(same && !subEvent.empty()){
+			XiaData *expected = make_hit(i, 9);
+			if(!same_hit(expected, subEvent.front())){ same = false; }
+			delete expected;
+		}
+		clear(rawEvent);
+		clear(subEvent);
+	}
+	check(same, "contents of all events");
+	check(numRead == NUM_EVENTS, "number of events read");
+
+	// Random access through the index.
+	check(reader.Seek(NUM_EVENTS/2), "Seek");
+	check(reader.Read(startTime, realStartTime, realStopTime, rawEvent, subEvent) && startTime == 1000.0*(NUM_EVENTS/2), "Read after Seek");
+	clear(rawEvent);
+	clear(subEvent);
+	check(!reader.Seek(NUM_EVENTS+1), "Seek past the end");
+
+	reader.Close();
+
+	// An index entry pointing past the events is refused rather than read.
+	FILE *file = fopen(fname.c_str(), "r+b");
+	check(file != NULL, "open the cache for writing");
+	if(file){
+		uint64_t bad = ~0ULL;
+		fseek(file, -(long)((NUM_EVENTS-1)*sizeof(uint64_t)), SEEK_END);
+		fwrite(&bad, sizeof(bad), 1, file);
+		fclose(file);
+	}
+	check(reader.Open(fname), "Open with a damaged index");
+	check(!reader.Read(startTime, realStartTime, realStopTime, rawEvent, subEvent) && rawEvent.empty(), "Read before a damaged index entry");
+	check(!reader.Read(startTime, realStartTime, realStopTime, rawEvent, subEvent) && rawEvent.empty(), "Read at a damaged index entry");
+	check(reader.Read(startTime, realStartTime, realStopTime, rawEvent, subEvent) && startTime == 2000.0, "Read after a damaged index entry");
+	clear(rawEvent);
+	clear(subEvent);
+	reader.Close();
+	remove(fname.c_str());
+
+	return check_result(argv[0]);
+}
@@ -74,9 +74,15 @@ class Filterer : public Unpacker{
 	
 	int GetDelay(){ return delay_; }
  	
-	void SetMod(int mod){ mod_ = mod; }
-	
-	void SetChan(int chan){ chan_ = chan; }
+	void SetMod(int mod){ 
+		mod_ = mod;
+		SetChannelSelection(mod_, chan_, false);
+	}
+	
+	void SetChan(int chan){ 
+		chan_ = chan;
+		SetChannelSelection(mod_, chan_, false);
+	}
 
 	/// Set the number of seconds to wait between drawing of traces.
 	void SetDelay(int delay){ delay_ = (delay>1)?delay:1; }
@@ -9,6 +9,7 @@
 
 // PixieCore libraries
 #include "Unpacker.hpp"
+#include "ChannelEventBatch.hpp"
 #include "ScanInterface.hpp"
 
 class ChannelEvent;
@@ -32,9 +33,17 @@ class scopeUnpacker : public Unpacker {
 	/// Destructor.
 	~scopeUnpacker(){  }
 
-	int SetMod(const unsigned int &mod){ return(mod >= 0 ? (mod_ = mod) : (mod_ = 0)); }
+	int SetMod(const unsigned int &mod){ 
+		mod_ = mod;
+		SetChannelSelection(mod_, chan_, false);
+		return mod_;
+	}
 	
-	int SetChan(const unsigned int &chan){ return(chan >= 0 ? (chan_ = chan) : (chan_ = 0)); }
+	int SetChan(const unsigned int &chan){ 
+		chan_ = chan;
+		SetChannelSelection(mod_, chan_, false);
+		return chan_;
+	}
 	
 	void SetThreshLow(const int &threshLow){ threshLow_ = threshLow; }
 	
@@ -218,6 +227,7 @@ class scopeScanner : public ScanInterface {
   
 	std::vector<int> x_vals;
 	std::deque<ChannelEvent*> chanEvents_; ///<The buffer of waveforms to be plotted.
+	ChannelEventBatch batch_; ///<Analyzes the waveforms of the buffer which are plotted.
 
 	time_t last_trace; ///< The time of the last trace.
 	
@@ -0,0 +1,207 @@
+/** \file trapScan.hpp
+ * \brief Offline scan of the pixie16 energy filter parameters using recorded traces.
+ *
+ * The online paramScan program reprograms the modules and takes an MCA run for
+ * every point in the parameter grid. This program instead reads traced list
+ * mode data (.ldf or .pld), re-runs the trapezoidal filter from TraceFilter on
+ * the stored traces for every point in an ENERGY_RISETIME x ENERGY_FLATTOP (x TAU)
+ * grid, fits the resulting peak, and writes the best settings for each channel
+ * as a poll2 command script.
+ *
+ * \date Oct. 19th, 2026
+ */
+#ifndef TRAPSCAN_HPP
+#define TRAPSCAN_HPP
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Unpacker.hpp"
+#include "ScanInterface.hpp"
+
+#include "TrapFilterParameters.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// class trapScanUnpacker
+///////////////////////////////////////////////////////////////////////////////
+
+class trapScanUnpacker : public Unpacker {
+  public:
+	/// Default constructor.
+	trapScanUnpacker() : Unpacker() {  }
+
+	/// Destructor.
+	~trapScanUnpacker(){  }
+
+  private:
+	/** Process all events in the event list.
+	  * \param[in]  addr_ Pointer to a ScanInterface object.
+	  * \return Nothing.
+	  */
+	virtual void ProcessRawEvent(ScanInterface *addr_=NULL);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class scanRange
+///////////////////////////////////////////////////////////////////////////////
+
+/// A single scanned filter parameter given as start:stop:step in ns.
+class scanRange {
+  public:
+	double start; /// First value of the parameter (ns).
+	double stop; /// Last value of the parameter (ns).
+	double step; /// Step size of the parameter (ns).
+
+	scanRange() : start(0), stop(0), step(1) { }
+
+	scanRange(const double &value_) : start(value_), stop(value_), step(1) { }
+
+	/// Parse a string of the form "start[:stop:step]". Return false on failure.
+	bool Set(const std::string &str_);
+
+	/// Return the number of points in the range.
+	size_t GetSize() const { return (stop > start ? (size_t)((stop - start) / step + 1E-6) + 1 : 1); }
+
+	/// Return the value of the i'th point in the range.
+	double At(const size_t &index_) const { return start + index_ * step; }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class scanPoint
+///////////////////////////////////////////////////////////////////////////////
+
+/// The result of the peak fit for one channel at one point in the parameter grid.
+class scanPoint {
+  public:
+	unsigned int id; /// The channel id (mod * 16 + chan).
+	double rise; /// Energy filter risetime (ns).
+	double flat; /// Energy filter flattop (ns).
+	double tau; /// Preamplifier decay constant (ns).
+
+	double centroid; /// Fitted peak centroid (filter units).
+	double sigma; /// Fitted peak width (filter units).
+	double resolution; /// FWHM resolution (percent). Negative if the fit failed.
+
+	unsigned int numGood; /// Number of traces which returned a valid filter energy.
+
+	scanPoint() : id(0), rise(0), flat(0), tau(0), centroid(0), sigma(0), resolution(-1), numGood(0) { }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class trapScanner
+///////////////////////////////////////////////////////////////////////////////
+
+class trapScanner : public ScanInterface {
+  public:
+	/// Default constructor.
+	trapScanner();
+
+	/// Destructor.
+	~trapScanner();
+
+	/** ExtraCommands is used to send command strings to classes derived
+	  * from ScanInterface. If ScanInterface receives an unrecognized
+	  * command from the user, it will pass it on to the derived class.
+	  * \param[in]  cmd_ The command to interpret.
+	  * \param[out] arg_ Vector or arguments to the user command.
+	  * \return True if the command was recognized and false otherwise.
+	  */
+	virtual bool ExtraCommands(const std::string &cmd_, std::vector<std::string> &args_);
+
+	/** ExtraArguments is used to send command line arguments to classes derived
+	  * from ScanInterface. This method should loop over the optionExt elements
+	  * in the vector userOpts and check for those options which have been flagged
+	  * as active by ::Setup(). This should be overloaded in the derived class.
+	  * \return Nothing.
+	  */
+	virtual void ExtraArguments();
+
+	/** CmdHelp is used to allow a derived class to print a help statement about
+	  * its own commands. This method is called whenever the user enters 'help'
+	  * or 'h' into the interactive terminal (if available).
+	  * \param[in]  prefix_ String to append at the start of any output. Not used by default.
+	  * \return Nothing.
+	  */
+	virtual void CmdHelp(const std::string &prefix_="");
+
+	/** ArgHelp is used to allow a derived class to add a command line option
+	  * to the main list of options. This method is called at the end of
+	  * from the ::Setup method.
+	  * \return Nothing.
+	  */
+	virtual void ArgHelp();
+
+	/** SyntaxStr is used to print a linux style usage message to the screen.
+	  * \param[in]  name_ The name of the program.
+	  * \return Nothing.
+	  */
+	virtual void SyntaxStr(char *name_);
+
+	/** Initialize the scanner.
+	  * \param[in]  prefix_ String to append to the beginning of system output.
+	  * \return True upon successfully initializing and false otherwise.
+	  */
+	virtual bool Initialize(std::string prefix_="");
+
+	/** Receive various status notifications from the scan. The parameter scan
+	  * is started when the input file has been completely read.
+	  * \param[in] code_ The notification code passed from ScanInterface methods.
+	  * \return Nothing.
+	  */
+	virtual void Notify(const std::string &code_="");
+
+	/** Return a pointer to the Unpacker object to use for data unpacking.
+	  * If no object has been initialized, create a new one.
+	  * \return Pointer to an Unpacker object.
+	  */
+	virtual Unpacker *GetCore();
+
+	/** Store the trace of a channel event for the parameter scan.
+	  * This method should only be called from trapScanUnpacker::ProcessRawEvent().
+	  * \param[in]  event_ The raw XiaData to add.
+	  * \return False.
+	  */
+	virtual bool AddEvent(XiaData *event_);
+
+	/** Run the filter over all stored traces for every point in the parameter grid.
+	  * \return True if at least one channel was scanned and false otherwise.
+	  */
+	bool ScanParameters();
+
+  private:
+	bool init; /// Set to true when the initialization process successfully completes.
+	bool scanned; /// Set to true once the stored traces have been scanned.
+
+	unsigned int nsPerSample; /// ADC sampling period (ns).
+	unsigned int maxTraces; /// Maximum number of traces to store per channel.
+	unsigned int numThreads; /// Number of worker threads to use for the scan.
+	unsigned int numBins; /// Number of bins in the energy spectrum of each grid point.
+
+	int selectMod; /// Only store traces from this module (-1 for all modules).
+	int selectChan; /// Only store traces from this channel (-1 for all channels).
+
+	scanRange riseRange; /// ENERGY_RISETIME grid (ns).
+	scanRange flatRange; /// ENERGY_FLATTOP grid (ns).
+	scanRange tauRange; /// TAU grid (ns).
+
+	TrapFilterParameters trigPars; /// Trigger filter used to locate the pulse (ns, ns, ADC units).
+
+	std::map<unsigned int, std::vector<std::vector<int> > > traces; /// Stored traces by channel id.
+	std::mutex tracesLock; /// Guards traces and results against the file reader thread while scanning.
+	std::vector<scanPoint> results; /// Fit results for every channel and grid point.
+
+	/** Evaluate a single grid point for a single channel.
+	  * \param[in,out] point_ The grid point to evaluate. The fit results are written into it.
+	  * \return Nothing.
+	  */
+	void EvaluatePoint(scanPoint &point_);
+
+	/** Write the full result table and the poll2 command script.
+	  * \return True if the output files were written and false otherwise.
+	  */
+	bool WriteResults();
+};
+
+#endif
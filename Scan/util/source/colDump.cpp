@@ -0,0 +1,98 @@
+/** \file colDump.cpp
+  * \brief Print the schema and contents of a columnar event file.
+  * \date Oct. 19th, 2026
+  */
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ColumnFile.h"
+
+void help(char *name_){
+	std::cout << "  SYNTAX: " << name_ << " [options] <file>\n";
+	std::cout << "   Available options:\n";
+	std::cout << "    --columns <a,b,...> | Only print the listed columns.\n";
+	std::cout << "    --rows <N>          | Print the values of the first N events as tab-delimited text (-1 for all).\n";
+	std::cout << "    --text              | Print only the values of all events as space-delimited text, as the old text dumps of the processors.\n";
+}
+
+int main(int argc, char *argv[]){
+	if(argc < 2){
+		std::cout << " Error: Invalid number of arguments to " << argv[0] << ". Expected 1, received " << argc-1 << ".\n";
+		help(argv[0]);
+		return 1;
+	}
+
+	std::string filename;
+	std::vector<std::string> selected;
+	long long maxRows = 0;
+	bool textOnly = false;
+	for(int i = 1; i < argc; i++){
+		if(strcmp(argv[i], "--columns") == 0 && i+1 < argc){
+			std::string list = argv[++i];
+			size_t start = 0, stop;
+			while((stop = list.find(',', start)) != std::string::npos){
+				selected.push_back(list.substr(start, stop-start));
+				start = stop+1;
+			}
+			selected.push_back(list.substr(start));
+		}
+		else if(strcmp(argv[i], "--rows") == 0 && i+1 < argc){ maxRows = strtoll(argv[++i], NULL, 0); }
+		else if(strcmp(argv[i], "--text") == 0){
+			textOnly = true;
+			maxRows = -1;
+		}
+		else if(strcmp(argv[i], "--help") == 0){
+			help(argv[0]);
+			return 0;
+		}
+		else{ filename = argv[i]; }
+	}
+
+	ColumnReader reader;
+	if(filename.empty() || !reader.Open(filename)){
+		std::cout << " Error: Failed to open input file \"" << filename << "\".\n";
+		return 1;
+	}
+
+	if(!selected.empty() && !reader.SetActiveColumns(selected)){ return 1; }
+
+	std::vector<size_t> printed;
+	if(selected.empty()){
+		for(size_t i = 0; i < reader.GetNumColumns(); i++){ printed.push_back(i); }
+	}
+	else{
+		for(std::vector<std::string>::iterator iter = selected.begin(); iter != selected.end(); iter++){ printed.push_back(reader.FindColumn(*iter)); }
+	}
+
+	if(!textOnly){
+		std::cout << "# " << filename << ": " << reader.GetNumColumns() << " columns, " << reader.GetEntries() << " events\n";
+		for(std::vector<size_t>::iterator iter = printed.begin(); iter != printed.end(); iter++){
+			const ColumnInfo &info = reader.GetColumn(*iter);
+			std::cout << "#  " << info.name << "\t" << GetColumnTypeName(info.type);
+			if(info.count > 1){ std::cout << "[" << info.count << "]"; }
+			std::cout << std::endl;
+		}
+	}
+	const char *delimiter = (textOnly ? " " : "\t");
+
+	if(maxRows == 0){ return 0; }
+
+	long long numRows = 0;
+	while((maxRows < 0 || numRows < maxRows) && reader.ReadChunk()){
+		for(unsigned int row = 0; row < reader.GetChunkRows() && (maxRows < 0 || numRows < maxRows); row++, numRows++){
+			for(size_t i = 0; i < printed.size(); i++){
+				const ColumnInfo &info = reader.GetColumn(printed[i]);
+				for(unsigned int element = 0; element < info.count; element++){
+					std::cout << (i+element > 0 ? delimiter : "") << reader.GetValue(printed[i], row, element);
+				}
+			}
+			std::cout << "\n";
+		}
+	}
+
+	return 0;
+}
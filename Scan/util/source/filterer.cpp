@@ -56,6 +56,9 @@ Filterer::Filterer(int mod /*= 0*/, int chan/*=0*/) :
 {
 	time(&last_trace);
 
+	// Only the selected channel is decoded and its waveforms do not need event building.
+	SetChannelSelection(mod_, chan_, false);
+
 	trig_rise = 4;
 	trig_flat = 0;
 	
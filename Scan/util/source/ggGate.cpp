@@ -0,0 +1,132 @@
+/** \file ggGate.cpp
+  * \brief Project and gate the compact gamma-gamma matrices (.ggm) and cubes written by utkscan.
+  * \date Oct. 19th, 2026
+  */
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "Exceptions.hpp"
+#include "GammaCoincidences.hpp"
+
+void help(char *name_){
+	std::cout << "  SYNTAX: " << name_ << " [options] <input>\n";
+	std::cout << "   <input> is a .ggm matrix or a gamma cube. The spectrum is written as two\n";
+	std::cout << "   columns, bin and counts, with the empty bins left out.\n";
+	std::cout << "   Available options:\n";
+	std::cout << "    -g, --gate <low> <high> | Gate on the bins [low,high] of another axis. A matrix\n";
+	std::cout << "                            | takes one gate, a cube two. Without a gate the matrix\n";
+	std::cout << "                            | is projected.\n";
+	std::cout << "    -o, --output <file>     | Write the spectrum to <file> instead of the terminal.\n";
+	std::cout << "    -i, --info              | Only print the binning of the input.\n";
+}
+
+/// Convert a command line argument to a bin number, returns false if it is not one
+bool get_bin(const char *arg_, unsigned int &value_){
+	char *end;
+	long value = strtol(arg_, &end, 10);
+	value_ = (unsigned int)value;
+	return (end != arg_ && *end == '\0' && value >= 0);
+}
+
+int main(int argc, char *argv[]){
+	if(argc < 2){
+		std::cout << " Error: Invalid number of arguments to " << argv[0] << ". Expected at least 1, received " << argc-1 << ".\n";
+		help(argv[0]);
+		return 1;
+	}
+
+	std::string input, output;
+	std::vector<unsigned int> gates;
+	bool infoOnly = false;
+	for(int i = 1; i < argc; i++){
+		if((strcmp(argv[i], "-g") == 0 || strcmp(argv[i], "--gate") == 0) && i+2 < argc){
+			unsigned int low, high;
+			if(!get_bin(argv[i+1], low) || !get_bin(argv[i+2], high) || low > high){
+				std::cout << " Error: Invalid gate \"" << argv[i+1] << " " << argv[i+2] << "\".\n";
+				return 1;
+			}
+			gates.push_back(low);
+			gates.push_back(high);
+			i += 2;
+		}
+		else if((strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) && i+1 < argc){ output = argv[++i]; }
+		else if(strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "--info") == 0){ infoOnly = true; }
+		else if(strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0){
+			help(argv[0]);
+			return 0;
+		}
+		else if(argv[i][0] == '-' && argv[i][1] != '\0'){
+			std::cout << " Error: Unknown or incomplete option \"" << argv[i] << "\".\n";
+			help(argv[0]);
+			return 1;
+		}
+		else if(input.empty()){ input = argv[i]; }
+		else{
+			std::cout << " Error: Only one input may be given.\n";
+			return 1;
+		}
+	}
+
+	if(input.empty()){
+		std::cout << " Error: An input is required.\n";
+		help(argv[0]);
+		return 1;
+	}
+
+	std::vector<double> spectrum;
+	try{
+		GammaMatrix matrix;
+		bool isMatrix = true;
+		try{ matrix.Read(input); }
+		catch(GeneralException &e){ isMatrix = false; }
+
+		if(isMatrix){
+			if(infoOnly){
+				std::cout << " " << input << ": gamma-gamma matrix, " << matrix.GetNumBins() << " bins, " << matrix.GetMemoryUsage() << " bytes in memory\n";
+				return 0;
+			}
+			if(gates.size() > 2){
+				std::cout << " Error: A matrix takes a single gate.\n";
+				return 1;
+			}
+			if(gates.empty()){ matrix.Project(spectrum); }
+			else{ matrix.Gate(gates[0], gates[1], spectrum); }
+		}
+		else{
+			GammaCube cube(input);
+			if(infoOnly){
+				std::cout << " " << input << ": gamma-gamma-gamma cube, " << cube.GetNumBins() << " bins, " << cube.GetNumAllocatedBlocks() << " blocks\n";
+				return 0;
+			}
+			if(gates.size() != 4){
+				std::cout << " Error: A cube takes two gates.\n";
+				return 1;
+			}
+			cube.Gate(gates[0], gates[1], gates[2], gates[3], spectrum);
+		}
+	}
+	catch(GeneralException &e){
+		std::cout << " Error: " << e.what() << ".\n";
+		return 1;
+	}
+
+	std::ofstream file;
+	if(!output.empty()){
+		file.open(output.c_str());
+		if(!file.good()){
+			std::cout << " Error: Failed to open the output file \"" << output << "\".\n";
+			return 1;
+		}
+	}
+	std::ostream &out = (output.empty() ? std::cout : file);
+	for(size_t bin = 0; bin < spectrum.size(); bin++){
+		if(spectrum[bin] != 0){ out << bin << "\t" << spectrum[bin] << "\n"; }
+	}
+
+	return 0;
+}
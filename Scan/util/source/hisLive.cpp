@@ -0,0 +1,79 @@
+/** \file hisLive.cpp
+  * \brief Sample the live histograms published by a running scan.
+  * \date Oct. 19th, 2026
+  */
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "his_shm.h"
+
+void help(char *name_){
+	std::cout << "  SYNTAX: " << name_ << " [options] [hisID]\n";
+	std::cout << "   Without a histogram id the directory of the segment is listed.\n";
+	std::cout << "   Available options:\n";
+	std::cout << "    --name <name> | Name of the shared memory segment (default " << HIS_SHM_DEFAULT_NAME << ").\n";
+	std::cout << "    --all         | Also print the empty bins of the histogram.\n";
+}
+
+int main(int argc, char *argv[]){
+	std::string name = HIS_SHM_DEFAULT_NAME;
+	bool printAll = false;
+	int hisID = -1;
+	for(int i = 1; i < argc; i++){
+		if(strcmp(argv[i], "--name") == 0 && i+1 < argc){
+			name = argv[++i];
+			if(name[0] != '/'){ name = "/" + name; }
+		}
+		else if(strcmp(argv[i], "--all") == 0){ printAll = true; }
+		else if(strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0){
+			help(argv[0]);
+			return 0;
+		}
+		else{ hisID = atoi(argv[i]); }
+	}
+
+	HisShmReader reader;
+	if(!reader.Open(name.c_str())){
+		std::cout << " Error: Failed to open the live histogram segment \"" << name << "\".\n";
+		return 1;
+	}
+
+	const HisShmHeader *header = reader.GetHeader();
+	std::cout << "# " << header->description << ": " << header->numHis << " histograms, written by pid " << header->writerPid;
+	std::cout << (reader.IsClosed() ? " (closed)\n" : "\n");
+
+	if(hisID < 0){
+		for(unsigned int i = 0; i < reader.GetNumHistograms(); i++){
+			const HisShmEntry *entry = reader.GetEntry(i);
+			std::cout << entry->hisID << "\t" << entry->hisDim << "D\t" << entry->scaled[0];
+			if(entry->hisDim > 1){ std::cout << "x" << entry->scaled[1]; }
+			std::cout << "\t" << entry->sequence / 2 << " updates\t" << entry->title << std::endl;
+		}
+		return 0;
+	}
+
+	int index = reader.Find(hisID);
+	if(index < 0){
+		std::cout << " Error: Histogram " << hisID << " is not in the segment.\n";
+		return 1;
+	}
+
+	std::vector<unsigned int> cells;
+	unsigned int sequence;
+	if(!reader.Read(index, cells, sequence)){ std::cout << "# Warning: The histogram changed during every copy, the contents may be inconsistent.\n"; }
+
+	const HisShmEntry *entry = reader.GetEntry(index);
+	std::cout << "# " << entry->hisID << " " << entry->title << ", version " << sequence / 2 << std::endl;
+	unsigned int xbins = (entry->scaled[0] > 0 ? entry->scaled[0] : 1);
+	for(size_t bin = 0; bin < cells.size(); bin++){
+		if(!printAll && cells[bin] == 0){ continue; }
+		if(entry->hisDim > 1){ std::cout << bin % xbins << "\t" << bin / xbins << "\t" << cells[bin] << std::endl; }
+		else{ std::cout << bin << "\t" << cells[bin] << std::endl; }
+	}
+
+	return 0;
+}
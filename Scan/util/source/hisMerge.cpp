@@ -0,0 +1,123 @@
+/** \file hisMerge.cpp
+  * \brief Add, subtract and scale the histograms of several .his/.drr files.
+  * \date Oct. 19th, 2026
+  */
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "HisFile.hpp"
+
+OutputHisFile *output_his = NULL; /// Required by HisFile, not used here
+
+void help(char *name_){
+	std::cout << "  SYNTAX: " << name_ << " [options] -o <output> <input> [<input> ...]\n";
+	std::cout << "   The output is scale * sum(weight * input) and is written to <output>.his/.drr.\n";
+	std::cout << "   Inputs may be given with or without the .his/.drr extension and must all\n";
+	std::cout << "   use the same histogram definitions.\n";
+	std::cout << "   Available options:\n";
+	std::cout << "    -o, --output <prefix>   | Filename prefix of the output (required).\n";
+	std::cout << "    --subtract <input>      | Subtract the contents of <input>.\n";
+	std::cout << "    --weight <w> <input>    | Add the contents of <input> multiplied by <w>.\n";
+	std::cout << "    --scale <s>             | Multiply the final result by <s> (default 1).\n";
+	std::cout << "    -j, --threads <N>       | Number of histograms combined at the same time (default 1).\n";
+	std::cout << "   Plain sums wrap around like the scan does when filling. Weighted results\n";
+	std::cout << "   are rounded and clipped to the range of a cell, the number of clipped\n";
+	std::cout << "   bins is reported.\n";
+}
+
+/// Strip a trailing .his or .drr extension from a filename
+std::string get_prefix(const std::string &name_){
+	if(name_.size() > 4){
+		std::string ext = name_.substr(name_.size()-4);
+		if(ext == ".his" || ext == ".drr"){ return name_.substr(0, name_.size()-4); }
+	}
+	return name_;
+}
+
+/// Convert a command line argument to a double, returns false if it is not a number
+bool get_number(const char *arg_, double &value_){
+	char *end;
+	value_ = strtod(arg_, &end);
+	return (end != arg_ && *end == '\0');
+}
+
+int main(int argc, char *argv[]){
+	if(argc < 2){
+		std::cout << " Error: Invalid number of arguments to " << argv[0] << ". Expected at least 1, received " << argc-1 << ".\n";
+		help(argv[0]);
+		return 1;
+	}
+
+	std::string output;
+	std::vector<std::string> inputs;
+	std::vector<double> weights;
+	double scale = 1.0;
+	unsigned int threads = 1;
+	for(int i = 1; i < argc; i++){
+		if((strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) && i+1 < argc){ output = get_prefix(argv[++i]); }
+		else if(strcmp(argv[i], "--subtract") == 0 && i+1 < argc){
+			inputs.push_back(get_prefix(argv[++i]));
+			weights.push_back(-1.0);
+		}
+		else if(strcmp(argv[i], "--weight") == 0 && i+2 < argc){
+			double weight;
+			if(!get_number(argv[++i], weight)){
+				std::cout << " Error: Invalid weight \"" << argv[i] << "\".\n";
+				return 1;
+			}
+			inputs.push_back(get_prefix(argv[++i]));
+			weights.push_back(weight);
+		}
+		else if(strcmp(argv[i], "--scale") == 0 && i+1 < argc){
+			if(!get_number(argv[++i], scale)){
+				std::cout << " Error: Invalid scale factor \"" << argv[i] << "\".\n";
+				return 1;
+			}
+		}
+		else if((strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--threads") == 0) && i+1 < argc){
+			int value = atoi(argv[++i]);
+			threads = (value > 0 ? value : sysconf(_SC_NPROCESSORS_ONLN));
+		}
+		else if(strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0){
+			help(argv[0]);
+			return 0;
+		}
+		else if(argv[i][0] == '-' && argv[i][1] != '\0'){
+			std::cout << " Error: Unknown or incomplete option \"" << argv[i] << "\".\n";
+			help(argv[0]);
+			return 1;
+		}
+		else{
+			inputs.push_back(get_prefix(argv[i]));
+			weights.push_back(1.0);
+		}
+	}
+
+	if(output.empty() || inputs.empty()){
+		std::cout << " Error: An output and at least one input are required.\n";
+		help(argv[0]);
+		return 1;
+	}
+
+	for(std::vector<double>::iterator iter = weights.begin(); iter != weights.end(); iter++){ *iter *= scale; }
+
+	std::cout << " Combining " << inputs.size() << " inputs into " << output << ".his\n";
+	for(size_t i = 0; i < inputs.size(); i++){ std::cout << "  " << weights[i] << " x " << inputs[i] << std::endl; }
+
+	std::string error;
+	unsigned long long clipped = 0;
+	if(!CombineHisFiles(inputs, weights, output, error, threads, &clipped)){
+		std::cout << " Error: " << error << ".\n";
+		return 1;
+	}
+
+	if(clipped > 0){ std::cout << " Warning: " << clipped << " bins were outside the range of a cell and were clipped.\n"; }
+	std::cout << " Done.\n";
+
+	return 0;
+}
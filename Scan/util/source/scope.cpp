@@ -72,6 +72,9 @@ scopeUnpacker::scopeUnpacker(const unsigned int &mod/*=0*/, const unsigned int &
 	chan_ = chan;
 	threshLow_ = 0;
 	threshHigh_ = -1;	
+
+	// Only the selected channel is decoded and its waveforms do not need event building.
+	SetChannelSelection(mod_, chan_, false);
 }
 
 /** Process all events in the event list.
@@ -94,6 +97,7 @@ void scopeUnpacker::ProcessRawEvent(ScanInterface *addr_/*=NULL*/){
 
 		// Safety catches for null event or empty adcTrace.
 		if(!current_event || current_event->adcTrace.empty()){
+			delete current_event;
 			continue;
 		}
 
@@ -115,6 +119,7 @@ void scopeUnpacker::ProcessRawEvent(ScanInterface *addr_/*=NULL*/){
 				addr_->ProcessEvents();
 			}
 		}
+		else{ delete current_event; }
 	}
 }
 
@@ -277,8 +282,8 @@ void scopeScanner::Plot(){
 		float highVal = (chanEvents_.front()->max_index + fitHigh_) * ADC_TIME_STEP;
 
 		if(performCfd_){
-			// Find the zero-crossing of the cfd waveform.
-			float cfdCrossing = chanEvents_.front()->AnalyzeCFD(cfdF_, cfdD_, cfdL_);
+			// The cfd waveform was computed with the rest of the batch.
+			float cfdCrossing = chanEvents_.front()->cfdCrossing;
 			
 			// Draw the cfd waveform.
 			for(size_t cfdIndex = 0; cfdIndex < chanEvents_.front()->size; cfdIndex++)
@@ -427,11 +432,7 @@ bool scopeScanner::AddEvent(XiaData *event_){
 	//Get the first event int the FIFO.
 	ChannelEvent *channel_event = new ChannelEvent(event_);
 
-	//Process the waveform.
-	//channel_event->FindLeadingEdge();
-	channel_event->CorrectBaseline();
-	channel_event->FindQDC();
-	
+	//The waveform is processed in ProcessEvents(), and only if it is plotted.
 	//Push the channel event into the deque.
 	chanEvents_.push_back(channel_event);
 
@@ -462,6 +463,20 @@ bool scopeScanner::ProcessEvents(){
 		}
 	}	
 
+	//Process the waveforms which will be plotted as one batch.
+	batch_.Clear();
+	for(unsigned int i = 0; i < numAvgWaveforms_ && i < chanEvents_.size(); i++){
+		ChannelEvent *evt = chanEvents_.at(i);
+		if(!batch_.Add(evt)){ // Trace length differs from the rest of the batch.
+			evt->CorrectBaseline();
+			evt->FindQDC();
+			if(performCfd_){ evt->AnalyzeCFD(cfdF_, cfdD_, cfdL_); }
+		}
+	}
+	batch_.CorrectBaseline();
+	batch_.IntegratePulse();
+	if(performCfd_){ batch_.AnalyzeCFD(cfdF_, cfdD_, cfdL_); }
+
 	//When we have the correct number of waveforms we plot them.
 	Plot(); 
 	
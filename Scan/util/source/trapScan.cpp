@@ -0,0 +1,507 @@
+/** \file trapScan.cpp
+ * \brief Offline scan of the pixie16 energy filter parameters using recorded traces.
+ *
+ * \date Oct. 19th, 2026
+ */
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include <getopt.h>
+
+#include "XiaData.hpp"
+#include "TraceFilter.hpp"
+
+// Local files
+#include "trapScan.hpp"
+
+// Define the name of the program.
+#ifndef PROG_NAME
+#define PROG_NAME "trapScan"
+#endif
+
+#define FWHM_PER_SIGMA 2.35482 // 2*sqrt(2*ln(2))
+
+///////////////////////////////////////////////////////////////////////////////
+// class trapScanUnpacker
+///////////////////////////////////////////////////////////////////////////////
+
+/** Process all events in the event list.
+  * \param[in]  addr_ Pointer to a location in memory.
+  * \return Nothing.
+  */
+void trapScanUnpacker::ProcessRawEvent(ScanInterface *addr_/*=NULL*/){
+	if(!addr_){ return; }
+
+	XiaData *current_event = NULL;
+
+	// Pass every channel event to the scanner. It takes ownership of them.
+	while(!rawEvent.empty()){
+		current_event = rawEvent.front();
+		rawEvent.pop_front();
+
+		if(!current_event){ continue; }
+
+		addr_->AddEvent(current_event);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class scanRange
+///////////////////////////////////////////////////////////////////////////////
+
+/// Parse a string of the form "start[:stop:step]". Return false on failure.
+bool scanRange::Set(const std::string &str_){
+	std::vector<double> values;
+	std::stringstream stream(str_);
+	std::string token;
+	while(std::getline(stream, token, ':')){
+		if(token.empty()){ return false; }
+		values.push_back(strtod(token.c_str(), NULL));
+	}
+
+	if(values.size() == 1){
+		start = values[0];
+		stop = values[0];
+		step = 1;
+	}
+	else if(values.size() == 3 && values[2] > 0 && values[1] >= values[0]){
+		start = values[0];
+		stop = values[1];
+		step = values[2];
+	}
+	else{ return false; }
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class trapScanner
+///////////////////////////////////////////////////////////////////////////////
+
+/// Default constructor.
+trapScanner::trapScanner() : ScanInterface() {
+	init = false;
+	scanned = false;
+
+	nsPerSample = 4;
+	maxTraces = 10000;
+	numThreads = std::thread::hardware_concurrency();
+	if(numThreads == 0){ numThreads = 1; }
+	numBins = 1024;
+
+	selectMod = -1;
+	selectChan = -1;
+
+	// Default grid in ns, the RevF ENERGY_RISETIME and ENERGY_FLATTOP step
+	// is 32 ns for the default SLOW_FILTER_RANGE.
+	riseRange.Set("128:1024:64");
+	flatRange.Set("64:512:64");
+	tauRange.Set("40000");
+
+	trigPars = TrapFilterParameters(100, 20, 20);
+}
+
+/// Destructor.
+trapScanner::~trapScanner(){
+}
+
+/** ExtraCommands is used to send command strings to classes derived
+  * from ScanInterface. If ScanInterface receives an unrecognized
+  * command from the user, it will pass it on to the derived class.
+  * \param[in]  cmd_ The command to interpret.
+  * \param[out] arg_ Vector or arguments to the user command.
+  * \return True if the command was recognized and false otherwise.
+  */
+bool trapScanner::ExtraCommands(const std::string &cmd_, std::vector<std::string> &args_){
+	if(cmd_ == "scan"){
+		if(ScanParameters())
+			WriteResults();
+	}
+	else if(cmd_ == "rise" || cmd_ == "flat" || cmd_ == "tau"){
+		scanRange *range = (cmd_ == "rise" ? &riseRange : (cmd_ == "flat" ? &flatRange : &tauRange));
+		if(args_.size() >= 1){
+			if(!range->Set(args_.at(0)))
+				std::cout << msgHeader << "Invalid range '" << args_.at(0) << "', expected <start>[:<stop>:<step>] in ns.\n";
+		}
+		std::cout << msgHeader << cmd_ << " = " << range->start << ":" << range->stop << ":" << range->step << " ns (" << range->GetSize() << " points).\n";
+	}
+	else if(cmd_ == "clear"){
+		std::lock_guard<std::mutex> lock(tracesLock);
+		traces.clear();
+		results.clear();
+		scanned = false;
+		std::cout << msgHeader << "Cleared all stored traces.\n";
+	}
+	else if(cmd_ == "status"){
+		std::lock_guard<std::mutex> lock(tracesLock);
+		for(std::map<unsigned int, std::vector<std::vector<int> > >::iterator iter = traces.begin(); iter != traces.end(); iter++)
+			std::cout << msgHeader << " M" << iter->first/16 << "C" << iter->first%16 << ": " << iter->second.size() << " traces\n";
+	}
+	else{ return false; } // Unrecognized command.
+
+	return true;
+}
+
+/** ExtraArguments is used to send command line arguments to classes derived
+  * from ScanInterface. This method should loop over the optionExt elements
+  * in the vector userOpts and check for those options which have been flagged
+  * as active by ::Setup(). This should be overloaded in the derived class.
+  * \return Nothing.
+  */
+void trapScanner::ExtraArguments(){
+	if(userOpts.at(0).active && !riseRange.Set(userOpts.at(0).argument))
+		std::cout << msgHeader << "Invalid argument to --rise (" << userOpts.at(0).argument << ")!\n";
+	if(userOpts.at(1).active && !flatRange.Set(userOpts.at(1).argument))
+		std::cout << msgHeader << "Invalid argument to --flat (" << userOpts.at(1).argument << ")!\n";
+	if(userOpts.at(2).active && !tauRange.Set(userOpts.at(2).argument))
+		std::cout << msgHeader << "Invalid argument to --tau (" << userOpts.at(2).argument << ")!\n";
+	if(userOpts.at(3).active){
+		std::vector<double> values;
+		std::stringstream stream(userOpts.at(3).argument);
+		std::string token;
+		while(std::getline(stream, token, ':'))
+			values.push_back(strtod(token.c_str(), NULL));
+		if(values.size() == 3)
+			trigPars = TrapFilterParameters(values[0], values[1], values[2]);
+		else
+			std::cout << msgHeader << "Invalid argument to --trigger (" << userOpts.at(3).argument << ")!\n";
+	}
+	if(userOpts.at(4).active)
+		nsPerSample = strtoul(userOpts.at(4).argument.c_str(), NULL, 0);
+	if(userOpts.at(5).active)
+		maxTraces = strtoul(userOpts.at(5).argument.c_str(), NULL, 0);
+	if(userOpts.at(6).active){
+		numThreads = strtoul(userOpts.at(6).argument.c_str(), NULL, 0);
+		if(numThreads == 0){ numThreads = 1; }
+	}
+	if(userOpts.at(7).active){
+		std::string arg = userOpts.at(7).argument;
+		selectMod = atoi(arg.c_str());
+		if(arg.find(':') != std::string::npos)
+			selectChan = atoi(arg.substr(arg.find(':')+1).c_str());
+	}
+	if(userOpts.at(8).active){
+		unsigned long bins = strtoul(userOpts.at(8).argument.c_str(), NULL, 0);
+		if(bins > 0){ numBins = bins; }
+		else{ std::cout << msgHeader << "Invalid argument to --bins (" << userOpts.at(8).argument << ")!\n"; }
+	}
+}
+
+/** CmdHelp is used to allow a derived class to print a help statement about
+  * its own commands. This method is called whenever the user enters 'help'
+  * or 'h' into the interactive terminal (if available).
+  * \param[in]  prefix_ String to append at the start of any output. Not used by default.
+  * \return Nothing.
+  */
+void trapScanner::CmdHelp(const std::string &prefix_/*=""*/){
+	std::cout << "   scan          - Scan the parameter grid using all stored traces.\n";
+	std::cout << "   rise [range]  - Set or display the ENERGY_RISETIME range (ns).\n";
+	std::cout << "   flat [range]  - Set or display the ENERGY_FLATTOP range (ns).\n";
+	std::cout << "   tau [range]   - Set or display the TAU range (ns).\n";
+	std::cout << "   status        - Display the number of stored traces for each channel.\n";
+	std::cout << "   clear         - Clear all stored traces.\n";
+}
+
+/** ArgHelp is used to allow a derived class to add a command line option
+  * to the main list of options. This method is called at the end of
+  * from the ::Setup method.
+  * \return Nothing.
+  */
+void trapScanner::ArgHelp(){
+	AddOption(optionExt("rise", required_argument, NULL, 'r', "<start[:stop:step]>", "ENERGY_RISETIME range in ns (default=128:1024:64)."));
+	AddOption(optionExt("flat", required_argument, NULL, 'f', "<start[:stop:step]>", "ENERGY_FLATTOP range in ns (default=64:512:64)."));
+	AddOption(optionExt("tau", required_argument, NULL, 't', "<start[:stop:step]>", "TAU range in ns (default=40000)."));
+	AddOption(optionExt("trigger", required_argument, NULL, 0, "<rise:flat:thresh>", "Trigger filter in ns and ADC units (default=100:20:20)."));
+	AddOption(optionExt("adc", required_argument, NULL, 0, "<ns>", "ADC sampling period in ns (default=4)."));
+	AddOption(optionExt("traces", required_argument, NULL, 'n', "<num>", "Maximum number of traces to use per channel (default=10000)."));
+	AddOption(optionExt("threads", required_argument, NULL, 'j', "<num>", "Number of worker threads (default=number of cores)."));
+	AddOption(optionExt("channel", required_argument, NULL, 0, "<mod[:chan]>", "Only scan the specified module or channel."));
+	AddOption(optionExt("bins", required_argument, NULL, 0, "<num>", "Number of bins in each energy spectrum (default=1024)."));
+}
+
+/** SyntaxStr is used to print a linux style usage message to the screen.
+  * \param[in]  name_ The name of the program.
+  * \return Nothing.
+  */
+void trapScanner::SyntaxStr(char *name_){
+	std::cout << " usage: " << std::string(name_) << " [options]\n";
+}
+
+/** Initialize the scanner.
+  * \param[in]  prefix_ String to append to the beginning of system output.
+  * \return True upon successfully initializing and false otherwise.
+  */
+bool trapScanner::Initialize(std::string prefix_){
+	if(init){ return false; }
+
+	std::cout << prefix_ << "ENERGY_RISETIME = " << riseRange.start << ":" << riseRange.stop << ":" << riseRange.step << " ns\n";
+	std::cout << prefix_ << "ENERGY_FLATTOP  = " << flatRange.start << ":" << flatRange.stop << ":" << flatRange.step << " ns\n";
+	std::cout << prefix_ << "TAU             = " << tauRange.start << ":" << tauRange.stop << ":" << tauRange.step << " ns\n";
+	std::cout << prefix_ << "Using " << numThreads << " worker threads and up to " << maxTraces << " traces per channel.\n";
+
+	return (init = true);
+}
+
+/** Receive various status notifications from the scan. The parameter scan
+  * is started when the input file has been completely read.
+  * \param[in] code_ The notification code passed from ScanInterface methods.
+  * \return Nothing.
+  */
+void trapScanner::Notify(const std::string &code_/*=""*/){
+	if(code_ == "START_SCAN"){  }
+	else if(code_ == "STOP_SCAN"){  }
+	else if(code_ == "SCAN_COMPLETE"){
+		std::cout << msgHeader << "Finished reading traces.\n";
+		if(!scanned && ScanParameters())
+			WriteResults();
+	}
+	else if(code_ == "LOAD_FILE"){ std::cout << msgHeader << "File loaded.\n"; }
+	else if(code_ == "REWIND_FILE"){  }
+	else{ std::cout << msgHeader << "Unknown notification code '" << code_ << "'!\n"; }
+}
+
+/** Return a pointer to the Unpacker object to use for data unpacking.
+  * If no object has been initialized, create a new one.
+  * \return Pointer to an Unpacker object.
+  */
+Unpacker *trapScanner::GetCore(){
+	if(!core){ core = (Unpacker*)(new trapScanUnpacker()); }
+	return core;
+}
+
+/** Store the trace of a channel event for the parameter scan.
+  * This method should only be called from trapScanUnpacker::ProcessRawEvent().
+  * \param[in]  event_ The raw XiaData to add.
+  * \return False.
+  */
+bool trapScanner::AddEvent(XiaData *event_){
+	if(!event_){ return false; }
+
+	if(!event_->adcTrace.empty() && !event_->pileupBit && !event_->saturatedBit &&
+	   (selectMod < 0 || (int)event_->modNum == selectMod) &&
+	   (selectChan < 0 || (int)event_->chanNum == selectChan)){
+		std::lock_guard<std::mutex> lock(tracesLock);
+		std::vector<std::vector<int> > &list = traces[event_->getID()];
+		if(list.size() < maxTraces){
+			list.push_back(std::vector<int>());
+			list.back().swap(event_->adcTrace);
+		}
+	}
+
+	delete event_;
+
+	return false;
+}
+
+/** Evaluate a single grid point for a single channel.
+  * \param[in,out] point_ The grid point to evaluate. The fit results are written into it.
+  * \return Nothing.
+  */
+void trapScanner::EvaluatePoint(scanPoint &point_){
+	const std::vector<std::vector<int> > &list = traces.find(point_.id)->second;
+
+	TraceFilter filter(nsPerSample, trigPars, TrapFilterParameters(point_.rise, point_.flat, point_.tau));
+
+	std::vector<double> energies;
+	energies.reserve(list.size());
+	for(std::vector<std::vector<int> >::const_iterator iter = list.begin(); iter != list.end(); iter++){
+		if(filter.CalcFilters(&(*iter)) != 0){ continue; }
+		double energy = filter.GetEnergy();
+		if(std::isfinite(energy)){ energies.push_back(energy); }
+	}
+
+	point_.numGood = energies.size();
+	if(energies.size() < 10){ return; }
+
+	// Histogram the energies between the 0.1% and 99.9% quantiles so that a
+	// few garbage values cannot stretch the spectrum.
+	std::sort(energies.begin(), energies.end());
+	double low = energies[(size_t)(0.001*(energies.size()-1))];
+	double high = energies[(size_t)(0.999*(energies.size()-1))];
+	if(high <= low){ return; }
+	double width = (high - low) / numBins;
+
+	std::vector<unsigned int> spectrum(numBins, 0);
+	for(std::vector<double>::iterator iter = energies.begin(); iter != energies.end(); iter++){
+		if(*iter < low || *iter >= high){ continue; }
+		spectrum[(size_t)((*iter - low) / width)]++;
+	}
+
+	// Find the tallest peak, skipping the lowest bins which contain the noise.
+	size_t peak = numBins/100 + 1;
+	if(peak >= numBins){ return; }
+	for(size_t i = peak + 1; i < numBins; i++){
+		if(spectrum[i] > spectrum[peak]){ peak = i; }
+	}
+	if(spectrum[peak] == 0){ return; }
+
+	// Fit the peak region (everything above half of the maximum) with a gaussian
+	// using a weighted least squares parabola through the log of the counts.
+	size_t lowBin = peak, highBin = peak;
+	while(lowBin > 0 && 2*spectrum[lowBin-1] >= spectrum[peak]){ lowBin--; }
+	while(highBin+1 < numBins && 2*spectrum[highBin+1] >= spectrum[peak]){ highBin++; }
+	if(highBin - lowBin < 2){ // Widen the range to at least three bins.
+		if(lowBin > 0){ lowBin--; }
+		if(highBin+1 < numBins){ highBin++; }
+	}
+
+	double s[5] = {0, 0, 0, 0, 0}; // Sums of w*x^n
+	double t[3] = {0, 0, 0}; // Sums of w*x^n*ln(y)
+	for(size_t i = lowBin; i <= highBin; i++){
+		if(spectrum[i] == 0){ continue; }
+		double x = (double)i - (double)peak;
+		double w = spectrum[i];
+		double lny = std::log((double)spectrum[i]);
+		double xn = w;
+		for(int n = 0; n < 5; n++){
+			s[n] += xn;
+			if(n < 3){ t[n] += xn * lny; }
+			xn *= x;
+		}
+	}
+
+	// Solve the normal equations for ln(y) = a + b*x + c*x^2.
+	double det = s[0]*(s[2]*s[4]-s[3]*s[3]) - s[1]*(s[1]*s[4]-s[3]*s[2]) + s[2]*(s[1]*s[3]-s[2]*s[2]);
+	if(det == 0){ return; }
+	double b = (s[0]*(t[1]*s[4]-s[3]*t[2]) - t[0]*(s[1]*s[4]-s[3]*s[2]) + s[2]*(s[1]*t[2]-t[1]*s[2])) / det;
+	double c = (s[0]*(s[2]*t[2]-t[1]*s[3]) - s[1]*(s[1]*t[2]-t[1]*s[2]) + t[0]*(s[1]*s[3]-s[2]*s[2])) / det;
+	if(c >= 0){ return; }
+
+	point_.centroid = low + (peak + 0.5 - b/(2*c)) * width;
+	point_.sigma = std::sqrt(-1.0/(2*c)) * width;
+	if(point_.centroid > 0)
+		point_.resolution = 100 * FWHM_PER_SIGMA * point_.sigma / point_.centroid;
+}
+
+/** Run the filter over all stored traces for every point in the parameter grid.
+  * \return True if at least one channel was scanned and false otherwise.
+  */
+bool trapScanner::ScanParameters(){
+	// The reader thread may still be appending traces when the scan command
+	// is issued, so hold the lock for the whole scan. Reading resumes after.
+	std::lock_guard<std::mutex> lock(tracesLock);
+
+	results.clear();
+
+	if(traces.empty()){
+		std::cout << msgHeader << "No traces are stored, nothing to scan!\n";
+		return false;
+	}
+
+	// Build the list of all channel and grid point combinations.
+	for(std::map<unsigned int, std::vector<std::vector<int> > >::iterator iter = traces.begin(); iter != traces.end(); iter++){
+		for(size_t i = 0; i < riseRange.GetSize(); i++){
+			for(size_t j = 0; j < flatRange.GetSize(); j++){
+				for(size_t k = 0; k < tauRange.GetSize(); k++){
+					scanPoint point;
+					point.id = iter->first;
+					point.rise = riseRange.At(i);
+					point.flat = flatRange.At(j);
+					point.tau = tauRange.At(k);
+					results.push_back(point);
+				}
+			}
+		}
+	}
+
+	std::cout << msgHeader << "Scanning " << results.size() << " grid points for " << traces.size() << " channels using " << numThreads << " threads.\n";
+
+	// Every worker pulls the next unevaluated point until none are left. Each
+	// point is written by exactly one worker, so no locking is needed.
+	std::atomic<size_t> nextPoint(0);
+	std::vector<std::thread> workers;
+	for(unsigned int i = 0; i < numThreads; i++){
+		workers.push_back(std::thread([this, &nextPoint](){
+			size_t index;
+			while((index = nextPoint++) < results.size())
+				EvaluatePoint(results[index]);
+		}));
+	}
+	for(std::vector<std::thread>::iterator iter = workers.begin(); iter != workers.end(); iter++)
+		iter->join();
+
+	scanned = true;
+
+	return true;
+}
+
+/** Write the full result table and the poll2 command script.
+  * \return True if the output files were written and false otherwise.
+  */
+bool trapScanner::WriteResults(){
+	std::lock_guard<std::mutex> lock(tracesLock);
+
+	std::string prefix = GetOutputFilename();
+	if(prefix.empty()){ prefix = PROG_NAME; }
+
+	std::ofstream table((prefix+".dat").c_str());
+	std::ofstream script((prefix+".cmd").c_str());
+	if(!table.good() || !script.good()){
+		std::cout << msgHeader << "Failed to open output files with prefix '" << prefix << "'!\n";
+		return false;
+	}
+
+	table << "#mod\tchan\trise(ns)\tflat(ns)\ttau(ns)\tnumGood\tcentroid\tsigma\tfwhm(%)\n";
+	script << "# Optimal energy filter settings found by " << PROG_NAME << ".\n";
+	script << "# Load these into poll2 with '.cmd " << prefix << ".cmd'.\n";
+
+	std::cout << msgHeader << "Optimal settings:\n";
+	std::cout << "  mod\tchan\trise(ns)\tflat(ns)\ttau(ns)\tfwhm(%)\n";
+
+	std::vector<scanPoint>::iterator best = results.end();
+	for(std::vector<scanPoint>::iterator iter = results.begin(); iter != results.end(); iter++){
+		table << iter->id/16 << "\t" << iter->id%16 << "\t" << iter->rise << "\t" << iter->flat << "\t" << iter->tau << "\t";
+		table << iter->numGood << "\t" << iter->centroid << "\t" << iter->sigma << "\t" << iter->resolution << "\n";
+
+		if(iter->resolution > 0 && (best == results.end() || iter->resolution < best->resolution))
+			best = iter;
+
+		// Results are grouped by channel, so write the best point when the channel changes.
+		if(iter+1 == results.end() || (iter+1)->id != iter->id){
+			if(best != results.end()){
+				unsigned int mod = best->id/16, chan = best->id%16;
+				std::cout << "  " << mod << "\t" << chan << "\t" << best->rise << "\t\t" << best->flat << "\t\t" << best->tau << "\t" << best->resolution << "\n";
+
+				// Pixie16 filter parameters are given in microseconds.
+				script << "pwrite " << mod << " " << chan << " ENERGY_RISETIME " << best->rise/1000 << "\n";
+				script << "pwrite " << mod << " " << chan << " ENERGY_FLATTOP " << best->flat/1000 << "\n";
+				if(tauRange.GetSize() > 1)
+					script << "pwrite " << mod << " " << chan << " TAU " << best->tau/1000 << "\n";
+			}
+			else{ std::cout << "  " << iter->id/16 << "\t" << iter->id%16 << "\tno valid fits\n"; }
+			best = results.end();
+		}
+	}
+
+	std::cout << msgHeader << "Wrote " << prefix << ".dat and " << prefix << ".cmd\n";
+
+	return true;
+}
+
+int main(int argc, char *argv[]){
+	// Define a new unpacker object.
+	trapScanner scanner;
+
+	// Set the output message prefix.
+	scanner.SetProgramName(std::string(PROG_NAME));
+
+	// Initialize the scanner.
+	if(!scanner.Setup(argc, argv))
+		return 1;
+
+	// Run the main loop.
+	int retval = scanner.Execute();
+
+	scanner.Close();
+
+	return retval;
+}
@@ -0,0 +1,120 @@
+/** \file GammaCoincidencesTest.cpp
+  * \brief Sum the gamma-gamma matrices and cubes of run list workers and check their projections and gates.
+  * \date Oct. 19th, 2026
+  */
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "GammaCoincidences.hpp"
+#include "OutputFiles.hpp"
+#include "TestCheck.h"
+
+#define NUM_PARTS 3
+#define MATRIX_BINS 300
+#define CUBE_BINS 40
+
+std::string temp_name(const std::string &ext_){
+	std::stringstream stream;
+	stream << "GammaCoincidencesTest." << getpid() << ext_;
+	return stream.str();
+}
+
+int main(int argc, char *argv[]){
+	// Each worker fills its own part, the reference gets every coincidence.
+	GammaMatrix reference(MATRIX_BINS);
+	std::vector<std::string> matrixParts, cubeParts;
+	for(int part = 0; part < NUM_PARTS; part++){
+		GammaMatrix matrix(MATRIX_BINS);
+		std::stringstream name;
+		name << "_part" << part << ".ggm";
+		GammaCube cube(temp_name(name.str() + ".cube"), CUBE_BINS);
+		for(int i = 0; i < 2000; i++){
+			double e1 = (i * 37 + part * 11) % (MATRIX_BINS + 20);
+			double e2 = (i * 53 + part * 7) % MATRIX_BINS;
+			matrix.Fill(e1, e2);
+			reference.Fill(e1, e2);
+			cube.Fill(i % CUBE_BINS, (i * 3 + part) % CUBE_BINS, (i * 7) % CUBE_BINS);
+		}
+		matrixParts.push_back(temp_name(name.str()));
+		cubeParts.push_back(temp_name(name.str() + ".cube"));
+		matrix.Write(matrixParts.back());
+		check(cube.Close(), "write cube part " + cubeParts.back());
+	}
+
+	std::string error;
+	std::string matrixName = temp_name(".ggm");
+	check(OutputFiles::Combine(matrixName, OUTPUT_GAMMA_MATRIX, matrixParts, error), "combine matrices: " + error);
+
+	GammaMatrix sum;
+	sum.Read(matrixName);
+	check(sum.GetNumBins() == MATRIX_BINS, "matrix binning");
+	bool equal = true;
+	for(unsigned int x = 0; x < MATRIX_BINS && equal; x++){
+		for(unsigned int y = 0; y < MATRIX_BINS && equal; y++){ equal = (sum.Get(x, y) == reference.Get(x, y)); }
+	}
+	check(equal, "summed matrix equals the matrix of all events");
+
+	std::vector<double> projection, gated, full;
+	sum.Project(projection);
+	double total = 0, expectedTotal = 0;
+	for(size_t i = 0; i < projection.size(); i++){ total += projection[i]; }
+	for(unsigned int x = 0; x < MATRIX_BINS; x++){
+		for(unsigned int y = 0; y < MATRIX_BINS; y++){ expectedTotal += reference.Get(x, y); }
+	}
+	check(total > 0 && total == expectedTotal, "projection of the full symmetric matrix");
+	sum.Gate(10, 20, gated);
+	reference.Gate(10, 20, full);
+	check(gated == full, "gate of the summed matrix");
+	double expected = 0;
+	for(unsigned int x = 10; x <= 20; x++){ expected += reference.Get(x, 123); }
+	check(gated[123] == expected, "gate counts the full symmetric matrix");
+
+	std::string cubeName = temp_name(".cube");
+	check(OutputFiles::Combine(cubeName, OUTPUT_GAMMA_CUBE, cubeParts, error), "combine cubes: " + error);
+	{
+		GammaCube cube(cubeName);
+		std::vector<GammaCube*> parts;
+		for(size_t i = 0; i < cubeParts.size(); i++){ parts.push_back(new GammaCube(cubeParts[i])); }
+		bool cubeEqual = true;
+		for(unsigned int x = 0; x < CUBE_BINS && cubeEqual; x++){
+			for(unsigned int y = 0; y < CUBE_BINS && cubeEqual; y++){
+				for(unsigned int z = 0; z < CUBE_BINS && cubeEqual; z++){
+					unsigned int counts = 0;
+					for(size_t i = 0; i < parts.size(); i++){ counts += parts[i]->Get(x, y, z); }
+					cubeEqual = (cube.Get(x, y, z) == counts);
+				}
+			}
+		}
+		check(cubeEqual, "summed cube equals the sum of the parts");
+
+		std::vector<double> cubeGate;
+		cube.Gate(0, CUBE_BINS - 1, 0, CUBE_BINS - 1, cubeGate);
+		double cubeTotal = 0;
+		for(size_t i = 0; i < cubeGate.size(); i++){ cubeTotal += cubeGate[i]; }
+		check(cubeTotal > 0, "cube gate is not empty");
+		for(size_t i = 0; i < parts.size(); i++){ delete parts[i]; }
+	}
+
+	// Parts with a different binning are refused.
+	GammaMatrix other(MATRIX_BINS / 2);
+	std::string otherName = temp_name("_other.ggm");
+	other.Write(otherName);
+	std::vector<std::string> mixed;
+	mixed.push_back(matrixParts.front());
+	mixed.push_back(otherName);
+	check(!OutputFiles::Combine(temp_name("_mixed.ggm"), OUTPUT_GAMMA_MATRIX, mixed, error), "matrices with different binning");
+
+	for(size_t i = 0; i < matrixParts.size(); i++){ remove(matrixParts[i].c_str()); }
+	for(size_t i = 0; i < cubeParts.size(); i++){ remove(cubeParts[i].c_str()); }
+	remove(matrixName.c_str());
+	remove(cubeName.c_str());
+	remove(otherName.c_str());
+	remove(temp_name("_mixed.ggm").c_str());
+
+	return check_result(argv[0]);
+}
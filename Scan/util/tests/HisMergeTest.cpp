@@ -0,0 +1,143 @@
+/** \file HisMergeTest.cpp
+  * \brief Write two .his/.drr files, combine them and check the result bin by bin.
+  * \date Oct. 19th, 2026
+  */
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "HisFile.hpp"
+#include "TestCheck.h"
+
+OutputHisFile *output_his = NULL; /// Required by HisFile, not used here
+
+#define ID_1D 100
+#define ID_2D 200
+#define BINS_1D 4096
+#define BINS_2D 256
+
+/// The contents of bin i of the 1d histogram of input n.
+unsigned int content_1d(const unsigned int &n_, const unsigned int &bin_){ return (bin_ % 17)*(n_ + 1) + (bin_ == 5 ? 40000 : 0); }
+
+/// The contents of bin (x, y) of the 2d histogram of input n.
+unsigned int content_2d(const unsigned int &n_, const unsigned int &x_, const unsigned int &y_){ return ((x_ + y_) % 3 == 0 ? n_ + x_ % 5 : 0); }
+
+/// Write the histograms of input n.
+bool write_input(const std::string &prefix_, const unsigned int &n_){
+	OutputHisFile his(prefix_);
+	if(!his.IsWritable()){ return false; }
+	his.push_back(new drr_entry(ID_1D, 1, BINS_1D, BINS_1D, 0, BINS_1D-1, "1d short cells"));
+	his.push_back(new drr_entry(ID_2D, 2, BINS_2D, BINS_2D, 0, BINS_2D-1, BINS_2D, BINS_2D, 0, BINS_2D-1, "2d int cells"));
+	if(!his.Finalize()){ return false; }
+
+	for(unsigned int i = 0; i < BINS_1D; i++){
+		unsigned int value = content_1d(n_, i);
+		if(value > 0){ his.FillBin(ID_1D, i, 0, value); }
+	}
+	for(unsigned int x = 0; x < BINS_2D; x++){
+		for(unsigned int y = 0; y < BINS_2D; y++){
+			unsigned int value = content_2d(n_, x, y);
+			if(value > 0){ his.FillBin(ID_2D, x, y, value); }
+		}
+	}
+
+	// Zeroing a histogram with pending fills must not leave stale fills behind.
+	his.FillBin(ID_1D, 7, 0, 3);
+	his.Zero(ID_1D);
+	for(unsigned int i = 0; i < BINS_1D; i++){
+		unsigned int value = content_1d(n_, i);
+		if(value > 0){ his.FillBin(ID_1D, i, 0, value); }
+	}
+
+	his.Close();
+	return true;
+}
+
+/// Return the bins of a histogram of a .his file.
+bool read_histogram(const std::string &prefix_, const unsigned int &id_, const size_t &numBins_, std::vector<unsigned int> &bins_){
+	HisFile his(prefix_.c_str());
+	if(his.GetHistogram(id_) == 0){ return false; } // Entries are looked up by histogram ID.
+	bins_.resize(numBins_);
+	for(size_t i = 0; i < numBins_; i++){ bins_[i] = his.GetData()->Get(i); }
+	return true;
+}
+
+void remove_files(const std::string &prefix_){
+	remove((prefix_+".his").c_str());
+	remove((prefix_+".drr").c_str());
+	remove((prefix_+".list").c_str());
+	remove((prefix_+".log").c_str());
+}
+
+int main(int argc, char *argv[]){
+	std::string base = "HisMergeTest." + std::to_string(getpid());
+	std::vector<std::string> inputs;
+	inputs.push_back(base + ".a");
+	inputs.push_back(base + ".b");
+	std::string sum = base + ".sum";
+	std::string diff = base + ".diff";
+
+	check(write_input(inputs[0], 0), "write the first input");
+	check(write_input(inputs[1], 1), "write the second input");
+	if(failures > 0){ return check_result(argv[0]); }
+
+	// The plain sum.
+	std::string error;
+	check(SumHisFiles(inputs, sum, error), "SumHisFiles: " + error);
+
+	std::vector<unsigned int> bins;
+	check(read_histogram(sum, ID_1D, BINS_1D, bins), "read the summed 1d histogram");
+	bool same = true;
+	for(size_t i = 0; i < bins.size(); i++){
+		if(bins[i] != ((content_1d(0, i) + content_1d(1, i)) & 0xFFFF)){ same = false; } // Short cells wrap.
+	}
+	check(same, "contents of the summed 1d histogram");
+
+	check(read_histogram(sum, ID_2D, BINS_2D*BINS_2D, bins), "read the summed 2d histogram");
+	same = true;
+	for(unsigned int x = 0; x < BINS_2D; x++){
+		for(unsigned int y = 0; y < BINS_2D; y++){
+			if(bins[x + y*BINS_2D] != content_2d(0, x, y) + content_2d(1, x, y)){ same = false; }
+		}
+	}
+	check(same, "contents of the summed 2d histogram");
+
+	// Weighted difference using several threads, negative results are clipped to zero.
+	std::vector<double> weights;
+	weights.push_back(2.0);
+	weights.push_back(-1.0);
+	unsigned long long clipped = 0;
+	check(CombineHisFiles(inputs, weights, diff, error, 2, &clipped), "CombineHisFiles: " + error);
+
+	check(read_histogram(diff, ID_2D, BINS_2D*BINS_2D, bins), "read the combined 2d histogram");
+	same = true;
+	unsigned long long expectClipped = 0;
+	for(unsigned int x = 0; x < BINS_2D; x++){
+		for(unsigned int y = 0; y < BINS_2D; y++){
+			double value = 2.0*content_2d(0, x, y) - content_2d(1, x, y);
+			if(value < 0){
+				value = 0;
+				expectClipped++;
+			}
+			if(bins[x + y*BINS_2D] != (unsigned int)value){ same = false; }
+		}
+	}
+	check(same, "contents of the combined 2d histogram");
+
+	check(read_histogram(diff, ID_1D, BINS_1D, bins), "read the combined 1d histogram");
+	for(size_t i = 0; i < bins.size(); i++){
+		double value = 2.0*content_1d(0, i) - content_1d(1, i);
+		if(value < 0 || value > 0xFFFF){ expectClipped++; }
+	}
+	check(clipped == expectClipped, "number of clipped bins");
+
+	remove_files(inputs[0]);
+	remove_files(inputs[1]);
+	remove_files(sum);
+	remove_files(diff);
+
+	return check_result(argv[0]);
+}
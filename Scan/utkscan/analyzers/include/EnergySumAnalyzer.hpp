@@ -0,0 +1,73 @@
+/** \file EnergySumAnalyzer.hpp
+ * \brief Reconstructs energies from the onboard energy filter sums
+ * \date Oct. 19th, 2026
+ */
+#ifndef __ENERGYSUMANALYZER_HPP__
+#define __ENERGYSUMANALYZER_HPP__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ChanEvent.hpp"
+#include "TraceAnalyzer.hpp"
+
+/*! \brief Computes the energy of a channel from the partial sums of the
+ * energy filter that Pixie records in 8 and 16 word headers.
+ *
+ * The energy is C0 * trailing + Cg * gap + C1 * leading - baseline, with the
+ * coefficients of the same decay corrected trapezoid that is used by the
+ * TraceFilter. The risetime and tau are taken from the energy filter
+ * parameters of the type:subtype, so they can be changed offline without
+ * traces. The risetime has to match the one used by the module, since it
+ * sets the length of the sums.
+ */
+class EnergySumAnalyzer : public TraceAnalyzer {
+public:
+    /** Constructor
+     * \param [in] useOnboardBaseline : True to subtract the baseline from
+     * the channel header
+     * \param [in] baselineOffset : a constant subtracted from every energy */
+    EnergySumAnalyzer(const bool &useOnboardBaseline = true,
+                      const double &baselineOffset = 0.0);
+
+    /** Default Destructor */
+    virtual ~EnergySumAnalyzer(){};
+
+    /** The sums do not come from the trace, channels are handled by
+     * CalcEnergy instead.
+     * \param [in] trace : the trace
+     * \param [in] type : the detector type
+     * \param [in] subtype : the detector subtype
+     * \param [in] tagmap : map of the tags for the channel */
+    virtual void Analyze(Trace &trace, const std::string &type,
+                         const std::string &subtype,
+                         const std::map<std::string,int> &tagmap) {};
+
+    /** Reconstruct the energy of a channel from its onboard sums
+     * \param [in] chan : the channel, which has to carry the sums
+     * \param [in] type : the detector type
+     * \param [in] subtype : the detector subtype
+     * \return the energy in the units of the filter output */
+    double CalcEnergy(const ChanEvent &chan, const std::string &type,
+                      const std::string &subtype);
+
+    /** Drop the cached coefficients, they are recalculated from the reloaded
+     * trapezoidal filter parameters
+     * \param [in] xml : The freshly parsed configuration file
+     * \return True */
+    virtual bool Reload(const XmlConfiguration &xml) {
+        coeffs_.clear();
+        return(true);
+    }
+private:
+    /** Calculate the filter coefficients for a type:subtype
+     * \param [in] key : the type:subtype
+     * \return the coefficients for the trailing, gap and leading sums */
+    std::vector<double> CalcCoefficients(const std::string &key);
+
+    bool useOnboardBaseline_; //!< True if the onboard baseline is subtracted
+    double baselineOffset_; //!< Constant subtracted from every energy
+    std::map<std::string, std::vector<double> > coeffs_; //!< coefficients for each type:subtype
+};
+#endif // __ENERGYSUMANALYZER_HPP__
@@ -12,6 +12,8 @@
 #include "Plots.hpp"
 #include "Trace.hpp"
 
+class XmlConfiguration;
+
 ///Abstract class that all trace analyzers are derived from
 class TraceAnalyzer {
 public:
@@ -40,6 +42,14 @@ public:
     virtual void Analyze(Trace &trace, const std::string &type,
                          const std::string &subtype,
                          const std::map<std::string, int> & tagMap);
+    /** Forget the parameters that were cached from the configuration, called
+     * between two events when the configuration is reloaded during a scan.
+     * \param [in] xml : The freshly parsed configuration file
+     * \return True if any parameters were reloaded */
+    virtual bool Reload(const XmlConfiguration &xml) {return(false);};
+    /** \return True if the analyzer sets the energy of the channel, such
+     * analyzers are kept when the trace analysis is shed */
+    virtual bool DefinesEnergy(void) const {return(false);};
     /** End the analysis and record the analyzer level in the trace
      * \param [in] trace : the trace */
     void EndAnalyze(Trace &trace);
@@ -50,8 +60,20 @@ public:
     void SetLevel(int i) {level=i;}
     /** \return the level of the trace analysis */
     int  GetLevel() {return level;}
+    /** \return the name of the analyzer */
+    const std::string &GetName() const {return name;}
+    /** Set the channel of the traces given to Analyze, used to tell where
+     * the errors counted in the Diagnostics came from.
+     * \param [in] mod : the module number, -1 if it is not known
+     * \param [in] chan : the channel number, -1 if it is not known */
+    void SetChannel(const int &mod, const int &chan) {
+        modNum = mod;
+        chanNum = chan;
+    }
 protected:
     int level;                ///< the level of analysis to proceed with
+    int modNum;               ///< the module of the trace being analyzed
+    int chanNum;              ///< the channel of the trace being analyzed
     static int numTracesAnalyzed;    ///< rownumber for DAMM spectrum 850
     std::string name;         ///< name of the analyzer
 private:
@@ -30,22 +30,43 @@
 #include <vector>
 #include <utility>
 
-#include "Trace.hpp"
 #include "TrapFilterParameters.hpp"
 
-/*! The class to perform the filtering */
+/*! The class to perform the filtering
+ *
+ * The trigger and energy filters are computed for every sample of the trace
+ * in a single pass using running sums of the trace, so the cost of the
+ * filtering does not depend on the filter lengths or on the number of pulses.
+ * The energy of a pulse is the value of the energy filter at its trigger,
+ * only the first trigger is used unless pileups are analyzed. Pulses whose
+ * energy sums overlap with another pulse are flagged as piled up. The buffers are kept between
+ * calls so one filter can be reused for many traces. */
 class TraceFilter {
 public:
+    ///Flags that describe the quality of a single pulse
+    enum PulseFlags {
+        PULSE_OK = 0, //!< The energy sums are complete and undisturbed
+        PULSE_EARLY = 1, //!< The energy sums start before the trace
+        PULSE_LATE = 2, //!< The energy sums end after the trace
+        PULSE_PILEUP = 4 //!< Another pulse is inside the energy sums
+    };
+
     /** Default Constructor */
-    TraceFilter(){};
+    TraceFilter() : isVerbose_(false), isConverted_(false),
+                    analyzePileup_(false) {};
     /** Constructor 
      * \param [in] nsPerSample : The ns/Sample for the ADC */
-    TraceFilter(const int &nsPerSample){nsPerSample_ = nsPerSample;}
+    TraceFilter(const int &nsPerSample) : isVerbose_(false),
+                                          isConverted_(false),
+                                          analyzePileup_(false) {
+        nsPerSample_ = nsPerSample;
+    }
     /** Constructor 
      * \param [in] nsPerSample : The ns/Sample for the ADC 
      * \param [in] tFilt : Parameters for the trigger filter
      * \param [in] eFilt : Paramters for the energy filter
-     * \param [in] analyzePileup : True if we want additional analysis for pileups. 
+     * \param [in] analyzePileup : True to calculate the energy of every
+     *     pulse in the trace, otherwise only the first pulse is used.
      * \param [in] verbose : true if we want verbose output from the filter */
     TraceFilter(const unsigned int &nsPerSample, 
                 const TrapFilterParameters &tFilt,
@@ -61,12 +82,17 @@ public:
     /** \return the average value of the baseline */
     double GetBaseline(void){return(baseline_);}
     /** \return The energy calculated from the first trigger. */
-    double GetEnergy(void){return(en_[0]);}
+    double GetEnergy(void){return(en_.empty() ? 0.0 : en_[0]);}
 
     /** This is the main method that will be used to calculate the filters and 
      * other necessary information. 
-     * \param [in] sig : The trace that we are going to be filtering  */
-    unsigned int CalcFilters(const Trace *sig);
+     * \param [in] sig : The trace that we are going to be filtering
+     * \param [in] mod : The module of the trace, for the Diagnostics
+     * \param [in] chan : The channel of the trace, for the Diagnostics
+     * \return 0 on success or one of the ErrTypes describing why the energy
+     *     of the first pulse could not be calculated */
+    unsigned int CalcFilters(const std::vector<int> *sig, const int &mod = -1,
+                             const int &chan = -1);
     /** \return The number of triggers that were found */
     unsigned int GetNumTriggers(void) {return(trigs_.size());}
     /** \return The position in the trace of the first trigger found by the trigger 
@@ -74,29 +100,29 @@ public:
     unsigned int GetTrigger(void){return(trigs_[0]);}
 
     /** \return The trigger filter */
-    std::vector<double> GetTriggerFilter(void) {return(trigFilter_);}
-    /** \return The list of energies that were found if we chose to analyze 
-     * pileup events. */
-    std::vector<double> GetEnergies(void){return(en_);}
-    /** There will be three coefficients per identified trigger if we chose to 
-     * analyze pileups. This means the first three elements belong to the first 
-     * trigger, the next three to the second trigger, etc. The size will always 
-     * be 3*NumTriggers.
-     *  \return The list of energy filter coefficients.  */
-    std::vector<double> GetEnergyFilterCoefficients(void) {return(coeffs_);}
-    /** There will be three energy sums per identified trigger if we chose to 
-     * analyze pileups. This means the first three elements belong to the first 
-     * trigger, the next three to the second trigger, etc. The size will always 
-     * be 3*NumTriggers.
-     *  \return The list of energy filter coefficients.  */
-    std::vector<double> GetEnergySums(void) {return(esums_);}
+    const std::vector<double> &GetTriggerFilter(void) {return(trigFilter_);}
+    /** \return The energy filter, the baseline is not subtracted and
+     *     samples where the sums do not fit in the trace are zero. */
+    const std::vector<double> &GetEnergyFilter(void) {return(enFilter_);}
+    /** \return The energies of the pulses in the trace, pulses whose sums
+     *     do not fit in the trace have zero energy. Only the first pulse is
+     *     included unless pileups are analyzed. */
+    const std::vector<double> &GetEnergies(void){return(en_);}
+    /** \return The PulseFlags of the pulses in GetEnergies */
+    const std::vector<unsigned int> &GetPulseFlags(void){return(flags_);}
+    /** \return The three energy filter coefficients (rise, gap, fall) */
+    const std::vector<double> &GetEnergyFilterCoefficients(void) {return(coeffs_);}
+    /** There are three energy sums per pulse in GetEnergies. This means the
+     * first three elements belong to the first trigger, the next three to
+     * the second trigger, etc.
+     *  \return The list of energy sums.  */
+    const std::vector<double> &GetEnergySums(void) {return(esums_);}
 
     /** \return List of the triggers found in the trace.*/
-    std::vector<unsigned int> GetTriggers(void){return(trigs_);}
-    /** This will always have 6 elements. If analyzing pileups it will be the 
-     * limits for the last identified pileup. 
+    const std::vector<unsigned int> &GetTriggers(void){return(trigs_);}
+    /** This will always have 6 elements, the limits for the first trigger.
      *  \return List of the limits for the energy sums */
-    std::vector<unsigned int> GetEnergySumLimits(void){return(limits_);}
+    const std::vector<unsigned int> &GetEnergySumLimits(void){return(limits_);}
 
     /** Sets the value of the ns/Sample for the ADC */
     void SetAdcSample(const double &a){nsPerSample_ = a;}
@@ -106,7 +132,7 @@ public:
         ConvertToClockticks();
     }
     /** Sets the trace that we are going to use to filter */
-    void SetSig(const Trace *sig){sig_ = sig;}
+    void SetSig(const std::vector<int> *sig){sig_ = sig;}
     /** Sets the trapezoidal filter parameters for the trigger (fast) filter */
     void SetTriggerParams(const TrapFilterParameters &a) {
         t_ = a;
@@ -118,7 +144,7 @@ public:
 private:
     bool isVerbose_; //!< True if we want verbose output
     bool isConverted_; //!< True if Filter Pars converted to clockticks
-    bool analyzePileup_; //!< True if we want to analyze pileups
+    bool analyzePileup_; //!< True if every pulse in the trace is analyzed
 
     double baseline_; //!< the value of the baseline of the trace
 
@@ -130,22 +156,45 @@ private:
     
     unsigned int nsPerSample_; //!< The number of ns per sample
 
-    const Trace *sig_; //!< the signal to filter
+    const std::vector<int> *sig_; //!< the signal to filter
 
+    std::vector<double> sums_; //!< running sums of the signal, sums_[i] = sig[0]+...+sig[i-1]
     std::vector<double> en_; //!< the calculated energies
     std::vector<double> coeffs_; //!< the calculated energy coefficients
     std::vector<double> trigFilter_; //!< the calculated trigger filter
+    std::vector<double> enFilter_; //!< the calculated energy filter
     std::vector<double> esums_; //!< the caluclated energy sums
     
     std::vector<unsigned int> limits_; //!< the limits for the energy filter
     std::vector<unsigned int> trigs_; //!< the identified triggers
+    std::vector<unsigned int> flags_; //!< the PulseFlags of each trigger
+
+    /** \return the sum of the signal in [low, high), zero if the range is empty
+     * \param [in] low : the first sample of the sum
+     * \param [in] high : one past the last sample of the sum */
+    double Sum(const unsigned int &low, const unsigned int &high) {
+        return(high > low ? sums_[high] - sums_[low] : 0.0);
+    }
 
-    void CalcBaseline(void); //!< calculates the baseline
-    void CalcEnergyFilterCoeffs(void); //!< calculates energy filter coeffs
-    void CalcEnergyFilterLimits(const unsigned int &tpos); //!< calc energy filter limits
-    void CalcEnergyFilter(void); //!< calculate the energy filter
-    void CalcTriggerFilter(void); //!< calculate trigger filter
+    unsigned int CalcBaseline(void); //!< calculates the baseline
+    unsigned int CalcEnergyFilterCoeffs(void); //!< calculates energy filter coeffs
+    /** calc energy filter limits for a trigger
+     * \param [in] tpos : the position of the trigger
+     * \param [out] lim : the six limits of the energy sums
+     * \return PULSE_OK, PULSE_EARLY or PULSE_LATE */
+    unsigned int CalcEnergyFilterLimits(const unsigned int &tpos,
+                                        unsigned int *lim);
+    void CalcFilterPass(void); //!< calculate both filters and find the triggers
+    void CalcPulses(void); //!< calculate the energy and flags of the pulses
     void ConvertToClockticks(void); //!< convert from ns to clockticks
+    /** Count an error code in the Diagnostics, the first few are kept with
+     * their explanation
+     * \param [in] errcode : the code to explain
+     * \param [in] mod : the module of the trace
+     * \param [in] chan : the channel of the trace
+     * \return the error code */
+    unsigned int Explain(const unsigned int &errcode, const int &mod,
+                         const int &chan);
     void Reset(void); //!< Reset values for repeated calls. 
 };
 #endif //__TRACEFILTER_HPP__
@@ -7,22 +7,28 @@
 #ifndef __TRACEFILTERANALYZER_HPP__
 #define __TRACEFILTERANALYZER_HPP__
 
+#include <map>
 #include <string>
 #include <vector>
 
 #include "Trace.hpp"
 #include "TraceAnalyzer.hpp"
+#include "TraceFilter.hpp"
 #include "TrapFilterParameters.hpp"
 
 //! \brief A class to perform trapezoidal filters on the traces
 class TraceFilterAnalyzer : public TraceAnalyzer {
 public:
     /** Default Constructor */
-    TraceFilterAnalyzer(){};
+    TraceFilterAnalyzer() : analyzePileup_(false),
+                            useFilterEnergy_(false) {};
 
     /** Constructor 
-     * \param [in] analyzePileup : True if we want to analyze pileups */
-    TraceFilterAnalyzer(const bool &analyzePileup);
+     * \param [in] analyzePileup : True if we want to analyze pileups
+     * \param [in] useFilterEnergy : True if the energy of the trace filter
+     *     replaces the onboard energy of the channel */
+    TraceFilterAnalyzer(const bool &analyzePileup,
+                        const bool &useFilterEnergy = false);
 
     /** Default Destructor */
     virtual ~TraceFilterAnalyzer(){};
@@ -38,12 +44,26 @@ public:
     virtual void Analyze(Trace &trace, const std::string &type,
                          const std::string &subtype,
                          const std::map<std::string,int> &tagmap);
+
+    /** Drop the cached filters, they are rebuilt from the reloaded trapezoidal
+     * filter parameters
+     * \param [in] xml : The freshly parsed configuration file
+     * \return True */
+    virtual bool Reload(const XmlConfiguration &xml) {
+        filters_.clear();
+        return(true);
+    }
+
+    /** \return True if the filter energy replaces the onboard energy */
+    virtual bool DefinesEnergy(void) const {return(useFilterEnergy_);}
 private:
     bool analyzePileup_; //!< True if looking for pileups
+    bool useFilterEnergy_; //!< True if filterEnergy is recorded in the trace
     TrapFilterParameters trigPars_; //!< Trigger filter parameters
     TrapFilterParameters enPars_; //!< energy filter parametersf
     std::vector<double> fastFilter;   //!< fast filter of trace
     std::vector<double> energyFilter; //!< slow filter of trace
+    std::map<std::string, TraceFilter> filters_; //!< filters for each type:subtype
 
 };
 #endif // __TRACEFILTERER_HPP_
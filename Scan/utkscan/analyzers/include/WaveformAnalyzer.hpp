@@ -6,7 +6,6 @@
 #define __WAVEFORMANALYZER_HPP_
 
 #include "Globals.hpp"
-#include "Messenger.hpp"
 #include "Trace.hpp"
 #include "TraceAnalyzer.hpp"
 
@@ -35,7 +34,6 @@ private:
 
     double mean_; //!< The mean of the baseline
     unsigned int mval_; //!< the maximum value in the trace
-    Messenger *messenger_;//!< A pointer for the messenger class
     Globals *g_; //!< A pointer to the globals class for the class
     std::pair<Trace::iterator, Trace::iterator> waverng_; //!< the waveform
 //!< range
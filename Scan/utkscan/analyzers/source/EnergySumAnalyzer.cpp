@@ -0,0 +1,61 @@
+/** \file EnergySumAnalyzer.cpp
+ * \brief Reconstructs energies from the onboard energy filter sums
+ * \date Oct. 19th, 2026
+ */
+#include <cmath>
+
+#include "EnergySumAnalyzer.hpp"
+#include "Globals.hpp"
+
+using namespace std;
+
+EnergySumAnalyzer::EnergySumAnalyzer(const bool &useOnboardBaseline,
+                                     const double &baselineOffset) :
+    TraceAnalyzer() {
+    useOnboardBaseline_ = useOnboardBaseline;
+    baselineOffset_ = baselineOffset;
+    name = "EnergySumAnalyzer";
+}
+
+double EnergySumAnalyzer::CalcEnergy(const ChanEvent &chan,
+                                     const std::string &type,
+                                     const std::string &subtype) {
+    string key = type + ":" + subtype;
+    map<string, vector<double> >::iterator it = coeffs_.find(key);
+    if(it == coeffs_.end())
+        it = coeffs_.insert(make_pair(key, CalcCoefficients(key))).first;
+    const vector<double> &c = it->second;
+
+    double energy = c[0] * chan.GetEnergySum(XiaData::TRAILING_SUM) +
+        c[1] * chan.GetEnergySum(XiaData::GAP_SUM) +
+        c[2] * chan.GetEnergySum(XiaData::LEADING_SUM) - baselineOffset_;
+    if(useOnboardBaseline_)
+        energy -= chan.GetEnergySumBaseline();
+    return(energy);
+}
+
+vector<double> EnergySumAnalyzer::CalcCoefficients(const std::string &key) {
+    TrapFilterParameters pars = Globals::get()->trapFiltPars(key).second;
+    //The sums are accumulated in filter clock ticks
+    double nsPerTick = Globals::get()->filterClockInSeconds() * 1e9;
+    double l = ceil(pars.GetRisetime() / nsPerTick);
+    if(l < 1)
+        l = 1;
+
+    vector<double> coeffs(3);
+    //Without a decay to correct for the filter is a plain trapezoid
+    if(pars.GetT() <= 0) {
+        coeffs[0] = -1 / l;
+        coeffs[1] = 0;
+        coeffs[2] = 1 / l;
+        return(coeffs);
+    }
+
+    double beta = exp(-nsPerTick / pars.GetT());
+    double cg = 1 - beta;
+    double ctmp = 1 - pow(beta, l);
+    coeffs[0] = -(cg / ctmp) * pow(beta, l);
+    coeffs[1] = cg;
+    coeffs[2] = cg / ctmp;
+    return(coeffs);
+}
@@ -25,7 +25,8 @@ int TraceAnalyzer::numTracesAnalyzed = 0; //!< number of analyzed traces
 
 using namespace dammIds::trace;
 
-TraceAnalyzer::TraceAnalyzer() : userTime(0.), systemTime(0.) {
+TraceAnalyzer::TraceAnalyzer() : modNum(-1), chanNum(-1), userTime(0.),
+                                 systemTime(0.) {
     name = "Trace";
     // start at -1 so that when incremented on first trace analysis,
     //   row 0 is respectively filled in the trace spectrum of inheritees
@@ -34,6 +34,7 @@
 
 #include <cmath>
 
+#include "Diagnostics.hpp"
 #include "TraceFilter.hpp"
 
 using namespace std;
@@ -46,98 +47,142 @@ TraceFilter::TraceFilter(const unsigned int &adc,
     e_ = eFilt;
     t_ = tFilt;
     nsPerSample_ = adc;
+    isConverted_ = false;
     isVerbose_ = verbose;
     analyzePileup_ = analyzePileup;
 }
 
-void TraceFilter::CalcBaseline(void) {
-    double l = t_.GetRisetime();
-    int offset = trigs_[0] - l - 5;
+unsigned int TraceFilter::CalcBaseline(void) {
+    int offset = trigs_[0] - t_.GetRisetime() - 5;
 
-    if(offset < 0)
-        throw(EARLY_TRIG);
+    if(offset <= 0)
+        return(EARLY_TRIG);
     
-    for(unsigned int i = 0; i < (unsigned int) offset; i++)
-        baseline_ += sig_->at(i);
-    baseline_ /= offset;
+    baseline_ = Sum(0, offset) / offset;
     
     if(isVerbose_) 
         cout << "********** CalcBaseline **********" << endl
              << "  Range:" << " Low = 0  High = " << offset << endl
              << "  Value: " << baseline_ << endl << endl;
+    return(0);
 }
 
-unsigned int TraceFilter::CalcFilters(const Trace *sig) {
-    try{
-        Reset();
-        sig_ = sig;
+unsigned int TraceFilter::CalcFilters(const std::vector<int> *sig,
+                                      const int &mod, const int &chan) {
+    Reset();
+    sig_ = sig;
         
-        if(!isConverted_)
-            ConvertToClockticks();
-        CalcTriggerFilter();
-        CalcBaseline();
-        CalcEnergyFilterCoeffs();
-
-        for(vector<unsigned int>::iterator it = trigs_.begin(); it!= trigs_.end(); it++) {
-            CalcEnergyFilterLimits((*it));
-            CalcEnergyFilter();
-            
-            if(!analyzePileup_)
-                break;                
-        }
-    } catch(ErrTypes errcode) {
-        switch(errcode) {
-        case(NO_TRIG) :
-            cerr << "We could not find a trigger in the trace." << endl;
-            break;
-        case(LATE_TRIG) :
-            cerr << "The trigger came too late in the trace! I cannnot perform "
-                 << "the sums over the necessary ranges, giving zero energy!!"
-                 << endl;
-            break;
-        case(EARLY_TRIG) :
-            cerr << "The trigger was too early. Could not calculate baseline "
-                 << "or Energy Filter Limits." << endl;
-            break;
-        case(BAD_FILTER_COEFF):
-            cerr << "One of the energy filter coefficients was nan." << endl;
-            break;
-        case(BAD_FILTER_LIMITS):
-            cerr << "The Energy filter was too long for the trace." << endl;
-            break;
-        }
+    if(!isConverted_)
+        ConvertToClockticks();
+    unsigned int coeffErr = CalcEnergyFilterCoeffs();
+    CalcFilterPass();
+
+    if(trigs_.empty())
+        return(Explain(NO_TRIG, mod, chan));
+    unsigned int retval = CalcBaseline();
+    if(retval != 0)
+        return(Explain(retval, mod, chan));
+    if(coeffErr != 0)
+        return(Explain(coeffErr, mod, chan));
+
+    CalcPulses();
+    if(flags_[0] & PULSE_EARLY)
+        return(Explain(EARLY_TRIG, mod, chan));
+    if(flags_[0] & PULSE_LATE)
+        return(Explain(LATE_TRIG, mod, chan));
+    return(0);
+}
+
+unsigned int TraceFilter::Explain(const unsigned int &errcode,
+                                  const int &mod, const int &chan) {
+    //The errors are counted rather than printed, a bad channel would
+    // otherwise print for every trace.
+    static const unsigned int codes[] = {
+        Diagnostics::get()->Register("trace filter: no trigger"),
+        Diagnostics::get()->Register("trace filter: early trigger"),
+        Diagnostics::get()->Register("trace filter: late trigger"),
+        Diagnostics::get()->Register("trace filter: bad coefficient"),
+        Diagnostics::get()->Register("trace filter: bad limits")
+    };
+    if(errcode < NO_TRIG || errcode > BAD_FILTER_LIMITS)
+        return(errcode);
+
+    unsigned int code = codes[errcode - NO_TRIG];
+    if(!Diagnostics::get()->Count(code, mod, chan))
         return(errcode);
+
+    switch(errcode) {
+    case(NO_TRIG) :
+        Diagnostics::get()->Sample(code, mod, chan, "We could not find a trigger "
+                                   "in the trace.");
+        break;
+    case(LATE_TRIG) :
+        Diagnostics::get()->Sample(code, mod, chan, "The trigger came too late "
+                                   "in the trace! I cannnot perform the sums "
+                                   "over the necessary ranges, giving zero "
+                                   "energy!!");
+        break;
+    case(EARLY_TRIG) :
+        Diagnostics::get()->Sample(code, mod, chan, "The trigger was too early. "
+                                   "Could not calculate baseline or Energy "
+                                   "Filter Limits.");
+        break;
+    case(BAD_FILTER_COEFF):
+        Diagnostics::get()->Sample(code, mod, chan, "One of the energy filter "
+                                   "coefficients was nan.");
+        break;
+    case(BAD_FILTER_LIMITS):
+        Diagnostics::get()->Sample(code, mod, chan, "The Energy filter was too "
+                                   "long for the trace.");
+        break;
     }
-    return(0);
+    return(errcode);
 }
 
-void TraceFilter::CalcEnergyFilter(void) {
-    double partA = 0, partB = 0, partC = 0;
+void TraceFilter::CalcPulses(void) {
+    unsigned int lim[6];
+    double el = e_.GetRisetime(), eg = e_.GetFlattop();
+    unsigned int numPulses = analyzePileup_ ? trigs_.size() : 1;
 
-    for(unsigned int i = limits_[0]; i < limits_[1]; i++)
-        partA += sig_->at(i);
-    for(unsigned int i = limits_[2]; i < limits_[3]; i++)
-        partB += sig_->at(i);
-    for(unsigned int i = limits_[4]; i < limits_[5]; i++)
-        partC += sig_->at(i);
-    esums_.push_back(partA);
-    esums_.push_back(partB);
-    esums_.push_back(partC);
+    for(unsigned int i = 0; i < numPulses; i++) {
+        unsigned int flag = CalcEnergyFilterLimits(trigs_[i], lim);
 
-    en_.push_back(coeffs_[0]*partA + coeffs_[1]*partB + coeffs_[2]*partC - baseline_);
-    if(isVerbose_)
-        cout << "********** CalcEnergyFilter **********" << endl
-             << "Calculated Energy : " << en_.back() << endl << endl;
+        //Another pulse rising inside of the sums distorts the energy
+        if(i > 0 && trigs_[i-1] + el + 10 >= trigs_[i])
+            flag |= PULSE_PILEUP;
+        if(i + 1 < trigs_.size() && trigs_[i+1] < trigs_[i] + el + eg)
+            flag |= PULSE_PILEUP;
+        flags_.push_back(flag);
+
+        if(flag & (PULSE_EARLY | PULSE_LATE)) {
+            esums_.insert(esums_.end(), 3, 0.0);
+            en_.push_back(0.0);
+            continue;
+        }
+
+        if(i == 0)
+            limits_.assign(lim, lim + 6);
+        esums_.push_back(Sum(lim[0], lim[1]));
+        esums_.push_back(Sum(lim[2], lim[3]));
+        esums_.push_back(Sum(lim[4], lim[5]));
+        en_.push_back(enFilter_[trigs_[i]] - baseline_);
+
+        if(isVerbose_)
+            cout << "********** CalcEnergyFilter **********" << endl
+                 << "Calculated Energy : " << en_.back() << endl
+                 << "Pileup : " << ((flag & PULSE_PILEUP) != 0) << endl
+                 << endl;
+    }
 }
 
-void TraceFilter::CalcEnergyFilterCoeffs(void) {
+unsigned int TraceFilter::CalcEnergyFilterCoeffs(void) {
     double l = e_.GetRisetime();
     double beta = exp(-1.0/ e_.GetT());
     double cg = 1-beta;
     double ctmp = 1-pow(beta,l);
 
     if(std::isnan(beta) || std::isnan(cg) || std::isnan(ctmp))
-        throw(BAD_FILTER_COEFF);
+        return(BAD_FILTER_COEFF);
     
     coeffs_.push_back(-(cg/ctmp)*pow(beta,l));
     coeffs_.push_back(cg);
@@ -149,13 +194,14 @@ void TraceFilter::CalcEnergyFilterCoeffs(void) {
              << "  CRise : " << coeffs_[0] << endl
              << "  CGap  : " << coeffs_[1] << endl
              << "  CFall : " << coeffs_[2] << endl << endl;
+    return(0);
 }
 
-void TraceFilter::CalcEnergyFilterLimits(const unsigned int &tpos) {
-    limits_.clear();
+unsigned int TraceFilter::CalcEnergyFilterLimits(const unsigned int &tpos,
+                                                 unsigned int *lim) {
     double l = e_.GetRisetime(), g = e_.GetFlattop();
 
-    double p0 = tpos - l - 10;
+    double p0 = (double)tpos - l - 10;
     double p1 = p0 +l - 1;
     double p2 = p0 +l;
     double p3 = p0 + l + g - 1;
@@ -164,10 +210,10 @@ void TraceFilter::CalcEnergyFilterLimits(const unsigned int &tpos) {
     double p7 = tpos + l + g;
 
     if(p0 < 0)
-        throw(EARLY_TRIG);
+        return(PULSE_EARLY);
     
     if(p7 > sig_->size())
-        throw(LATE_TRIG);
+        return(PULSE_LATE);
         
     if(isVerbose_)
         cout << "********** CalcEnergyFilterLimits **********" << endl
@@ -176,47 +222,62 @@ void TraceFilter::CalcEnergyFilterLimits(const unsigned int &tpos) {
              << "  Gap Sum  : Low = " << p2 << " High = " << p3 << endl
              << "  Fall Sum : Low = " << p4 << " High = " << p5 << endl << endl;
     
-    limits_.push_back(p0);      // beginning of  sum E0
-    limits_.push_back(p1);      // end of sum E0
-    limits_.push_back(p2);      // beginning of gap sum
-    limits_.push_back(p3);      // end of gap sum
-    limits_.push_back(p4);      // beginning of sum E1
-    limits_.push_back(p5);      // end of sum E1
+    lim[0] = p0;      // beginning of  sum E0
+    lim[1] = p1;      // end of sum E0
+    lim[2] = p2;      // beginning of gap sum
+    lim[3] = p3;      // end of gap sum
+    lim[4] = p4;      // beginning of sum E1
+    lim[5] = p5;      // end of sum E1
+    return(PULSE_OK);
 }
 
-void TraceFilter::CalcTriggerFilter(void) {
+void TraceFilter::CalcFilterPass(void) {
     bool hasRecrossed = false;
+    unsigned int n = sig_->size();
 
-    int l = t_.GetRisetime(), g = t_.GetFlattop();
-    for(int i = 0; i < (int)sig_->size(); i++) {
-        double sum1 = 0, sum2 = 0;
-        if( (i-2*l-g+1) >= 0 ) {
-            for(int a = i-2*l-g+1; a < i-l-g+1; a++)
-                sum1 += sig_->at(a);
-            for(int a = i-l+1; a < i+1; a++)
-                sum2 += sig_->at(a);
-            
-            if((sum2 - sum1)/l >= t_.GetT()) {
+    sums_.resize(n + 1);
+    trigFilter_.assign(n, 0.0);
+    enFilter_.assign(n, 0.0);
+
+    //Trigger filter: sample j is the end of the second sum.
+    unsigned int l = t_.GetRisetime(), g = t_.GetFlattop();
+    double thresh = t_.GetT();
+    //Energy filter: the value at sample i is complete once sample
+    // i + el + eg - 1 has been added, the sums start at i - el - 10.
+    unsigned int el = e_.GetRisetime(), eg = e_.GetFlattop();
+    unsigned int enDelay = el + eg;
+    bool hasEnergy = coeffs_.size() == 3 && el > 0;
+
+    sums_[0] = 0;
+    for(unsigned int j = 0; j < n; j++) {
+        sums_[j+1] = sums_[j] + (*sig_)[j];
+
+        if(l > 0 && j + 1 >= 2*l + g) {
+            double val = (Sum(j-l+1, j+1) - Sum(j+1-2*l-g, j+1-l-g)) / l;
+            if(val >= thresh) {
                 if(trigs_.size() == 0) 
-                    trigs_.push_back(i);
+                    trigs_.push_back(j);
                 if(hasRecrossed) {
-                    trigs_.push_back(i);
+                    trigs_.push_back(j);
                     hasRecrossed = false;
                 }
-            }else {
-                if(trigs_.size() != 0)
-                    hasRecrossed = true;
-            }
-            
-            trigFilter_.push_back((sum2 - sum1)/l);
-        } else
-            trigFilter_.push_back(0.0);
+            } else if(trigs_.size() != 0)
+                hasRecrossed = true;
+            trigFilter_[j] = val;
+        }
+
+        if(hasEnergy && j + 1 >= enDelay + el + 10) {
+            unsigned int i = j + 1 - enDelay;
+            unsigned int p0 = i - el - 10;
+            double partA = Sum(p0, p0 + el - 1);
+            double partB = Sum(p0 + el, p0 + el + eg - 1);
+            double partC = Sum(p0 + el + eg, p0 + 2*el + eg - 1);
+            enFilter_[i] = coeffs_[0]*partA + coeffs_[1]*partB +
+                coeffs_[2]*partC;
+        }
     }
 
-    if(trigs_.size() == 0)
-        throw(NO_TRIG);
-    
-    if(isVerbose_ ) {
+    if(isVerbose_ && !trigs_.empty()) {
         cout << "********** CalcTriggerFilter **********" << endl;
         cout << "The First Trigger Position : " << trigs_[0] << endl;
         if(trigs_.size() > 1)
@@ -276,8 +337,12 @@ void TraceFilter::ConvertToClockticks(void) {
 
 void TraceFilter::Reset(void) {
     en_.clear();
+    coeffs_.clear();
+    esums_.clear();
     baseline_ = 0;
     trigFilter_.clear();
+    enFilter_.clear();
     trigs_.clear();
+    flags_.clear();
     limits_.clear();
 }
@@ -14,9 +14,11 @@
 using namespace std;
 using namespace dammIds::trace::tracefilteranalyzer;
 
-TraceFilterAnalyzer::TraceFilterAnalyzer(const bool &analyzePileup) :
+TraceFilterAnalyzer::TraceFilterAnalyzer(const bool &analyzePileup,
+                                         const bool &useFilterEnergy) :
     TraceAnalyzer() {
     analyzePileup_ = analyzePileup;
+    useFilterEnergy_ = useFilterEnergy;
     name = "TraceFilterAnalyzer";
 }
 
@@ -46,13 +48,19 @@ void TraceFilterAnalyzer::Analyze(Trace &trace, const std::string &type,
     static int numPileup = 0;
     static unsigned short numTraces = globs->numTraces();
 
-    pair<TrapFilterParameters, TrapFilterParameters> pars =
-	globs->trapFiltPars(type+":"+subtype);
-
-    //Want to put filter clock units of ns/Sample
-    TraceFilter filter(globs->filterClockInSeconds()*1e9,
-		       pars.first, pars.second, analyzePileup_);
-    unsigned int retval = filter.CalcFilters(&trace);
+    //One filter per detector type keeps its buffers between traces
+    string key = type + ":" + subtype;
+    map<string, TraceFilter>::iterator it = filters_.find(key);
+    if(it == filters_.end()) {
+        pair<TrapFilterParameters, TrapFilterParameters> pars =
+            globs->trapFiltPars(key);
+        //Want to put filter clock units of ns/Sample
+        it = filters_.insert(make_pair(key,
+             TraceFilter(globs->filterClockInSeconds()*1e9,
+                         pars.first, pars.second, analyzePileup_))).first;
+    }
+    TraceFilter &filter = it->second;
+    unsigned int retval = filter.CalcFilters(&trace, modNum, chanNum);
     
     //if retval != 0 there was a problem and we should look at the trace
     if(retval != 0) {
@@ -61,7 +69,7 @@ void TraceFilterAnalyzer::Analyze(Trace &trace, const std::string &type,
             trace.Plot(DD_REJECTED_TRACE, numRejected++);
     }
     
-    vector<double> tfilt = filter.GetTriggerFilter();
+    const vector<double> &tfilt = filter.GetTriggerFilter();
     trace.SetTriggerFilter(tfilt);
     trace.SetValue("numTriggers", (int)filter.GetNumTriggers());
 
@@ -70,7 +78,7 @@ void TraceFilterAnalyzer::Analyze(Trace &trace, const std::string &type,
 	trace.Plot(DD_PILEUP,numPileup++);
 
     //We will record in the trace all triggers that were found. 
-    vector<unsigned int> trigs = filter.GetTriggers();
+    const vector<unsigned int> &trigs = filter.GetTriggers();
     stringstream ss;
     for(unsigned int i = 0; i < trigs.size(); i++) {
 	ss << "triggerPosition" << i;
@@ -78,21 +86,34 @@ void TraceFilterAnalyzer::Analyze(Trace &trace, const std::string &type,
 	ss.str("");
     }
 
-    //We will record all the energies that were recorded
-    vector<double> energies = filter.GetEnergies();
-    for(unsigned int i = 0; i < trigs.size(); i++) {
-	ss << "filterEnergy" << i;
-	trace.SetValue(ss.str(), (int)trigs[i]);
-	ss.str("");
+    //The pulses are recorded as filterEnergy, filterTime, filterEnergy2,
+    // filterTime2, ... for the processors that handle pileups. The
+    // DetectorDriver takes the energy of the channel from filterEnergy, so
+    // the pulses are only recorded when asked for.
+    if(retval == 0 && useFilterEnergy_) {
+        const vector<double> &energies = filter.GetEnergies();
+        const vector<unsigned int> &flags = filter.GetPulseFlags();
+        trace.SetValue("numPulses", (int)energies.size());
+        for(unsigned int i = 0; i < energies.size(); i++) {
+            string suffix;
+            if(i > 0) {
+                ss << i + 1;
+                suffix = ss.str();
+                ss.str("");
+            }
+            trace.SetValue("filterEnergy" + suffix, energies[i]);
+            trace.SetValue("filterTime" + suffix, (int)trigs[i]);
+            trace.SetValue("filterFlags" + suffix, (int)flags[i]);
+        }
     }
     
     trace.SetValue("baseline", filter.GetBaseline());
     trace.SetEnergySums(filter.GetEnergySums());
     
     //500 is an arbitrary offset since DAMM cannot display negative numbers.
-    for(vector<double>::iterator it = tfilt.begin(); it != tfilt.end(); it++)
-	trace.plot(DD_TRIGGER_FILTER, (int)(it-tfilt.begin()),
-		   numTrigFilters, (*it)+500);
+    for(vector<double>::const_iterator val = tfilt.begin(); val != tfilt.end(); val++)
+	trace.plot(DD_TRIGGER_FILTER, (int)(val-tfilt.begin()),
+		   numTrigFilters, (*val)+500);
     numTrigFilters++;
    
     EndAnalyze(trace);
@@ -12,6 +12,7 @@
 
 #include <cmath>
 
+#include "Diagnostics.hpp"
 #include "WaveformAnalyzer.hpp"
 
 using namespace std;
@@ -22,9 +23,16 @@ enum WAVEFORMANALYZER_ERROR_CODES{
     LOW_GREATER_HIGH
 };
 
+//! The codes of the errors in the Diagnostics, in the order of the enum
+static const unsigned int diagCodes[] = {
+    Diagnostics::get()->Register("waveform: low bound before trace"),
+    Diagnostics::get()->Register("waveform: range outside trace"),
+    Diagnostics::get()->Register("waveform: low bound above high bound"),
+    Diagnostics::get()->Register("waveform: unidentified error")
+};
+
 WaveformAnalyzer::WaveformAnalyzer() : TraceAnalyzer() {
     name = "WaveformAnalyzer";
-    messenger_ = new Messenger();
 }
 
 void WaveformAnalyzer::Analyze(Trace &trace, const std::string &type,
@@ -58,38 +66,39 @@ void WaveformAnalyzer::Analyze(Trace &trace, const std::string &type,
         if (tags.find("psd") != tags.end())
             CalculateDiscrimination(g_->discriminationStart());
     } catch(WAVEFORMANALYZER_ERROR_CODES errorCode) {
-        switch(errorCode) {
-            case TOO_LOW:
-                messenger_->warning("The low bound for the search was before "
-                                            "the beginning of the trace. This"
-                                            " is a bad thing, no trace "
-                                            "analysis possible.", 0);
-                break;
-            case MAX_END:
-                messenger_->warning("The maximum value of the trace was found"
-                                            " at a point where your current "
-                                            "waveform range will be outside "
-                                            "of the trace. you should "
-                                            "reevaluate the waveform range to"
-                                            " make sure that you have set "
-                                            "something reasonable. I suggest "
-                                            "taking a look at the scope "
-                                            "program to view the traces. ", 0);
-                break;
-            case LOW_GREATER_HIGH:
-                messenger_->warning("The high bound for the waveform search "
-                                            "was lower than the low bound. "
-                                            "This should never have happened "
-                                            "and I have no idea why it did.",
-                                    0);
-                break;
-            default:
-                stringstream ss;
-                ss << "There was an unidentified error with an error code of "
-                   << errorCode << ". Please review your settings for the "
-                        "trace analysis.";
-                messenger_->warning(ss.str(),0);
-                break;
+        //The errors are counted, only the first few are explained. A badly
+        // set waveform range would otherwise warn for every trace.
+        unsigned int code = errorCode <= LOW_GREATER_HIGH ?
+                            diagCodes[errorCode] : diagCodes[3];
+        if (Diagnostics::get()->Count(code, modNum, chanNum)) {
+            stringstream ss;
+            ss << type << ":" << subtype << " : ";
+            switch(errorCode) {
+                case TOO_LOW:
+                    ss << "The low bound for the search was before the "
+                            "beginning of the trace. This is a bad thing, no "
+                            "trace analysis possible.";
+                    break;
+                case MAX_END:
+                    ss << "The maximum value of the trace was found at a "
+                            "point where your current waveform range will be "
+                            "outside of the trace. you should reevaluate the "
+                            "waveform range to make sure that you have set "
+                            "something reasonable. I suggest taking a look at "
+                            "the scope program to view the traces. ";
+                    break;
+                case LOW_GREATER_HIGH:
+                    ss << "The high bound for the waveform search was lower "
+                            "than the low bound. This should never have "
+                            "happened and I have no idea why it did.";
+                    break;
+                default:
+                    ss << "There was an unidentified error with an error code "
+                            "of " << errorCode << ". Please review your "
+                            "settings for the trace analysis.";
+                    break;
+            }
+            Diagnostics::get()->Sample(code, modNum, chanNum, ss.str());
         }
         EndAnalyze();
     }
@@ -0,0 +1,179 @@
+/** \file SpillGenerator.cpp
+ * \brief Generates deterministic synthetic Pixie-16 list mode spills
+ * \date Oct. 19th, 2026
+ */
+#include <algorithm>
+#include <utility>
+
+#include <cmath>
+
+#include "SpillGenerator.hpp"
+#include "pixie16app_defs.h"
+
+using namespace std;
+
+namespace {
+    ///Pixie-16 revision F timestamp clock in seconds
+    const double CLOCK_IN_SECONDS = 8e-9;
+    ///Largest record that a single module can deliver in a spill (words)
+    const double MAX_MODULE_WORDS = 131072;
+    ///Largest spill that Unpacker::ReadSpill accepts (words)
+    const double MAX_SPILL_WORDS = 1000000;
+    ///Baseline of the simulated traces in ADC units
+    const double TRACE_BASELINE = 400.;
+    ///Noise of the simulated traces in ADC units
+    const double TRACE_NOISE = 3.;
+}
+
+SpillGenerator::SpillGenerator(const unsigned int &numModules,
+                               const double &rate,
+                               const unsigned int &headerLength,
+                               const unsigned int &traceLength,
+                               const unsigned int &seed) {
+    numModules_ = min(max(numModules, 1u), 13u);
+    rate_ = max(rate, 1.0);
+    headerLength_ = headerLength;
+    if (headerLength_ != 4 && headerLength_ != 8 && headerLength_ != 12 &&
+        headerLength_ != 16)
+        headerLength_ = 4;
+    traceLength_ = traceLength + traceLength % 2;
+    eventLength_ = headerLength_ + traceLength_ / 2;
+    seed_ = 0x9E3779B97F4A7C15ULL * (seed + 1);
+
+    //A simple preamplifier pulse: fast exponential rise and slow decay,
+    // triggered a quarter of the way into the trace.
+    pulse_.assign(traceLength_, 0.0);
+    const double rise = 2.0, decay = max(0.4 * traceLength_, 10.);
+    unsigned int start = traceLength_ / 4;
+    double peak = 0;
+    for (unsigned int i = start; i < traceLength_; i++) {
+        double t = i - start;
+        pulse_[i] = exp(-t / decay) - exp(-t / rise);
+        peak = max(peak, pulse_[i]);
+    }
+    if (peak > 0)
+        for (unsigned int i = 0; i < traceLength_; i++)
+            pulse_[i] /= peak;
+
+    SetSpillLength(0.1);
+    Reset();
+}
+
+void SpillGenerator::Reset() {
+    state_ = seed_;
+    currentTime_ = 1.0;
+    numHits_ = 0;
+}
+
+double SpillGenerator::SetSpillLength(const double &a) {
+    //Leave room for Poisson fluctuations in the number of events.
+    double wordsPerSecond = NUMBER_OF_CHANNELS * rate_ * eventLength_;
+    double maxLength = min(0.75 * MAX_MODULE_WORDS / wordsPerSecond,
+                           0.75 * MAX_SPILL_WORDS /
+                                   (numModules_ * wordsPerSecond));
+    spillLength_ = min(a, maxLength);
+    return spillLength_;
+}
+
+double SpillGenerator::Uniform() {
+    state_ ^= state_ >> 12;
+    state_ ^= state_ << 25;
+    state_ ^= state_ >> 27;
+    return ((state_ * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0)
+           + 0.5 / 9007199254740992.0;
+}
+
+double SpillGenerator::Gauss() {
+    return sqrt(-2 * log(Uniform())) * cos(2 * M_PI * Uniform());
+}
+
+unsigned int SpillGenerator::Energy() {
+    //Two lines on a flat background in 16 bit energy units.
+    double u = Uniform();
+    double energy;
+    if (u < 0.35)
+        energy = 11730 + 12 * Gauss();
+    else if (u < 0.65)
+        energy = 13320 + 13 * Gauss();
+    else
+        energy = 200 + 14000 * Uniform();
+    return (unsigned int) max(energy, 1.0);
+}
+
+void SpillGenerator::AddEvent(const unsigned int &mod,
+                              const unsigned int &chan, const double &time,
+                              vector<unsigned int> &spill) {
+    unsigned long long ticks =
+            (unsigned long long) (time / CLOCK_IN_SECONDS);
+    unsigned int energy = Energy();
+    unsigned int cfd = (unsigned int) (Uniform() * 32768);
+
+    spill.push_back(chan | ((mod + 2) << 4) | (headerLength_ << 12) |
+                    (eventLength_ << 17));
+    spill.push_back((unsigned int) (ticks & 0xFFFFFFFF));
+    spill.push_back((unsigned int) ((ticks >> 32) & 0xFFFF) | (cfd << 16));
+    spill.push_back((energy & 0xFFFF) | (traceLength_ << 16));
+
+    //Onboard energy sums (trailing, leading, gap, baseline).
+    if (headerLength_ == 8 || headerLength_ == 16) {
+        spill.push_back(energy * 20);
+        spill.push_back(energy * 21);
+        spill.push_back(energy * 5);
+        spill.push_back(0x43C80000); // 400.0 as an IEEE float
+    }
+    //QDC sums.
+    if (headerLength_ >= 12)
+        for (unsigned int i = 0; i < 8; i++)
+            spill.push_back(energy * (i + 1));
+
+    double amplitude = energy / 5.;
+    for (unsigned int i = 0; i < traceLength_; i += 2) {
+        unsigned int samples[2];
+        for (unsigned int j = 0; j < 2; j++) {
+            double val = TRACE_BASELINE + TRACE_NOISE * Gauss() +
+                         amplitude * pulse_[i + j];
+            samples[j] = (unsigned int) min(max(val, 0.0), 16383.);
+        }
+        spill.push_back(samples[0] | (samples[1] << 16));
+    }
+}
+
+unsigned int SpillGenerator::Next(vector<unsigned int> &spill) {
+    spill.clear();
+    unsigned int numEvents = 0;
+    double stop = currentTime_ + spillLength_;
+
+    vector<pair<double, unsigned int> > hits;
+    for (unsigned int mod = 0; mod < numModules_; mod++) {
+        hits.clear();
+        for (unsigned int chan = 0; chan < NUMBER_OF_CHANNELS; chan++) {
+            double time = currentTime_;
+            while (true) {
+                time += -log(Uniform()) / rate_;
+                if (time >= stop)
+                    break;
+                hits.push_back(make_pair(time, chan));
+            }
+        }
+        //The module FIFO is filled in the order that the channels trigger.
+        sort(hits.begin(), hits.end());
+
+        size_t header = spill.size();
+        spill.push_back(0);
+        spill.push_back(mod);
+        for (vector<pair<double, unsigned int> >::iterator it = hits.begin();
+             it != hits.end(); it++)
+            AddEvent(mod, it->second, it->first, spill);
+        spill[header] = (unsigned int) (spill.size() - header);
+        numEvents += hits.size();
+    }
+
+    currentTime_ = stop;
+    numHits_ += numEvents;
+    return numEvents;
+}
+
+void SpillGenerator::AppendEndOfSpill(vector<unsigned int> &spill) {
+    spill.push_back(2);
+    spill.push_back(9999);
+}
@@ -0,0 +1,102 @@
+/** \file SpillGenerator.hpp
+ * \brief Generates deterministic synthetic Pixie-16 list mode spills
+ *
+ * The spills are laid out exactly as poll2 reads them out of the modules:
+ * one record per module consisting of the record length, the module number
+ * and the raw channel events. Events carry a configurable header length and
+ * a trace containing a simulated preamplifier pulse. The same seed always
+ * produces the same sequence of spills.
+ *
+ * \date Oct. 19th, 2026
+ */
+#ifndef __SPILLGENERATOR_HPP__
+#define __SPILLGENERATOR_HPP__
+
+#include <vector>
+
+#include <stdint.h>
+
+///A class that builds synthetic spills for benchmarking the scan code
+class SpillGenerator {
+public:
+    /** Constructor
+     * \param[in] numModules : Number of modules in the crate (at most 13)
+     * \param[in] rate : The count rate of each channel in Hz
+     * \param[in] headerLength : The number of header words (4, 8, 12 or 16)
+     * \param[in] traceLength : The number of trace samples (rounded up to even)
+     * \param[in] seed : Seed for the random number generator */
+    SpillGenerator(const unsigned int &numModules, const double &rate,
+                   const unsigned int &headerLength,
+                   const unsigned int &traceLength,
+                   const unsigned int &seed = 1);
+
+    /** Default Destructor */
+    ~SpillGenerator() {};
+
+    /** Fill the vector with the next spill. The spill does not contain the
+     * end of spill record expected by Unpacker::ReadSpill, use
+     * AppendEndOfSpill to add one.
+     * \param[out] spill : The words of the spill
+     * \return The number of channel events in the spill */
+    unsigned int Next(std::vector<unsigned int> &spill);
+
+    /** Append the end of spill record (2, 9999) that is added to a spill
+     * before it is passed to Unpacker::ReadSpill.
+     * \param[out] spill : The spill to terminate */
+    static void AppendEndOfSpill(std::vector<unsigned int> &spill);
+
+    /** \return The length of a spill in seconds */
+    double GetSpillLength() const { return spillLength_; }
+
+    /** \return The number of words in each channel event */
+    unsigned int GetEventLength() const { return eventLength_; }
+
+    /** \return The total number of channel events generated */
+    unsigned long long GetNumHits() const { return numHits_; }
+
+    /** Set the length of a spill in seconds. The length is shortened if the
+     * spill would not fit into the external FIFO of the modules.
+     * \param[in] a : The requested spill length in seconds
+     * \return The spill length that will be used */
+    double SetSpillLength(const double &a);
+
+    /** Reset the generator to the beginning of its sequence */
+    void Reset();
+
+private:
+    ///State of the xorshift64* generator. This is used instead of the
+    /// standard library distributions so that the sequence of spills is the
+    /// same with every compiler.
+    uint64_t state_;
+    uint64_t seed_; //!< The initial state of the generator
+
+    unsigned int numModules_; //!< Number of modules
+    double rate_; //!< Rate per channel in Hz
+    unsigned int headerLength_; //!< Number of header words
+    unsigned int traceLength_; //!< Number of trace samples
+    unsigned int eventLength_; //!< Number of words per event
+    double spillLength_; //!< Length of a spill in seconds
+    double currentTime_; //!< Time at the start of the next spill in seconds
+    unsigned long long numHits_; //!< Total number of events generated
+
+    std::vector<double> pulse_; //!< Normalized pulse shape used for the traces
+
+    /** \return A uniformly distributed number on (0,1) */
+    double Uniform();
+
+    /** \return A normally distributed number with unit width */
+    double Gauss();
+
+    /** \return A random raw energy drawn from a few lines on a background */
+    unsigned int Energy();
+
+    /** Append a single channel event to the spill.
+     * \param[in] mod : The module number
+     * \param[in] chan : The channel number
+     * \param[in] time : The time of the event in seconds
+     * \param[out] spill : The spill to append to */
+    void AddEvent(const unsigned int &mod, const unsigned int &chan,
+                  const double &time, std::vector<unsigned int> &spill);
+};
+
+#endif //__SPILLGENERATOR_HPP__
@@ -0,0 +1,728 @@
+/** \file paass_bench.cpp
+ * \brief Micro and macro benchmarks of the decoding and analysis chain
+ *
+ * Deterministic synthetic spills are generated with SpillGenerator and pushed
+ * through the same code that utkscan uses: Unpacker::ReadSpill and the event
+ * builder, DetectorDriver::ThreshAndCal, each of the configured
+ * TraceAnalyzers, Plots::Plot and OutputHisFile::Fill, and the .ldf and .pld
+ * readers. Every stage reports the number of hits, hits/s and ns/hit. The
+ * results can be written as JSON so that they may be compared between builds.
+ *
+ * \date Oct. 19th, 2026
+ */
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hribf_buffers.h"
+
+#include "DammPlotIds.hpp"
+#include "DetectorDriver.hpp"
+#include "DetectorLibrary.hpp"
+#include "EventCache.hpp"
+#include "Globals.hpp"
+#include "HisFile.hpp"
+#include "RawEvent.hpp"
+#include "TraceAnalyzer.hpp"
+#include "Unpacker.hpp"
+#include "XiaData.hpp"
+
+#include "SpillGenerator.hpp"
+
+using namespace std;
+
+///Defined in UtkScanInterface.cpp
+extern OutputHisFile *output_his;
+
+typedef chrono::steady_clock BenchClock;
+
+///Return the number of seconds between two time points
+static double Seconds(const BenchClock::time_point &start,
+                      const BenchClock::time_point &stop) {
+    return chrono::duration<double>(stop - start).count();
+}
+
+///The result of a single benchmark
+struct BenchResult {
+    string name; //!< Name of the benchmarked stage
+    unsigned long long hits; //!< Number of hits processed in one repetition
+    double seconds; //!< Fastest time of all repetitions
+
+    BenchResult(const string &n, const unsigned long long &h, const double &s)
+            : name(n), hits(h), seconds(s) {}
+
+    /** \return The number of hits processed per second */
+    double HitsPerSecond() const { return seconds > 0 ? hits / seconds : 0; }
+
+    /** \return The number of nanoseconds spent per hit */
+    double NsPerHit() const { return hits > 0 ? seconds * 1e9 / hits : 0; }
+};
+
+///An unpacker that only counts the raw events, optionally keeping a copy of
+/// them for the benchmarks of the later stages.
+class BenchUnpacker : public Unpacker {
+public:
+    /** Default Constructor */
+    BenchUnpacker() : Unpacker(), numHits_(0), numEvents_(0),
+                      buildTime_(0), buildHits_(0), maxKeep_(0),
+                      haveLast_(false) {}
+
+    /** Default Destructor */
+    ~BenchUnpacker() {
+        for (vector<XiaData *>::iterator it = kept_.begin();
+             it != kept_.end(); it++)
+            delete *it;
+    }
+
+    /** Mark the start of a new spill so that the time spent building the
+     * first event, which also contains the decoding and the time sort, is
+     * not counted as event building time. */
+    void StartSpill() { haveLast_ = false; }
+
+    /** Keep copies of up to max hits for the later benchmarks
+     * \param[in] max : The number of hits to keep */
+    void SetKeep(const size_t &max) { maxKeep_ = max; }
+
+    /** \return The number of hits in the built raw events */
+    unsigned long long GetNumHits() const { return numHits_; }
+
+    /** \return The number of built raw events */
+    unsigned long long GetNumEvents() const { return numEvents_; }
+
+    /** \return The time spent in BuildRawEvent (s) */
+    double GetBuildTime() const { return buildTime_; }
+
+    /** \return The number of hits in the events used for the build time */
+    unsigned long long GetBuildHits() const { return buildHits_; }
+
+    /** \return The kept hits */
+    const vector<XiaData *> &GetKept() const { return kept_; }
+
+    /** \return The size of each of the kept raw events */
+    const vector<size_t> &GetKeptEvents() const { return keptEvents_; }
+
+private:
+    unsigned long long numHits_; //!< Hits in all built events
+    unsigned long long numEvents_; //!< Number of built events
+    double buildTime_; //!< Time between consecutive ProcessRawEvent calls
+    unsigned long long buildHits_; //!< Hits counted in buildTime_
+    size_t maxKeep_; //!< Maximum number of hits to keep
+    bool haveLast_; //!< True if lastReturn_ belongs to the current spill
+    BenchClock::time_point lastReturn_; //!< When ProcessRawEvent last returned
+
+    vector<XiaData *> kept_; //!< Copies of the kept hits
+    vector<size_t> keptEvents_; //!< Number of hits in each kept event
+
+    /** Count the raw event. The time between the return of the previous call
+     * and this call is the time spent building this event. */
+    virtual void ProcessRawEvent(ScanInterface *addr_ = NULL) {
+        BenchClock::time_point now = BenchClock::now();
+        if (haveLast_) {
+            buildTime_ += Seconds(lastReturn_, now);
+            buildHits_ += rawEvent.size();
+        }
+
+        numHits_ += rawEvent.size();
+        numEvents_++;
+
+        if (kept_.size() + rawEvent.size() <= maxKeep_) {
+            for (deque<XiaData *>::iterator it = rawEvent.begin();
+                 it != rawEvent.end(); it++)
+                kept_.push_back(new XiaData(*it));
+            keptEvents_.push_back(rawEvent.size());
+        }
+
+        haveLast_ = true;
+        lastReturn_ = BenchClock::now();
+    }
+};
+
+///The options of the benchmark run
+struct BenchOptions {
+    unsigned int modules; //!< Number of modules
+    double rate; //!< Rate per channel (Hz)
+    unsigned int header; //!< Header length (words)
+    unsigned int trace; //!< Trace length (samples)
+    unsigned int spills; //!< Number of spills
+    double spillLength; //!< Requested spill length (s)
+    unsigned int seed; //!< Generator seed
+    unsigned int keep; //!< Hits used for the processing benchmarks
+    unsigned int repeat; //!< Number of repetitions of every benchmark
+    string directory; //!< Working directory
+    string output; //!< JSON output file
+    bool keepFiles; //!< Keep the working directory
+
+    BenchOptions() : modules(4), rate(1000), header(4), trace(250),
+                     spills(20), spillLength(0.1), seed(1), keep(20000),
+                     repeat(3), keepFiles(false) {}
+};
+
+/* Print help dialogue for command line options. */
+static void help(const char *progName_) {
+    cout << "\n SYNTAX: " << progName_ << " [options]\n";
+    cout << "  --modules (-m) <N>      | Number of modules (default 4, at most 13)\n";
+    cout << "  --rate (-r) <Hz>        | Count rate of every channel (default 1000)\n";
+    cout << "  --header (-H) <words>   | Header length: 4, 8, 12 or 16 (default 4)\n";
+    cout << "  --trace (-t) <samples>  | Trace length, 0 for no traces (default 250)\n";
+    cout << "  --spills (-s) <N>       | Number of spills to generate (default 20)\n";
+    cout << "  --length (-l) <s>       | Requested spill length (default 0.1)\n";
+    cout << "  --seed (-S) <N>         | Random number seed (default 1)\n";
+    cout << "  --keep (-k) <N>         | Hits used for the processing benchmarks (default 20000)\n";
+    cout << "  --repeat (-n) <N>       | Repetitions of each benchmark, fastest is reported (default 3)\n";
+    cout << "  --dir (-d) <path>       | Working directory (default: a new directory in /tmp)\n";
+    cout << "  --output (-o) <file>    | Write the results to a JSON file\n";
+    cout << "  --keep-files            | Do not remove the working directory\n";
+    cout << "  --help (-h)             | Display this dialogue\n\n";
+}
+
+///Write the configuration file used by Globals, DetectorLibrary and
+/// DetectorDriver. All channels are "generic:bench" detectors.
+static bool WriteConfig(const string &name, const BenchOptions &opts) {
+    ofstream cfg(name.c_str());
+    if (!cfg.good())
+        return false;
+
+    cfg << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        << "<Configuration>\n"
+        << "    <Description>paass_bench synthetic setup</Description>\n"
+        << "    <Global>\n"
+        << "        <Revision version=\"F\"/>\n"
+        << "        <EventWidth unit=\"ns\" value=\"496\"/>\n"
+        << "        <NumOfTraces value=\"16\"/>\n"
+        << "    </Global>\n"
+        << "    <DetectorDriver>\n";
+    if (opts.trace > 0) {
+        cfg << "        <Analyzer name=\"TraceFilterAnalyzer\"/>\n"
+            << "        <Analyzer name=\"WaveformAnalyzer\"/>\n"
+            << "        <Analyzer name=\"CfdAnalyzer\"/>\n"
+            << "        <Analyzer name=\"WaaAnalyzer\"/>\n"
+            << "        <Analyzer name=\"TauAnalyzer\"/>\n"
+            << "        <Analyzer name=\"TraceExtractor\" type=\"generic\" "
+               "subtype=\"bench\"/>\n";
+#ifdef usegsl
+        cfg << "        <Analyzer name=\"FittingAnalyzer\" type=\"gsl\"/>\n";
+#endif
+    }
+    cfg << "    </DetectorDriver>\n"
+        << "    <Map verbose_calibration=\"False\" verbose_map=\"False\" "
+           "verbose_walk=\"False\">\n";
+    for (unsigned int mod = 0; mod < opts.modules; mod++) {
+        cfg << "        <Module number=\"" << mod << "\">\n";
+        for (unsigned int chan = 0; chan < 16; chan++)
+            cfg << "            <Channel number=\"" << chan
+                << "\" type=\"generic\" subtype=\"bench\">\n"
+                << "                <Calibration model=\"linear\" "
+                   "max=\"65536\">0.0 0.1</Calibration>\n"
+                << "            </Channel>\n";
+        cfg << "        </Module>\n";
+    }
+    cfg << "    </Map>\n"
+        << "    <TimeCalibration verbose_timing=\"False\"></TimeCalibration>\n"
+        << "    <Trace>\n"
+        << "        <WaveformRange>\n"
+        << "            <Range name=\"default\"><Low value=\"5\"/>"
+           "<High value=\"10\"/></Range>\n"
+        << "            <Range name=\"generic:bench\"><Low value=\"5\"/>"
+           "<High value=\"10\"/></Range>\n"
+        << "        </WaveformRange>\n"
+        << "        <TrapFilters>\n"
+        << "            <Filter name=\"generic:bench\">\n"
+        << "                <Trigger l=\"100\" g=\"20\" t=\"10\"/>\n"
+        << "                <Energy l=\"200\" g=\"100\" t=\"400\"/>\n"
+        << "            </Filter>\n"
+        << "        </TrapFilters>\n"
+        << "        <DiscriminationStart unit=\"sample\" value=\"3\"/>\n"
+        << "        <TraceDelay unit=\"ns\" value=\"248\"/>\n"
+        << "    </Trace>\n"
+        << "    <Fitting>\n"
+        << "        <SigmaBaselineThresh value=\"3.0\"/>\n"
+        << "        <Parameters>\n"
+        << "            <Pars name=\"generic:bench\"><Beta value=\"0.0043\"/>"
+           "<Gamma value=\"0.145\"/></Pars>\n"
+        << "        </Parameters>\n"
+        << "    </Fitting>\n"
+        << "    <TreeCorrelator name=\"root\" verbose=\"False\">"
+           "</TreeCorrelator>\n"
+        << "</Configuration>\n";
+
+    return cfg.good();
+}
+
+///Benchmark Unpacker::ReadSpill and the event builder. The hits of the first
+/// repetition are kept for the later stages.
+static void BenchReadSpill(const vector<vector<unsigned int> > &spills,
+                           const BenchOptions &opts,
+                           vector<BenchResult> &results,
+                           BenchUnpacker &keeper) {
+    double bestRead = -1, bestBuild = -1;
+    unsigned long long hits = 0, buildHits = 0;
+
+    for (unsigned int rep = 0; rep < opts.repeat; rep++) {
+        BenchUnpacker local;
+        BenchUnpacker &unpacker = (rep == 0 ? keeper : local);
+        if (rep == 0)
+            unpacker.SetKeep(opts.keep);
+
+        BenchClock::time_point start = BenchClock::now();
+        for (vector<vector<unsigned int> >::const_iterator it = spills.begin();
+             it != spills.end(); it++) {
+            unpacker.StartSpill();
+            unpacker.ReadSpill(const_cast<unsigned int *>(&(*it)[0]),
+                               it->size(), false);
+        }
+        double elapsed = Seconds(start, BenchClock::now());
+
+        hits = unpacker.GetNumHits();
+        buildHits = unpacker.GetBuildHits();
+        if (bestRead < 0 || elapsed < bestRead)
+            bestRead = elapsed;
+        if (bestBuild < 0 || unpacker.GetBuildTime() < bestBuild)
+            bestBuild = unpacker.GetBuildTime();
+    }
+
+    results.push_back(BenchResult("Unpacker::ReadSpill", hits, bestRead));
+    results.push_back(BenchResult("Unpacker::BuildRawEvent", buildHits,
+                                  bestBuild));
+}
+
+///Write the built raw events to an event cache and time scanning them back
+/// with Unpacker::ReadCache, which skips the decoding and the event building.
+static BenchResult BenchEventCache(const vector<vector<unsigned int> > &spills,
+                                   const BenchOptions &opts,
+                                   vector<string> &files) {
+    string name = "Unpacker::ReadCache";
+    string filename = opts.directory + "/bench.evc";
+
+    BenchUnpacker writer;
+    if (!writer.SetCacheOutput(filename))
+        return BenchResult(name, 0, 0);
+    for (vector<vector<unsigned int> >::const_iterator it = spills.begin();
+         it != spills.end(); it++)
+        writer.ReadSpill(const_cast<unsigned int *>(&(*it)[0]), it->size(),
+                         false);
+    writer.CloseCacheOutput();
+    files.push_back(filename);
+
+    double best = -1;
+    unsigned long long hits = 0;
+    for (unsigned int rep = 0; rep < opts.repeat; rep++) {
+        BenchUnpacker unpacker;
+        EventCache cache;
+        BenchClock::time_point start = BenchClock::now();
+        if (!cache.Open(filename))
+            return BenchResult(name, 0, 0);
+        while (unpacker.ReadCache(&cache, 10000));
+        double elapsed = Seconds(start, BenchClock::now());
+
+        hits = unpacker.GetNumHits();
+        if (best < 0 || elapsed < best)
+            best = elapsed;
+    }
+
+    if (hits != writer.GetNumHits())
+        cout << "paass_bench : The event cache returned " << hits << " of "
+             << writer.GetNumHits() << " hits!\n";
+
+    return BenchResult(name, hits, best);
+}
+
+///Benchmark DetectorDriver::ThreshAndCal on the kept raw events. When
+/// withTraces is false the traces are removed first so that only the
+/// calibration, walk correction and detector summaries are timed.
+static BenchResult BenchThreshAndCal(const BenchUnpacker &keeper,
+                                     RawEvent &rawev, bool withTraces,
+                                     const BenchOptions &opts) {
+    DetectorDriver *driver = DetectorDriver::get();
+    const vector<XiaData *> &kept = keeper.GetKept();
+    const vector<size_t> &events = keeper.GetKeptEvents();
+    set<string> used;
+    double best = -1;
+
+    for (unsigned int rep = 0; rep < opts.repeat; rep++) {
+        double elapsed = 0;
+        size_t index = 0;
+        for (vector<size_t>::const_iterator ev = events.begin();
+             ev != events.end(); ev++) {
+            for (size_t i = 0; i < *ev; i++) {
+                //The copy stands in for the decoding, the ChanEvent then
+                // takes its trace as it does in UtkUnpacker.
+                XiaData copy(kept[index + i]);
+                if (!withTraces)
+                    copy.adcTrace.clear();
+                rawev.AddChan(&copy);
+            }
+
+            BenchClock::time_point start = BenchClock::now();
+            for (vector<ChanEvent *>::const_iterator it =
+                    rawev.GetEventList().begin();
+                 it != rawev.GetEventList().end(); it++)
+                driver->ThreshAndCal(*it, rawev);
+            elapsed += Seconds(start, BenchClock::now());
+
+            rawev.Zero(used);
+            index += *ev;
+        }
+        if (best < 0 || elapsed < best)
+            best = elapsed;
+    }
+
+    return BenchResult(withTraces ? "DetectorDriver::ThreshAndCal+traces" :
+                       "DetectorDriver::ThreshAndCal", kept.size(), best);
+}
+
+///Benchmark every configured TraceAnalyzer. The analyzers are run in the
+/// configured order on the same traces so that each one sees the values
+/// written by the previous ones, as it does in utkscan.
+static void BenchAnalyzers(const BenchUnpacker &keeper,
+                           const vector<string> &names,
+                           const BenchOptions &opts,
+                           vector<BenchResult> &results) {
+    const vector<TraceAnalyzer *> &analyzers =
+            DetectorDriver::get()->GetAnalyzers();
+    const vector<XiaData *> &kept = keeper.GetKept();
+    const map<string, int> tags;
+    vector<double> best(analyzers.size(), -1);
+
+    for (unsigned int rep = 0; rep < opts.repeat; rep++) {
+        vector<Trace> traces;
+        traces.reserve(kept.size());
+        for (vector<XiaData *>::const_iterator it = kept.begin();
+             it != kept.end(); it++)
+            traces.push_back(Trace((*it)->adcTrace));
+
+        for (size_t i = 0; i < analyzers.size(); i++) {
+            BenchClock::time_point start = BenchClock::now();
+            for (vector<Trace>::iterator trc = traces.begin();
+                 trc != traces.end(); trc++)
+                analyzers[i]->Analyze(*trc, "generic", "bench", tags);
+            double elapsed = Seconds(start, BenchClock::now());
+            if (best[i] < 0 || elapsed < best[i])
+                best[i] = elapsed;
+        }
+    }
+
+    for (size_t i = 0; i < analyzers.size(); i++)
+        results.push_back(BenchResult(i < names.size() ? names[i] :
+                                      "TraceAnalyzer", kept.size(), best[i]));
+}
+
+///Benchmark filling the raw energy spectra through Plots::Plot and directly
+/// through OutputHisFile::Fill.
+static void BenchHistograms(const BenchUnpacker &keeper,
+                            const BenchOptions &opts,
+                            vector<BenchResult> &results) {
+    DetectorDriver *driver = DetectorDriver::get();
+    const vector<XiaData *> &kept = keeper.GetKept();
+    double bestPlot = -1, bestFill = -1;
+
+    for (unsigned int rep = 0; rep < opts.repeat; rep++) {
+        BenchClock::time_point start = BenchClock::now();
+        for (vector<XiaData *>::const_iterator it = kept.begin();
+             it != kept.end(); it++)
+            driver->plot(dammIds::raw::D_RAW_ENERGY + (*it)->getID(),
+                         (*it)->energy);
+        double elapsed = Seconds(start, BenchClock::now());
+        if (bestPlot < 0 || elapsed < bestPlot)
+            bestPlot = elapsed;
+
+        start = BenchClock::now();
+        for (vector<XiaData *>::const_iterator it = kept.begin();
+             it != kept.end(); it++)
+            output_his->Fill(dammIds::raw::OFFSET + dammIds::raw::D_RAW_ENERGY
+                             + (*it)->getID(), (unsigned int) (*it)->energy, 1);
+        elapsed = Seconds(start, BenchClock::now());
+        if (bestFill < 0 || elapsed < bestFill)
+            bestFill = elapsed;
+    }
+
+    results.push_back(BenchResult("Plots::Plot", kept.size(), bestPlot));
+    results.push_back(BenchResult("OutputHisFile::Fill", kept.size(),
+                                  bestFill));
+}
+
+///Write the spills to a .ldf or .pld file and time reading them back with
+/// the same buffer classes that ScanInterface uses.
+static BenchResult BenchReader(const vector<vector<unsigned int> > &spills,
+                               unsigned long long hits, unsigned int format,
+                               const BenchOptions &opts,
+                               vector<string> &files) {
+    string name = (format == 0 ? "ldf reader" : "pld reader");
+
+    PollOutputFile writer;
+    writer.SetFileFormat(format);
+    unsigned int runNum = 1;
+    if (!writer.OpenNewFile("paass_bench", runNum, "bench",
+                            opts.directory + "/")) {
+        cout << "paass_bench : Failed to open a " << name << " file.\n";
+        return BenchResult(name, 0, 0);
+    }
+    string filename = writer.GetCurrentFilename();
+    size_t maxWords = 0;
+    for (vector<vector<unsigned int> >::const_iterator it = spills.begin();
+         it != spills.end(); it++) {
+        writer.Write((char *) &(*it)[0], it->size());
+        maxWords = max(maxWords, it->size());
+    }
+    writer.CloseFile();
+    files.push_back(filename);
+
+    vector<unsigned int> data(max(maxWords + 2, (size_t) 1000000));
+    double best = -1;
+    unsigned int numSpills = 0;
+    for (unsigned int rep = 0; rep < opts.repeat; rep++) {
+        ifstream input(filename.c_str(), ios::binary);
+        numSpills = 0;
+
+        BenchClock::time_point start = BenchClock::now();
+        unsigned int nBytes = 0;
+        if (format == 0) {
+            DIR_buffer dirbuff;
+            HEAD_buffer headbuff;
+            DATA_buffer databuff;
+            bool fullSpill, badSpill;
+            dirbuff.Read(&input);
+            headbuff.Read(&input);
+            databuff.Reset();
+            while (true) {
+                if (!databuff.Read(&input, (char *) &data[0], nBytes, 4000000,
+                                   fullSpill, badSpill)) {
+                    if (databuff.GetRetval() == 2 || databuff.GetRetval() == 6)
+                        break;
+                    continue;
+                }
+                if (fullSpill && !badSpill)
+                    numSpills++;
+            }
+        } else {
+            PLD_header pldHead;
+            PLD_data pldData;
+            pldHead.Read(&input);
+            pldData.Reset();
+            while (pldData.Read(&input, (char *) &data[0], nBytes,
+                                4 * pldHead.GetMaxSpillSize()))
+                numSpills++;
+        }
+        double elapsed = Seconds(start, BenchClock::now());
+        if (best < 0 || elapsed < best)
+            best = elapsed;
+    }
+
+    if (numSpills != spills.size())
+        cout << "paass_bench : The " << name << " returned " << numSpills
+             << " of " << spills.size() << " spills!\n";
+
+    return BenchResult(name, hits, best);
+}
+
+///Print the results as a table
+static void PrintResults(const vector<BenchResult> &results) {
+    cout << "\n" << setw(38) << left << "benchmark" << setw(12) << right
+         << "hits" << setw(16) << "hits/s" << setw(12) << "ns/hit" << "\n";
+    for (vector<BenchResult>::const_iterator it = results.begin();
+         it != results.end(); it++)
+        cout << setw(38) << left << it->name << setw(12) << right << it->hits
+             << setw(16) << fixed << setprecision(0) << it->HitsPerSecond()
+             << setw(12) << setprecision(1) << it->NsPerHit() << "\n";
+    cout << endl;
+}
+
+///Write the results and the options that produced them as JSON
+static bool WriteJson(const string &name, const vector<BenchResult> &results,
+                      const BenchOptions &opts) {
+    ofstream out(name.c_str());
+    if (!out.good())
+        return false;
+
+    out << "{\n  \"options\": {\"modules\": " << opts.modules
+        << ", \"rate\": " << opts.rate << ", \"header\": " << opts.header
+        << ", \"trace\": " << opts.trace << ", \"spills\": " << opts.spills
+        << ", \"spill_length\": " << opts.spillLength
+        << ", \"seed\": " << opts.seed << ", \"keep\": " << opts.keep
+        << ", \"repeat\": " << opts.repeat << "},\n  \"results\": [\n";
+    out << setprecision(6);
+    for (size_t i = 0; i < results.size(); i++) {
+        out << "    {\"name\": \"" << results[i].name << "\", \"hits\": "
+            << results[i].hits << ", \"seconds\": " << scientific
+            << results[i].seconds << fixed << ", \"hits_per_second\": "
+            << results[i].HitsPerSecond() << ", \"ns_per_hit\": "
+            << results[i].NsPerHit() << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return out.good();
+}
+
+int main(int argc, char *argv[]) {
+    BenchOptions opts;
+
+    struct option longOpts[] = {
+            {"modules", required_argument, NULL, 'm'},
+            {"rate", required_argument, NULL, 'r'},
+            {"header", required_argument, NULL, 'H'},
+            {"trace", required_argument, NULL, 't'},
+            {"spills", required_argument, NULL, 's'},
+            {"length", required_argument, NULL, 'l'},
+            {"seed", required_argument, NULL, 'S'},
+            {"keep", required_argument, NULL, 'k'},
+            {"repeat", required_argument, NULL, 'n'},
+            {"dir", required_argument, NULL, 'd'},
+            {"output", required_argument, NULL, 'o'},
+            {"keep-files", no_argument, NULL, 0},
+            {"help", no_argument, NULL, 'h'},
+            {NULL, no_argument, NULL, 0}
+    };
+
+    int idx = 0;
+    int retval = 0;
+    while ((retval = getopt_long(argc, argv, "m:r:H:t:s:l:S:k:n:d:o:h",
+                                 longOpts, &idx)) != -1) {
+        switch (retval) {
+            case 'm': opts.modules = atoi(optarg); break;
+            case 'r': opts.rate = atof(optarg); break;
+            case 'H': opts.header = atoi(optarg); break;
+            case 't': opts.trace = atoi(optarg); break;
+            case 's': opts.spills = atoi(optarg); break;
+            case 'l': opts.spillLength = atof(optarg); break;
+            case 'S': opts.seed = atoi(optarg); break;
+            case 'k': opts.keep = atoi(optarg); break;
+            case 'n': opts.repeat = max(atoi(optarg), 1); break;
+            case 'd': opts.directory = optarg; break;
+            case 'o': opts.output = optarg; break;
+            case 0:
+                if (strcmp("keep-files", longOpts[idx].name) == 0)
+                    opts.keepFiles = true;
+                break;
+            case 'h':
+                help(argv[0]);
+                return 0;
+            default:
+                help(argv[0]);
+                return 1;
+        }
+    }
+
+    if (opts.modules < 1 || opts.modules > 13 || opts.spills < 1) {
+        cout << "paass_bench : Invalid number of modules or spills.\n";
+        return 1;
+    }
+
+    bool madeDirectory = false;
+    if (opts.directory.empty()) {
+        char tmpl[] = "/tmp/paass_bench.XXXXXX";
+        if (!mkdtemp(tmpl)) {
+            cout << "paass_bench : Failed to create a working directory.\n";
+            return 1;
+        }
+        opts.directory = tmpl;
+        madeDirectory = true;
+    }
+
+    string cfgName = opts.directory + "/Config.xml";
+    if (!WriteConfig(cfgName, opts)) {
+        cout << "paass_bench : Failed to write " << cfgName << endl;
+        return 1;
+    }
+
+    //Generate all of the spills up front so that the generator is not timed.
+    SpillGenerator generator(opts.modules, opts.rate, opts.header,
+                             opts.trace, opts.seed);
+    generator.SetSpillLength(opts.spillLength);
+    vector<vector<unsigned int> > spills(opts.spills);
+    for (vector<vector<unsigned int> >::iterator it = spills.begin();
+         it != spills.end(); it++)
+        generator.Next(*it);
+    unsigned long long numHits = generator.GetNumHits();
+
+    cout << "paass_bench : Generated " << opts.spills << " spills of "
+         << generator.GetSpillLength() << " s with " << numHits
+         << " hits.\n";
+
+    vector<BenchResult> results;
+    vector<string> files;
+
+    //The readers see the spills as poll2 writes them.
+    results.push_back(BenchReader(spills, numHits, 0, opts, files));
+    results.push_back(BenchReader(spills, numHits, 1, opts, files));
+
+    //The unpacker needs the end of spill record added by the readers.
+    for (vector<vector<unsigned int> >::iterator it = spills.begin();
+         it != spills.end(); it++)
+        SpillGenerator::AppendEndOfSpill(*it);
+
+    //Initialize utkscan the same way as UtkScanInterface::Initialize.
+    Globals::get(cfgName);
+    string hisName = opts.directory + "/bench";
+    output_his = new OutputHisFile(hisName.c_str());
+    DetectorDriver *driver = DetectorDriver::get();
+    driver->DeclarePlots();
+    output_his->Finalize();
+
+    RawEvent rawev;
+    DetectorLibrary::get()->PrintUsedDetectors(rawev);
+    driver->Init(rawev);
+
+    vector<string> analyzerNames;
+    if (opts.trace > 0) {
+        const char *names[] = {"TraceFilterAnalyzer", "WaveformAnalyzer",
+                               "CfdAnalyzer", "WaaAnalyzer", "TauAnalyzer",
+                               "TraceExtractor", "FittingAnalyzer"};
+        analyzerNames.assign(names, names + 7);
+    }
+
+    BenchUnpacker keeper;
+    BenchReadSpill(spills, opts, results, keeper);
+    results.push_back(BenchEventCache(spills, opts, files));
+    cout << "paass_bench : Built " << keeper.GetNumEvents()
+         << " raw events, keeping " << keeper.GetKept().size()
+         << " hits for the processing benchmarks.\n";
+
+    results.push_back(BenchThreshAndCal(keeper, rawev, false, opts));
+    if (opts.trace > 0) {
+        results.push_back(BenchThreshAndCal(keeper, rawev, true, opts));
+        BenchAnalyzers(keeper, analyzerNames, opts, results);
+    }
+    BenchHistograms(keeper, opts, results);
+
+    PrintResults(results);
+
+    int status = 0;
+    if (!opts.output.empty()) {
+        if (WriteJson(opts.output, results, opts))
+            cout << "paass_bench : Wrote results to " << opts.output << endl;
+        else {
+            cout << "paass_bench : Failed to write " << opts.output << endl;
+            status = 1;
+        }
+    }
+
+    delete output_his;
+    output_his = NULL;
+
+    if (!opts.keepFiles) {
+        files.push_back(cfgName);
+        files.push_back(hisName + ".his");
+        files.push_back(hisName + ".drr");
+        files.push_back(hisName + ".list");
+        files.push_back(hisName + ".log");
+        for (vector<string>::iterator it = files.begin(); it != files.end();
+             it++)
+            remove(it->c_str());
+        if (madeDirectory)
+            rmdir(opts.directory.c_str());
+    }
+
+    return status;
+}
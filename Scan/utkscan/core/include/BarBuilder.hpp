@@ -41,28 +41,20 @@ public:
      * \param [in] a : The channel list to build bars out of. */
     void SetChannelList(const std::vector<ChanEvent*> a){list_ = a;};
 private:
-    /** The bar number calculated from the location. We assume here
-     * that the bars are located in adjacent slots so that they are always
-     * paired in a {0,1} {2,3} {4,5} ... {n,n+1} manner. This is especially
-     * true if using a VANDLE firmware (As of 04/22/2016).
-     * \param [in] loc : the location of the current event
-     * \return The calculated bar number */
-    unsigned int CalcBarNumber(const unsigned int &loc);
-
     /** Clears out the data maps from any previously built bars and ends */
     void ClearMaps(void);
 
-    /** Fills the ends of the detector into two separate maps. Things labeled
-     * {left, up,top} are filled into one map, and things labeled {right, down,bottom}
-     * are filled into another map. Currently these are the only six
-     * recognized end types that one may have, this can be expanded later if
-     * others should arise. */
+    /** Fills the ends of the detector into the slot of their bar, using the
+     * BarIndex to find the bar and side of each channel. Things labeled
+     * {left, up,top} are one end, and things labeled {right, down,bottom}
+     * are the other. Currently these are the only six recognized end types
+     * that one may have, this can be expanded later if others should arise. */
     void FillMaps(void);
 
     BarMap hrtBars_; //!< Map containing bars with high resolution timing..
     std::map<unsigned int, std::pair<double,double> > lrtBars_; //!<Map with low res bars
-    std::map<unsigned int, unsigned int> lefts_; //!< Map containing the left sides of bars
-    std::map<unsigned int, unsigned int> rights_; //!< Map containing the left sides of bars
+    std::vector<std::pair<int,int> > slots_; //!< The {left, right} ends of each bar, as indices in list_ or -1
+    std::vector<unsigned int> used_; //!< The bar numbers of the slots filled in this event
     std::vector<ChanEvent*> list_; //!< Vector of events to build bars out of.
 };
 #endif // __BARBUILDER_HPP_
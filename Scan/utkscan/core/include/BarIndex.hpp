@@ -0,0 +1,64 @@
+/*! \file BarIndex.hpp
+ *  \brief A table relating the channels to the ends of bar style detectors
+ *  \date Oct. 19th, 2026
+*/
+#ifndef __BARINDEX_HPP__
+#define __BARINDEX_HPP__
+
+#include <vector>
+
+#include "Globals.hpp"
+
+//! A table giving for every channel of the DetectorLibrary the bar it
+//! belongs to, the side of the bar it reads out and its TimingIdentifier.
+//! The table is compiled once, when it is first asked for, so that building
+//! bars and timing maps does not copy Identifiers and look up their tags
+//! for every hit.
+class BarIndex {
+public:
+    /** The side of a bar that a channel reads out */
+    enum BarSide {NONE, LEFT, RIGHT};
+
+    /** The entry of a channel in the table */
+    struct Entry {
+        BarSide side; //!< The side of the bar, NONE if the channel has no side tag
+        unsigned int bar; //!< The bar number
+        TimingDefs::TimingIdentifier key; //!< The location and the subtype of the channel
+    };
+
+    /** \return the only instance of the class */
+    static BarIndex* get();
+
+    /** \return The entry of a channel, an entry without side if it is unknown
+     * \param [in] id : The index of the channel in the DetectorLibrary, see
+     * ChanEvent::GetID */
+    const Entry& GetEntry(const int &id) const {
+        if(id < 0 || (unsigned int)id >= entries_.size())
+            return(none_);
+        return(entries_[id]);
+    }
+
+    /** \return One more than the largest bar number of any channel with a
+     * side, the size of an array indexed by bar number */
+    unsigned int GetNumBars(void) const {return(numBars_);}
+
+private:
+    /** Default constructor, compiles the table from the DetectorLibrary */
+    BarIndex();
+    BarIndex(const BarIndex&); //!< Prevent copying the singleton
+    BarIndex& operator=(const BarIndex&); //!< Prevent assigning the singleton
+    static BarIndex* instance; //!< The only instance of the class
+
+    /** The bar number calculated from the location. We assume here
+     * that the bars are located in adjacent slots so that they are always
+     * paired in a {0,1} {2,3} {4,5} ... {n,n+1} manner. This is especially
+     * true if using a VANDLE firmware (As of 04/22/2016).
+     * \param [in] loc : the location of the channel
+     * \return The calculated bar number */
+    static unsigned int CalcBarNumber(const unsigned int &loc) {return(loc/2);}
+
+    std::vector<Entry> entries_; //!< The entries indexed by channel
+    Entry none_; //!< The entry returned for unknown channels
+    unsigned int numBars_; //!< One more than the largest bar number
+};
+#endif // __BARINDEX_HPP__
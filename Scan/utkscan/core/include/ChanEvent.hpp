@@ -36,6 +36,12 @@ public:
     ///Default Destructor
     ~ChanEvent(){};
 
+    /** Fill the channel from decoded XIA data, zeroing everything that was
+     * set for a previous event. The trace samples are moved out of the
+     * XiaData rather than copied, which leaves its adcTrace empty.
+     * \param [in] xiadata : the decoded channel data */
+    void Set(XiaData *xiadata);
+
     /** Set the energy
      * \param [in] a : the energy */
     void SetEnergy(double a) {energy = a;}
@@ -124,6 +130,18 @@ public:
     /** \return The Onboard QDC value at i
      * \param [in] i : the QDC number to obtain, possible values [0,7] */
     unsigned long GetQdcValue(int i) const;
+    /** \return true if the header contained the onboard energy filter sums */
+    bool HasEnergySums() const {
+        return data_.hasEnergySums;
+    }
+    /** \return The onboard energy filter sum at i
+     * \param [in] i : the sum to obtain, one of XiaData::TRAILING_SUM,
+     * XiaData::LEADING_SUM or XiaData::GAP_SUM */
+    unsigned long GetEnergySum(int i) const;
+    /** \return the onboard baseline of the energy filter */
+    double GetEnergySumBaseline() const {
+        return data_.energyBaseline;
+    }
 
     /** Channel event zeroing
      * All numerical values are set to -1, and the trace,
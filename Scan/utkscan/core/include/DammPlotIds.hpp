@@ -31,6 +31,7 @@ namespace dammIds {
         const int D_SCALAR = 600;//!< Rates for the detectors
         const int D_TIME = 900;//!< Arrival times for the channels
         const int D_CAL_ENERGY = 1200;//!< Calibrated energies
+        const int D_SUM_ENERGY = 1500;//!< Energies from the onboard sums
 
         const int D_HIT_SPECTRUM = 1801;//!< Channel hit spectrum
         const int D_SUBEVENT_GAP = 1802;//!< Time difference between sub events
@@ -44,6 +45,8 @@ namespace dammIds {
         const int DD_RUNTIME_MSEC = 1810;//!< Run Time in ms
         const int D_NUMBER_OF_EVENTS = 1811;//!< Number of processed events
         const int D_HAS_TRACE = 1812;//!< Plot for Channels w/ Traces
+        const int D_SPILL_PRESCALE = 1813;//!< Processed spills vs. prescale
+        const int DD_SHED_LEVEL = 1814;//!< Load shedding level vs. wall time
     }
 
     /// in PspmtProcessor.cpp
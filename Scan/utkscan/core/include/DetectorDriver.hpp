@@ -33,6 +33,8 @@
 #ifndef __DETECTORDRIVER_HPP_
 #define __DETECTORDRIVER_HPP_
 
+#include <atomic>
+#include <mutex>
 #include <set>
 #include <string>
 #include <utility>
@@ -46,9 +48,11 @@
 #include "WalkCorrector.hpp"
 
 class Calibration;
+class EnergySumAnalyzer;
 class RawEvent;
 class EventProcessor;
 class TraceAnalyzer;
+class XmlConfiguration;
 
 /*! \brief DetectorDriver controls event processing
 
@@ -145,6 +149,11 @@ public:
         return(vecProcess);
     }
 
+    /** \return the list of the Trace Analyzers in the analysis */
+    const std::vector<TraceAnalyzer *>& GetAnalyzers(void) const {
+        return(vecAnalyzer);
+    }
+
     /** \return The requested event processor
      * \param [in] name : the name of the processor to return */
     EventProcessor* GetProcessor(const std::string &name) const;
@@ -152,6 +161,28 @@ public:
     /** \return the set of detectors used in the analysis */
     const std::set<std::string> &GetUsedDetectors(void) const;
 
+    /** Parse the configuration file again and schedule the calibrations,
+     * walk corrections, timing calibrations, trapezoidal filter parameters
+     * and the reloadable parameters of the analyzers and processors to be
+     * replaced before the next event is processed. The
+     * histograms are left untouched. This may be called from a thread other
+     * than the one processing the events. Throws a GeneralException, without
+     * changing anything, if the file cannot be parsed or if its channel map
+     * differs from the one in use. */
+    void RequestReload(void);
+
+    /** Shed parts of the trace analysis when the online scan falls behind.
+     * Level 1 skips the FittingAnalyzer, level 2 and above skip all of the
+     * trace analyzers except those defining the energy of the channels (a
+     * TraceFilterAnalyzer with UseFilterEnergy), so the energies keep their
+     * source. The EnergySumAnalyzer is never shed. This may be called from a
+     * thread other than the one processing the events.
+     * \param [in] level : the number of analysis levels to shed, 0 for none */
+    void SetShedLevel(const unsigned int &level) {shedLevel = level;}
+
+    /** \return the number of analysis levels which are shed */
+    unsigned int GetShedLevel(void) const {return shedLevel;}
+
     /** Default Destructor - Not called due to singleton nature */
     virtual ~DetectorDriver();
 private:
@@ -165,11 +196,31 @@ private:
 
     std::vector<TraceAnalyzer*> vecAnalyzer; /**< object which analyzes traces of channels to extract
                    energy and time information */
+    EnergySumAnalyzer *energySumAnalyzer; /**< reconstructs energies from the
+                   onboard sums, owned by vecAnalyzer */
+    TraceAnalyzer *fittingAnalyzer; /**< the FittingAnalyzer, the first to
+                   be shed, owned by vecAnalyzer */
+    std::atomic<unsigned int> shedLevel; //!< number of analysis levels which are shed
+    /** Energy of a channel without a trace derived one: reconstructed from
+     * the onboard sums if the header has them and the EnergySumAnalyzer is
+     * loaded, otherwise the Pixie energy randomized within its bin.
+     * \param [in] chan : the channel
+     * \param [in] type : the detector type
+     * \param [in] subtype : the detector subtype
+     * \return the uncalibrated energy */
+    double OnboardEnergy(ChanEvent *chan, const std::string &type,
+                         const std::string &subtype);
+
     std::set<std::string> knownDetectors; /**< list of valid detectors that can
                    be used as detector types */
-    std::string cfg_; //!< The configuration file to read
     std::pair<double, time_t> pixieToWallClock; /**< rough estimate of pixie to wall clock */
 
+    std::mutex reloadLock; //!< Protects the reload waiting to be applied
+    std::atomic<bool> reloadPending; //!< True if a reload is waiting
+    XmlConfiguration *reloadConfig; //!< The configuration to reload from
+    Calibrator *reloadCali; //!< The calibrator built from reloadConfig
+    WalkCorrector *reloadWalk; //!< The walk corrector built from reloadConfig
+
 
     /*! Declares a 1D histogram calls the C++ wrapper for DAMM
     * \param [in] dammId : The histogram number to define
@@ -193,10 +244,18 @@ private:
      * \param [in] m : the messenger to pass the loading messages through */
     void LoadProcessors(Messenger& m);
 
-    /** Read in the Calibration parameters from the Config.xml */
-    void ReadCalXml();
-    /** Read in the Walk correction parameters from the Config.xml */
-    void ReadWalkXml();
+    /** Read in the Calibration parameters from the Config.xml
+     * \param [in] xml : the configuration to read from
+     * \param [out] cal : the calibrator to add the channels to */
+    void ReadCalXml(const XmlConfiguration &xml, Calibrator &cal);
+    /** Read in the Walk correction parameters from the Config.xml
+     * \param [in] xml : the configuration to read from
+     * \param [out] corr : the walk corrector to add the channels to */
+    void ReadWalkXml(const XmlConfiguration &xml, WalkCorrector &corr);
+
+    /** Replace the parameters with the ones prepared by RequestReload,
+     * called between events by the thread processing the data. */
+    void ApplyReload(void);
 };
 
 #endif // __DETECTORDRIVER_HPP_
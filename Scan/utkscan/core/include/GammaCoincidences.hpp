@@ -0,0 +1,247 @@
+/** \file GammaCoincidences.hpp
+ * \brief Compact storage for symmetric gamma-gamma matrices and
+ * gamma-gamma-gamma cubes, and an index for gamma-gamma gates
+ * \date Oct. 19th, 2026
+ */
+#ifndef __GAMMACOINCIDENCES_HPP_
+#define __GAMMACOINCIDENCES_HPP_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/** \brief A symmetric gamma-gamma matrix stored as its upper triangle.
+ *
+ * The matrix is split into square blocks of blockBins x blockBins bins and
+ * only the blocks on or above the diagonal are kept. A block is allocated
+ * when one of its bins is first filled, so regions of the matrix which never
+ * see a coincidence cost nothing. Each pair is counted once, so there is one
+ * fill instead of the two of a full matrix filled at (x,y) and (y,x). The
+ * cells are 4 bytes and held in memory, while a DAMM 2D histogram uses 2
+ * byte cells by default and lives in the .his file, so the compact matrix
+ * only needs less memory than the full one when most blocks stay empty.
+ * The values returned by Get, Project and Gate are those of the full matrix.
+ * The matrices are not part of the .his, ggGate projects and gates the
+ * written files.
+ */
+class GammaMatrix {
+public:
+    /** Constructor
+     * \param [in] bins : the number of bins on each axis
+     * \param [in] blockBins : the number of bins on each side of a block */
+    GammaMatrix(unsigned int bins = 4096, unsigned int blockBins = 64);
+
+    /** Add a coincidence between two energies, values outside of the
+     * matrix are dropped
+     * \param [in] e1 : the first energy
+     * \param [in] e2 : the second energy
+     * \param [in] weight : the weight of the coincidence */
+    void Fill(double e1, double e2, unsigned int weight = 1);
+
+    /** \return the content of bin (x,y) of the full symmetric matrix
+     * \param [in] x : the first bin
+     * \param [in] y : the second bin */
+    unsigned int Get(unsigned int x, unsigned int y) const;
+
+    /** Project the full matrix onto one of its (identical) axes
+     * \param [out] spectrum : the projection, resized to the number of bins */
+    void Project(std::vector<double> &spectrum) const;
+
+    /** Fill the spectrum in coincidence with a gate on the other axis
+     * \param [in] low : the first bin of the gate
+     * \param [in] high : the last bin of the gate (included)
+     * \param [out] spectrum : the gated spectrum, resized to the number of bins */
+    void Gate(unsigned int low, unsigned int high,
+              std::vector<double> &spectrum) const;
+
+    /** Write the allocated blocks to a file
+     * \param [in] fileName : the name of the file */
+    void Write(const std::string &fileName) const;
+
+    /** Replace the matrix with one written by Write
+     * \param [in] fileName : the name of the file */
+    void Read(const std::string &fileName);
+
+    /** Add the counts of another matrix, for example the part of a run
+     * list worker. Throws a GeneralException if the binning differs.
+     * \param [in] other : the matrix to add */
+    void Add(const GammaMatrix &other);
+
+    /** Remove all coincidences and release the blocks */
+    void Clear(void);
+
+    /** \return the number of bins on each axis */
+    unsigned int GetNumBins(void) const {return bins_;}
+
+    /** \return the number of bins on each side of a block */
+    unsigned int GetBlockBins(void) const {return blockBins_;}
+
+    /** \return the number of bytes used by the allocated blocks */
+    size_t GetMemoryUsage(void) const;
+
+private:
+    unsigned int bins_; //!< number of bins on each axis
+    unsigned int blockBins_; //!< number of bins on each side of a block
+    unsigned int numBlocks_; //!< number of blocks on each axis
+
+    /** Blocks of the upper triangle, indexed by the position of (bx,by),
+     * bx <= by, in the packed triangle. An empty block has no counts. */
+    std::vector< std::vector<unsigned int> > blocks_;
+
+    /** \return the index of block (bx,by), bx <= by, in the packed triangle */
+    size_t BlockIndex(unsigned int bx, unsigned int by) const {
+        return (size_t)by * (by + 1) / 2 + bx;
+    }
+};
+
+/** \brief A symmetric gamma-gamma-gamma cube stored in a memory mapped file.
+ *
+ * Only the part of the cube with x <= y <= z is kept, split into cubic blocks
+ * of blockBins^3 bins. Blocks are appended to the file when one of their bins
+ * is first filled and the file is mapped in chunks as it grows, so the size
+ * of the cube is limited by the disk rather than by memory. Each triple is
+ * counted once, irrespective of the order of the energies. Close() writes
+ * the block directory at the end of the file, after which it can be opened
+ * again for gating with the constructor taking only a file name, or with
+ * ggGate.
+ */
+class GammaCube {
+public:
+    /** Constructor creating a new cube file
+     * \param [in] fileName : the name of the file backing the cube
+     * \param [in] bins : the number of bins on each axis
+     * \param [in] blockBins : the number of bins on each side of a block */
+    GammaCube(const std::string &fileName, unsigned int bins,
+              unsigned int blockBins = 16);
+
+    /** Constructor opening a cube file written earlier, read only
+     * \param [in] fileName : the name of the file */
+    GammaCube(const std::string &fileName);
+
+    /** Default destructor, closes the file ignoring any error */
+    ~GammaCube();
+
+    /** The cube owns its mapping of the file, so it can not be copied */
+    GammaCube(const GammaCube &) = delete;
+
+    /** The cube owns its mapping of the file, so it can not be copied */
+    GammaCube &operator=(const GammaCube &) = delete;
+
+    /** Add a coincidence between three energies, values outside of the
+     * cube are dropped
+     * \param [in] e1 : the first energy
+     * \param [in] e2 : the second energy
+     * \param [in] e3 : the third energy */
+    void Fill(double e1, double e2, double e3);
+
+    /** \return the number of triples with the given bins, in any order
+     * \param [in] x : the first bin
+     * \param [in] y : the second bin
+     * \param [in] z : the third bin */
+    unsigned int Get(unsigned int x, unsigned int y, unsigned int z) const;
+
+    /** Fill the spectrum in coincidence with two gates
+     * \param [in] low1 : the first bin of the first gate
+     * \param [in] high1 : the last bin of the first gate (included)
+     * \param [in] low2 : the first bin of the second gate
+     * \param [in] high2 : the last bin of the second gate (included)
+     * \param [out] spectrum : the gated spectrum, resized to the number of bins */
+    void Gate(unsigned int low1, unsigned int high1,
+              unsigned int low2, unsigned int high2,
+              std::vector<double> &spectrum) const;
+
+    /** Add the counts of another cube, for example the part of a run list
+     * worker. Throws a GeneralException if this cube is read only or the
+     * binning differs.
+     * \param [in] other : the cube to add */
+    void Add(const GammaCube &other);
+
+    /** Write the block directory and release the file. Called by the
+     * destructor, the cube can not be used afterwards.
+     * \return false if the directory of a new cube could not be written */
+    bool Close(void);
+
+    /** \return the number of bins on each axis */
+    unsigned int GetNumBins(void) const {return bins_;}
+
+    /** \return the number of bins on each side of a block */
+    unsigned int GetBlockBins(void) const {return blockBins_;}
+
+    /** \return the number of allocated blocks */
+    unsigned int GetNumAllocatedBlocks(void) const {return numAllocated_;}
+
+private:
+    std::string fileName_; //!< name of the backing file
+    int fd_; //!< descriptor of the backing file, -1 once closed
+    bool readOnly_; //!< true if the cube was opened for gating only
+
+    unsigned int bins_; //!< number of bins on each axis
+    unsigned int blockBins_; //!< number of bins on each side of a block
+    unsigned int numBlocks_; //!< number of blocks on each axis
+    unsigned int numAllocated_; //!< number of blocks in the file
+
+    /** For every block with bx <= by <= bz the number of its block in the
+     * file plus one, or zero if it has not been allocated. */
+    std::vector<unsigned int> directory_;
+    std::vector<unsigned int*> chunks_; //!< mapped chunks of the file
+
+    /** Map the chunk of the file holding the given block, growing the file
+     * if needed */
+    void MapChunk(unsigned int chunk);
+
+    /** \return the block of a directory entry, NULL if not allocated */
+    unsigned int *Block(size_t index) const;
+
+    /** \return the index of block (bx,by,bz), bx <= by <= bz, in the
+     * directory */
+    size_t BlockIndex(unsigned int bx, unsigned int by, unsigned int bz) const {
+        return (size_t)bz * (bz + 1) * (bz + 2) / 6 +
+               (size_t)by * (by + 1) / 2 + bx;
+    }
+
+    /** \return the number of words in a block */
+    size_t BlockWords(void) const {
+        return (size_t)blockBins_ * blockBins_ * blockBins_;
+    }
+};
+
+/** \brief Index of gamma-gamma gates for fast lookup of a coincidence.
+ *
+ * Each gate is a pair of energy ranges, the lower energy of a coincidence is
+ * checked against the first range and the higher against the second. The
+ * first ranges are cut into elementary intervals which know the gates they
+ * belong to, so a lookup is a binary search instead of a pass over every
+ * gate.
+ */
+class GammaGateIndex {
+public:
+    /** A gamma-gamma gate, the first and the second energy range */
+    typedef std::pair< std::pair<double, double>,
+                       std::pair<double, double> > Gate;
+
+    /** Default constructor */
+    GammaGateIndex() {};
+
+    /** Build the index, the position of a gate in the list is its number
+     * \param [in] gates : the list of gates */
+    void Build(const std::vector<Gate> &gates);
+
+    /** Find the gates containing a coincidence
+     * \param [in] e1 : the lower energy
+     * \param [in] e2 : the higher energy
+     * \param [out] hits : the numbers of the gates, in increasing order */
+    void Find(double e1, double e2, std::vector<unsigned int> &hits) const;
+
+    /** \return the number of gates in the index */
+    size_t GetNumGates(void) const {return gates_.size();}
+
+private:
+    std::vector<Gate> gates_; //!< the gates
+    std::vector<double> edges_; //!< sorted borders of the first ranges
+    /** Gates whose first range contains the point at each edge and the
+     * open interval after it */
+    std::vector< std::vector<unsigned int> > atEdge_;
+    std::vector< std::vector<unsigned int> > afterEdge_;
+};
+
+#endif // __GAMMACOINCIDENCES_HPP_
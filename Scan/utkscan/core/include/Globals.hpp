@@ -151,6 +151,8 @@ namespace strings {
     }
 }
 
+class XmlConfiguration;
+
 /** \brief Singleton class holding global parameters.*/
 class Globals {
 public:
@@ -266,6 +268,12 @@ public:
                                TrapFilterParameters(125, 125, 10)));
     }
 
+    /** Re-read the trapezoidal filter parameters, called by the
+     * DetectorDriver when the configuration is reloaded during a scan. The
+     * analyzers that cache the parameters have to be reloaded as well.
+     * \param [in] xml : The freshly parsed configuration file */
+    void ReloadTrapFilters(const XmlConfiguration &xml);
+
     /*! \return path to use to output files, can be different from output
      * file path
      * \param [in] fileName : the path for the configuration files */
@@ -303,6 +311,13 @@ private:
     /** Check that some of the values make sense */
     void SanityCheck();
 
+    /** Read the trapezoidal filter parameters of every type:subtype
+    * \param [in] node : the TrapFilters node of the Trace section
+    * \param [out] pars : the trigger and energy filter parameters */
+    static void ReadTrapFilters(const pugi::xml_node &node,
+            std::map<std::string, std::pair<TrapFilterParameters,
+                                            TrapFilterParameters> > &pars);
+
     /** Warn that we have an unknown parameter in the XML configuration file
     * \param [in] m : an instance of the messenger to send the warning
     * \param [in] it : an iterator pointing to the location of the unknown */
@@ -17,8 +17,11 @@
 #include <iostream>
 #include <map>
 #include <set>
+#include <string>
 #include <vector>
 
+#include "his_shm.h"
+
 #ifndef USE_HRIBF
 /// Create a DAMM 1D histogram
 void hd1d_(int dammId, int nHalfWords, int rawlen, int histlen, int min, int max,
@@ -83,6 +86,38 @@ private:
     bool init;
 };
 
+/// Number of bins in each block of pending histogram fills
+#define HIS_BLOCK_BINS 1024
+
+/// Fills of a single histogram which have not been written to the .his file
+/// yet. The increments are kept in blocks of HIS_BLOCK_BINS bins which are
+/// only allocated once one of their bins is filled, so declared histograms
+/// that stay empty (or mostly empty) cost next to no memory.
+struct his_pending{
+    std::vector<std::vector<unsigned int> > blocks; /// Bin increments, an empty block has no fills
+    std::vector<size_t> dirty; /// Indices of the allocated blocks
+    
+    /// Add weight_ to the specified global bin of a histogram with total_bins_ bins
+    void add(size_t total_bins_, size_t bin_, unsigned int weight_){
+        size_t index = bin_ / HIS_BLOCK_BINS;
+        if(blocks.empty())
+            blocks.resize((total_bins_ + HIS_BLOCK_BINS - 1) / HIS_BLOCK_BINS);
+        std::vector<unsigned int> &block = blocks[index];
+        if(block.empty()){
+            block.assign(HIS_BLOCK_BINS, 0);
+            dirty.push_back(index);
+        }
+        block[bin_ % HIS_BLOCK_BINS] += weight_;
+    }
+    
+    /// Release all blocks
+    void clear(){
+        for(std::vector<size_t>::iterator iter = dirty.begin(); iter != dirty.end(); iter++)
+            std::vector<unsigned int>().swap(blocks[*iter]);
+        dirty.clear();
+    }
+};
+
 /// drr entry information
 struct drr_entry{
     unsigned int hisID; /// ID of the histogram
@@ -111,8 +146,11 @@ struct drr_entry{
     unsigned int total_counts; /// Total number of attempted histogram fills
     unsigned int good_counts; /// Total number of actual histogram fills
     
+    his_pending pending; /// Fills not yet written to the .his file (output only)
+    HisShmEntry *live; /// Directory entry in the live histogram segment, NULL if not published (output only)
+    
     /// Default constructor
-    drr_entry(){}
+    drr_entry() : live(NULL) {}
     
     /// Constructor for 1d histogram
     drr_entry(unsigned int hisID_, unsigned short halfWords_,
@@ -172,23 +210,6 @@ struct drr_entry{
     void print_list(std::ofstream *file_);
 };
 
-struct fill_queue{
-    drr_entry *entry; /// .drr entry of the histogram to be filled
-    unsigned int byte; /// Offset of bin (in bytes)
-    unsigned int weight; /// Weight of fill
-    bool good; /// True if the histo array index is within range
-    
-    fill_queue(drr_entry *entry_, unsigned int bin_, unsigned int w_){
-        entry = entry_;
-        byte = bin_ * entry->halfWords * 2;
-        weight = w_;
-        good = entry->check_bin(bin_);
-        if(byte < 0)
-            std::cout << " his id = " << entry_->hisID
-                      << " byte offset is less than zero (" << byte << ")!\n";
-    }
-};
-
 class HisFile{
 protected:
     bool is_good; /// True if a valid drr file is open
@@ -307,6 +328,9 @@ public:
     /// Get a drr entry from the vector
     void GetEntry(const size_t & id);
     
+    /// Return the map associating histogram IDs with drr entries
+    const std::map<unsigned int, drr_entry*> &GetDrrMap(){ return drrMap_; }
+    
     /// Load the specified histogram
     size_t GetHistogram(unsigned int hist_, bool no_copy_=false);
     
@@ -333,13 +357,27 @@ private:
     bool existing_file; /// True if the .his file was a previously existing file
     unsigned int Flush_wait; /// Number of fills to wait between Flushes
     unsigned int Flush_count; /// Number of fills since last Flush
-    std::vector<fill_queue*> fills_waiting; /// Vector containing list of histograms to be filled
+    std::vector<drr_entry*> pending_entries; /// Histograms with fills waiting to be written
     std::set<unsigned int> failed_fills; /// Vector containing list of histogram fills into an invalid his id
     std::streampos total_his_size; /// Total size of .his file
+    HisShmPublisher live; /// Live copy of all histograms in shared memory
+    std::string live_name; /// Name of the live histogram segment, empty if disabled
     
     /// Find the specified .drr entry in the drr list using its histogram id
     drr_entry *find_drr_in_list(unsigned int hisID_);
     
+    /// Queue a fill of a global bin
+    void add_fill(drr_entry *entry_, unsigned int bin_, unsigned int weight_);
+    
+    /// Add the pending fills of a histogram to the .his file
+    void flush_entry(drr_entry *entry_);
+    
+    /// Set the length of the .his file, the new space reads as zeros without being written
+    bool resize_his(std::streampos size_);
+    
+    /// Create the live histogram segment and fill its directory
+    void open_live();
+    
 public:
     OutputHisFile();
     
@@ -356,8 +394,18 @@ public:
     /// Set the number of fills to wait between file Flushes
     void SetFlushWait(unsigned int wait_){ Flush_wait = wait_; }
     
+    /* Publish the current contents of all histograms in a shared memory
+     * segment with the given name, so that viewers can sample them without
+     * waiting for a Flush. Every fill is applied to the segment immediately.
+     * The segment is created by Finalize() and removed by Close(), so this
+     * must be called before Finalize().
+     */
+    void EnableLive(const std::string &name_){ live_name = name_; }
+    
     /* Push back with another histogram entry. This command will also
-     * extend the length of the .his file (if possible). DO NOT delete
+     * extend the length of the .his file (if possible). The new space is
+     * left as a hole in the file, so it does not use any disk until the
+     * histogram is filled. DO NOT delete
      * the passed drr_entry after calling. OutputHisFile will handle cleanup.
      * On success, returns the number of bytes the file was extended by and zero
      * upon failure.
@@ -393,4 +441,34 @@ public:
 
 extern OutputHisFile *output_his; /// The global .his file handler
 
+/** Add the histograms of several outputs which were written using the same
+  * histogram definitions, e.g. by scanning different files with the same
+  * configuration. The .drr file of the first input is copied to the output,
+  * the .his files are summed one block of bins at a time so that the memory
+  * used does not depend on the size of the histograms.
+  * \param[in] inputs_ Filename prefixes of the inputs (without extension).
+  * \param[in] output_ Filename prefix of the output (without extension).
+  * \param[out] error_ Description of the problem if the sum fails.
+  * \return True upon success and false otherwise.
+  */
+bool SumHisFiles(const std::vector<std::string> &inputs_, const std::string &output_, std::string &error_);
+
+/** Combine the histograms of several outputs which were written using the
+  * same histogram definitions into output = sum(weights_[i] * inputs_[i]).
+  * When all weights are one the cells are summed exactly as SumHisFiles
+  * does, otherwise the result is rounded to the nearest integer and clipped
+  * to the range of a cell. Every thread combines whole histograms, reading
+  * and writing one block of bins at a time.
+  * \param[in] inputs_ Filename prefixes of the inputs (without extension).
+  * \param[in] weights_ The weight of every input, e.g. -1 to subtract it.
+  * \param[in] output_ Filename prefix of the output (without extension).
+  * \param[out] error_ Description of the problem if the operation fails.
+  * \param[in] threads_ The number of threads used to combine the histograms.
+  * \param[out] clipped_ If not NULL, the number of bins which had to be clipped.
+  * \return True upon success and false otherwise.
+  */
+bool CombineHisFiles(const std::vector<std::string> &inputs_, const std::vector<double> &weights_,
+                     const std::string &output_, std::string &error_, unsigned int threads_=1,
+                     unsigned long long *clipped_=NULL);
+
 #endif
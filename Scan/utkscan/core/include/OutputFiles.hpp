@@ -0,0 +1,96 @@
+/** \file OutputFiles.hpp
+ * \brief Names the files written by processors apart from the histograms
+ *
+ * The workers of a run list (see RunListScanner) all use the same
+ * configuration, so processors which write their own files would write to
+ * the same names. Processors take the names of such files from here. In a
+ * worker a suffix is inserted before the extension and the file is recorded
+ * in a list that the worker writes when it finishes. After all of the
+ * workers succeed the parts are combined into the original names, according
+ * to the kind of file. Outside of a run list the names are unchanged.
+ *
+ * \date Oct. 19th, 2026
+ */
+#ifndef __OUTPUTFILES_HPP__
+#define __OUTPUTFILES_HPP__
+
+#include <string>
+#include <vector>
+
+///Describes how the parts of a file written by several workers are combined
+enum OutputKind {
+    OUTPUT_KEEP = 0, //!< Not combined, the parts are kept
+    OUTPUT_TEXT = 1, //!< Text, the parts are concatenated
+    OUTPUT_TEXT_APPEND = 2, //!< Text, the parts are appended to an existing file
+    OUTPUT_COLUMNS = 3, //!< A column file, the events of the parts are concatenated
+    OUTPUT_GAMMA_MATRIX = 4, //!< A .ggm matrix, the parts are summed
+    OUTPUT_GAMMA_CUBE = 5 //!< A gamma cube, the parts are summed
+};
+
+///A file written by a processor
+struct OutputFileEntry {
+    std::string name; //!< The name given in the configuration
+    std::string part; //!< The name that was written
+    OutputKind kind; //!< How the parts are combined
+};
+
+///Keeps the names of the files written by the processors
+class OutputFiles {
+public:
+    /** \return the only instance of the class */
+    static OutputFiles *get();
+
+    /** Set the suffix inserted into the names, done by a run list worker
+     * before the processors are created
+     * \param [in] suffix : the suffix, e.g. _part003 */
+    void SetSuffix(const std::string &suffix) { suffix_ = suffix; }
+
+    /** \return the suffix inserted into the names */
+    const std::string &GetSuffix() const { return suffix_; }
+
+    /** Register a file and return the name it should be written to
+     * \param [in] name : the name of the file in the configuration
+     * \param [in] kind : how the parts of the file are combined
+     * \return the name to write, which includes the suffix if one is set */
+    std::string Register(const std::string &name, const OutputKind &kind);
+
+    /** Write the list of registered files
+     * \param [in] listName : the name of the list file
+     * \return true if the list was written */
+    bool WriteList(const std::string &listName) const;
+
+    /** Read a list written by a worker
+     * \param [in] listName : the name of the list file
+     * \param [out] entries : the files in the list
+     * \return true if the list was read */
+    static bool ReadList(const std::string &listName,
+                         std::vector<OutputFileEntry> &entries);
+
+    /** Combine the parts of a file written by several workers
+     * \param [in] name : the name of the combined file
+     * \param [in] kind : how the parts are combined
+     * \param [in] parts : the names of the parts in the order of the run list
+     * \param [out] error : a description of the problem if it fails
+     * \return true if the parts were combined and may be removed */
+    static bool Combine(const std::string &name, const OutputKind &kind,
+                        const std::vector<std::string> &parts,
+                        std::string &error);
+
+    /** \return the name with the suffix inserted before the extension
+     * \param [in] name : the name of the file
+     * \param [in] suffix : the suffix to insert */
+    static std::string InsertSuffix(const std::string &name,
+                                    const std::string &suffix);
+
+private:
+    /** Default constructor */
+    OutputFiles() {};
+    OutputFiles(OutputFiles const &); //!< Not implemented
+    void operator=(OutputFiles const &); //!< Not implemented
+    static OutputFiles *instance; //!< The only instance of the class
+
+    std::string suffix_; //!< The suffix inserted into the names
+    std::vector<OutputFileEntry> entries_; //!< The registered files
+};
+
+#endif //__OUTPUTFILES_HPP__
@@ -46,11 +46,14 @@ public:
     /** Default Constructor */
     RawEvent(){};
 
-    /** Default Destructor */
-    ~RawEvent(){};
+    /** Default Destructor, deletes the channels in the event and the pool */
+    ~RawEvent();
 
     /** Clear the list of individual channel events (Memory is managed elsewhere) */
-    void Clear(void) {eventList.clear();};
+    void Clear(void) {
+        eventList.clear();
+        subEventList.clear();
+    };
 
     /** \return the number of channels in the current event */
     size_t Size(void) const {return(eventList.size());};
@@ -65,10 +68,24 @@ public:
     * \param [in] event : the event to add to the raw event */
     void AddChan(ChanEvent* event) {eventList.push_back(event);};
 
+    /** Add a channel event built from decoded XIA data to the raw event. The
+    * ChanEvent is taken from the pool of channels recycled by Zero() and
+    * takes the trace of the XiaData, see ChanEvent::Set.
+    * \param [in] xiadata : the decoded data for the channel
+    * \return a pointer to the added channel event */
+    ChanEvent* AddChan(XiaData *xiadata);
+
+    /** Add a channel event of the sub-event, the channels with their own
+    * event window (see Unpacker::SetChannelWindow), built like AddChan.
+    * \param [in] xiadata : the decoded data for the channel
+    * \return a pointer to the added channel event */
+    ChanEvent* AddSubEventChan(XiaData *xiadata);
+
     /** \brief Raw event zeroing
     *
     * For any detector type that was used in the event, zero the appropriate
-    * detector summary in the map, and clear the event list
+    * detector summary in the map, and clear the event list. The channel
+    * events are returned to the pool for reuse rather than deleted.
     * \param [in] usedev : the detector summary to zero */
     void Zero(const std::set<std::string> &usedev);
 
@@ -87,11 +104,26 @@ public:
 
     /** \return the list of events */
     const std::vector<ChanEvent *> &GetEventList(void) const {return eventList;}
+
+    /** \return the channels of the sub-event. They are added to the
+    * detector summaries of their types like the channels of the event, but
+    * are not part of the event list. */
+    const std::vector<ChanEvent *> &GetSubEventList(void) const {
+        return subEventList;
+    }
 private:
     std::map<std::string, DetectorSummary> sumMap; /**< An STL map containing DetectorSummary classes
 					    associated with detector types */
     mutable std::set<std::string> nullSummaries;   /**< Summaries which were requested but don't exist */
     std::vector<ChanEvent*> eventList; /**< Pointers to all the channels that are close
                                             enough in time to be considered a single event */
+    std::vector<ChanEvent*> subEventList; /**< Channels with their own event
+                                               window that follow the event */
+    std::vector<ChanEvent*> chanPool; /**< Channel events that are free for reuse */
+
+    /** The raw event owns its channels, so it cannot be copied */
+    RawEvent(const RawEvent &);
+    /** The raw event owns its channels, so it cannot be assigned */
+    RawEvent& operator=(const RawEvent &);
 };
 #endif // __RAWEVENT_HPP_
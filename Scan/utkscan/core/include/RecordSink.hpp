@@ -0,0 +1,98 @@
+/** \file RecordSink.hpp
+ * \brief A buffered binary sink for the records dumped by processors
+ * \date Oct. 19th, 2026
+ */
+#ifndef __RECORDSINK_HPP__
+#define __RECORDSINK_HPP__
+
+#include <string>
+#include <vector>
+
+#include <ctime>
+
+#include "ColumnFile.h"
+#include "Exceptions.hpp"
+
+//! Replaces the per event text dumps of the experiment processors. A
+//! processor declares the layout of its records once, as a list of named and
+//! typed fields, and then writes one record per call to Write. The records
+//! are batched into a column file by a ColumnWriter, which encodes and writes
+//! them from a background thread, so the scan neither formats numbers nor
+//! flushes a stream for every event. The records are handed to the writer at
+//! least once a second, so a scan which is killed or crashes only loses the
+//! last second of records. Such files have no footer but are still read. The
+//! files are turned back into the old space delimited text with
+//! "colDump --text".
+class RecordSink {
+public:
+    /** Default constructor */
+    RecordSink() : lastFlush_(0) {};
+    /** Default destructor, writes the remaining records and closes the file */
+    ~RecordSink() {Close();};
+
+    /** Declare the next field of the records. Fields must be added before
+     * the file is first opened.
+     * \param [in] name : the name of the field, the column name in the file
+     * \param [in] type : the type the field is stored as
+     * \return true if the field was added */
+    bool AddField(const std::string &name, const ColumnType &type = COLUMN_DOUBLE);
+
+    /** Open the output file and start the writer thread. An existing file is
+     * replaced, the records of earlier runs are not appended.
+     * \param [in] fileName : the name of the file
+     * \return true if the file was opened */
+    bool Open(const std::string &fileName);
+
+    /** \return true if the file is open */
+    bool IsOpen(void) {return(writer_.IsOpen());};
+
+    /** Write the remaining records and close the file */
+    void Close(void) {writer_.Close();};
+
+    /** Write a record, one value per declared field and in the same order.
+     * The values are converted to the types of their fields, integers
+     * beyond 2^53 lose precision. Nothing is written if the file is not open.
+     * \param [in] values : the values of the fields */
+    template<typename... Values>
+    void Write(const Values&... values) {
+        if(!writer_.IsOpen())
+            return;
+        if(sizeof...(values) != types_.size())
+            throw GeneralException("RecordSink::Write : The number of values "
+                                   "does not match the fields of " + fileName_);
+        SetFields(0, values...);
+        writer_.Fill();
+        time_t now = time(NULL);
+        if(now != lastFlush_) {
+            writer_.Flush();
+            lastFlush_ = now;
+        }
+    }
+
+    /** \return the number of records written */
+    unsigned long long GetNumRecords(void) {return(writer_.GetEntries());};
+private:
+    /** Store a value in a field of the current record
+     * \param [in] field : the index of the field
+     * \param [in] value : the value */
+    void SetField(const size_t &field, const double &value);
+
+    /** Ends the recursion of SetFields */
+    void SetFields(const size_t &field) {};
+
+    /** Store the values of the current record, one field at a time */
+    template<typename Value, typename... Values>
+    void SetFields(const size_t &field, const Value &value,
+                   const Values&... values) {
+        SetField(field, (double)value);
+        SetFields(field + 1, values...);
+    }
+
+    std::string fileName_; //!< The name of the output file
+    std::vector<std::string> names_; //!< The names of the fields
+    std::vector<ColumnType> types_; //!< The types of the fields
+    std::vector<unsigned long long> record_; //!< The current record, one 8 byte slot per field
+    ColumnWriter writer_; //!< The writer of the column file
+    time_t lastFlush_; //!< The time the records were last handed to the writer
+};
+#endif // __RECORDSINK_HPP__
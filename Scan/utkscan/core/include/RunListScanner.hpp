@@ -0,0 +1,73 @@
+/** \file RunListScanner.hpp
+ * \brief Scans a list of input files in parallel and sums the histograms
+ *
+ * The analysis relies on a number of singletons (DetectorDriver,
+ * DetectorLibrary, TreeCorrelator, the global .his file, ...), so the files
+ * of a run list are scanned by worker processes forked from utkscan. Each
+ * worker has its own copy of the processor state, scans a single file in
+ * batch mode and writes its own .his/.drr. Files written by processors get
+ * a per worker name from OutputFiles. When all of the workers have finished
+ * the histograms are summed into the requested output, the other files are
+ * combined where possible and the per file outputs are removed.
+ *
+ * \date Oct. 19th, 2026
+ */
+#ifndef __RUNLISTSCANNER_HPP__
+#define __RUNLISTSCANNER_HPP__
+
+#include <string>
+#include <vector>
+
+///Runs utkscan over a list of files with several worker processes
+class RunListScanner {
+public:
+    /** Constructor that looks for the run list options in the command line,
+     * the remaining options are passed on to the workers
+     * \param[in] argc : The number of command line arguments
+     * \param[in] argv : The command line arguments */
+    RunListScanner(int argc, char *argv[]);
+
+    /** Default Destructor */
+    ~RunListScanner() {};
+
+    /** \return true if a run list was given on the command line */
+    bool IsRequested() const { return !listName_.empty(); }
+
+    /** Scan all of the files in the run list and sum the histograms
+     * \return 0 on success and 1 otherwise */
+    int Execute();
+
+private:
+    std::string progName_; //!< The name of the program
+    std::string listName_; //!< The name of the run list file
+    std::string output_; //!< The output filename prefix
+    unsigned int jobs_; //!< The number of files scanned at the same time
+    std::vector<std::string> passArgs_; //!< Options given to every worker
+    std::vector<std::string> files_; //!< The files in the run list
+
+    /** Read the names of the files from the run list. Empty lines and
+     * lines starting with # are ignored.
+     * \return true if at least one file was read */
+    bool ReadList();
+
+    /** \return the output filename prefix of a worker
+     * \param[in] index : The index of the file in the run list */
+    std::string GetPartName(const size_t &index) const;
+
+    /** Scan a single file, called in the worker process
+     * \param[in] index : The index of the file in the run list
+     * \return the exit code of the worker */
+    int ScanFile(const size_t &index);
+
+    /** Sum the counters written to the .log files of the workers
+     * \param[in] parts : The output prefixes of the workers */
+    void MergeLogs(const std::vector<std::string> &parts) const;
+
+    /** Combine the files written by the processors of the workers, e.g.
+     * column files and notebooks, into the names from the configuration
+     * \param[in] parts : The output prefixes of the workers
+     * \return true if every file that can be combined was combined */
+    bool MergeOutputs(const std::vector<std::string> &parts) const;
+};
+
+#endif //__RUNLISTSCANNER_HPP__
@@ -13,6 +13,8 @@
 #include "Globals.hpp"
 #include "Messenger.hpp"
 
+class XmlConfiguration;
+
 //! A class to hold the timing calibration for a detector
 class TimingCalibration {
 public:
@@ -83,13 +85,23 @@ public:
     /** \return The calibration for the requested bar
      * \param [in] id : the id of the bar that you want the calibration for */
     TimingCalibration GetCalibration(const TimingDefs::TimingIdentifier &id);
+
+    /** Replace the calibrations with the ones found in the given
+     * configuration. Does nothing if the calibrator was never used.
+     * \param [in] xml : the freshly parsed configuration file */
+    static void Reload(const XmlConfiguration &xml);
 private:
-    TimingCalibrator() {ReadTimingCalXml();}; //!<Default constructor
+    TimingCalibrator(); //!<Default constructor
     TimingCalibrator (const TimingCalibrator&);//!< Overload of the constructor
     TimingCalibrator& operator = (TimingCalibrator const&);//!< the copy constructor
     static TimingCalibrator* instance; //!< static instance of the class
 
-    void ReadTimingCalXml(); //!< Reads in the calibrations in the XML config
+    /** Reads in the calibrations in the XML config
+     * \param [in] xml : the configuration to read from
+     * \param [out] cals : the map to fill with the calibrations */
+    void ReadTimingCalXml(const XmlConfiguration &xml,
+                          std::map<TimingDefs::TimingIdentifier,
+                                   TimingCalibration> &cals);
 
     Messenger m_; //!< Instance of the Messenger class to output information
     std::map <TimingDefs::TimingIdentifier, TimingCalibration> calibrations_; //!< map to hold the calibrations
@@ -29,6 +29,17 @@ public:
     * \param [in] x : the trace to store in the class */
     Trace(const std::vector<int> &x) : std::vector<int>(x) {}
 
+    /** Clear the samples and all of the values and filters that were stored
+    * with the trace. The memory is kept so that the trace can be reused. */
+    void Reset() {
+        clear();
+        waveform_.clear();
+        trigFilter_.clear();
+        esums_.clear();
+        doubleTraceData.clear();
+        intTraceData.clear();
+    }
+
     /** Insert a value into the trace map
     * \param [in] name : the name of the parameter to insert
     * \param [in] value : the value to insert into the map */
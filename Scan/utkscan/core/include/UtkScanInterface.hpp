@@ -26,11 +26,9 @@ public:
                                std::vector<std::string> &args_);
 
     /** ExtraArguments is used to send command line arguments to classes derived
-     * from ScanInterface. It has its own instance of getopts to look for its known 
-     * parameters. 
-     * \param[in] argc : The number of command line arguments
-     * \param[in] argv[] : The arrary containing all command line arguments */
-    virtual void ExtraArguments(int argc, char *argv[]) {}
+     * from ScanInterface. It checks the options added by ArgHelp which
+     * have been flagged as active by ScanInterface::Setup. */
+    virtual void ExtraArguments(void);
 
     /** Initialize the map file, the config file, the processor handler, 
      * and add all of the required processors.
@@ -60,9 +58,10 @@ public:
 
     /** ArgHelp is used to allow a derived class to print a help statment about
      * its own command line arguments. This method is called at the end of
-     * the ScanInterface::help method.
+     * the ScanInterface::help method. Adds the run list options, which are
+     * handled by the RunListScanner before the scan is set up.
      * \return Nothing. */
-    virtual void ArgHelp(void) {}
+    virtual void ArgHelp(void);
 
     /** SyntaxStr is used to print a linux style usage message to the screen.
      * \param[in]  name_ The name of the program.
@@ -85,9 +84,17 @@ public:
      * \return Nothing. */
     virtual void Notify(const std::string &code_ = "");
 
+    /** Record the load shedding applied to a spill received from poll2.
+     * \param[in] processed_ True if the spill is processed and false if it
+     * is shed.
+     * \return Nothing. */
+    virtual void SpillReceived(const bool &processed_);
+
 private:
     bool init_; /// Set to true when the initialization process successfully completes.
     std::string outputFname_; /// The output histogram filename prefix.
+    std::string liveName_; /// The name of the live histogram segment, empty if disabled.
+    time_t shedStart_; /// The wall time of the first spill seen by the load shedding.
 };
 
 #endif //__UTK_SCAN_INTERFACE_HPP__
@@ -23,6 +23,11 @@ public:
     UtkUnpacker() : Unpacker() {}
     /// Default destructor that deconstructs the DetectorDriver singleton
     ~UtkUnpacker();
+
+    ///@brief Gives the channels of the detector groups in the EventWindows
+    /// section of the configuration their own event windows. Must be called
+    /// after the DetectorLibrary has read the map.
+    void LoadEventWindows();
     
 private:
     ///@brief Process all events in the event list.
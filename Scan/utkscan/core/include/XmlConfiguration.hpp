@@ -0,0 +1,124 @@
+/** \file XmlConfiguration.hpp
+ * \brief The configuration file parsed once and shared by the whole scan
+ *
+ * The XML configuration is read and parsed a single time at startup. The
+ * channel map, together with the energy calibrations and walk corrections of
+ * every channel, is validated and converted into a typed model that the
+ * DetectorLibrary and DetectorDriver consume. The remaining sections are
+ * handed out as nodes of the shared document. If the Map node carries the
+ * attribute cache="true" the typed channel map is stored in a binary cache
+ * next to the configuration file, keyed by a hash of the file contents, and
+ * is read back from there on the next start. The hash is checked before the
+ * file is parsed, and with a valid cache the Map section is left out of the
+ * parse.
+ *
+ * \date Oct. 19th, 2026
+ */
+#ifndef __XMLCONFIGURATION_HPP__
+#define __XMLCONFIGURATION_HPP__
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include "pugixml.hpp"
+
+///A calibration or walk correction of a single channel
+struct CorrectionModel {
+    std::string model; //!< The name of the model
+    double min; //!< The lower edge of the validity range
+    double max; //!< The upper edge of the validity range
+    std::vector<double> parameters; //!< The parameters of the model
+};
+
+///The description of a single channel in the map
+struct ChannelModel {
+    int module; //!< The module number
+    int channel; //!< The channel number
+    std::string type; //!< The detector type
+    std::string subtype; //!< The detector subtype
+    int location; //!< The location, -1 if it should be assigned automatically
+    std::vector<std::string> tags; //!< The tags of the channel
+    std::vector<CorrectionModel> calibrations; //!< The energy calibrations
+    std::vector<CorrectionModel> walks; //!< The walk corrections
+};
+
+///The parsed configuration file that is shared by all parts of the scan
+class XmlConfiguration {
+public:
+    /** \return the only instance of the class, the configuration file is
+     * taken from the Globals */
+    static XmlConfiguration *get();
+
+    /** \return the only instance of the class, parsing the file on the
+     * first call
+     * \param[in] file : the configuration file to parse */
+    static XmlConfiguration *get(const std::string &file);
+
+    /** Parse a configuration file into a new instance that is not shared
+     * with the rest of the scan, used to reload parameters while running.
+     * The caller owns the returned object.
+     * \param[in] file : the configuration file to parse
+     * \return the parsed configuration */
+    static XmlConfiguration *Parse(const std::string &file);
+
+    /** Default Destructor */
+    ~XmlConfiguration();
+
+    /** \return the name of the configuration file */
+    const std::string &GetFileName() const { return fileName_; }
+
+    /** \return the 64-bit FNV-1a hash of the contents of the file */
+    uint64_t GetHash() const { return hash_; }
+
+    /** \return the requested child of the Configuration node, the node is
+     * empty if the section is not present in the file
+     * \param[in] name : the name of the section */
+    pugi::xml_node GetSection(const std::string &name) const {
+        return doc_.child("Configuration").child(name.c_str());
+    }
+
+    /** \return the typed channel map in the order of the file */
+    const std::vector<ChannelModel> &GetChannels() const { return channels_; }
+
+    /** \return true if the channel map was read from the binary cache */
+    bool IsMapFromCache() const { return mapFromCache_; }
+
+private:
+    /** Constructor that reads and parses the file
+     * \param[in] file : the configuration file */
+    XmlConfiguration(const std::string &file);
+    XmlConfiguration(XmlConfiguration const &); //!< Not implemented
+    void operator=(XmlConfiguration const &); //!< Not implemented
+    static XmlConfiguration *instance; //!< The only instance of the class
+
+    /** Build the typed channel map from the Map section of the document */
+    void ParseMap();
+
+    /** Parse all of the calibration like children of a channel
+     * \param[in] channel : the channel node
+     * \param[in] name : the name of the children to parse
+     * \param[out] list : the vector to fill */
+    void ParseCorrections(const pugi::xml_node &channel, const char *name,
+                          std::vector<CorrectionModel> &list);
+
+    /** \return the name of the binary cache of the channel map */
+    std::string GetCacheName() const;
+
+    /** Read the channel map from the binary cache
+     * \return true if the cache exists and belongs to the current file */
+    bool ReadCache();
+
+    /** Write the channel map to the binary cache, failures are reported
+     * but are not fatal */
+    void WriteCache() const;
+
+    std::string fileName_; //!< The name of the configuration file
+    uint64_t hash_; //!< The hash of the contents of the file
+    pugi::xml_document doc_; //!< The parsed document
+    std::vector<ChannelModel> channels_; //!< The typed channel map
+    bool mapFromCache_; //!< True if the map was read from the cache
+};
+
+#endif //__XMLCONFIGURATION_HPP__
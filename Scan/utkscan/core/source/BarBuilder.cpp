@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "BarBuilder.hpp"
+#include "BarIndex.hpp"
 #include "TimingMapBuilder.hpp"
 
 using namespace std;
@@ -15,49 +16,58 @@ void BarBuilder::BuildBars(void) {
     ClearMaps();
     FillMaps();
 
-    for(map<unsigned int, unsigned int>::const_iterator it = lefts_.begin();
-        it != lefts_.end(); it++) {
-	map<unsigned int, unsigned int>::const_iterator mate = rights_.find(it->first);
-	if(mate == rights_.end())
+    for(vector<unsigned int>::const_iterator it = used_.begin();
+        it != used_.end(); it++) {
+	const pair<int,int> &ends = slots_[*it];
+	if(ends.first < 0 || ends.second < 0)
 	    continue;
 
-	if(list_.at(it->second)->GetTrace().size() != 0 &&
-	   list_.at(mate->second)->GetTrace().size() != 0) {
+	ChanEvent *left = list_[ends.first];
+	ChanEvent *right = list_[ends.second];
+	if(left->GetTrace().size() != 0 && right->GetTrace().size() != 0) {
 	    TimingDefs::TimingIdentifier key =
-	     	make_pair(it->first, list_.at(it->second)->GetChanID().GetSubtype());
+	     	make_pair(*it, BarIndex::get()->GetEntry(left->GetID()).key.second);
 	    hrtBars_.insert(make_pair(key,
-            BarDetector(HighResTimingData(list_.at(it->second)),
-                        HighResTimingData(list_.at(mate->second)), key)));
+            BarDetector(HighResTimingData(left),
+                        HighResTimingData(right), key)));
 	} else {
-	    lrtBars_.insert(make_pair(it->first,
-				      make_pair(0.5*(list_.at(it->second)->GetCorrectedTime()+
-						     list_.at(mate->second)->GetCorrectedTime()),
-						sqrt(list_.at(it->second)->GetCalEnergy()*
-						     list_.at(mate->second)->GetCalEnergy()))));
+	    lrtBars_.insert(make_pair(*it,
+				      make_pair(0.5*(left->GetCorrectedTime()+
+						     right->GetCorrectedTime()),
+						sqrt(left->GetCalEnergy()*
+						     right->GetCalEnergy()))));
 	}
     }
 }
 
-unsigned int BarBuilder::CalcBarNumber(const unsigned int &loc) {
-    return(loc/2);
-}
-
 void BarBuilder::ClearMaps(void){
     lrtBars_.clear();
     hrtBars_.clear();
-    lefts_.clear();
-    rights_.clear();
+    for(vector<unsigned int>::const_iterator it = used_.begin();
+        it != used_.end(); it++)
+	slots_[*it] = make_pair(-1,-1);
+    used_.clear();
 }
 
 void BarBuilder::FillMaps(void) {
+    const BarIndex *index = BarIndex::get();
+    if(slots_.size() != index->GetNumBars())
+	slots_.assign(index->GetNumBars(), make_pair(-1,-1));
+
     for(vector<ChanEvent*>::const_iterator it = list_.begin();
     it != list_.end(); it++) {
-	Identifier id = (*it)->GetChanID();
-	unsigned int barNum = CalcBarNumber(id.GetLocation());
-	unsigned int idx = (unsigned int)(it - list_.begin());
-	if(id.HasTag("left") || id.HasTag("up") || id.HasTag("top"))
-	    lefts_.insert(make_pair(barNum,idx));
-	if(id.HasTag("right") || id.HasTag("down") || id.HasTag("bottom"))
-	    rights_.insert(make_pair(barNum,idx));
+	const BarIndex::Entry &entry = index->GetEntry((*it)->GetID());
+	if(entry.side == BarIndex::NONE)
+	    continue;
+
+	//The first end found of each side is kept, as the maps used to do.
+	pair<int,int> &ends = slots_[entry.bar];
+	if(ends.first < 0 && ends.second < 0)
+	    used_.push_back(entry.bar);
+	int idx = (int)(it - list_.begin());
+	if(entry.side == BarIndex::LEFT && ends.first < 0)
+	    ends.first = idx;
+	else if(entry.side == BarIndex::RIGHT && ends.second < 0)
+	    ends.second = idx;
     }
 }
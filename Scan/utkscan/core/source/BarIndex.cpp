@@ -0,0 +1,43 @@
+/*! \file BarIndex.cpp
+ *  \brief A table relating the channels to the ends of bar style detectors
+ *  \date Oct. 19th, 2026
+*/
+#include "BarIndex.hpp"
+#include "DetectorLibrary.hpp"
+
+using namespace std;
+
+BarIndex* BarIndex::instance = NULL;
+
+BarIndex* BarIndex::get() {
+    if (!instance)
+        instance = new BarIndex();
+    return instance;
+}
+
+BarIndex::BarIndex() {
+    none_.side = NONE;
+    none_.bar = 0;
+    numBars_ = 0;
+
+    DetectorLibrary *lib = DetectorLibrary::get();
+    entries_.resize(lib->size(), none_);
+    for(DetectorLibrary::size_type i = 0; i < lib->size(); i++) {
+        const Identifier &id = lib->at(i);
+        if(id.GetType() == "")
+            continue;
+
+        Entry &entry = entries_[i];
+        entry.key = make_pair(id.GetLocation(), id.GetSubtype());
+        entry.bar = CalcBarNumber(id.GetLocation());
+        //Things labeled {left, up, top} are one end and things labeled
+        // {right, down, bottom} the other.
+        if(id.HasTag("left") || id.HasTag("up") || id.HasTag("top"))
+            entry.side = LEFT;
+        else if(id.HasTag("right") || id.HasTag("down") || id.HasTag("bottom"))
+            entry.side = RIGHT;
+
+        if(entry.side != NONE && entry.bar >= numBars_)
+            numBars_ = entry.bar + 1;
+    }
+}
@@ -32,6 +32,12 @@ unsigned long ChanEvent::GetQdcValue(int i) const {
     return data_.qdcValue[i];
 }
 
+unsigned long ChanEvent::GetEnergySum(int i) const {
+    if (i < 0 || i >= data_.numEnergySums)
+        return pixie::U_DELIMITER;
+    return data_.energySums[i];
+}
+
 const Identifier& ChanEvent::GetChanID() const {
     return DetectorLibrary::get()->at(data_.modNum, data_.chanNum);
 }
@@ -40,9 +46,18 @@ int ChanEvent::GetID() const {
     return DetectorLibrary::get()->GetIndex(data_.modNum, data_.chanNum);
 }
 
+void ChanEvent::Set(XiaData *xiadata) {
+    ZeroNums();
+    trace.Reset();
+    //Hand the old (empty) sample buffer to the XiaData so that copying the
+    // header below does not copy the trace.
+    trace.swap(xiadata->adcTrace);
+    data_ = *xiadata;
+}
+
 //! [Zero Channel]
 void ChanEvent::ZeroVar() {
     ZeroNums();
-    trace.clear();
+    trace.Reset();
 }
 //! [Zero Channel]
@@ -26,6 +26,7 @@
 #include "Globals.hpp"
 #include "DetectorDriver.hpp"
 #include "LogicProcessor.hpp"
+#include "OutputFiles.hpp"
 #include "RawEvent.hpp"
 #include "Correlator.hpp"
 
@@ -102,7 +103,9 @@ void CorrelationList::clear() {
 }
 
 void CorrelationList::PrintDecayList() const {
-    ofstream fullLog("HIS/full_decays.txt", ios::app);
+    static const string logName = OutputFiles::get()->Register(
+            "HIS/full_decays.txt", OUTPUT_TEXT_APPEND);
+    ofstream fullLog(logName.c_str(), ios::app);
     stringstream str;
     DetectorDriver* driver = DetectorDriver::get();
     const double printTimeResolution = 1e-3;
@@ -20,9 +20,12 @@
 #include "HighResTimingData.hpp"
 #include "RandomPool.hpp"
 #include "RawEvent.hpp"
+#include "TimingCalibrator.hpp"
 #include "TreeCorrelator.hpp"
+#include "XmlConfiguration.hpp"
 
 #include "BetaScintProcessor.hpp"
+#include "ColumnProcessor.hpp"
 #include "DoubleBetaProcessor.hpp"
 #include "Hen3Processor.hpp"
 #include "GeProcessor.hpp"
@@ -41,7 +44,10 @@
 #include "ValidProcessor.hpp"
 
 #include "CfdAnalyzer.hpp"
+#include "EnergySumAnalyzer.hpp"
+#ifdef usegsl
 #include "FittingAnalyzer.hpp"
+#endif
 #include "TauAnalyzer.hpp"
 #include "TraceAnalyzer.hpp"
 #include "TraceExtractor.hpp"
@@ -66,8 +72,10 @@ DetectorDriver* DetectorDriver::get() {
     return instance;
 }
 
-DetectorDriver::DetectorDriver() : histo(OFFSET, RANGE, "DetectorDriver") {
-    cfg_ = Globals::get()->configfile();
+DetectorDriver::DetectorDriver() : histo(OFFSET, RANGE, "DetectorDriver"),
+    energySumAnalyzer(NULL), fittingAnalyzer(NULL), shedLevel(0),
+    reloadPending(false), reloadConfig(NULL),
+    reloadCali(NULL), reloadWalk(NULL) {
     Messenger m;
     try {
         m.start("Loading Processors");
@@ -97,22 +105,18 @@ DetectorDriver::~DetectorDriver() {
 	 it != vecAnalyzer.end(); it++)
         delete(*it);
     vecAnalyzer.clear();
+
+    delete reloadConfig;
+    delete reloadCali;
+    delete reloadWalk;
     instance = NULL;
 }
 
 void DetectorDriver::LoadProcessors(Messenger& m) {
-    pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_file(cfg_.c_str());
-    if (!result) {
-        stringstream ss;
-        ss << "DetectorDriver: error parsing file " << cfg_;
-        ss << " : " << result.description();
-        throw IOException(ss.str());
-    }
-
     DetectorLibrary::get();
 
-    pugi::xml_node driver = doc.child("Configuration").child("DetectorDriver");
+    pugi::xml_node driver =
+            XmlConfiguration::get()->GetSection("DetectorDriver");
     for (pugi::xml_node processor = driver.child("Processor"); processor;
         processor = processor.next_sibling("Processor")) {
         string name = processor.attribute("name").value();
@@ -170,10 +174,18 @@ void DetectorDriver::LoadProcessors(Messenger& m) {
                 processor.attribute("cycle_gate2_max").as_double(0.0);
             if (cycle_gate2_max == 0.0)
                 m.warning("Using default cycle_gate2_max = 0.0", 1);
-            vecProcess.push_back(new GeProcessor(gamma_threshold, low_ratio,
+            GeProcessor *ge = new GeProcessor(gamma_threshold, low_ratio,
                 high_ratio, sub_event, gamma_beta_limit, gamma_gamma_limit,
                 cycle_gate1_min, cycle_gate1_max, cycle_gate2_min,
-                cycle_gate2_max));
+                cycle_gate2_max);
+            string cube_file = processor.attribute("cube_file").as_string("");
+            ge->SetCoincidenceStorage(
+                processor.attribute("compact_matrices").as_bool(false),
+                Globals::get()->outputPath("gg_"),
+                cube_file.empty() ? cube_file :
+                    Globals::get()->outputPath(cube_file),
+                processor.attribute("cube_bins").as_uint(2048));
+            vecProcess.push_back(ge);
         } else if (name == "GeCalibProcessor") {
             double gamma_threshold =
                 processor.attribute("gamma_threshold").as_double(1);
@@ -216,6 +228,13 @@ void DetectorDriver::LoadProcessors(Messenger& m) {
         } else if (name == "TemplateExpProcessor") {
             vecProcess.push_back(new TemplateExpProcessor());
 	}
+        else if (name == "ColumnProcessor") {
+            vecProcess.push_back(new ColumnProcessor(
+                Globals::get()->outputPath(
+                    processor.attribute("file").as_string("events.col")),
+                processor.attribute("chunk_rows").as_uint(4096),
+                processor.attribute("compression").as_int(1)));
+        }
 #ifdef useroot
         else if (name == "RootProcessor") {
             vecProcess.push_back(new RootProcessor("tree.root", "tree"));
@@ -245,7 +264,16 @@ void DetectorDriver::LoadProcessors(Messenger& m) {
 
 	if(name == "TraceFilterAnalyzer") {
 	    bool findPileups = analyzer.attribute("FindPileup").as_bool(false);
-	    vecAnalyzer.push_back(new TraceFilterAnalyzer(findPileups));
+	    bool useFilterEnergy =
+                analyzer.attribute("UseFilterEnergy").as_bool(false);
+	    vecAnalyzer.push_back(new TraceFilterAnalyzer(findPileups,
+                                                          useFilterEnergy));
+	} else if(name == "EnergySumAnalyzer") {
+            bool useBaseline =
+                analyzer.attribute("UseOnboardBaseline").as_bool(true);
+            double offset = analyzer.attribute("BaselineOffset").as_double(0.0);
+            energySumAnalyzer = new EnergySumAnalyzer(useBaseline, offset);
+            vecAnalyzer.push_back(energySumAnalyzer);
 	} else if(name == "TauAnalyzer") {
             vecAnalyzer.push_back(new TauAnalyzer());
         } else if (name == "TraceExtractor") {
@@ -260,8 +288,14 @@ void DetectorDriver::LoadProcessors(Messenger& m) {
         } else if (name == "WaaAnalyzer") {
             vecAnalyzer.push_back(new WaaAnalyzer());
         } else if (name == "FittingAnalyzer") {
+#ifdef usegsl
             string type = analyzer.attribute("type").as_string();
-            vecAnalyzer.push_back(new FittingAnalyzer(type));
+            fittingAnalyzer = new FittingAnalyzer(type);
+            vecAnalyzer.push_back(fittingAnalyzer);
+#else
+            throw GeneralException("DetectorDriver: FittingAnalyzer "
+                                   "requires utkscan to be built with GSL");
+#endif
         } else {
             stringstream ss;
             ss << "DetectorDriver: unknown analyzer type" << name;
@@ -293,8 +327,8 @@ void DetectorDriver::Init(RawEvent& rawev) {
     }
 
     try {
-        ReadCalXml();
-        ReadWalkXml();
+        ReadCalXml(*XmlConfiguration::get(), cali);
+        ReadWalkXml(*XmlConfiguration::get(), walk);
     } catch (GeneralException &e) {
         //! Any exception in reading calibration and walk correction
         //! will be intercepted here
@@ -311,10 +345,18 @@ void DetectorDriver::Init(RawEvent& rawev) {
 }
 
 void DetectorDriver::ProcessEvent(RawEvent& rawev) {
+    if (reloadPending)
+        ApplyReload();
+
     plot(dammIds::raw::D_NUMBER_OF_EVENTS, dammIds::GENERIC_CHANNEL);
     try {
-        for (vector<ChanEvent*>::const_iterator it = rawev.GetEventList().begin();
-             it != rawev.GetEventList().end(); ++it) {
+        //The channels of the sub-event are calibrated and activate their
+        // places like the channels of the event
+        const vector<ChanEvent*> *lists[2] = {&rawev.GetEventList(),
+                                              &rawev.GetSubEventList()};
+        for (unsigned int list = 0; list < 2; list++)
+        for (vector<ChanEvent*>::const_iterator it = lists[list]->begin();
+             it != lists[list]->end(); ++it) {
             PlotRaw((*it));
             ThreshAndCal((*it), rawev);
             PlotCal((*it));
@@ -374,6 +416,9 @@ void DetectorDriver::DeclarePlots() {
         DeclareHistogram1D(D_HIT_SPECTRUM, S7, "channel hit spectrum");
         DeclareHistogram2D(DD_RUNTIME_SEC, SE, S6, "run time - s");
         DeclareHistogram2D(DD_RUNTIME_MSEC, SE, S7, "run time - ms");
+        DeclareHistogram1D(D_SPILL_PRESCALE, S7, "processed spills vs prescale");
+        DeclareHistogram2D(DD_SHED_LEVEL, SE, S4,
+                           "load shedding level vs wall time - 10 s");
 
         if(Globals::get()->hasRaw()) {
             DetectorLibrary* modChan = DetectorLibrary::get();
@@ -413,6 +458,9 @@ void DetectorDriver::DeclarePlots() {
                                        ("Time " + idstr.str()).c_str() );
                 DeclareHistogram1D(D_CAL_ENERGY + i, SE,
                                   ("CalE " + idstr.str()).c_str() );
+                if (energySumAnalyzer != NULL)
+                    DeclareHistogram1D(D_SUM_ENERGY + i, SE,
+                                       ("SumE " + idstr.str()).c_str() );
             }
         }
 
@@ -441,8 +489,6 @@ int DetectorDriver::ThreshAndCal(ChanEvent *chan, RawEvent& rawev) {
     bool hasStartTag  = chanId.HasTag("start");
     Trace &trace      = chan->GetTrace();
 
-    RandomPool* randoms = RandomPool::get();
-
     double energy = 0.0;
     
     if (type == "ignore" || type == "")
@@ -451,8 +497,18 @@ int DetectorDriver::ThreshAndCal(ChanEvent *chan, RawEvent& rawev) {
     if ( !trace.empty() ) {
         plot(D_HAS_TRACE, id);
 
+        //When the online scan is overloaded the analyzers are shed in steps.
+        // The analyzers defining the energy are always kept, otherwise the
+        // channels would switch to the onboard energy in the middle of a run.
+        unsigned int level = shedLevel;
         for (vector<TraceAnalyzer *>::iterator it = vecAnalyzer.begin();
             it != vecAnalyzer.end(); it++) {
+            if (level > 0 && *it == fittingAnalyzer)
+                continue;
+            if (level > 1 && !(*it)->DefinesEnergy())
+                continue;
+            (*it)->SetChannel(DetectorLibrary::get()->ModuleFromIndex(id),
+                              DetectorLibrary::get()->ChannelFromIndex(id));
             (*it)->Analyze(trace, type, subtype, tags);
         }
 
@@ -484,7 +540,7 @@ int DetectorDriver::ThreshAndCal(ChanEvent *chan, RawEvent& rawev) {
             energy = trace.GetValue("calcEnergy");
             chan->SetEnergy(energy);
         } else if (!trace.HasValue("filterEnergy")) {
-            energy = chan->GetEnergy() + randoms->Get();
+            energy = OnboardEnergy(chan, type, subtype);
         }
 
         if (trace.HasValue("phase") ) {
@@ -496,9 +552,7 @@ int DetectorDriver::ThreshAndCal(ChanEvent *chan, RawEvent& rawev) {
         }
     } else {
         /// otherwise, use the Pixie on-board calculated energy
-        /// add a random number to convert an integer value to a
-        ///   uniformly distributed floating point
-        energy = chan->GetEnergy() + randoms->Get();
+        energy = OnboardEnergy(chan, type, subtype);
 	chan->SetHighResTime(0.0);
     }
 
@@ -531,6 +585,18 @@ int DetectorDriver::ThreshAndCal(ChanEvent *chan, RawEvent& rawev) {
     return(1);
 }
 
+double DetectorDriver::OnboardEnergy(ChanEvent *chan, const string &type,
+                                     const string &subtype) {
+    if (energySumAnalyzer != NULL && chan->HasEnergySums()) {
+        double energy = energySumAnalyzer->CalcEnergy(*chan, type, subtype);
+        plot(D_SUM_ENERGY + chan->GetID(), energy);
+        return(energy);
+    }
+    /// add a random number to convert an integer value to a
+    ///   uniformly distributed floating point
+    return(chan->GetEnergy() + RandomPool::get()->Get());
+}
+
 int DetectorDriver::PlotRaw(const ChanEvent *chan) {
     plot(D_RAW_ENERGY + chan->GetID(), chan->GetEnergy());
     return(0);
@@ -550,143 +616,171 @@ EventProcessor* DetectorDriver::GetProcessor(const std::string& name) const {
     return(NULL);
 }
 
-void DetectorDriver::ReadCalXml() {
-    pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_file(cfg_.c_str());
-    if (!result) {
-        stringstream ss;
-        ss << "DetectorDriver: error parsing file" << cfg_;
-        ss << " : " << result.description();
-        throw GeneralException(ss.str());
-    }
-
+void DetectorDriver::ReadCalXml(const XmlConfiguration &xml,
+                                Calibrator &cal) {
     Messenger m;
     m.start("Loading Calibration");
 
-    pugi::xml_node map = doc.child("Configuration").child("Map");
-
-    /** Note that before this reading in of the xml file, it was already
-     * processed for the purpose of creating the channels map.
-     * Some sanity checks (module and channel number) were done there
-     * so they are not repeated here/
-     */
-    bool verbose = map.attribute("verbose_calibration").as_bool();
-    for (pugi::xml_node module = map.child("Module"); module;
-         module = module.next_sibling("Module")) {
-        int module_number = module.attribute("number").as_int(-1);
-        for (pugi::xml_node channel = module.child("Channel"); channel;
-             channel = channel.next_sibling("Channel")) {
-            int ch_number = channel.attribute("number").as_int(-1);
-            Identifier chanID = DetectorLibrary::get()->at(module_number,
-                                                           ch_number);
-            bool calibrated = false;
-            for (pugi::xml_node cal = channel.child("Calibration");
-                cal; cal = cal.next_sibling("Calibration")) {
-                string model = cal.attribute("model").as_string("None");
-                double min = cal.attribute("min").as_double(0);
-                double max =
-                  cal.attribute("max").as_double(numeric_limits<double>::max());
-
-                stringstream pars(cal.text().as_string());
-                vector<double> parameters;
-                while (true) {
-                    double p;
-                    pars >> p;
-                    if (pars)
-                        parameters.push_back(p);
-                    else
-                        break;
-                }
-                if (verbose) {
-                    stringstream ss;
-                    ss << "Module " << module_number << ", channel "
-                       << ch_number << ": ";
-                    ss << " model-" << model;
-                    for (vector<double>::iterator it = parameters.begin();
-                         it != parameters.end(); ++it)
-                        ss << " " << (*it);
-                    m.detail(ss.str(), 1);
-                }
-                cali.AddChannel(chanID, model, min, max, parameters);
-                calibrated = true;
-            }
-            if (!calibrated && verbose) {
+    /** Note that the channels map was validated (module and channel number)
+     * when the configuration file was parsed, so the checks are not
+     * repeated here. */
+    bool verbose =
+            xml.GetSection("Map").attribute("verbose_calibration").as_bool();
+    const vector<ChannelModel> &channels = xml.GetChannels();
+    for (vector<ChannelModel>::const_iterator ch = channels.begin();
+         ch != channels.end(); ch++) {
+        const Identifier &chanID =
+                DetectorLibrary::get()->at(ch->module, ch->channel);
+        for (vector<CorrectionModel>::const_iterator it_cal =
+                ch->calibrations.begin(); it_cal != ch->calibrations.end();
+             it_cal++) {
+            if (verbose) {
                 stringstream ss;
-                ss << "Module " << module_number << ", channel "
-                   << ch_number << ": ";
-                ss << " non-calibrated";
+                ss << "Module " << ch->module << ", channel "
+                   << ch->channel << ": ";
+                ss << " model-" << it_cal->model;
+                for (vector<double>::const_iterator it =
+                        it_cal->parameters.begin();
+                     it != it_cal->parameters.end(); ++it)
+                    ss << " " << (*it);
                 m.detail(ss.str(), 1);
             }
+            cal.AddChannel(chanID, it_cal->model, it_cal->min, it_cal->max,
+                           it_cal->parameters);
+        }
+        if (ch->calibrations.empty() && verbose) {
+            stringstream ss;
+            ss << "Module " << ch->module << ", channel "
+               << ch->channel << ": ";
+            ss << " non-calibrated";
+            m.detail(ss.str(), 1);
         }
     }
     m.done();
 }
 
-void DetectorDriver::ReadWalkXml() {
-    pugi::xml_document doc;
-
-    pugi::xml_parse_result result = doc.load_file(cfg_.c_str());
-    if (!result) {
-        stringstream ss;
-        ss << "DetectorDriver: error parsing file " << cfg_;
-        ss << " : " << result.description();
-        throw GeneralException(ss.str());
-    }
-
+void DetectorDriver::ReadWalkXml(const XmlConfiguration &xml,
+                                 WalkCorrector &corr) {
     Messenger m;
     m.start("Loading Walk Corrections");
 
-    pugi::xml_node map = doc.child("Configuration").child("Map");
     /** See comment in the similiar place at ReadCalXml() */
-    bool verbose = map.attribute("verbose_walk").as_bool();
-    for (pugi::xml_node module = map.child("Module"); module;
-         module = module.next_sibling("Module")) {
-        int module_number = module.attribute("number").as_int(-1);
-        for (pugi::xml_node channel = module.child("Channel"); channel;
-             channel = channel.next_sibling("Channel")) {
-            int ch_number = channel.attribute("number").as_int(-1);
-            Identifier chanID = DetectorLibrary::get()->at(module_number,
-                                                           ch_number);
-            bool corrected = false;
-            for (pugi::xml_node walkcorr = channel.child("WalkCorrection");
-                walkcorr; walkcorr = walkcorr.next_sibling("WalkCorrection")) {
-                string model = walkcorr.attribute("model").as_string("None");
-                double min = walkcorr.attribute("min").as_double(0);
-                double max =
-                  walkcorr.attribute("max").as_double(
-                                              numeric_limits<double>::max());
-
-                stringstream pars(walkcorr.text().as_string());
-                vector<double> parameters;
-                while (true) {
-                    double p;
-                    pars >> p;
-                    if (pars)
-                        parameters.push_back(p);
-                    else
-                        break;
-                }
-                if (verbose) {
-                    stringstream ss;
-                    ss << "Module " << module_number
-                       << ", channel " << ch_number << ": ";
-                    ss << " model: " << model;
-                    for (vector<double>::iterator it = parameters.begin();
-                         it != parameters.end(); ++it)
-                        ss << " " << (*it);
-                    m.detail(ss.str(), 1);
-                }
-                walk.AddChannel(chanID, model, min, max, parameters);
-                corrected = true;
-            }
-            if (!corrected && verbose) {
+    bool verbose = xml.GetSection("Map").attribute("verbose_walk").as_bool();
+    const vector<ChannelModel> &channels = xml.GetChannels();
+    for (vector<ChannelModel>::const_iterator ch = channels.begin();
+         ch != channels.end(); ch++) {
+        const Identifier &chanID =
+                DetectorLibrary::get()->at(ch->module, ch->channel);
+        for (vector<CorrectionModel>::const_iterator walkcorr =
+                ch->walks.begin(); walkcorr != ch->walks.end(); walkcorr++) {
+            if (verbose) {
                 stringstream ss;
-                ss << "Module " << module_number << ", channel "
-                << ch_number << ": ";
-                ss << " not corrected for walk";
+                ss << "Module " << ch->module
+                   << ", channel " << ch->channel << ": ";
+                ss << " model: " << walkcorr->model;
+                for (vector<double>::const_iterator it =
+                        walkcorr->parameters.begin();
+                     it != walkcorr->parameters.end(); ++it)
+                    ss << " " << (*it);
                 m.detail(ss.str(), 1);
             }
+            corr.AddChannel(chanID, walkcorr->model, walkcorr->min,
+                            walkcorr->max, walkcorr->parameters);
+        }
+        if (ch->walks.empty() && verbose) {
+            stringstream ss;
+            ss << "Module " << ch->module << ", channel "
+            << ch->channel << ": ";
+            ss << " not corrected for walk";
+            m.detail(ss.str(), 1);
         }
     }
     m.done();
 }
+
+void DetectorDriver::RequestReload(void) {
+    XmlConfiguration *xml =
+            XmlConfiguration::Parse(Globals::get()->configfile());
+    Calibrator *newCali = new Calibrator();
+    WalkCorrector *newWalk = new WalkCorrector();
+    try {
+        /** The identifiers, and with them the histograms and the places of
+         * the correlator, were built from the map in use. Only the
+         * calibrations and walk corrections are allowed to change. */
+        const vector<ChannelModel> &oldMap =
+                XmlConfiguration::get()->GetChannels();
+        const vector<ChannelModel> &newMap = xml->GetChannels();
+        if (oldMap.size() != newMap.size())
+            throw GeneralException("DetectorDriver::RequestReload : The "
+                                   "number of channels in the map changed");
+        for (size_t i = 0; i < oldMap.size(); i++) {
+            if (oldMap[i].module != newMap[i].module ||
+                oldMap[i].channel != newMap[i].channel ||
+                oldMap[i].type != newMap[i].type ||
+                oldMap[i].subtype != newMap[i].subtype ||
+                oldMap[i].location != newMap[i].location ||
+                oldMap[i].tags != newMap[i].tags) {
+                stringstream ss;
+                ss << "DetectorDriver::RequestReload : The definition of "
+                   << "module " << newMap[i].module << ", channel "
+                   << newMap[i].channel << " changed, a restart is needed";
+                throw GeneralException(ss.str());
+            }
+        }
+        ReadCalXml(*xml, *newCali);
+        ReadWalkXml(*xml, *newWalk);
+    } catch (...) {
+        delete xml;
+        delete newCali;
+        delete newWalk;
+        throw;
+    }
+
+    std::lock_guard<std::mutex> lock(reloadLock);
+    delete reloadConfig;
+    delete reloadCali;
+    delete reloadWalk;
+    reloadConfig = xml;
+    reloadCali = newCali;
+    reloadWalk = newWalk;
+    reloadPending = true;
+}
+
+void DetectorDriver::ApplyReload(void) {
+    std::lock_guard<std::mutex> lock(reloadLock);
+    if (!reloadConfig)
+        return;
+
+    Messenger m;
+    m.start("Reloading parameters from " + reloadConfig->GetFileName());
+    cali = *reloadCali;
+    walk = *reloadWalk;
+    try {
+        TimingCalibrator::Reload(*reloadConfig);
+        Globals::get()->ReloadTrapFilters(*reloadConfig);
+        for (vector<TraceAnalyzer *>::iterator it = vecAnalyzer.begin();
+             it != vecAnalyzer.end(); it++) {
+            if ((*it)->Reload(*reloadConfig))
+                m.detail("Reloaded " + (*it)->GetName(), 1);
+        }
+        for (vector<EventProcessor *>::iterator it = vecProcess.begin();
+             it != vecProcess.end(); it++) {
+            if ((*it)->Reload(*reloadConfig))
+                m.detail("Reloaded " + (*it)->GetName(), 1);
+        }
+        m.done();
+    } catch (GeneralException &e) {
+        /// A processor that fails to reload keeps its old parameters
+        m.fail();
+        cout << "Exception caught at DetectorDriver::ApplyReload" << endl;
+        cout << "\t" << e.what() << endl;
+    }
+
+    delete reloadConfig;
+    delete reloadCali;
+    delete reloadWalk;
+    reloadConfig = NULL;
+    reloadCali = NULL;
+    reloadWalk = NULL;
+    reloadPending = false;
+}
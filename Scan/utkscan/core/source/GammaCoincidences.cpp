@@ -0,0 +1,452 @@
+/** \file GammaCoincidences.cpp
+ * \brief Compact storage for symmetric gamma-gamma matrices and
+ * gamma-gamma-gamma cubes, and an index for gamma-gamma gates
+ * \date Oct. 19th, 2026
+ */
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Exceptions.hpp"
+#include "GammaCoincidences.hpp"
+
+using namespace std;
+
+namespace {
+    /** Size of the header of a cube file, the blocks start on a page */
+    const off_t CUBE_HEADER_SIZE = 4096;
+    /** Number of blocks of a cube mapped at a time */
+    const unsigned int CUBE_CHUNK_BLOCKS = 1024;
+
+    /** Header of a cube file */
+    struct CubeHeader {
+        char magic[8]; //!< "GGGCUBE1"
+        unsigned int bins; //!< number of bins on each axis
+        unsigned int blockBins; //!< number of bins on each side of a block
+        unsigned int numAllocated; //!< number of blocks in the file
+        unsigned int unused; //!< padding
+        unsigned long long dirOffset; //!< location of the block directory
+    };
+
+    const char MATRIX_MAGIC[8] = {'G','G','M','A','T','R','X','1'};
+    const char CUBE_MAGIC[8] = {'G','G','G','C','U','B','E','1'};
+
+    /** \return the bin of an energy, or -1 if it is outside of [0,bins) */
+    int ToBin(double energy, unsigned int bins) {
+        int bin = int(energy);
+        if (energy < 0 || bin >= (int)bins)
+            return -1;
+        return bin;
+    }
+
+    /** Throw a GeneralException about a file */
+    void FileError(const string &what, const string &fileName) {
+        stringstream ss;
+        ss << "GammaCoincidences: " << what << " '" << fileName << "'";
+        throw GeneralException(ss.str());
+    }
+}
+
+GammaMatrix::GammaMatrix(unsigned int bins, unsigned int blockBins) {
+    bins_ = bins;
+    blockBins_ = blockBins;
+    numBlocks_ = (bins_ + blockBins_ - 1) / blockBins_;
+    blocks_.resize(BlockIndex(numBlocks_ - 1, numBlocks_ - 1) + 1);
+}
+
+void GammaMatrix::Fill(double e1, double e2, unsigned int weight) {
+    int x = ToBin(e1, bins_);
+    int y = ToBin(e2, bins_);
+    if (x < 0 || y < 0)
+        return;
+    if (x > y)
+        swap(x, y);
+
+    vector<unsigned int> &block =
+        blocks_[BlockIndex(x / blockBins_, y / blockBins_)];
+    if (block.empty())
+        block.assign(blockBins_ * blockBins_, 0);
+
+    // A full matrix gets both (x,y) and (y,x), which is the same bin on the
+    // diagonal.
+    block[(x % blockBins_) * blockBins_ + y % blockBins_] +=
+        (x == y ? 2 * weight : weight);
+}
+
+unsigned int GammaMatrix::Get(unsigned int x, unsigned int y) const {
+    if (x >= bins_ || y >= bins_)
+        return 0;
+    if (x > y)
+        swap(x, y);
+    const vector<unsigned int> &block =
+        blocks_[BlockIndex(x / blockBins_, y / blockBins_)];
+    if (block.empty())
+        return 0;
+    return block[(x % blockBins_) * blockBins_ + y % blockBins_];
+}
+
+void GammaMatrix::Project(vector<double> &spectrum) const {
+    Gate(0, bins_ - 1, spectrum);
+}
+
+void GammaMatrix::Gate(unsigned int low, unsigned int high,
+                       vector<double> &spectrum) const {
+    spectrum.assign(bins_, 0);
+    if (low > high)
+        return;
+
+    for (unsigned int by = 0; by < numBlocks_; ++by) {
+        for (unsigned int bx = 0; bx <= by; ++bx) {
+            const vector<unsigned int> &block = blocks_[BlockIndex(bx, by)];
+            if (block.empty())
+                continue;
+
+            // Skip blocks which have no bin in the gate on either axis.
+            unsigned int x0 = bx * blockBins_, y0 = by * blockBins_;
+            bool xInGate = x0 <= high && x0 + blockBins_ > low;
+            bool yInGate = y0 <= high && y0 + blockBins_ > low;
+            if (!xInGate && !yInGate)
+                continue;
+
+            for (unsigned int i = 0; i < blockBins_; ++i) {
+                unsigned int x = x0 + i;
+                if (x >= bins_)
+                    break;
+                for (unsigned int j = 0; j < blockBins_; ++j) {
+                    unsigned int y = y0 + j;
+                    unsigned int value = block[i * blockBins_ + j];
+                    if (value == 0 || y >= bins_ || y < x)
+                        continue;
+                    if (x >= low && x <= high)
+                        spectrum[y] += value;
+                    if (x != y && y >= low && y <= high)
+                        spectrum[x] += value;
+                }
+            }
+        }
+    }
+}
+
+void GammaMatrix::Write(const string &fileName) const {
+    ofstream out(fileName.c_str(), ios::binary | ios::trunc);
+    if (!out.good())
+        FileError("Could not open", fileName);
+
+    unsigned int numStored = 0;
+    for (size_t i = 0; i < blocks_.size(); ++i)
+        if (!blocks_[i].empty())
+            ++numStored;
+
+    out.write(MATRIX_MAGIC, sizeof(MATRIX_MAGIC));
+    out.write((const char*)&bins_, sizeof(bins_));
+    out.write((const char*)&blockBins_, sizeof(blockBins_));
+    out.write((const char*)&numStored, sizeof(numStored));
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        if (blocks_[i].empty())
+            continue;
+        unsigned int index = i;
+        out.write((const char*)&index, sizeof(index));
+        out.write((const char*)&blocks_[i][0],
+                  blocks_[i].size() * sizeof(unsigned int));
+    }
+
+    if (!out.good())
+        FileError("Failed writing", fileName);
+}
+
+void GammaMatrix::Read(const string &fileName) {
+    ifstream in(fileName.c_str(), ios::binary);
+    if (!in.good())
+        FileError("Could not open", fileName);
+
+    char magic[sizeof(MATRIX_MAGIC)];
+    unsigned int bins, blockBins, numStored;
+    in.read(magic, sizeof(magic));
+    in.read((char*)&bins, sizeof(bins));
+    in.read((char*)&blockBins, sizeof(blockBins));
+    in.read((char*)&numStored, sizeof(numStored));
+    if (!in.good() || memcmp(magic, MATRIX_MAGIC, sizeof(magic)) != 0 ||
+        bins == 0 || blockBins == 0)
+        FileError("Not a gamma-gamma matrix", fileName);
+
+    *this = GammaMatrix(bins, blockBins);
+    for (unsigned int n = 0; n < numStored; ++n) {
+        unsigned int index;
+        in.read((char*)&index, sizeof(index));
+        if (!in.good() || index >= blocks_.size())
+            FileError("Corrupt gamma-gamma matrix", fileName);
+        blocks_[index].resize(blockBins_ * blockBins_);
+        in.read((char*)&blocks_[index][0],
+                blocks_[index].size() * sizeof(unsigned int));
+    }
+
+    if (!in.good())
+        FileError("Corrupt gamma-gamma matrix", fileName);
+}
+
+void GammaMatrix::Add(const GammaMatrix &other) {
+    if (other.bins_ != bins_ || other.blockBins_ != blockBins_)
+        throw GeneralException("GammaMatrix::Add - The matrices have a "
+                               "different binning");
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        const vector<unsigned int> &block = other.blocks_[i];
+        if (block.empty())
+            continue;
+        if (blocks_[i].empty()) {
+            blocks_[i] = block;
+            continue;
+        }
+        for (size_t j = 0; j < block.size(); ++j)
+            blocks_[i][j] += block[j];
+    }
+}
+
+void GammaMatrix::Clear(void) {
+    for (size_t i = 0; i < blocks_.size(); ++i)
+        vector<unsigned int>().swap(blocks_[i]);
+}
+
+size_t GammaMatrix::GetMemoryUsage(void) const {
+    size_t bytes = blocks_.size() * sizeof(vector<unsigned int>);
+    for (size_t i = 0; i < blocks_.size(); ++i)
+        bytes += blocks_[i].capacity() * sizeof(unsigned int);
+    return bytes;
+}
+
+GammaCube::GammaCube(const string &fileName, unsigned int bins,
+                     unsigned int blockBins) {
+    fileName_ = fileName;
+    readOnly_ = false;
+    bins_ = bins;
+    blockBins_ = blockBins;
+    numBlocks_ = (bins_ + blockBins_ - 1) / blockBins_;
+    numAllocated_ = 0;
+    directory_.assign(BlockIndex(numBlocks_ - 1, numBlocks_ - 1,
+                                 numBlocks_ - 1) + 1, 0);
+
+    fd_ = open(fileName_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0)
+        FileError("Could not create", fileName_);
+}
+
+GammaCube::GammaCube(const string &fileName) {
+    fileName_ = fileName;
+    readOnly_ = true;
+    fd_ = open(fileName_.c_str(), O_RDONLY);
+    if (fd_ < 0)
+        FileError("Could not open", fileName_);
+
+    CubeHeader header;
+    if (pread(fd_, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        memcmp(header.magic, CUBE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.bins == 0 || header.blockBins == 0) {
+        close(fd_);
+        FileError("Not a gamma-gamma-gamma cube", fileName_);
+    }
+
+    bins_ = header.bins;
+    blockBins_ = header.blockBins;
+    numBlocks_ = (bins_ + blockBins_ - 1) / blockBins_;
+    numAllocated_ = header.numAllocated;
+    directory_.resize(BlockIndex(numBlocks_ - 1, numBlocks_ - 1,
+                                 numBlocks_ - 1) + 1);
+    ssize_t dirBytes = directory_.size() * sizeof(unsigned int);
+    bool good = header.dirOffset == CUBE_HEADER_SIZE +
+        (unsigned long long)numAllocated_ * BlockWords() * sizeof(unsigned int) &&
+        pread(fd_, &directory_[0], dirBytes, header.dirOffset) == dirBytes;
+    // Block() trusts the directory, so every entry must be an allocated block.
+    for (size_t i = 0; good && i < directory_.size(); ++i)
+        good = directory_[i] <= numAllocated_;
+    if (!good) {
+        close(fd_);
+        FileError("Corrupt gamma-gamma-gamma cube", fileName_);
+    }
+
+    if (numAllocated_ > 0)
+        MapChunk((numAllocated_ - 1) / CUBE_CHUNK_BLOCKS);
+}
+
+GammaCube::~GammaCube() {
+    // A destructor must not throw, the caller checks Close() if it cares.
+    Close();
+}
+
+void GammaCube::MapChunk(unsigned int chunk) {
+    size_t chunkBytes = CUBE_CHUNK_BLOCKS * BlockWords() * sizeof(unsigned int);
+    while (chunks_.size() <= chunk) {
+        off_t offset = CUBE_HEADER_SIZE + (off_t)chunks_.size() * chunkBytes;
+        // The new space is a hole in the file which reads as zeros.
+        if (!readOnly_ && ftruncate(fd_, offset + chunkBytes) != 0)
+            FileError("Could not grow", fileName_);
+
+        void *data = mmap(NULL, chunkBytes,
+                          readOnly_ ? PROT_READ : PROT_READ | PROT_WRITE,
+                          MAP_SHARED, fd_, offset);
+        if (data == MAP_FAILED)
+            FileError("Could not map", fileName_);
+        chunks_.push_back((unsigned int*)data);
+    }
+}
+
+unsigned int *GammaCube::Block(size_t index) const {
+    unsigned int number = directory_[index];
+    if (number == 0)
+        return NULL;
+    --number;
+    return chunks_[number / CUBE_CHUNK_BLOCKS] +
+           (number % CUBE_CHUNK_BLOCKS) * BlockWords();
+}
+
+void GammaCube::Fill(double e1, double e2, double e3) {
+    if (fd_ < 0 || readOnly_)
+        return;
+
+    int bin[3] = {ToBin(e1, bins_), ToBin(e2, bins_), ToBin(e3, bins_)};
+    if (bin[0] < 0 || bin[1] < 0 || bin[2] < 0)
+        return;
+    sort(bin, bin + 3);
+
+    size_t index = BlockIndex(bin[0] / blockBins_, bin[1] / blockBins_,
+                              bin[2] / blockBins_);
+    if (directory_[index] == 0) {
+        MapChunk(numAllocated_ / CUBE_CHUNK_BLOCKS);
+        directory_[index] = ++numAllocated_;
+    }
+
+    unsigned int *block = Block(index);
+    block[((bin[0] % blockBins_) * blockBins_ + bin[1] % blockBins_) *
+          blockBins_ + bin[2] % blockBins_] += 1;
+}
+
+unsigned int GammaCube::Get(unsigned int x, unsigned int y,
+                            unsigned int z) const {
+    if (x >= bins_ || y >= bins_ || z >= bins_ || chunks_.empty())
+        return 0;
+
+    unsigned int bin[3] = {x, y, z};
+    sort(bin, bin + 3);
+    const unsigned int *block = Block(BlockIndex(bin[0] / blockBins_,
+                                                 bin[1] / blockBins_,
+                                                 bin[2] / blockBins_));
+    if (block == NULL)
+        return 0;
+    return block[((bin[0] % blockBins_) * blockBins_ + bin[1] % blockBins_) *
+                 blockBins_ + bin[2] % blockBins_];
+}
+
+void GammaCube::Gate(unsigned int low1, unsigned int high1,
+                     unsigned int low2, unsigned int high2,
+                     vector<double> &spectrum) const {
+    spectrum.assign(bins_, 0);
+    high1 = min(high1, bins_ - 1);
+    high2 = min(high2, bins_ - 1);
+    for (unsigned int x = low1; x <= high1; ++x)
+        for (unsigned int y = low2; y <= high2; ++y)
+            for (unsigned int z = 0; z < bins_; ++z)
+                spectrum[z] += Get(x, y, z);
+}
+
+void GammaCube::Add(const GammaCube &other) {
+    if (fd_ < 0 || readOnly_)
+        FileError("Can not add to the read only cube", fileName_);
+    if (other.bins_ != bins_ || other.blockBins_ != blockBins_)
+        FileError("Different binning than the cube", other.fileName_);
+
+    for (size_t index = 0; index < directory_.size(); ++index) {
+        const unsigned int *block = other.Block(index);
+        if (block == NULL)
+            continue;
+        if (directory_[index] == 0) {
+            MapChunk(numAllocated_ / CUBE_CHUNK_BLOCKS);
+            directory_[index] = ++numAllocated_;
+        }
+        unsigned int *sum = Block(index);
+        for (size_t i = 0; i < BlockWords(); ++i)
+            sum[i] += block[i];
+    }
+}
+
+bool GammaCube::Close(void) {
+    if (fd_ < 0)
+        return true;
+
+    size_t chunkBytes = CUBE_CHUNK_BLOCKS * BlockWords() * sizeof(unsigned int);
+    for (size_t i = 0; i < chunks_.size(); ++i)
+        munmap(chunks_[i], chunkBytes);
+    chunks_.clear();
+
+    if (!readOnly_) {
+        // Drop the unused end of the last chunk and put the directory there.
+        CubeHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, CUBE_MAGIC, sizeof(header.magic));
+        header.bins = bins_;
+        header.blockBins = blockBins_;
+        header.numAllocated = numAllocated_;
+        header.dirOffset = CUBE_HEADER_SIZE +
+            (unsigned long long)numAllocated_ * BlockWords() * sizeof(unsigned int);
+
+        ssize_t dirBytes = directory_.size() * sizeof(unsigned int);
+        bool good = ftruncate(fd_, header.dirOffset) == 0 &&
+            pwrite(fd_, &directory_[0], dirBytes, header.dirOffset) == dirBytes &&
+            pwrite(fd_, &header, sizeof(header), 0) == (ssize_t)sizeof(header);
+        close(fd_);
+        fd_ = -1;
+        return good;
+    }
+
+    close(fd_);
+    fd_ = -1;
+    return true;
+}
+
+void GammaGateIndex::Build(const vector<Gate> &gates) {
+    gates_ = gates;
+    edges_.clear();
+    for (vector<Gate>::const_iterator it = gates_.begin();
+         it != gates_.end(); ++it) {
+        edges_.push_back(it->first.first);
+        edges_.push_back(it->first.second);
+    }
+    sort(edges_.begin(), edges_.end());
+    edges_.erase(unique(edges_.begin(), edges_.end()), edges_.end());
+
+    atEdge_.assign(edges_.size(), vector<unsigned int>());
+    afterEdge_.assign(edges_.size(), vector<unsigned int>());
+    for (unsigned int ig = 0; ig < gates_.size(); ++ig) {
+        double low = gates_[ig].first.first;
+        double high = gates_[ig].first.second;
+        for (size_t k = lower_bound(edges_.begin(), edges_.end(), low) -
+                 edges_.begin(); k < edges_.size() && edges_[k] <= high; ++k) {
+            atEdge_[k].push_back(ig);
+            if (edges_[k] < high)
+                afterEdge_[k].push_back(ig);
+        }
+    }
+}
+
+void GammaGateIndex::Find(double e1, double e2,
+                          vector<unsigned int> &hits) const {
+    hits.clear();
+    vector<double>::const_iterator it =
+        upper_bound(edges_.begin(), edges_.end(), e1);
+    if (it == edges_.begin())
+        return;
+    size_t k = (it - edges_.begin()) - 1;
+
+    const vector<unsigned int> &candidates =
+        (edges_[k] == e1 ? atEdge_[k] : afterEdge_[k]);
+    for (vector<unsigned int>::const_iterator ig = candidates.begin();
+         ig != candidates.end(); ++ig) {
+        const pair<double, double> &second = gates_[*ig].second;
+        if (e2 >= second.first && e2 <= second.second)
+            hits.push_back(*ig);
+    }
+}
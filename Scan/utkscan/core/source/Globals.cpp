@@ -8,6 +8,7 @@
 
 #include "Exceptions.hpp"
 #include "Globals.hpp"
+#include "XmlConfiguration.hpp"
 
 Globals *Globals::instance = NULL;
 
@@ -24,24 +25,17 @@ Globals::Globals(const std::string &file) {
     numTraces_ = 16;
 
     try {
-        pugi::xml_document doc;
-        pugi::xml_parse_result result = doc.load_file(configFile_.c_str());
-
+        XmlConfiguration *xml = XmlConfiguration::get(configFile_);
         std::stringstream ss;
-        if (!result) {
-            ss << "Globals : error parsing file " << configFile_;
-            ss << " : " << result.description();
-            throw GeneralException(ss.str());
-        }
 
         Messenger m;
         pugi::xml_node description =
-                doc.child("Configuration").child("Description");
+                xml->GetSection("Description");
         std::string desc_text = description.text().get();
         m.detail("Experiment: " + desc_text);
 
         m.start("Loading global parameters");
-        pugi::xml_node global = doc.child("Configuration").child("Global");
+        pugi::xml_node global = xml->GetSection("Global");
         for (pugi::xml_node_iterator it = global.begin();
              it != global.end(); ++it) {
             if (std::string(it->name()).compare("Revision") == 0) {
@@ -116,7 +110,7 @@ Globals::Globals(const std::string &file) {
         numTraces_ = power2;
 
         m.detail("Loading rejection regions");
-        pugi::xml_node reject = doc.child("Configuration").child("Reject");
+        pugi::xml_node reject = xml->GetSection("Reject");
         for (pugi::xml_node time = reject.child("Time"); time;
              time = time.next_sibling("Time")) {
             int start = time.attribute("start").as_int(-1);
@@ -138,7 +132,7 @@ Globals::Globals(const std::string &file) {
             hasReject_ = true;
         }
 
-        pugi::xml_node phys = doc.child("Configuration").child("Physical");
+        pugi::xml_node phys = xml->GetSection("Physical");
         for (pugi::xml_node_iterator it = phys.begin();
              it != phys.end(); ++it) {
             if (std::string(it->name()).compare("NeutronMass") == 0)
@@ -161,7 +155,7 @@ Globals::Globals(const std::string &file) {
                 WarnOfUnknownParameter(m, it);
         }
 
-        pugi::xml_node trc = doc.child("Configuration").child("Trace");
+        pugi::xml_node trc = xml->GetSection("Trace");
         for (pugi::xml_node_iterator it = trc.begin(); it != trc.end(); ++it) {
             if (std::string(it->name()).compare("DiscriminationStart") == 0)
                 discriminationStart_ = it->attribute("value").as_double(3);
@@ -180,27 +174,12 @@ Globals::Globals(const std::string &file) {
                                                    "value").as_int(10))));
                 }
             } else if (std::string(it->name()).compare("TrapFilters") == 0) {
-                for (pugi::xml_node_iterator trapit = it->begin();
-                     trapit != it->end(); ++trapit) {
-                    pugi::xml_node trig = trapit->child("Trigger");
-                    TrapFilterParameters tfilt(
-                            trig.attribute("l").as_double(125),
-                            trig.attribute("g").as_double(125),
-                            trig.attribute("t").as_double(10));
-                    pugi::xml_node en = trapit->child("Energy");
-                    TrapFilterParameters efilt(en.attribute("l").as_double(300),
-                                               en.attribute("g").as_double(300),
-                                               en.attribute("t").as_double(50));
-                    trapFiltPars_.insert(std::make_pair(
-                            trapit->attribute("name").as_string(),
-                            std::make_pair(tfilt, efilt)));
-
-                }
+                ReadTrapFilters(*it, trapFiltPars_);
             } else
                 WarnOfUnknownParameter(m, it);
         }
 
-        pugi::xml_node fit = doc.child("Configuration").child("Fitting");
+        pugi::xml_node fit = xml->GetSection("Fitting");
         for (pugi::xml_node_iterator it = fit.begin(); it != fit.end(); ++it) {
             if (std::string(it->name()).compare("SigmaBaselineThresh") == 0)
                 sigmaBaselineThresh_ = it->attribute("value").as_double(3.0);
@@ -278,6 +257,31 @@ void Globals::SanityCheck() {
     m.done();
 }
 
+void Globals::ReadTrapFilters(const pugi::xml_node &node,
+        std::map<std::string, std::pair<TrapFilterParameters,
+                                        TrapFilterParameters> > &pars) {
+    for (pugi::xml_node_iterator trapit = node.begin();
+         trapit != node.end(); ++trapit) {
+        pugi::xml_node trig = trapit->child("Trigger");
+        TrapFilterParameters tfilt(trig.attribute("l").as_double(125),
+                                   trig.attribute("g").as_double(125),
+                                   trig.attribute("t").as_double(10));
+        pugi::xml_node en = trapit->child("Energy");
+        TrapFilterParameters efilt(en.attribute("l").as_double(300),
+                                   en.attribute("g").as_double(300),
+                                   en.attribute("t").as_double(50));
+        pars.insert(std::make_pair(trapit->attribute("name").as_string(),
+                                   std::make_pair(tfilt, efilt)));
+    }
+}
+
+void Globals::ReloadTrapFilters(const XmlConfiguration &xml) {
+    std::map<std::string, std::pair<TrapFilterParameters,
+                                    TrapFilterParameters> > pars;
+    ReadTrapFilters(xml.GetSection("Trace").child("TrapFilters"), pars);
+    trapFiltPars_.swap(pars);
+}
+
 void Globals::WarnOfUnknownParameter(Messenger &m,
                                      pugi::xml_node_iterator &it) {
     std::stringstream ss;
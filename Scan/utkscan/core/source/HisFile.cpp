@@ -10,15 +10,24 @@
  * \author C. R. Thornsberry
  * \date Feb. 12th, 2016
  */
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <vector>
 
+#include <errno.h>
+#include <fcntl.h>
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include <unistd.h>
+
+#include <sys/stat.h>
 
 #include "HisFile.hpp"
 
@@ -199,6 +208,7 @@ drr_entry::drr_entry(unsigned int hisID_, unsigned short halfWords_,
     total_size = total_bins * 2 * halfWords;
     total_counts = 0;
     good_counts = 0;
+    live = NULL;
     
     good = true;
     offset = 0; // The file offset will be set later
@@ -240,6 +250,7 @@ drr_entry::drr_entry(unsigned int hisID_, unsigned short halfWords_,
     set_char_array(title, std::string(title_), 40);
     total_counts = 0;
     good_counts = 0;
+    live = NULL;
     
     good = true;
     offset = 0; // The file offset will be set later
@@ -656,11 +667,23 @@ bool HisFile::LoadDrr(const char* prefix_, bool open_his_/*=true*/){
     drr.read(description, 40); description[40] = '\0';
     
     // Read in all drr drr_entries
+    std::vector<drr_entry*> entries;
     for(int i = 0; i < nHis; i++){
-        drr_entry *entry = read_entry();
-        unsigned int id = entry->hisID;
-        drrMap_.insert(std::make_pair(id, entry));
-                       //drr_entries.push_back(read_entry());
+        entries.push_back(read_entry());
+    }
+    
+    // The histogram IDs are stored after the entries, in the same order
+    for(std::vector<drr_entry*>::iterator iter = entries.begin(); iter != entries.end(); iter++){
+        int his_id = -1;
+        drr.read((char*)&his_id, 4);
+        if(!drr.good() || !drrMap_.insert(std::make_pair((unsigned int)his_id, *iter)).second){
+            err_flag = 2;
+            is_good = false;
+            for(; iter != entries.end(); iter++)
+                delete *iter;
+            return false;
+        }
+        (*iter)->hisID = his_id;
     }
     
     return true;
@@ -715,55 +738,99 @@ drr_entry *OutputHisFile::find_drr_in_list(unsigned int hisId){
     return(NULL);
 }
 
+void OutputHisFile::add_fill(drr_entry *entry_, unsigned int bin_, unsigned int weight_){
+    if(!entry_->check_bin(bin_))
+        return;
+    
+    entry_->good_counts++;
+    if(entry_->live)
+        live.Add(entry_->live, bin_, weight_);
+    if(entry_->pending.dirty.empty())
+        pending_entries.push_back(entry_);
+    entry_->pending.add(entry_->total_bins, bin_, weight_);
+    
+    if(++Flush_count >= Flush_wait)
+        Flush();
+}
+
+void OutputHisFile::flush_entry(drr_entry *entry_){
+    his_pending &fills = entry_->pending;
+    unsigned int bytesPerBin = entry_->halfWords * 2;
+    std::vector<char> buffer(HIS_BLOCK_BINS * bytesPerBin);
+    
+    for(std::vector<size_t>::iterator iter = fills.dirty.begin();
+        iter != fills.dirty.end(); iter++){
+        std::vector<unsigned int> &block = fills.blocks[*iter];
+        size_t firstBin = *iter * HIS_BLOCK_BINS;
+        size_t numBins = std::min((size_t)HIS_BLOCK_BINS, entry_->total_bins - firstBin);
+        std::streampos location = (std::streampos)entry_->offset*2 + (std::streampos)(firstBin * bytesPerBin);
+        
+        // Read the block, add the fills and write it back
+        ofile.seekg(location, std::ios::beg);
+        ofile.read(&buffer[0], numBins * bytesPerBin);
+        if(!ofile.good()){
+            ofile.clear();
+            memset(&buffer[0], 0x0, numBins * bytesPerBin);
+        }
+        
+        if(entry_->use_int){
+            unsigned int *ival = (unsigned int*)&buffer[0];
+            for(size_t i = 0; i < numBins; i++)
+                ival[i] += block[i];
+        }
+        else{
+            unsigned short *sval = (unsigned short*)&buffer[0];
+            for(size_t i = 0; i < numBins; i++)
+                sval[i] += (unsigned short)block[i];
+        }
+        
+        ofile.seekp(location, std::ios::beg);
+        ofile.write(&buffer[0], numBins * bytesPerBin);
+    }
+    
+    fills.clear();
+}
+
+bool OutputHisFile::resize_his(std::streampos size_){
+    ofile.flush();
+    if(truncate((fname+".his").c_str(), (off_t)size_) == 0)
+        return true;
+    
+    if(debug_mode)
+        std::cout << "debug: Failed to resize the .his file, writing zeros instead.\n";
+    
+    // Fall back to writing the zeros for file systems without truncate
+    ofile.seekp(0, std::ios::end);
+    std::streamoff remaining = size_ - ofile.tellp();
+    std::vector<char> block(65536, 0x0);
+    while(remaining > 0){
+        std::streamoff count = std::min(remaining, (std::streamoff)block.size());
+        ofile.write(&block[0], count);
+        remaining -= count;
+    }
+    return ofile.good();
+}
+
 void OutputHisFile::Flush(){
     if(debug_mode)
         std::cout << "debug: Flushing histogram entries to file.\n";
     
     if(writable){ // Do the filling
-        for(std::vector<fill_queue*>::iterator iter = fills_waiting.begin();
-            iter != fills_waiting.end(); iter++){
-
-            if(!(*iter)->good)
-                continue;
-            
-            current_entry = (*iter)->entry;
-            current_entry->good_counts++;
-            
-            // Seek to the specified bin
-            ofile.seekg(current_entry->offset*2 + (*iter)->byte, std::ios::beg); // input offset
-            
-            unsigned short sval = 0;
-            unsigned int ival = 0;
-            
-            // Overwrite the bin value
-            if(current_entry->use_int){
-                // Get the original value of the bin
-                ofile.read((char*)&ival, 4);
-                ival += (*iter)->weight;
-		
-                // Set the new value of the bin
-                ofile.seekp(current_entry->offset*2 + (*iter)->byte, std::ios::beg); // output offset
-                ofile.write((char*)&ival, 4);
-            }
-            else{
-                // Get the original value of the bin
-                ofile.read((char*)&sval, 2);
-                sval += (short)(*iter)->weight;
-		
-                // Set the new value of the bin
-                ofile.seekp(current_entry->offset*2 + (*iter)->byte, std::ios::beg); // output offset
-                ofile.write((char*)&sval, 2);
-            }
+        for(std::vector<drr_entry*>::iterator iter = pending_entries.begin();
+            iter != pending_entries.end(); iter++){
+            flush_entry(*iter);
         }
+        ofile.flush();
     }
-    else if(debug_mode){ std::cout << "debug: Output file is not writable!\n"; }
-    
-    // Delete the drr_entries in the fill_queue vector
-    for(std::vector<fill_queue*>::iterator iter = fills_waiting.begin(); iter != fills_waiting.end(); iter++){
-        delete (*iter);
+    else{
+        if(debug_mode){ std::cout << "debug: Output file is not writable!\n"; }
+        for(std::vector<drr_entry*>::iterator iter = pending_entries.begin();
+            iter != pending_entries.end(); iter++){
+            (*iter)->pending.clear();
+        }
     }
-    fills_waiting.clear();
     
+    pending_entries.clear();
     Flush_count = 0;
 }
 
@@ -775,6 +842,7 @@ OutputHisFile::OutputHisFile(){
     Flush_wait = 100000;
     Flush_count = 0;
     total_his_size = 0;
+    live_name = "";
     
     initialize();
 }
@@ -787,6 +855,7 @@ OutputHisFile::OutputHisFile(std::string fname_prefix){
     Flush_wait = 100000;
     Flush_count = 0;
     total_his_size = 0;
+    live_name = "";
     
     initialize();
     Open(fname_prefix);
@@ -814,9 +883,8 @@ size_t OutputHisFile::push_back(drr_entry *entry){
         return(0);
     }
     
-    // Seek to the end of this histogram file
-    ofile.seekp(0, std::ios::end);
-    entry->offset = (size_t)ofile.tellp()/2; // Set the file offset (in 2 byte words)
+    // The histogram goes at the end of this histogram file
+    entry->offset = (size_t)total_his_size/2; // Set the file offset (in 2 byte words)
     drrMap_.insert(std::make_pair(entry->hisID,entry));
     
     if(debug_mode)
@@ -824,17 +892,40 @@ size_t OutputHisFile::push_back(drr_entry *entry){
                   << " bytes for his ID = " << entry->hisID << " i.e. '"
                   << rstrip(entry->title) << "'\n";
     
-    char *block = new char[entry->total_size];	
-    memset(block, 0x0, entry->total_size);
-    ofile.write(block, entry->total_size);
-    delete[] block;
-    
-    ofile.seekp(0, std::ios::end);
-    total_his_size = ofile.tellp();
+    total_his_size += entry->total_size;
+    resize_his(total_his_size);
     
     return entry->total_size;
 }
 
+void OutputHisFile::open_live(){
+    if(!live.Open(drrMap_.size(), (unsigned long long)total_his_size, fname, live_name.c_str())){
+        std::cout << "OutputHisFile: Failed to create the live histogram segment " << live_name << ": " << strerror(errno) << std::endl;
+        return;
+    }
+    
+    // The directory follows the order of the .drr file
+    unsigned int index = 0;
+    for(std::map<unsigned int, drr_entry*>::iterator iter = drrMap_.begin();
+        iter != drrMap_.end(); iter++, index++){
+        drr_entry *entry = (*iter).second;
+        HisShmEntry *dir = live.GetEntry(index);
+        dir->hisID = entry->hisID;
+        dir->hisDim = entry->hisDim;
+        dir->halfWords = entry->halfWords;
+        for(int i = 0; i < 4; i++){
+            dir->scaled[i] = entry->scaled[i];
+            dir->minc[i] = entry->minc[i];
+            dir->maxc[i] = entry->maxc[i];
+        }
+        dir->numBins = entry->total_bins;
+        dir->offset = (unsigned long long)entry->offset * 2;
+        strncpy(dir->title, rstrip(entry->title).c_str(), sizeof(dir->title) - 1);
+        entry->live = dir;
+    }
+    live.Activate();
+}
+
 bool OutputHisFile::Finalize(bool make_list_file_/*=false*/, const std::string &descrip_/*="RootPixieScan .drr file"*/){
     if(!writable || finalized){ 
         if(debug_mode)
@@ -924,6 +1015,9 @@ bool OutputHisFile::Finalize(bool make_list_file_/*=false*/, const std::string &
     }
     list_file.close();	
     
+    if(!live_name.empty())
+        open_live();
+    
     finalized = true;
     
     return retval;
@@ -941,12 +1035,8 @@ bool OutputHisFile::Fill(unsigned int hisID_, unsigned int x_, unsigned int y_,
         if(!temp_drr->find_bin((unsigned int)(x_/temp_drr->comp[0]), (unsigned int)(y_/temp_drr->comp[1]), bin))
             return(false);
         
-        // Push this fill into the queue
-        fill_queue *fill = new fill_queue(temp_drr, bin, weight_);
-        fills_waiting.push_back(fill);
-        
-        if(++Flush_count >= Flush_wait)
-            Flush();
+        // Add this fill to the pending fills
+        add_fill(temp_drr, bin, weight_);
     }
     
     return(false);
@@ -961,11 +1051,8 @@ bool OutputHisFile::FillBin(unsigned int hisID_, unsigned int x_, unsigned int y
         temp_drr->total_counts++;
         if(!temp_drr->get_bin(x_, y_, bin)){ return false; }
 	
-        // Push this fill into the queue
-        fill_queue *fill = new fill_queue(temp_drr, bin, weight_);
-        fills_waiting.push_back(fill);
-        
-        if(++Flush_count >= Flush_wait){ Flush(); }
+        // Add this fill to the pending fills
+        add_fill(temp_drr, bin, weight_);
         return true;
     }
     
@@ -977,6 +1064,13 @@ bool OutputHisFile::Zero(unsigned int hisID_){
     
     drr_entry *temp_drr = find_drr_in_list(hisID_);
     if(temp_drr){
+        // Drop the fills which have not been written yet. The entry is also
+        // taken off the pending list, or the next fill would add it twice.
+        temp_drr->pending.clear();
+        pending_entries.erase(std::remove(pending_entries.begin(), pending_entries.end(), temp_drr), pending_entries.end());
+        if(temp_drr->live)
+            live.Zero(temp_drr->live);
+        
         ofile.seekp(temp_drr->offset*2, std::ios::beg);
 	
         char *block = new char[temp_drr->total_size];	
@@ -994,6 +1088,26 @@ bool OutputHisFile::Zero(){
     if(!writable)
         return false;
     
+    // Drop the fills which have not been written yet
+    for(std::vector<drr_entry*>::iterator iter = pending_entries.begin();
+        iter != pending_entries.end(); iter++){
+        (*iter)->pending.clear();
+    }
+    pending_entries.clear();
+    Flush_count = 0;
+    
+    for(std::map<unsigned int, drr_entry*>::iterator iter = drrMap_.begin();
+        iter != drrMap_.end(); iter++){
+        if((*iter).second->live)
+            live.Zero((*iter).second->live);
+    }
+    
+    // Cutting the file down and extending it again leaves one big hole
+    ofile.flush();
+    if(truncate((fname+".his").c_str(), 0) == 0 &&
+       truncate((fname+".his").c_str(), (off_t)total_his_size) == 0)
+        return true;
+    
     for(std::map<unsigned int, drr_entry*>::iterator iter = drrMap_.begin();
         iter != drrMap_.end(); iter++){
         ofile.seekp((*iter).second->offset*2, std::ios::beg);
@@ -1042,9 +1156,326 @@ void OutputHisFile::Close(){
     else if(debug_mode){ std::cout << "debug: Failed to open the .log file for writing!\n"; }
     log_file.close();
     
+    // The final contents stay available to viewers which have the segment open
+    live.Close();
+    
     // Clear the .drr entries in the entries vector
     clear_drr_entries();
     
     writable = false;
     ofile.close();
 }
+
+/// Return true if two sets of .drr entries describe the same histograms at the same locations
+static bool same_definitions(const std::map<unsigned int, drr_entry*> &first_, const std::map<unsigned int, drr_entry*> &second_, std::string &reason_){
+    if(first_.size() != second_.size()){
+        std::stringstream stream;
+        stream << "they contain " << first_.size() << " and " << second_.size() << " histograms";
+        reason_ = stream.str();
+        return false;
+    }
+    
+    std::map<unsigned int, drr_entry*>::const_iterator iter1 = first_.begin();
+    std::map<unsigned int, drr_entry*>::const_iterator iter2 = second_.begin();
+    for(; iter1 != first_.end(); iter1++, iter2++){
+        const drr_entry *entry1 = (*iter1).second;
+        const drr_entry *entry2 = (*iter2).second;
+        bool same = ((*iter1).first == (*iter2).first && entry1->hisDim == entry2->hisDim &&
+                     entry1->halfWords == entry2->halfWords && entry1->offset == entry2->offset);
+        for(int i = 0; i < 4 && same; i++){
+            same = (entry1->raw[i] == entry2->raw[i] && entry1->scaled[i] == entry2->scaled[i] &&
+                    entry1->minc[i] == entry2->minc[i] && entry1->maxc[i] == entry2->maxc[i]);
+        }
+        if(!same){
+            std::stringstream stream;
+            if((*iter1).first != (*iter2).first)
+                stream << "histogram " << (*iter1).first << " is not defined in both";
+            else
+                stream << "histogram " << (*iter1).first << " has a different definition";
+            reason_ = stream.str();
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+/// Read exactly count_ bytes from a file at the given location
+static bool read_fully(int fd_, char *data_, size_t count_, off_t location_){
+    while(count_ > 0){
+        ssize_t nRead = pread(fd_, data_, count_, location_);
+        if(nRead < 0 && errno == EINTR)
+            continue;
+        if(nRead <= 0)
+            return false;
+        data_ += nRead;
+        count_ -= nRead;
+        location_ += nRead;
+    }
+    return true;
+}
+
+/// Write exactly count_ bytes to a file at the given location
+static bool write_fully(int fd_, const char *data_, size_t count_, off_t location_){
+    while(count_ > 0){
+        ssize_t nWritten = pwrite(fd_, data_, count_, location_);
+        if(nWritten < 0 && errno == EINTR)
+            continue;
+        if(nWritten <= 0)
+            return false;
+        data_ += nWritten;
+        count_ -= nWritten;
+        location_ += nWritten;
+    }
+    return true;
+}
+
+/// State shared by the threads combining the histograms of several .his files
+struct combine_job{
+    std::vector<const drr_entry*> entries; /// The histograms to combine
+    std::vector<int> inputs; /// File descriptors of the input .his files
+    std::vector<double> weights; /// The weight of each input
+    std::vector<std::string> names; /// Filename prefixes of the inputs
+    bool plain_sum; /// True if all of the weights are one
+    int output; /// File descriptor of the output .his file
+    
+    std::atomic<size_t> next; /// Index of the next histogram to combine
+    std::atomic<unsigned long long> clipped; /// Number of bins outside the range of a cell
+    std::atomic<bool> failed; /// Set when any of the threads fails
+    std::mutex error_lock; /// Protects the error message
+    std::string error; /// Description of the first failure
+    
+    combine_job() : plain_sum(true), output(-1), next(0), clipped(0), failed(false) { }
+    
+    void fail(const std::string &error_){
+        std::lock_guard<std::mutex> lock(error_lock);
+        if(!failed)
+            error = error_;
+        failed = true;
+    }
+};
+
+/// Combine histograms taken from a shared job until none are left. Only
+/// blocks with counts are written so that empty regions of the output stay
+/// holes in the file.
+static void combine_histograms(combine_job *job_){
+    std::vector<unsigned int> sum(HIS_BLOCK_BINS * 64);
+    std::vector<double> weighted;
+    if(!job_->plain_sum)
+        weighted.resize(sum.size());
+    std::vector<char> buffer(sum.size() * 4);
+    
+    size_t index;
+    while(!job_->failed && (index = job_->next++) < job_->entries.size()){
+        const drr_entry *entry = job_->entries[index];
+        unsigned int bytesPerBin = entry->halfWords * 2;
+        double maxValue = (entry->use_int ? 4294967295.0 : 65535.0);
+        off_t start = (off_t)entry->offset * 2;
+        
+        for(size_t firstBin = 0; firstBin < entry->total_bins; firstBin += sum.size()){
+            size_t numBins = std::min(sum.size(), entry->total_bins - firstBin);
+            off_t location = start + (off_t)(firstBin * bytesPerBin);
+            std::fill(sum.begin(), sum.begin() + numBins, 0);
+            if(!job_->plain_sum)
+                std::fill(weighted.begin(), weighted.begin() + numBins, 0.0);
+            
+            for(size_t i = 0; i < job_->inputs.size(); i++){
+                if(!read_fully(job_->inputs[i], &buffer[0], numBins * bytesPerBin, location)){
+                    job_->fail("Failed to read " + job_->names[i] + ".his");
+                    return;
+                }
+                double weight = job_->weights[i];
+                if(entry->use_int){
+                    unsigned int *ival = (unsigned int*)&buffer[0];
+                    if(job_->plain_sum){
+                        for(size_t j = 0; j < numBins; j++)
+                            sum[j] += ival[j];
+                    }
+                    else{
+                        for(size_t j = 0; j < numBins; j++)
+                            weighted[j] += weight * ival[j];
+                    }
+                }
+                else{
+                    unsigned short *sval = (unsigned short*)&buffer[0];
+                    if(job_->plain_sum){
+                        for(size_t j = 0; j < numBins; j++)
+                            sum[j] += sval[j];
+                    }
+                    else{
+                        for(size_t j = 0; j < numBins; j++)
+                            weighted[j] += weight * sval[j];
+                    }
+                }
+            }
+            
+            // Round the weighted contents and clip them to the range of a cell.
+            // Plain sums wrap around just like filling the histogram would.
+            if(!job_->plain_sum){
+                unsigned long long clipped = 0;
+                for(size_t j = 0; j < numBins; j++){
+                    double value = floor(weighted[j] + 0.5);
+                    if(value < 0){
+                        value = 0;
+                        clipped++;
+                    }
+                    else if(value > maxValue){
+                        value = maxValue;
+                        clipped++;
+                    }
+                    sum[j] = (unsigned int)value;
+                }
+                if(clipped > 0)
+                    job_->clipped += clipped;
+            }
+            
+            bool has_counts = false;
+            for(size_t j = 0; j < numBins && !has_counts; j++)
+                has_counts = (sum[j] != 0);
+            if(!has_counts)
+                continue;
+            
+            if(entry->use_int){
+                memcpy(&buffer[0], &sum[0], numBins * 4);
+            }
+            else{
+                unsigned short *sval = (unsigned short*)&buffer[0];
+                for(size_t j = 0; j < numBins; j++)
+                    sval[j] = (unsigned short)sum[j];
+            }
+            if(!write_fully(job_->output, &buffer[0], numBins * bytesPerBin, location)){
+                job_->fail("Failed to write the output .his file");
+                return;
+            }
+        }
+    }
+}
+
+bool SumHisFiles(const std::vector<std::string> &inputs_, const std::string &output_, std::string &error_){
+    return CombineHisFiles(inputs_, std::vector<double>(inputs_.size(), 1.0), output_, error_);
+}
+
+bool CombineHisFiles(const std::vector<std::string> &inputs_, const std::vector<double> &weights_,
+                     const std::string &output_, std::string &error_, unsigned int threads_/*=1*/,
+                     unsigned long long *clipped_/*=NULL*/){
+    if(inputs_.empty()){
+        error_ = "No input files were given";
+        return false;
+    }
+    if(weights_.size() != inputs_.size()){
+        error_ = "The number of weights does not match the number of inputs";
+        return false;
+    }
+    
+    // All inputs must use the histogram definitions of the first one
+    HisFile reference;
+    if(!reference.LoadDrr(inputs_[0].c_str(), false)){
+        error_ = "Failed to load " + inputs_[0] + ".drr";
+        return false;
+    }
+    const std::map<unsigned int, drr_entry*> &entries = reference.GetDrrMap();
+    for(size_t i = 1; i < inputs_.size(); i++){
+        HisFile other;
+        if(!other.LoadDrr(inputs_[i].c_str(), false)){
+            error_ = "Failed to load " + inputs_[i] + ".drr";
+            return false;
+        }
+        std::string reason;
+        if(!same_definitions(entries, other.GetDrrMap(), reason)){
+            error_ = inputs_[i] + ".drr does not match " + inputs_[0] + ".drr, " + reason;
+            return false;
+        }
+    }
+    
+    combine_job job;
+    off_t total_his_size = 0;
+    for(std::map<unsigned int, drr_entry*>::const_iterator iter = entries.begin(); iter != entries.end(); iter++){
+        job.entries.push_back((*iter).second);
+        total_his_size = std::max(total_his_size, (off_t)(*iter).second->offset * 2 + (off_t)(*iter).second->total_size);
+    }
+    job.weights = weights_;
+    job.names = inputs_;
+    for(size_t i = 0; i < weights_.size(); i++){
+        if(weights_[i] != 1.0)
+            job.plain_sum = false;
+    }
+    
+    // Open all of the inputs and check that they are large enough before
+    // anything is written, the output may not replace one of the inputs.
+    struct stat output_stat;
+    bool output_exists = (stat((output_+".his").c_str(), &output_stat) == 0);
+    bool retval = true;
+    for(size_t i = 0; i < inputs_.size() && retval; i++){
+        int fd = open((inputs_[i]+".his").c_str(), O_RDONLY);
+        struct stat input_stat;
+        if(fd < 0 || fstat(fd, &input_stat) != 0){
+            error_ = "Failed to open " + inputs_[i] + ".his";
+            retval = false;
+        }
+        else if(input_stat.st_size < total_his_size){
+            error_ = inputs_[i] + ".his is shorter than its .drr file requires";
+            retval = false;
+        }
+        else if(output_exists && input_stat.st_dev == output_stat.st_dev && input_stat.st_ino == output_stat.st_ino){
+            error_ = "The output would overwrite the input " + inputs_[i] + ".his";
+            retval = false;
+        }
+        if(fd >= 0)
+            job.inputs.push_back(fd);
+    }
+    
+    if(retval){
+        job.output = open((output_+".his").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(job.output < 0){
+            error_ = "Failed to open " + output_ + ".his for writing";
+            retval = false;
+        }
+    }
+    
+    if(retval){
+        // Every thread takes whole histograms from the job until none are left
+        size_t numThreads = std::min((size_t)std::max(threads_, 1U), job.entries.size());
+        std::vector<std::thread> workers;
+        for(size_t i = 1; i < numThreads; i++)
+            workers.push_back(std::thread(combine_histograms, &job));
+        combine_histograms(&job);
+        for(size_t i = 0; i < workers.size(); i++)
+            workers[i].join();
+        
+        if(job.failed){
+            error_ = job.error;
+            retval = false;
+        }
+        else if(ftruncate(job.output, total_his_size) != 0 && total_his_size > 0){
+            // Fall back to writing the last byte for file systems without truncate
+            char zero = 0x0;
+            if(!write_fully(job.output, &zero, 1, total_his_size - 1)){
+                error_ = "Failed to write " + output_ + ".his";
+                retval = false;
+            }
+        }
+    }
+    
+    for(size_t i = 0; i < job.inputs.size(); i++)
+        close(job.inputs[i]);
+    if(job.output >= 0 && close(job.output) != 0 && retval){
+        error_ = "Failed to write " + output_ + ".his";
+        retval = false;
+    }
+    
+    if(retval){
+        // Copy the .drr file of the first input
+        std::ifstream drr_in((inputs_[0]+".drr").c_str(), std::ios::binary);
+        std::ofstream drr_out((output_+".drr").c_str(), std::ios::binary | std::ios::trunc);
+        drr_out << drr_in.rdbuf();
+        if(!drr_out.good()){
+            error_ = "Failed to write " + output_ + ".drr";
+            retval = false;
+        }
+    }
+    
+    if(clipped_)
+        *clipped_ = job.clipped;
+    
+    return retval;
+}
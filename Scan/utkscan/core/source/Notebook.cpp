@@ -7,7 +7,8 @@
 #include "Globals.hpp"
 #include "Messenger.hpp"
 #include "Notebook.hpp"
-#include "pugixml.hpp"
+#include "OutputFiles.hpp"
+#include "XmlConfiguration.hpp"
 
 Notebook* Notebook::instance = NULL;
 
@@ -19,21 +20,12 @@ Notebook* Notebook::get() {
 }
 
 Notebook::Notebook() {
-    std::string cfg = Globals::get()->configfile();
-    pugi::xml_document doc;
+    pugi::xml_node note = XmlConfiguration::get()->GetSection("Notebook");
 
-    pugi::xml_parse_result result = doc.load_file(cfg.c_str());
-    if (!result) {
-        std::stringstream ss;
-        ss << "Notebook: error parsing file " << cfg;
-        ss << " : " << result.description();
-        throw IOException(ss.str());
-    }
-
-    pugi::xml_node note = doc.child("Configuration").child("Notebook");
-
-    file_name_ = std::string(note.attribute("file").as_string());
     mode_ = std::string(note.attribute("mode").as_string("a"));
+    file_name_ = OutputFiles::get()->Register(
+            note.attribute("file").as_string(),
+            mode_ == "a" ? OUTPUT_TEXT_APPEND : OUTPUT_TEXT);
 
     Messenger m;
     m.detail("Notebook: " + file_name_ + " mode: " + mode_);
@@ -0,0 +1,131 @@
+/** \file OutputFiles.cpp
+ * \brief Names the files written by processors apart from the histograms
+ * \date Oct. 19th, 2026
+ */
+#include <fstream>
+#include <sstream>
+
+#include <cstdlib>
+
+#include "ColumnFile.h"
+#include "Exceptions.hpp"
+#include "GammaCoincidences.hpp"
+#include "OutputFiles.hpp"
+
+using namespace std;
+
+OutputFiles *OutputFiles::instance = NULL;
+
+OutputFiles *OutputFiles::get() {
+    if (!instance)
+        instance = new OutputFiles();
+    return instance;
+}
+
+string OutputFiles::InsertSuffix(const string &name, const string &suffix) {
+    size_t slash = name.find_last_of('/');
+    size_t dot = name.find_last_of('.');
+    if (dot == string::npos || (slash != string::npos && dot < slash) ||
+        dot == (slash == string::npos ? 0 : slash + 1))
+        return name + suffix;
+    return name.substr(0, dot) + suffix + name.substr(dot);
+}
+
+string OutputFiles::Register(const string &name, const OutputKind &kind) {
+    if (suffix_.empty())
+        return name;
+    for (vector<OutputFileEntry>::iterator it = entries_.begin();
+         it != entries_.end(); it++)
+        if (it->name == name)
+            return it->part;
+
+    OutputFileEntry entry;
+    entry.name = name;
+    entry.part = InsertSuffix(name, suffix_);
+    entry.kind = kind;
+    entries_.push_back(entry);
+    return entry.part;
+}
+
+bool OutputFiles::WriteList(const string &listName) const {
+    ofstream list(listName.c_str());
+    for (vector<OutputFileEntry>::const_iterator it = entries_.begin();
+         it != entries_.end(); it++)
+        list << it->kind << "\t" << it->name << "\t" << it->part << "\n";
+    return list.good();
+}
+
+bool OutputFiles::ReadList(const string &listName,
+                           vector<OutputFileEntry> &entries) {
+    ifstream list(listName.c_str());
+    if (!list.good())
+        return false;
+
+    string line;
+    while (getline(list, line)) {
+        stringstream ss(line);
+        string kind;
+        OutputFileEntry entry;
+        if (!getline(ss, kind, '\t') || !getline(ss, entry.name, '\t') ||
+            !getline(ss, entry.part))
+            return false;
+        entry.kind = (OutputKind) atoi(kind.c_str());
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+bool OutputFiles::Combine(const string &name, const OutputKind &kind,
+                          const vector<string> &parts, string &error) {
+    if (kind == OUTPUT_COLUMNS)
+        return MergeColumnFiles(parts, name, error);
+
+    if (kind == OUTPUT_TEXT || kind == OUTPUT_TEXT_APPEND) {
+        ofstream out(name.c_str(), kind == OUTPUT_TEXT_APPEND ?
+                                   ios::out | ios::app : ios::out | ios::trunc);
+        for (vector<string>::const_iterator it = parts.begin();
+             it != parts.end() && out.good(); it++) {
+            ifstream in(it->c_str());
+            if (in.peek() != ifstream::traits_type::eof())
+                out << in.rdbuf();
+        }
+        if (!out.good())
+            error = "Failed to write " + name;
+        return out.good();
+    }
+
+    if ((kind == OUTPUT_GAMMA_MATRIX || kind == OUTPUT_GAMMA_CUBE) &&
+        !parts.empty()) {
+        try {
+            if (kind == OUTPUT_GAMMA_MATRIX) {
+                GammaMatrix sum;
+                sum.Read(parts.front());
+                for (vector<string>::const_iterator it = parts.begin() + 1;
+                     it != parts.end(); it++) {
+                    GammaMatrix part;
+                    part.Read(*it);
+                    sum.Add(part);
+                }
+                sum.Write(name);
+            } else {
+                GammaCube first(parts.front());
+                GammaCube sum(name, first.GetNumBins(), first.GetBlockBins());
+                first.Close();
+                for (vector<string>::const_iterator it = parts.begin();
+                     it != parts.end(); it++)
+                    sum.Add(GammaCube(*it));
+                if (!sum.Close()) {
+                    error = "Failed writing " + name;
+                    return false;
+                }
+            }
+        } catch (GeneralException &e) {
+            error = e.what();
+            return false;
+        }
+        return true;
+    }
+
+    error = "The parts of " + name + " can not be combined";
+    return false;
+}
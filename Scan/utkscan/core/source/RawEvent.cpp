@@ -25,17 +25,50 @@ void RawEvent::Init(const std::set<std::string> &usedTypes)
     }
 }
 
+RawEvent::~RawEvent() {
+    for (vector<ChanEvent*>::iterator it = eventList.begin();
+         it != eventList.end(); it++)
+        delete *it;
+    for (vector<ChanEvent*>::iterator it = subEventList.begin();
+         it != subEventList.end(); it++)
+        delete *it;
+    for (vector<ChanEvent*>::iterator it = chanPool.begin();
+         it != chanPool.end(); it++)
+        delete *it;
+}
+
+ChanEvent* RawEvent::AddChan(XiaData *xiadata) {
+    ChanEvent *event;
+    if (chanPool.empty())
+        event = new ChanEvent();
+    else {
+        event = chanPool.back();
+        chanPool.pop_back();
+    }
+    event->Set(xiadata);
+    eventList.push_back(event);
+    return event;
+}
+
+ChanEvent* RawEvent::AddSubEventChan(XiaData *xiadata) {
+    ChanEvent *event = AddChan(xiadata);
+    eventList.pop_back();
+    subEventList.push_back(event);
+    return event;
+}
+
 void RawEvent::Zero(const std::set<std::string> &usedev) {
     for (map<string, DetectorSummary>::iterator it = sumMap.begin();
 	 it != sumMap.end(); it++) {
         (*it).second.Zero();
     }
 
-    for(vector<ChanEvent*>::iterator it = eventList.begin();
-                it != eventList.end(); it++)
-        delete *it;
-
+    //The channels go back to the pool, the lists keep their capacity so
+    // nothing is allocated for events no larger than the ones already seen.
+    chanPool.insert(chanPool.end(), eventList.begin(), eventList.end());
+    chanPool.insert(chanPool.end(), subEventList.begin(), subEventList.end());
     eventList.clear();
+    subEventList.clear();
 }
 
 DetectorSummary *RawEvent::GetSummary(const std::string& s, bool construct) {
@@ -0,0 +1,66 @@
+/** \file RecordSink.cpp
+ * \brief A buffered binary sink for the records dumped by processors
+ * \date Oct. 19th, 2026
+ */
+#include <iostream>
+
+#include <stdint.h>
+
+#include "OutputFiles.hpp"
+#include "RecordSink.hpp"
+
+using namespace std;
+
+bool RecordSink::AddField(const std::string &name, const ColumnType &type) {
+    if(writer_.GetNumColumns() > 0 || GetColumnTypeSize(type) == 0)
+        return(false);
+    names_.push_back(name);
+    types_.push_back(type);
+    return(true);
+}
+
+bool RecordSink::Open(const std::string &fileName) {
+    Close();
+    fileName_ = OutputFiles::get()->Register(fileName, OUTPUT_COLUMNS);
+
+    //The writer reads the fields from these addresses for every record, so
+    // the record is sized once, when the file is first opened.
+    if(writer_.GetNumColumns() == 0) {
+        record_.assign(types_.size(), 0);
+        for(size_t i = 0; i < types_.size(); i++) {
+            if(!writer_.AddColumn(names_[i], types_[i], &record_[i]))
+                return(false);
+        }
+    }
+
+    if(!writer_.Open(fileName_)) {
+        cerr << "RecordSink::Open : Unable to open " << fileName_ << endl;
+        return(false);
+    }
+    lastFlush_ = time(NULL);
+    return(true);
+}
+
+void RecordSink::SetField(const size_t &field, const double &value) {
+    void *slot = &record_[field];
+    switch(types_[field]) {
+        case COLUMN_INT32:
+            *(int32_t*)slot = (int32_t)value;
+            break;
+        case COLUMN_UINT32:
+            *(uint32_t*)slot = (uint32_t)value;
+            break;
+        case COLUMN_INT64:
+            *(int64_t*)slot = (int64_t)value;
+            break;
+        case COLUMN_UINT64:
+            *(uint64_t*)slot = (uint64_t)value;
+            break;
+        case COLUMN_FLOAT:
+            *(float*)slot = (float)value;
+            break;
+        default:
+            *(double*)slot = value;
+            break;
+    }
+}
@@ -0,0 +1,311 @@
+/** \file RunListScanner.cpp
+ * \brief Scans a list of input files in parallel and sums the histograms
+ * \date Oct. 19th, 2026
+ */
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "HisFile.hpp"
+#include "OutputFiles.hpp"
+#include "RunListScanner.hpp"
+#include "UtkScanInterface.hpp"
+
+using namespace std;
+
+RunListScanner::RunListScanner(int argc, char *argv[]) {
+    progName_ = argc > 0 ? argv[0] : "utkscan";
+    output_ = "out";
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    jobs_ = cpus > 0 ? (unsigned int) cpus : 1;
+
+    //The input and output options are replaced for every worker, so they
+    // are taken out together with the run list options.
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string value;
+        bool hasValue = i + 1 < argc;
+        if (arg == "--run-list" || arg == "--jobs" || arg == "-j" ||
+            arg == "--output" || arg == "-o" || arg == "--input" ||
+            arg == "-i") {
+            if (hasValue)
+                value = argv[++i];
+        } else if (arg.find('=') != string::npos && arg.compare(0, 2, "--") == 0) {
+            value = arg.substr(arg.find('=') + 1);
+            arg = arg.substr(0, arg.find('='));
+            if (arg != "--run-list" && arg != "--jobs" && arg != "--output" &&
+                arg != "--input") {
+                passArgs_.push_back(argv[i]);
+                continue;
+            }
+        } else {
+            passArgs_.push_back(arg);
+            continue;
+        }
+
+        if (arg == "--run-list")
+            listName_ = value;
+        else if (arg == "--jobs" || arg == "-j")
+            jobs_ = max(atoi(value.c_str()), 1);
+        else if (arg == "--output" || arg == "-o")
+            output_ = value;
+        else
+            cout << "utkscan : Ignoring input file " << value
+                 << " given together with a run list" << endl;
+    }
+}
+
+bool RunListScanner::ReadList() {
+    ifstream list(listName_.c_str());
+    if (!list.good()) {
+        cout << "utkscan : Unable to open the run list " << listName_ << endl;
+        return false;
+    }
+
+    string line;
+    while (getline(list, line)) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == string::npos || line[first] == '#')
+            continue;
+        size_t last = line.find_last_not_of(" \t\r");
+        files_.push_back(line.substr(first, last - first + 1));
+    }
+
+    if (files_.empty())
+        cout << "utkscan : The run list " << listName_ << " is empty" << endl;
+    return !files_.empty();
+}
+
+string RunListScanner::GetPartName(const size_t &index) const {
+    stringstream ss;
+    ss << output_ << "_part" << setw(3) << setfill('0') << index;
+    return ss.str();
+}
+
+int RunListScanner::ScanFile(const size_t &index) {
+    string part = GetPartName(index);
+
+    //The output of the workers would be interleaved on the terminal
+    int fd = open((part + ".out").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        close(fd);
+    }
+
+    vector<string> args;
+    args.push_back(progName_);
+    args.insert(args.end(), passArgs_.begin(), passArgs_.end());
+    args.push_back("--batch");
+    args.push_back("--input");
+    args.push_back(files_[index]);
+    args.push_back("--output");
+    args.push_back(part);
+
+    vector<char *> argv;
+    for (vector<string>::iterator it = args.begin(); it != args.end(); it++)
+        argv.push_back(&(*it)[0]);
+    argv.push_back(NULL);
+
+    //Processors that write their own files take the names from OutputFiles,
+    // which inserts the suffix of this worker into them.
+    OutputFiles::get()->SetSuffix(part.substr(output_.size()));
+
+    UtkScanInterface scanner;
+    scanner.SetProgramName("utkscan");
+    if (!scanner.Setup(argv.size() - 1, &argv[0]))
+        return 1;
+    int retval = scanner.Execute();
+    scanner.Close();
+    delete output_his;
+    output_his = NULL;
+    if (!OutputFiles::get()->WriteList(part + ".outputs"))
+        retval = 1;
+    return retval;
+}
+
+int RunListScanner::Execute() {
+    if (!ReadList())
+        return 1;
+    for (vector<string>::iterator it = passArgs_.begin();
+         it != passArgs_.end(); it++) {
+        if (*it == "--shm" || *it == "-s" ||
+            it->compare(0, 10, "--live-his") == 0) {
+            cout << "utkscan : A run list cannot be used with shared memory"
+                 << endl;
+            return 1;
+        }
+    }
+
+    cout << "utkscan : Scanning " << files_.size() << " files from "
+         << listName_ << " with up to " << jobs_ << " workers" << endl;
+
+    map<pid_t, size_t> running;
+    vector<bool> succeeded(files_.size(), false);
+    size_t next = 0;
+    while (next < files_.size() || !running.empty()) {
+        while (next < files_.size() && running.size() < jobs_) {
+            cout.flush();
+            pid_t pid = fork();
+            if (pid == 0) {
+                int retval = ScanFile(next);
+                cout.flush();
+                _exit(retval);
+            } else if (pid < 0) {
+                cout << "utkscan : Failed to start a worker for "
+                     << files_[next] << " : " << strerror(errno) << endl;
+                next++;
+                continue;
+            }
+            running[pid] = next++;
+        }
+
+        int status;
+        pid_t pid = wait(&status);
+        if (pid < 0)
+            break;
+        map<pid_t, size_t>::iterator it = running.find(pid);
+        if (it == running.end())
+            continue;
+
+        size_t index = it->second;
+        running.erase(it);
+        succeeded[index] = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        cout << "utkscan : " << (succeeded[index] ? "Finished " : "FAILED ")
+             << files_[index] << " (" << index + 1 << "/" << files_.size()
+             << ")" << endl;
+    }
+
+    vector<string> parts;
+    bool allGood = true;
+    for (size_t i = 0; i < files_.size(); i++) {
+        parts.push_back(GetPartName(i));
+        if (!succeeded[i]) {
+            cout << "utkscan : The scan of " << files_[i] << " failed, see "
+                 << parts.back() << ".out" << endl;
+            allGood = false;
+        }
+    }
+    if (!allGood) {
+        cout << "utkscan : The histograms were not summed, the outputs of "
+             << "the single files are kept" << endl;
+        return 1;
+    }
+
+    string error;
+    if (!SumHisFiles(parts, output_, error)) {
+        cout << "utkscan : Failed to sum the histograms : " << error << endl;
+        return 1;
+    }
+    MergeLogs(parts);
+    bool outputsGood = MergeOutputs(parts);
+
+    const char *extensions[] = {".his", ".drr", ".list", ".log", ".out",
+                                ".outputs"};
+    for (vector<string>::iterator it = parts.begin(); it != parts.end(); it++)
+        for (unsigned int i = 0; i < 6; i++)
+            remove((*it + extensions[i]).c_str());
+
+    cout << "utkscan : Summed the histograms of " << parts.size()
+         << " files into " << output_ << ".his" << endl;
+    return outputsGood ? 0 : 1;
+}
+
+void RunListScanner::MergeLogs(const vector<string> &parts) const {
+    map<unsigned int, pair<unsigned long long, unsigned long long> > counts;
+    set<unsigned int> failed;
+    for (vector<string>::const_iterator it = parts.begin();
+         it != parts.end(); it++) {
+        ifstream log((*it + ".log").c_str());
+        string line;
+        bool inFailed = false;
+        while (getline(log, line)) {
+            if (line.find("Failed histogram fills") != string::npos) {
+                inFailed = true;
+                continue;
+            }
+            stringstream ss(line);
+            unsigned int id;
+            unsigned long long total, good;
+            if (inFailed) {
+                if (ss >> id)
+                    failed.insert(id);
+            } else if (ss >> id >> total >> good) {
+                counts[id].first += total;
+                counts[id].second += good;
+            }
+        }
+    }
+
+    ofstream log((output_ + ".log").c_str());
+    log << "  HID      TOTAL      GOOD\n\n";
+    for (map<unsigned int, pair<unsigned long long, unsigned long long> >::
+         iterator it = counts.begin(); it != counts.end(); it++)
+        log << setw(5) << it->first << setw(10) << it->second.first
+            << setw(10) << it->second.second << endl;
+    log << "\nFailed histogram fills:\n\n";
+    for (set<unsigned int>::iterator it = failed.begin(); it != failed.end();
+         it++)
+        log << setw(5) << *it << endl;
+}
+
+bool RunListScanner::MergeOutputs(const vector<string> &parts) const {
+    //The parts of every file in the order of the run list
+    vector<string> names;
+    map<string, pair<OutputKind, vector<string> > > files;
+    for (vector<string>::const_iterator it = parts.begin();
+         it != parts.end(); it++) {
+        vector<OutputFileEntry> entries;
+        if (!OutputFiles::ReadList(*it + ".outputs", entries)) {
+            cout << "utkscan : Unable to read the list of files written for "
+                 << *it << endl;
+            return false;
+        }
+        for (vector<OutputFileEntry>::iterator entry = entries.begin();
+             entry != entries.end(); entry++) {
+            if (files.find(entry->name) == files.end()) {
+                names.push_back(entry->name);
+                files[entry->name].first = entry->kind;
+            }
+            files[entry->name].second.push_back(entry->part);
+        }
+    }
+
+    bool allGood = true;
+    for (vector<string>::iterator it = names.begin(); it != names.end();
+         it++) {
+        pair<OutputKind, vector<string> > &file = files[*it];
+        if (file.first == OUTPUT_KEEP) {
+            cout << "utkscan : " << *it << " was written as "
+                 << file.second.size() << " separate files ("
+                 << file.second.front() << ", ...)" << endl;
+            continue;
+        }
+
+        string error;
+        if (!OutputFiles::Combine(*it, file.first, file.second, error)) {
+            cout << "utkscan : Failed to combine the parts of " << *it
+                 << " : " << error << ", the parts are kept" << endl;
+            allGood = false;
+            continue;
+        }
+        for (vector<string>::iterator part = file.second.begin();
+             part != file.second.end(); part++)
+            remove(part->c_str());
+        cout << "utkscan : Combined " << file.second.size()
+             << " parts into " << *it << endl;
+    }
+    return allGood;
+}
@@ -11,6 +11,7 @@
 
 #include "Exceptions.hpp"
 #include "TimingCalibrator.hpp"
+#include "XmlConfiguration.hpp"
 
 using namespace std;
 
@@ -31,22 +32,24 @@ TimingCalibrator* TimingCalibrator::get() {
     return instance;
 }
 
-void TimingCalibrator::ReadTimingCalXml() {
-    string cfg = Globals::get()->configfile();
-    pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_file(cfg.c_str());
-    if (!result) {
-        stringstream ss;
-        ss << "TimingCalibrator: error parsing file " << cfg;
-        ss << " : " << result.description();
-        throw GeneralException(ss.str());
-    }
+TimingCalibrator::TimingCalibrator() {
+    ReadTimingCalXml(*XmlConfiguration::get(), calibrations_);
+}
+
+void TimingCalibrator::Reload(const XmlConfiguration &xml) {
+    if (!instance)
+        return;
+    map<TimingDefs::TimingIdentifier, TimingCalibration> cals;
+    instance->ReadTimingCalXml(xml, cals);
+    instance->calibrations_.swap(cals);
+}
 
+void TimingCalibrator::ReadTimingCalXml(const XmlConfiguration &xml,
+        map<TimingDefs::TimingIdentifier, TimingCalibration> &cals) {
     Messenger m;
     m.start("Loading Time Calibrations");
 
-    pugi::xml_node timeCals =
-        doc.child("Configuration").child("TimeCalibration");
+    pugi::xml_node timeCals = xml.GetSection("TimeCalibration");
 
     isVerbose_ = timeCals.attribute("verbose_timing").as_bool();
 
@@ -78,7 +81,7 @@ void TimingCalibrator::ReadTimingCalXml() {
                     temp.SetTofOffset(tofoffset->attribute("location").as_int(-1),
                                       tofoffset->attribute("offset").as_double(0.0));
 
-                if(!calibrations_.insert(make_pair(id, temp)).second) {
+                if(!cals.insert(make_pair(id, temp)).second) {
                     stringstream ss;
                     ss << "TimingCalibrator: We have found a duplicate "
                        << "entry into the TimingCalibrations at "
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <vector>
 
+#include "BarIndex.hpp"
 #include "TimingMapBuilder.hpp"
 
 using namespace std;
@@ -16,14 +17,12 @@ TimingMapBuilder::TimingMapBuilder(const std::vector<ChanEvent*> &evts) {
 
 void TimingMapBuilder::FillMaps(const std::vector<ChanEvent*> &evts) {
     map_.clear();
+    const BarIndex *index = BarIndex::get();
     for(vector<ChanEvent*>::const_iterator it = evts.begin();
     it != evts.end(); it++) {
-        Identifier id = (*it)->GetChanID();
-        TimingDefs::TimingIdentifier key(id.GetLocation(), id.GetSubtype());
-
         HighResTimingData data((*it));
         if(!data.GetIsValid())
             continue;
-        map_.insert(make_pair(key,data));
+        map_.insert(make_pair(index->GetEntry((*it)->GetID()).key, data));
     }
 }
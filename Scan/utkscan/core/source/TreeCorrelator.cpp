@@ -9,6 +9,7 @@
 #include "Globals.hpp"
 #include "Exceptions.hpp"
 #include "Messenger.hpp"
+#include "XmlConfiguration.hpp"
 
 using namespace std;
 
@@ -170,21 +171,10 @@ void TreeCorrelator::createPlace(std::map<std::string, std::string>& params,
 }
 
 void TreeCorrelator::buildTree() {
-    string cfg = Globals::get()->configfile();
-    pugi::xml_document doc;
-
     Messenger m;
     m.start("Creating TreeCorrelator");
-    pugi::xml_parse_result result = doc.load_file(cfg.c_str());
-    if (!result) {
-        stringstream ss;
-        ss << "DetectorDriver: error parsing file " << cfg;
-        ss << " : " << result.description();
-        m.fail();
-        throw IOException(ss.str());
-    }
 
-    pugi::xml_node tree = doc.child("Configuration").child("TreeCorrelator");
+    pugi::xml_node tree = XmlConfiguration::get()->GetSection("TreeCorrelator");
     bool verbose = tree.attribute("verbose").as_bool(false);
 
     Walker walker;
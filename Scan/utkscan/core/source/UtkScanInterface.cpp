@@ -1,6 +1,11 @@
+#include <ctime>
+#include <cstring>
+
+#include "DammPlotIds.hpp"
 #include "DetectorDriver.hpp"
 #include "UtkScanInterface.hpp"
 #include "UtkUnpacker.hpp"
+#include "his_shm.h"
 
 // Define a pointer to an OutputHisFile for later use.
 #ifndef USE_HRIBF
@@ -10,6 +15,7 @@ OutputHisFile *output_his = NULL;
 /// Default constructor.
 UtkScanInterface::UtkScanInterface() : ScanInterface() {
     init_ = false;
+    shedStart_ = 0;
 }
 
 /// Destructor.
@@ -28,13 +34,17 @@ UtkScanInterface::~UtkScanInterface() {
  * \return True if the command was recognized and false otherwise. */
 bool UtkScanInterface::ExtraCommands(const std::string &cmd_,
                                      std::vector<std::string> &args_) {
-    if (cmd_ == "mycmd") {
-        if (args_.size() >= 1) {
-            // Handle the command.
-        } else {
-            std::cout << msgHeader
-                      << "Invalid number of parameters to 'mycmd'\n";
-            std::cout << msgHeader << " -SYNTAX- mycmd <param>\n";
+    if (cmd_ == "reload") {
+        if (!init_) {
+            std::cout << msgHeader << "The scan is not initialized.\n";
+            return (true);
+        }
+        try {
+            DetectorDriver::get()->RequestReload();
+            std::cout << msgHeader << "Calibrations, walk corrections and "
+                      << "gates will be replaced before the next event.\n";
+        } catch (std::exception &e) {
+            std::cout << msgHeader << "Reload failed : " << e.what() << "\n";
         }
     } else
         return (false); // Unrecognized command.
@@ -47,7 +57,36 @@ bool UtkScanInterface::ExtraCommands(const std::string &cmd_,
  * or 'h' into the interactive terminal (if available).
  * \param[in]  prefix_ String to append at the start of any output. */
 void UtkScanInterface::CmdHelp() {
-    std::cout << "   mycmd <param> - Do something useful.\n";
+    std::cout << "   reload        - Re-read the calibrations, walk corrections, timing calibrations\n";
+    std::cout << "                   and gates from the configuration file without a restart.\n";
+}
+
+/** ArgHelp is used to allow a derived class to add command line options
+ * to the main list of options. The run list options are only listed here,
+ * they are handled by the RunListScanner in main(). */
+void UtkScanInterface::ArgHelp() {
+    AddOption(optionExt("run-list", required_argument, NULL, 0, "<filename>",
+                        "Scan the files listed in <filename> in parallel and sum the histograms"));
+    AddOption(optionExt("jobs", required_argument, NULL, 'j', "<number>",
+                        "Number of files from the run list scanned at the same time"));
+    AddOption(optionExt("live-his", optional_argument, NULL, 0, "[=name]",
+                        "Publish the live histograms in shared memory (default " HIS_SHM_DEFAULT_NAME ")"));
+}
+
+/** ExtraArguments is used to send command line arguments to classes derived
+ * from ScanInterface. Only the live histogram option is handled here, the
+ * run list options were already taken care of in main(). */
+void UtkScanInterface::ExtraArguments() {
+    for (std::vector<optionExt>::iterator it = userOpts.begin();
+         it != userOpts.end(); it++) {
+        if (strcmp(it->name, "live-his") != 0 || !it->active)
+            continue;
+        liveName_ = it->argument;
+        if (liveName_.empty())
+            liveName_ = HIS_SHM_DEFAULT_NAME;
+        else if (liveName_[0] != '/')
+            liveName_ = "/" + liveName_;
+    }
 }
 
 /** SyntaxStr is used to print a linux style usage message to the screen.
@@ -74,6 +113,11 @@ bool UtkScanInterface::Initialize(std::string prefix_) {
         // Read in the name of the his file.
         output_his = new OutputHisFile(GetOutputFilename().c_str());
         output_his->SetDebugMode(false);
+        if (!liveName_.empty()) {
+            std::cout << prefix_ << "Publishing live histograms in shared "
+                      << "memory as " << liveName_ << "\n";
+            output_his->EnableLive(liveName_);
+        }
 
         /** The DetectorDriver constructor will load processors
          *  from the xml configuration file upon first call.
@@ -88,6 +132,9 @@ bool UtkScanInterface::Initialize(std::string prefix_) {
          */
         DetectorDriver::get()->DeclarePlots();
         output_his->Finalize();
+
+        // The event windows of the detector groups need the channel map.
+        ((UtkUnpacker *) GetCore())->LoadEventWindows();
     } catch (std::exception &e) {
         // Any exceptions will be intercepted here
         std::cout << prefix_ << "Exception caught at Initialize:" << std::endl;
@@ -115,12 +162,33 @@ void UtkScanInterface::Notify(const std::string &code_/*=""*/) {
     } else if (code_ == "LOAD_FILE") {
         std::cout << msgHeader << "File loaded.\n";
     } else if (code_ == "REWIND_FILE") {
+    } else if (code_ == "OVERLOAD_LEVEL") {
+        DetectorDriver::get()->SetShedLevel(GetOverload().GetAnalysisLevel());
     } else {
         std::cout << msgHeader << "Unknown notification code '" << code_
                   << "'!\n";
     }
 }
 
+/** Record the load shedding applied to a spill received from poll2. The
+ * processed spills are counted at their prescale, so the rates can be
+ * corrected, and the level is plotted against the wall time.
+ * \param[in] processed_ True if the spill is processed and false if it is
+ * shed.
+ * \return Nothing. */
+void UtkScanInterface::SpillReceived(const bool &processed_) {
+    time_t now = time(NULL);
+    if (shedStart_ == 0)
+        shedStart_ = now;
+
+    DetectorDriver *driver = DetectorDriver::get();
+    driver->plot(dammIds::raw::DD_SHED_LEVEL, (now - shedStart_) / 10.,
+                 GetOverload().GetLevel());
+    if (processed_)
+        driver->plot(dammIds::raw::D_SPILL_PRESCALE,
+                     GetOverload().GetPrescale());
+}
+
 /** Return a pointer to the Unpacker object to use for data unpacking.
  * If no object has been initialized, create a new one.
  * \return Pointer to an Unpacker object. */
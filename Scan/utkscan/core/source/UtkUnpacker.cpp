@@ -5,15 +5,20 @@
 ///@date June 17, 2016
 #include <iostream>
 #include <set>
+#include <sstream>
 
 #include <unistd.h>
 #include <sys/times.h>
 
 #include "DammPlotIds.hpp"
+#include "Exceptions.hpp"
+#include "Globals.hpp"
+#include "Messenger.hpp"
 #include "Places.hpp"
 #include "TreeCorrelator.hpp"
 #include "UtkScanInterface.hpp"
 #include "UtkUnpacker.hpp"
+#include "XmlConfiguration.hpp"
 
 using namespace std;
 using namespace dammIds::raw;
@@ -22,12 +27,77 @@ using namespace dammIds::raw;
 /// referenced in DetectorDriver.cpp, particularly in ProcessEvent().
 RawEvent rawev;
 
+/// The EventWindows section holds one Group node per detector type (and
+/// optionally subtype) which needs a window different from the event width,
+/// e.g. <Group type="3hen" width="20" unit="us" trigger="false"/>. Channels
+/// which are not triggers never open an event, their hits are attached to the
+/// sub-event of the preceding event (RawEvent::GetSubEventList) if they are
+/// within the window. Hits of trigger channels go into the event itself. This
+/// keeps the events of the fast detectors short while
+/// still catching the delayed partners. See
+/// share/utkscan/cfgs/examples/eventwindows.xml.
+void UtkUnpacker::LoadEventWindows() {
+    pugi::xml_node windows =
+        XmlConfiguration::get()->GetSection("EventWindows");
+    if (!windows)
+        return;
+
+    Messenger m;
+    m.start("Loading event windows");
+    DetectorLibrary *modChan = DetectorLibrary::get();
+    for (pugi::xml_node group = windows.child("Group"); group;
+         group = group.next_sibling("Group")) {
+        string type = group.attribute("type").as_string();
+        string subtype = group.attribute("subtype").as_string();
+        string units = group.attribute("unit").as_string("ns");
+        double width = group.attribute("width").as_double(-1);
+        bool trigger = group.attribute("trigger").as_bool(false);
+
+        if (units == "ns")
+            width *= 1e-9;
+        else if (units == "us")
+            width *= 1e-6;
+        else if (units == "ms")
+            width *= 1e-3;
+        else if (units != "s")
+            throw GeneralException("UtkUnpacker: unknown units " + units);
+
+        if (type.empty() || width < 0)
+            throw GeneralException("UtkUnpacker: event window groups need a"
+                                   " type and a positive width");
+
+        double ticks = width / Globals::get()->clockInSeconds();
+        unsigned int numChannels = 0;
+        for (DetectorLibrary::size_type index = 0; index < modChan->size();
+             index++) {
+            const Identifier &id = modChan->at(index);
+            if (id.GetType() != type ||
+                (!subtype.empty() && id.GetSubtype() != subtype))
+                continue;
+            if (SetChannelWindow(modChan->ModuleFromIndex(index),
+                                 modChan->ChannelFromIndex(index), ticks,
+                                 trigger))
+                numChannels++;
+        }
+
+        stringstream ss;
+        ss << type << (subtype.empty() ? "" : ":") << subtype << " : "
+           << width * 1e6 << " us (" << ticks << " ticks) for " << numChannels
+           << " channels" << (trigger ? ", trigger" : "");
+        m.detail(ss.str());
+    }
+    m.done();
+}
+
 ///The only thing that we do here is call the destructor of the
 /// DetectorDriver. This will ensure that the memory is freed for all of the
 /// initialized detector and experiment processors and that information about
 /// the amount of time spent in each processor is output to the screen at the
 /// end of execution.
 UtkUnpacker::~UtkUnpacker() {
+    if (GetNumOrphans() > 0)
+        cout << "UtkUnpacker: " << GetNumOrphans() << " channels were "
+             << "outside of the window of every trigger" << endl;
     delete DetectorDriver::get();
 }
 
@@ -82,9 +152,12 @@ void UtkUnpacker::ProcessRawEvent(ScanInterface *addr_/*=NULL*/) {
             Globals::get()->clockInSeconds()*1e9);
     driver->plot(D_EVENT_MULTIPLICITY, rawEvent.size());
 
-    //loop over the list of channels that fired in this event
-    for (deque<XiaData *>::iterator it = rawEvent.begin();
-         it != rawEvent.end(); it++) {
+    //loop over the list of channels that fired in this event, followed by
+    // those of the channels with their own event window
+    deque<XiaData *> *lists[2] = {&rawEvent, &subEvent};
+    for (unsigned int list = 0; list < 2; list++)
+    for (deque<XiaData *>::iterator it = lists[list]->begin();
+         it != lists[list]->end(); it++) {
 
         if (!(*it))
             continue;
@@ -102,12 +175,13 @@ void UtkUnpacker::ProcessRawEvent(ScanInterface *addr_/*=NULL*/) {
         if ((*modChan)[(*it)->getID()].GetType() == "ignore")
             continue;
 
-        // Convert an XiaData to a ChanEvent
-        ChanEvent *event = new ChanEvent((*it));
-
-        //Add the ChanEvent pointer to the rawev and used detectors.
+        //Add a ChanEvent built from the XiaData to the rawev and used
+        // detectors. The trace is moved into the ChanEvent, not copied.
         usedDetectors.insert((*modChan)[(*it)->getID()].GetType());
-        rawev.AddChan(event);
+        if (list == 0)
+            rawev.AddChan(*it);
+        else
+            rawev.AddSubEventChan(*it);
 
         ///@TODO Add back in the processing for the dtime.
     }//for(deque<PixieData*>::iterator
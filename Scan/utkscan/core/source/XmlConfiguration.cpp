@@ -0,0 +1,328 @@
+/** \file XmlConfiguration.cpp
+ * \brief The configuration file parsed once and shared by the whole scan
+ * \date Oct. 19th, 2026
+ */
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+
+#include "Exceptions.hpp"
+#include "Globals.hpp"
+#include "Messenger.hpp"
+#include "Unpacker.hpp"
+#include "XmlConfiguration.hpp"
+
+using namespace std;
+
+namespace {
+    const uint32_t CACHE_MAGIC = 0x434D5850; //!< "PXMC"
+    const uint32_t CACHE_VERSION = 1; //!< Version of the cache layout
+    //! The smallest record of a channel: module, channel, location, the
+    //! lengths of the type and subtype and the sizes of the three lists
+    const size_t CACHE_MIN_CHANNEL = 3 * sizeof(int) + 5 * sizeof(uint32_t);
+    //! The largest number of channels a cache may hold
+    const uint32_t CACHE_MAX_CHANNELS = (MAX_PIXIE_MOD + 1) * (MAX_PIXIE_CHAN + 1);
+
+    ///The 64-bit FNV-1a hash of a block of memory
+    uint64_t Fnv1a(const char *data, const size_t &size) {
+        uint64_t hash = 0xCBF29CE484222325ULL;
+        for (size_t i = 0; i < size; i++) {
+            hash ^= (unsigned char) data[i];
+            hash *= 0x100000001B3ULL;
+        }
+        return hash;
+    }
+
+    template<typename T>
+    void Write(ofstream &out, const T &val) {
+        out.write((const char *) &val, sizeof(T));
+    }
+
+    void Write(ofstream &out, const string &val) {
+        Write(out, (uint32_t) val.size());
+        out.write(val.data(), val.size());
+    }
+
+    void Write(ofstream &out, const vector<CorrectionModel> &list) {
+        Write(out, (uint32_t) list.size());
+        for (vector<CorrectionModel>::const_iterator it = list.begin();
+             it != list.end(); it++) {
+            Write(out, it->model);
+            Write(out, it->min);
+            Write(out, it->max);
+            Write(out, (uint32_t) it->parameters.size());
+            for (vector<double>::const_iterator par = it->parameters.begin();
+                 par != it->parameters.end(); par++)
+                Write(out, *par);
+        }
+    }
+
+    ///Copy the XML with the children of the Map node removed, so that a
+    ///channel map read from the cache does not have to be parsed again.
+    ///Returns false if the Map node can not be found.
+    bool StripMap(const string &in, string &out) {
+        size_t start = in.find("<Map");
+        while (start != string::npos &&
+               in.find_first_of(" \t\r\n/>", start + 4) != start + 4)
+            start = in.find("<Map", start + 4);
+        if (start == string::npos)
+            return false;
+        size_t tagEnd = in.find('>', start);
+        if (tagEnd == string::npos)
+            return false;
+        if (in[tagEnd - 1] == '/') {
+            out = in;
+            return true;
+        }
+        size_t end = in.find("</Map>", tagEnd);
+        if (end == string::npos)
+            return false;
+        out = in.substr(0, tagEnd + 1) + in.substr(end);
+        return true;
+    }
+
+    template<typename T>
+    bool Read(ifstream &in, T &val) {
+        return (bool) in.read((char *) &val, sizeof(T));
+    }
+
+    bool Read(ifstream &in, string &val) {
+        uint32_t size;
+        if (!Read(in, size) || size > 0xFFFF)
+            return false;
+        val.resize(size);
+        return size == 0 || (bool) in.read(&val[0], size);
+    }
+
+    bool Read(ifstream &in, vector<CorrectionModel> &list) {
+        uint32_t size;
+        if (!Read(in, size) || size > 0xFFFF)
+            return false;
+        list.resize(size);
+        for (vector<CorrectionModel>::iterator it = list.begin();
+             it != list.end(); it++) {
+            uint32_t numPars;
+            if (!Read(in, it->model) || !Read(in, it->min) ||
+                !Read(in, it->max) || !Read(in, numPars) || numPars > 0xFFFF)
+                return false;
+            it->parameters.resize(numPars);
+            for (vector<double>::iterator par = it->parameters.begin();
+                 par != it->parameters.end(); par++)
+                if (!Read(in, *par))
+                    return false;
+        }
+        return true;
+    }
+}
+
+XmlConfiguration *XmlConfiguration::instance = NULL;
+
+XmlConfiguration *XmlConfiguration::get() {
+    //Globals creates the instance from its own constructor.
+    if (!instance)
+        Globals::get();
+    if (!instance)
+        instance = new XmlConfiguration(Globals::get()->configfile());
+    return instance;
+}
+
+XmlConfiguration *XmlConfiguration::get(const std::string &file) {
+    if (!instance)
+        instance = new XmlConfiguration(file);
+    return instance;
+}
+
+XmlConfiguration *XmlConfiguration::Parse(const std::string &file) {
+    return new XmlConfiguration(file);
+}
+
+XmlConfiguration::~XmlConfiguration() {
+    if (instance == this)
+        instance = NULL;
+}
+
+XmlConfiguration::XmlConfiguration(const std::string &file) {
+    fileName_ = file;
+    mapFromCache_ = false;
+
+    ifstream in(fileName_.c_str(), ios::binary);
+    if (!in.good())
+        throw IOException("XmlConfiguration : unable to open file "
+                          + fileName_);
+    string contents((istreambuf_iterator<char>(in)),
+                    istreambuf_iterator<char>());
+    in.close();
+    hash_ = Fnv1a(contents.data(), contents.size());
+
+    //The hash of the whole file is checked against the cache before
+    //anything is parsed, a matching cache leaves only the other sections
+    //to parse.
+    string stripped;
+    if (ReadCache() && StripMap(contents, stripped) &&
+        doc_.load_buffer(stripped.data(), stripped.size()) &&
+        GetSection("Map").attribute("cache").as_bool(false)) {
+        mapFromCache_ = true;
+        Messenger m;
+        m.detail("Channel map read from " + GetCacheName());
+        return;
+    }
+    channels_.clear();
+
+    pugi::xml_parse_result result =
+            doc_.load_buffer(contents.data(), contents.size());
+    if (!result) {
+        stringstream ss;
+        ss << "XmlConfiguration : error parsing file " << fileName_;
+        ss << " : " << result.description();
+        throw GeneralException(ss.str());
+    }
+    if (!doc_.child("Configuration")) {
+        throw GeneralException("XmlConfiguration : the file " + fileName_ +
+                               " has no Configuration node");
+    }
+
+    bool useCache = GetSection("Map").attribute("cache").as_bool(false);
+    ParseMap();
+    if (useCache)
+        WriteCache();
+}
+
+void XmlConfiguration::ParseMap() {
+    pugi::xml_node map = GetSection("Map");
+    for (pugi::xml_node module = map.child("Module"); module;
+         module = module.next_sibling("Module")) {
+        int module_number = module.attribute("number").as_int(-1);
+        if (module_number < 0) {
+            stringstream ss;
+            ss << "XmlConfiguration : Illegal module number "
+               << "found " << module_number << " in configuration file.";
+            throw GeneralException(ss.str());
+        }
+        for (pugi::xml_node channel = module.child("Channel"); channel;
+             channel = channel.next_sibling("Channel")) {
+            int ch_number = channel.attribute("number").as_int(-1);
+            if (ch_number < 0 || ch_number >= (int) pixie::numberOfChannels) {
+                stringstream ss;
+                ss << "XmlConfiguration : Illegal channel number "
+                   << "found " << ch_number << " in configuration file.";
+                throw GeneralException(ss.str());
+            }
+
+            ChannelModel ch;
+            ch.module = module_number;
+            ch.channel = ch_number;
+            ch.type = channel.attribute("type").as_string("None");
+            ch.subtype = channel.attribute("subtype").as_string("None");
+            ch.location = channel.attribute("location").as_int(-1);
+
+            string tags = channel.attribute("tags").as_string("None");
+            if (tags != "None")
+                ch.tags = strings::tokenize(tags, ",");
+
+            ParseCorrections(channel, "Calibration", ch.calibrations);
+            ParseCorrections(channel, "WalkCorrection", ch.walks);
+            channels_.push_back(ch);
+        }
+    }
+}
+
+void XmlConfiguration::ParseCorrections(const pugi::xml_node &channel,
+                                        const char *name,
+                                        std::vector<CorrectionModel> &list) {
+    for (pugi::xml_node cal = channel.child(name); cal;
+         cal = cal.next_sibling(name)) {
+        CorrectionModel corr;
+        corr.model = cal.attribute("model").as_string("None");
+        corr.min = cal.attribute("min").as_double(0);
+        corr.max = cal.attribute("max").as_double(
+                numeric_limits<double>::max());
+
+        stringstream pars(cal.text().as_string());
+        while (true) {
+            double p;
+            pars >> p;
+            if (pars)
+                corr.parameters.push_back(p);
+            else
+                break;
+        }
+        list.push_back(corr);
+    }
+}
+
+std::string XmlConfiguration::GetCacheName() const {
+    return fileName_ + ".mapcache";
+}
+
+bool XmlConfiguration::ReadCache() {
+    ifstream in(GetCacheName().c_str(), ios::binary);
+    if (!in.good())
+        return false;
+
+    uint32_t magic, version, size;
+    uint64_t hash;
+    if (!Read(in, magic) || !Read(in, version) || !Read(in, hash) ||
+        !Read(in, size))
+        return false;
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION || hash != hash_)
+        return false;
+
+    //Bound the number of channels before allocating them, a damaged cache
+    //must not be able to request an arbitrary amount of memory.
+    streampos pos = in.tellg();
+    in.seekg(0, ios::end);
+    size_t remaining = (size_t) (in.tellg() - pos);
+    in.seekg(pos);
+    if (size > CACHE_MAX_CHANNELS || size * CACHE_MIN_CHANNEL > remaining)
+        return false;
+
+    vector<ChannelModel> channels(size);
+    for (vector<ChannelModel>::iterator it = channels.begin();
+         it != channels.end(); it++) {
+        uint32_t numTags;
+        if (!Read(in, it->module) || !Read(in, it->channel) ||
+            !Read(in, it->type) || !Read(in, it->subtype) ||
+            !Read(in, it->location) || !Read(in, numTags) || numTags > 0xFFFF)
+            return false;
+        it->tags.resize(numTags);
+        for (vector<string>::iterator tag = it->tags.begin();
+             tag != it->tags.end(); tag++)
+            if (!Read(in, *tag))
+                return false;
+        if (!Read(in, it->calibrations) || !Read(in, it->walks))
+            return false;
+    }
+
+    channels_.swap(channels);
+    return true;
+}
+
+void XmlConfiguration::WriteCache() const {
+    ofstream out(GetCacheName().c_str(), ios::binary | ios::trunc);
+    if (out.good()) {
+        Write(out, CACHE_MAGIC);
+        Write(out, CACHE_VERSION);
+        Write(out, hash_);
+        Write(out, (uint32_t) channels_.size());
+        for (vector<ChannelModel>::const_iterator it = channels_.begin();
+             it != channels_.end(); it++) {
+            Write(out, it->module);
+            Write(out, it->channel);
+            Write(out, it->type);
+            Write(out, it->subtype);
+            Write(out, it->location);
+            Write(out, (uint32_t) it->tags.size());
+            for (vector<string>::const_iterator tag = it->tags.begin();
+                 tag != it->tags.end(); tag++)
+                Write(out, *tag);
+            Write(out, it->calibrations);
+            Write(out, it->walks);
+        }
+    }
+    if (!out.good()) {
+        Messenger m;
+        m.warning("Unable to write the channel map cache "
+                  + GetCacheName());
+    }
+}
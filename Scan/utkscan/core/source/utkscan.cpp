@@ -1,6 +1,9 @@
 #include <iostream>
 
 // Local files
+#ifndef USE_HRIBF
+#include "RunListScanner.hpp"
+#endif
 #include "UtkScanInterface.hpp"
 #include "UtkUnpacker.hpp"
 
@@ -13,6 +16,13 @@ using std::cout;
 using std::endl;
 
 int main(int argc, char *argv[]){
+#ifndef USE_HRIBF
+    // Scan the files of a run list with several worker processes.
+    RunListScanner runList(argc, argv);
+    if(runList.IsRequested())
+        return(runList.Execute());
+#endif
+
     // Define a new unpacker object.
     cout << "utkscan.cpp : Instancing the UtkScanInterface" << endl;
     UtkScanInterface scanner;
@@ -8,6 +8,7 @@
 #define __ANL1471PROCESSOR_HPP_
 
 #include "EventProcessor.hpp"
+#include "RecordSink.hpp"
 #include "VandleProcessor.hpp"
 
 /// Class to process VANDLE related events
@@ -36,5 +37,6 @@ public:
 private:
     std::string fileName_; //!< name of the his file
     std::vector<std::string> fileNames_; //!< vector of output file names
+    RecordSink records_[2]; //!< the corrected tof and qdc of the small and medium bars
 };
 #endif
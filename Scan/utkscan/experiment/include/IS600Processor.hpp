@@ -10,6 +10,7 @@
 #include <fstream>
 
 #include "EventProcessor.hpp"
+#include "RecordSink.hpp"
 
 #ifdef useroot
 #include <TFile.h>
@@ -43,6 +44,6 @@ private:
     TH2D *qdctof_; //!< a 2D histogram in ROOT
     TH1D *vsize_; //!< a 1D histogram in root
 #endif
-    std::ofstream *outstream; //!< filestream to output to text file
+    RecordSink records_; //!< the tof and qdc of the bars, see RecordSink
 };
 #endif
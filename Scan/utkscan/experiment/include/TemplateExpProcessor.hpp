@@ -8,6 +8,7 @@
 #include <fstream>
 
 #include "EventProcessor.hpp"
+#include "RecordSink.hpp"
 
 #ifdef useroot
 #include <TFile.h>
@@ -41,11 +42,11 @@ private:
     void ObtainHisName(void);
     /** Sets the detectors that are associated with this processor */
     void SetAssociatedTypes(void);
-    /** Sets up the ASCII output file stream */
+    /** Sets up the binary record output, see RecordSink */
     void SetupAsciiOutput(void);
 
     std::string fileName_; //!< String to hold the file name from command line
-    std::ofstream *poutstream_; //!< Pointer to ouptut ASCII file stream.
+    RecordSink records_; //!< The records of template and ge energies
     double gCutoff_; //!< Variable used to set gamma cutoff energy
 
 #ifdef useroot
@@ -8,6 +8,7 @@
 #define __VANDLEATLERIBSSPROCESSOR_HPP_
 
 #include "EventProcessor.hpp"
+#include "RecordSink.hpp"
 #include "VandleProcessor.hpp"
 
 /// Class to process VANDLE related events
@@ -36,5 +37,6 @@ public:
 private:
     std::string fileName_; //!< the name of the his file
     std::vector<std::string> fileNames_; //!< the vector of output file names
+    RecordSink records_[3]; //!< the corrected tofs written to each output file
 };
 #endif
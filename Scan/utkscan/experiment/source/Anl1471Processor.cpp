@@ -77,9 +77,14 @@ Anl1471Processor::Anl1471Processor(const std::vector<std::string> &typeList,
     stringstream name;
     name << temp;
     fileName_ = name.str();
-    fileNames_.push_back(fileName_ + "-tof-sm.dat");
-    fileNames_.push_back(fileName_ + "-tof-md.dat");
-    fileNames_.push_back(fileName_ + "-tof-04Plus.dat");
+    fileNames_.push_back(fileName_ + "-tof-sm.col");
+    fileNames_.push_back(fileName_ + "-tof-md.col");
+    fileNames_.push_back(fileName_ + "-tof-04Plus.col");
+    for(unsigned int i = 0; i < 2; i++) {
+        records_[i].AddField("ctof");
+        records_[i].AddField("qdc");
+        records_[i].Open(fileNames_[i]);
+    }
 }
 
 bool Anl1471Processor::Process(RawEvent &event) {
@@ -121,15 +126,10 @@ bool Anl1471Processor::Process(RawEvent &event) {
                                            bar.GetQdc());
 	    //All of them are gated using a banana gate
             if(inPeel) {
-		ofstream data;
-		if(bar.GetType() == "small") {
-                    data.open(fileNames_[0].c_str(), ios::app);
-                    data << corTof << " " << bar.GetQdc() << endl;
-                } else {
-		    data.open(fileNames_[1].c_str(), ios::app);
-                    data << corTof << " " << bar.GetQdc() << endl;
-		}
-		data.close();
+		if(bar.GetType() == "small")
+                    records_[0].Write(corTof, bar.GetQdc());
+                else
+                    records_[1].Write(corTof, bar.GetQdc());
             }
 
             double cycleTime = TreeCorrelator::get()->place("Cycle")->last().time;
@@ -76,8 +76,10 @@ IS600Processor::IS600Processor() : EventProcessor(OFFSET, RANGE, "IS600PRocessor
     string temp = hisFileName;
     temp = temp.substr(0, temp.find_first_of(" "));
     stringstream name;
-    name << temp << ".dat";
-    outstream = new ofstream(name.str().c_str());
+    name << temp << ".col";
+    records_.AddField("tof");
+    records_.AddField("qdc");
+    records_.Open(name.str());
 #ifdef useroot
     stringstream rootname;
     rootname << temp << ".root";
@@ -91,8 +93,7 @@ IS600Processor::IS600Processor() : EventProcessor(OFFSET, RANGE, "IS600PRocessor
 }
 
 IS600Processor::~IS600Processor() {
-    outstream->close();
-    delete(outstream);
+    records_.Close();
 #ifdef useroot
     rootfile_->Write();
     rootfile_->Close();
@@ -184,7 +185,7 @@ bool IS600Processor::Process(RawEvent &event) {
             bar.GetQdc());
 	    bool isLowStart = start.GetQdc() < 300;
 
-	    *outstream << tof << " " << bar.GetQdc() << endl;
+	    records_.Write(tof, bar.GetQdc());
 #ifdef useroot
         qdctof_->Fill(tof,bar.GetQdc());
         qdc_ = bar.GetQdc();
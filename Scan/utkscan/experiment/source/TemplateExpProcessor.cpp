@@ -62,8 +62,7 @@ TemplateExpProcessor::TemplateExpProcessor(const double &gcut) :
 
 ///Destructor to close output files and clean up pointers
 TemplateExpProcessor::~TemplateExpProcessor() {
-    poutstream_->close();
-    delete(poutstream_);
+    records_.Close();
 #ifdef useroot
     prootfile_->Write();
     prootfile_->Close();
@@ -77,11 +76,14 @@ void TemplateExpProcessor::SetAssociatedTypes(void) {
     associatedTypes.insert("ge");
 }
 
-///Sets up the name of the output ascii data file
+///Sets up the output data file, "colDump --text" converts it to the old
+/// ascii columns
 void TemplateExpProcessor::SetupAsciiOutput(void) {
     stringstream name;
-    name << fileName_ << ".dat";
-    poutstream_ = new ofstream(name.str().c_str());
+    name << fileName_ << ".col";
+    records_.AddField("ten");
+    records_.AddField("gen");
+    records_.Open(name.str());
 }
 
 #ifdef useroot
@@ -162,8 +164,8 @@ bool TemplateExpProcessor::Process(RawEvent &event) {
             ///Plot the Template Energy vs. Ge Energy
             plot(DD_TENVSGEN, gEnergy, (*tit)->GetEnergy());
 
-            ///Output template and ge energy to text file
-            *poutstream_ << (*tit)->GetEnergy() << " " << gEnergy << endl;
+            ///Output template and ge energy to the data file
+            records_.Write((*tit)->GetEnergy(), gEnergy);
             ///Fill ROOT histograms and tree with the information
             #ifdef useroot
                 ptvsge_->Fill((*tit)->GetEnergy(), gEnergy);
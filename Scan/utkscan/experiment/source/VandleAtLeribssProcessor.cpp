@@ -77,9 +77,13 @@ VandleAtLeribssProcessor::VandleAtLeribssProcessor(const std::vector<std::string
     stringstream name;
     name << temp;
     fileName_ = name.str();
-    fileNames_.push_back(fileName_ + "-tof.dat");
-    fileNames_.push_back(fileName_ + "-tof-02Plus.dat");
-    fileNames_.push_back(fileName_ + "-tof-04Plus.dat");
+    fileNames_.push_back(fileName_ + "-tof.col");
+    fileNames_.push_back(fileName_ + "-tof-02Plus.col");
+    fileNames_.push_back(fileName_ + "-tof-04Plus.col");
+    for(unsigned int i = 0; i < fileNames_.size(); i++) {
+        records_[i].AddField("ctof");
+        records_[i].Open(fileNames_[i]);
+    }
 }
 
 bool VandleAtLeribssProcessor::Process(RawEvent &event) {
@@ -151,10 +155,7 @@ bool VandleAtLeribssProcessor::Process(RawEvent &event) {
                     plot(DD_DEBUGGING1, corTof*plotMult_+plotOffset_,bar.GetQdc());
 
                 if(isLower) {
-                    ofstream data;
-                    data.open(fileNames_[0].c_str(), ios::app);
-                    data << corTof << endl;
-                    data.close();
+                    records_[0].Write(corTof);
 
                     plot(DD_DEBUGGING2, corTof*plotMult_+plotOffset_, bar.GetQdc());
                 }
@@ -181,7 +182,6 @@ bool VandleAtLeribssProcessor::Process(RawEvent &event) {
             if(inPeel && isCleared)
                 plot(DD_DEBUGGING12, corTof*plotMult_+plotOffset_, decayTime*1.e-9);
 
-            ofstream gammaGated;
             if(geSummary_->GetMult() > 0 && isCleared && inPeel) {
                 const vector<ChanEvent *> &geList = geSummary_->GetList();
                 for(vector<ChanEvent *>::const_iterator itGe = geList.begin();
@@ -189,21 +189,16 @@ bool VandleAtLeribssProcessor::Process(RawEvent &event) {
                     double calEnergy = (*itGe)->GetCalEnergy();
                     plot(DD_DEBUGGING11, calEnergy, decayTime * 1e-9);
                     if(calEnergy >= 595 && calEnergy <= 603) {
-                        if(isLower) {
-                            gammaGated.open(fileNames_[1].c_str(), ios::app);
-                            gammaGated << corTof << endl;
-                        }
+                        if(isLower)
+                            records_[1].Write(corTof);
                         plot(DD_DEBUGGING4, corTof * plotMult_ + plotOffset_, bar.GetQdc());
                     }
                     if(calEnergy >= 692 && calEnergy <= 704) {
-                        if(isLower) {
-                            gammaGated.open(fileNames_[2].c_str(), ios::app);
-                            gammaGated << corTof << endl;
-                        }
+                        if(isLower)
+                            records_[2].Write(corTof);
                         plot(DD_DEBUGGING5, corTof * plotMult_ + plotOffset_, bar.GetQdc());
                     } // if(calEnergy >= 692
                 }// for(vector<ChanEvent *>::const_iterator
-                gammaGated.close();
             }//geSummary_->GetMult() > 0
         }//loop over starts
     }//loop over bars
@@ -0,0 +1,49 @@
+/** \file ColumnProcessor.hpp
+ * \brief Processor to write data from events into a columnar binary file
+ *
+ * This loops over the other event processors to fill their columns. Unlike
+ * the RootProcessor it does not need ROOT, the files are read back with the
+ * ColumnReader class of the PixieCore library.
+ * \date Oct. 19th, 2026
+ */
+#ifndef __COLUMNPROCESSOR_HPP_
+#define __COLUMNPROCESSOR_HPP_
+
+#include <string>
+#include <vector>
+
+#include "ColumnFile.h"
+#include "EventProcessor.hpp"
+
+//! A Class to handle writing event data into a column file
+class ColumnProcessor : public EventProcessor {
+public:
+    /** Constructor taking arguments for the file creation
+    * \param [in] fileName : the name of the column file
+    * \param [in] chunkRows : the number of events in each chunk of the file
+    * \param [in] level : the zlib compression level, 0 disables compression */
+    ColumnProcessor(const std::string &fileName, unsigned int chunkRows,
+                    int level);
+
+    /** Initializes the processor
+    * \param [in] rawev : the raw event to analyze
+    * \return true if the initialization was successful */
+    virtual bool Init(RawEvent& rawev);
+
+    /** Fills the columns of all the processors with column information
+    * \param [in] event : the event to process
+    * \return true if processing was successful */
+    virtual bool Process(RawEvent &event);
+
+    /** Default Destructor */
+    virtual ~ColumnProcessor();
+private:
+    std::string fileName_; //!< Name of the output file
+    unsigned int chunkRows_; //!< Number of events in each chunk
+    int level_; //!< The zlib compression level
+    ColumnWriter writer_; //!< The writer for the column file
+
+    /// All processors with AddColumns() information
+    std::vector<EventProcessor *> vecProcess_;
+};
+#endif // __COLUMNPROCESSOR_HPP_
@@ -14,8 +14,10 @@
 #include "TreeCorrelator.hpp"
 
 // forward declarations
+class ColumnWriter;
 class DetectorSummary;
 class RawEvent;
+class XmlConfiguration;
 
 #ifdef useroot
 class TTree;
@@ -84,6 +86,26 @@ public:
     std::string GetName(void) const {
         return(name);
     }
+    /** Re-read the parameters of the processor that may be changed while a
+    * scan is running (gates, for example). This is called between two events
+    * by the thread that processes the data. Histograms must not be declared
+    * again and the old parameters should be kept if the new ones are bad.
+    * \param [in] xml : The freshly parsed configuration file
+    * \return True if any parameters were reloaded */
+    virtual bool Reload(const XmlConfiguration &xml) {return(false);};
+
+    /** This function registers the columns that hold the data generated by
+    * this event processor in the columnar event output. The addresses given
+    * to the writer must stay valid for the lifetime of the processor.
+    * \param [in] writer : The writer to add the columns to
+    * \return True if any columns were added */
+    virtual bool AddColumns(ColumnWriter &writer) {return(false);};
+
+    /** This function is called before the columns are written for each
+    * event. As with FillBranch the data needs to be zeroed for events where
+    * no detectors of interest to this processor triggered. */
+    virtual void FillColumns(void) {};
+
 #ifdef useroot
     /** This functions adds the branch to the tree that will be responsible
     * for holding the data generated by this event processor
@@ -5,11 +5,13 @@
 #define __GEPROCESSOR_HPP_
 
 #include <map>
+#include <string>
 #include <vector>
 #include <utility>
 #include <cmath>
 
 #include "EventProcessor.hpp"
+#include "GammaCoincidences.hpp"
 #include "RawEvent.hpp"
 
 namespace dammIds {
@@ -191,6 +193,22 @@ public:
                 double gammaBetaLimit, double gammaGammaLimit,
                 double cycle_gate1_min, double cycle_gate1_max,
                 double cycle_gate2_min, double cycle_gate2_max);
+    /** Default destructor, writes the compact gamma-gamma matrices */
+    virtual ~GeProcessor();
+    /** Choose how gamma-gamma(-gamma) coincidences are stored. Must be
+     * called before DeclarePlots.
+     * \param [in] compactMatrices : store the symmetric gamma-gamma
+     *   spectra as triangular GammaMatrix instead of full DAMM histograms,
+     *   they are written to matrixPrefix<id>.ggm at the end of the scan
+     *   instead of the .his and are projected and gated with ggGate
+     * \param [in] matrixPrefix : path and prefix of the matrix files
+     * \param [in] cubeFile : file backing a gamma-gamma-gamma cube of
+     *   the different-clover triples, no cube is filled if empty
+     * \param [in] cubeBins : the number of bins on each axis of the cube */
+    void SetCoincidenceStorage(bool compactMatrices,
+                               const std::string &matrixPrefix,
+                               const std::string &cubeFile,
+                               unsigned int cubeBins);
     /** Preprocess the event
      * \param [in] event : the event to preprocess
      * \return true if successful */
@@ -202,6 +220,20 @@ public:
     /** Declare the plots for the processor */
     virtual void DeclarePlots(void);
 
+#ifdef GGATES
+    /** Reload the gamma-gamma gates
+     * \param [in] xml : the freshly parsed configuration file
+     * \return true if the gates were reloaded */
+    virtual bool Reload(const XmlConfiguration &xml);
+#endif
+
+    /** \return the compact gamma-gamma matrix with a given DAMM id, NULL
+     * if the matrices are kept as DAMM histograms
+     * \param [in] dammId : the id of the histogram the matrix replaces */
+    const GammaMatrix *GetMatrix(int dammId) const;
+    /** \return the gamma-gamma-gamma cube, NULL if none is filled */
+    const GammaCube *GetCube(void) const {return cube_;}
+
     /** Returns the events that were added to the geEvents_ vector */
     std::vector<ChanEvent*> GetGeEvents(void) {return(geEvents_);}
     /** Returns the events that were added to the addbackEvents_ */
@@ -253,6 +285,19 @@ protected:
      * \param [in] bin1 : the first bin to plot into
      * \param [in] bin2 : the second bin to plot into */
     void symplot(int dammID, double bin1, double bin2);
+    /** Declare a symmetric gamma-gamma spectrum, either as a DAMM histogram
+     * or as a compact GammaMatrix
+     * \param [in] dammId : the ID for the plot
+     * \param [in] bins : the number of bins on each axis
+     * \param [in] title : the title of the histogram */
+    void DeclareSymmetric(int dammId, int bins, const char *title);
+
+    bool compactMatrices_; //!< true if symplot fills the GammaMatrix list
+    std::string matrixPrefix_; //!< path and prefix of the matrix files
+    std::map<int, GammaMatrix*> matrices_; //!< compact matrices by DAMM id
+    std::string cubeFile_; //!< file backing the cube, empty for none
+    unsigned int cubeBins_; //!< number of bins on each axis of the cube
+    GammaCube *cube_; //!< gamma-gamma-gamma cube, NULL if not used
 
     /** addbackEvents vector of vectors, where first vector
      * enumerates cloves, second events */
@@ -263,6 +308,17 @@ protected:
     std::vector<AddBackEvent> tas_;
 #ifdef GGATES
     std::vector< std::vector<LineGate> > gGates; //!< List of Gamma gates to use
+    GammaGateIndex gateIndex_; //!< Index of gGates for the coincidence lookup
+    std::vector<unsigned int> gateHits_; //!< Gates matched by a coincidence
+
+    /** Build gateIndex_ from gGates */
+    void BuildGateIndex(void);
+
+    /** Read the gamma-gamma gates from the configuration
+     * \param [in] xml : the configuration to read from
+     * \param [out] gates : the list of gates to fill */
+    void LoadGates(const XmlConfiguration &xml,
+                   std::vector< std::vector<LineGate> > &gates);
 #endif
 
     /** Gamma low threshold in keV */
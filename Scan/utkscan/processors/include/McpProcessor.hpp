@@ -18,6 +18,13 @@ public:
      * \return true if the process was successful */
     virtual bool Process(RawEvent &rEvent);
 
+    /** Add the columns to the columnar output
+    * \param [in] writer : the writer to add the columns to
+    * \return true if you could do it */
+    virtual bool AddColumns(ColumnWriter &writer);
+    /** Fill the columns */
+    virtual void FillColumns(void);
+
 #ifdef useroot
     /** Add the branch to the tree
     * \param [in] tree : the tree to add the branch to
@@ -0,0 +1,73 @@
+/** \file ColumnProcessor.cpp
+ * \brief Implementation of class to write event info to a column file
+ * \date Oct. 19th, 2026
+ */
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+#include "ColumnProcessor.hpp"
+#include "DetectorDriver.hpp"
+#include "OutputFiles.hpp"
+
+using namespace std;
+
+ColumnProcessor::ColumnProcessor(const std::string &fileName,
+                                 unsigned int chunkRows, int level) :
+    EventProcessor(),
+    fileName_(OutputFiles::get()->Register(fileName, OUTPUT_COLUMNS)),
+    chunkRows_(chunkRows), level_(level) {
+    name = "ColumnProcessor";
+}
+
+bool ColumnProcessor::Init(RawEvent& rawev) {
+    const vector<EventProcessor *>& drvProcess =
+        DetectorDriver::get()->GetProcessors();
+
+    for (vector<EventProcessor *>::const_iterator it = drvProcess.begin();
+         it != drvProcess.end(); it++) {
+        if (*it == this || !(*it)->AddColumns(writer_))
+            continue;
+        vecProcess_.push_back(*it);
+        set_union((*it)->GetTypes().begin(), (*it)->GetTypes().end(),
+                  associatedTypes.begin(), associatedTypes.end(),
+                  inserter(associatedTypes, associatedTypes.begin()));
+    }
+
+    if (vecProcess_.empty()) {
+        cout << "ColumnProcessor: No processors provide columns, "
+             << fileName_ << " will not be written." << endl;
+        return false;
+    }
+
+    if (!writer_.Open(fileName_, chunkRows_, level_)) {
+        cout << "ColumnProcessor: Failed to open " << fileName_ << endl;
+        return false;
+    }
+
+    return EventProcessor::Init(rawev);
+}
+
+bool ColumnProcessor::Process(RawEvent &event) {
+    if (!EventProcessor::Process(event))
+        return false;
+
+    for (vector<EventProcessor *>::iterator it = vecProcess_.begin();
+         it != vecProcess_.end(); it++)
+        (*it)->FillColumns();
+
+    writer_.Fill();
+
+    EndProcess();
+    return true;
+}
+
+ColumnProcessor::~ColumnProcessor() {
+    if (writer_.IsOpen()) {
+        writer_.Close();
+        cout << "  saved " << writer_.GetEntries() << " events in "
+             << writer_.GetNumColumns() << " columns ("
+             << writer_.GetBytesWritten() << " bytes) to " << fileName_
+             << endl;
+    }
+}
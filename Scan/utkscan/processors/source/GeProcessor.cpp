@@ -22,9 +22,11 @@
 #include "GeProcessor.hpp"
 #include "Messenger.hpp"
 #include "Notebook.hpp"
+#include "OutputFiles.hpp"
 #include "Plots.hpp"
 #include "PlotsRegister.hpp"
 #include "RawEvent.hpp"
+#include "XmlConfiguration.hpp"
 
 using namespace std;
 using namespace dammIds::ge;
@@ -56,17 +58,51 @@ bool GeProcessor::GoodGammaBeta(double gb_dtime) {
 }
 
 void GeProcessor::symplot(int dammID, double bin1, double bin2) {
+    if (compactMatrices_) {
+        map<int, GammaMatrix*>::iterator it = matrices_.find(dammID);
+        if (it != matrices_.end())
+            it->second->Fill(bin1, bin2);
+        return;
+    }
     plot(dammID, bin1, bin2);
     plot(dammID, bin2, bin1);
 }
 
+void GeProcessor::DeclareSymmetric(int dammId, int bins, const char *title) {
+    if (!compactMatrices_) {
+        DeclareHistogram2D(dammId, bins, bins, title);
+        return;
+    }
+    if (matrices_.find(dammId) == matrices_.end())
+        matrices_[dammId] = new GammaMatrix(bins);
+}
+
+const GammaMatrix *GeProcessor::GetMatrix(int dammId) const {
+    map<int, GammaMatrix*>::const_iterator it = matrices_.find(dammId);
+    if (it == matrices_.end())
+        return NULL;
+    return it->second;
+}
+
+void GeProcessor::SetCoincidenceStorage(bool compactMatrices,
+                                        const std::string &matrixPrefix,
+                                        const std::string &cubeFile,
+                                        unsigned int cubeBins) {
+    compactMatrices_ = compactMatrices;
+    matrixPrefix_ = matrixPrefix;
+    cubeFile_ = cubeFile.empty() ? cubeFile :
+                OutputFiles::get()->Register(cubeFile, OUTPUT_GAMMA_CUBE);
+    cubeBins_ = cubeBins;
+}
+
 GeProcessor::GeProcessor(double gammaThreshold, double lowRatio,
                          double highRatio, double subEventWindow,
                          double gammaBetaLimit, double gammaGammaLimit,
                          double cycle_gate1_min, double cycle_gate1_max,
                          double cycle_gate2_min, double cycle_gate2_max) :
                          EventProcessor(OFFSET, RANGE, "GeProcessor"),
-                         leafToClover() {
+                         leafToClover(), compactMatrices_(false),
+                         cubeBins_(0), cube_(NULL) {
     associatedTypes.insert("ge"); // associate with germanium detectors
 
     gammaThreshold_ = gammaThreshold;
@@ -94,20 +130,39 @@ GeProcessor::GeProcessor(double gammaThreshold, double lowRatio,
     }
 
 #ifdef GGATES
-    Messenger m;
-    m.detail("Loading Gamma-gamma gates", 1);
+    LoadGates(*XmlConfiguration::get(), gGates);
+    BuildGateIndex();
+#endif
+}
 
-    string cfg = Globals::get()->configfile();
-    pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_file(cfg.c_str());
-    if (!result) {
+GeProcessor::~GeProcessor() {
+    Messenger m;
+    for (map<int, GammaMatrix*>::iterator it = matrices_.begin();
+         it != matrices_.end(); ++it) {
         stringstream ss;
-        ss << "DetectorDriver: error parsing file " << cfg;
-        ss << " : " << result.description();
-        throw IOException(ss.str());
+        ss << matrixPrefix_ << it->first << ".ggm";
+        string fileName =
+                OutputFiles::get()->Register(ss.str(), OUTPUT_GAMMA_MATRIX);
+        try {
+            it->second->Write(fileName);
+            m.detail("Wrote gamma-gamma matrix " + fileName);
+        } catch (GeneralException &e) {
+            m.warning(e.what());
+        }
+        delete it->second;
     }
+    if (cube_ != NULL && !cube_->Close())
+        m.warning("Failed writing the gamma-gamma-gamma cube " + cubeFile_);
+    delete cube_;
+}
 
-    pugi::xml_node gamma_gates = doc.child("Configuration").child("GammaGates");
+#ifdef GGATES
+void GeProcessor::LoadGates(const XmlConfiguration &xml,
+                            std::vector< std::vector<LineGate> > &gates) {
+    Messenger m;
+    m.detail("Loading Gamma-gamma gates", 1);
+
+    pugi::xml_node gamma_gates = xml.GetSection("GammaGates");
     for (pugi::xml_node gate = gamma_gates.child("Gate"); gate;
          gate = gate.next_sibling("Gate")) {
         vector<LineGate> vg;
@@ -135,7 +190,7 @@ not implemented");
                     it != vg.end(); ++it)
                 ss << "(" << it->min << "-" << it->max << "), ";
             if (completeGate) {
-                gGates.push_back(vg);
+                gates.push_back(vg);
                 ss << "loaded";
             } else {
                 ss << "has bad definition and is skipped!";
@@ -143,9 +198,27 @@ not implemented");
             m.detail(ss.str(), 2);
         }
     }
-#endif
 }
 
+bool GeProcessor::Reload(const XmlConfiguration &xml) {
+    vector< vector<LineGate> > gates;
+    LoadGates(xml, gates);
+    gGates.swap(gates);
+    BuildGateIndex();
+    return(true);
+}
+
+void GeProcessor::BuildGateIndex(void) {
+    vector<GammaGateIndex::Gate> gates;
+    for (vector< vector<LineGate> >::const_iterator it = gGates.begin();
+         it != gGates.end(); ++it) {
+        gates.push_back(make_pair(make_pair((*it)[0].min, (*it)[0].max),
+                                  make_pair((*it)[1].min, (*it)[1].max)));
+    }
+    gateIndex_.Build(gates);
+}
+#endif
+
 /** Declare plots including many for decay/implant/neutron gated analysis  */
 void GeProcessor::DeclarePlots(void) {
     const int energyBins1  = SD;
@@ -221,6 +294,9 @@ void GeProcessor::DeclarePlots(void) {
         addbackEvents_.push_back(empty);
     }
 
+    if (!cubeFile_.empty() && cube_ == NULL)
+        cube_ = new GammaCube(cubeFile_, cubeBins_);
+
     DeclareHistogram1D(D_ENERGY, energyBins1, "Gamma singles");
     DeclareHistogram1D(D_ENERGY_MOVE, energyBins1,
                        "Gamma singles tape move period");
@@ -281,49 +357,38 @@ void GeProcessor::DeclarePlots(void) {
                     energyBins1, ss.str().c_str());
     }
 
-    DeclareHistogram2D(DD_ENERGY, energyBins2, energyBins2, "Gamma gamma");
-    DeclareHistogram2D(DD_ENERGY_PROMPT, energyBins2, energyBins2,
-                       "Gamma gamma prompt");
-    DeclareHistogram2D(DD_ENERGY_CGATE1,
-                       energyBins2, energyBins2,
-                       "Gamma gamma cycle gate 1");
-    DeclareHistogram2D(DD_ENERGY_CGATE2,
-                       energyBins2, energyBins2,
-                       "Gamma gamma cycle gate 2");
-
-    DeclareHistogram2D(betaGated::DD_ENERGY,
-                       energyBins2, energyBins2,
-                       "Gamma gamma beta prompt gated");
-    DeclareHistogram2D(betaGated::DD_ENERGY_PROMPT,
-                       energyBins2, energyBins2,
-                       "Gamma gamma prompt beta prompt gated");
-    DeclareHistogram2D(betaGated::DD_ENERGY_BDELAYED,
-                       energyBins2, energyBins2,
-                       "Beta-gated gamma gamma - beta delayed");
-
-    DeclareHistogram2D(betaGated::DD_ENERGY_CGATE1,
-                       energyBins2, energyBins2,
-                       "Beta gated gamma gamma cycle gate 1");
-    DeclareHistogram2D(betaGated::DD_ENERGY_CGATE2,
-                       energyBins2, energyBins2,
-                       "Beta gated gamma gamma cycle gate 2");
-
-    DeclareHistogram2D(DD_ADD_ENERGY,
-                       energyBins2, energyBins2, "Gamma gamma addback");
-    DeclareHistogram2D(multi::DD_ADD_ENERGY,
-                       energyBins2, energyBins2,
-                       "Gamma gamma addback multi-gated");
-    DeclareHistogram2D(betaGated::DD_ADD_ENERGY,
-            energyBins2, energyBins2, "Beta-gated gamma-gamma addback");
-    DeclareHistogram2D(multi::betaGated::DD_ADD_ENERGY,
-                       energyBins2, energyBins2,
-                       "Beta-gated gamma-gamma addback multi-gated");
-    DeclareHistogram2D(betaGated::DD_ADD_ENERGY_PROMPT,
-                       energyBins2, energyBins2,
-                       "Beta-gated Gamma gamma addback beta-prompt");
-    DeclareHistogram2D(multi::betaGated::DD_ADD_ENERGY_PROMPT,
-                       energyBins2, energyBins2,
-                    "Beta-gated gamma-gamma addback multi-gated beta-prompt");
+    DeclareSymmetric(DD_ENERGY, energyBins2, "Gamma gamma");
+    DeclareSymmetric(DD_ENERGY_PROMPT, energyBins2,
+                     "Gamma gamma prompt");
+    DeclareSymmetric(DD_ENERGY_CGATE1, energyBins2,
+                     "Gamma gamma cycle gate 1");
+    DeclareSymmetric(DD_ENERGY_CGATE2, energyBins2,
+                     "Gamma gamma cycle gate 2");
+
+    DeclareSymmetric(betaGated::DD_ENERGY, energyBins2,
+                     "Gamma gamma beta prompt gated");
+    DeclareSymmetric(betaGated::DD_ENERGY_PROMPT, energyBins2,
+                     "Gamma gamma prompt beta prompt gated");
+    DeclareSymmetric(betaGated::DD_ENERGY_BDELAYED, energyBins2,
+                     "Beta-gated gamma gamma - beta delayed");
+
+    DeclareSymmetric(betaGated::DD_ENERGY_CGATE1, energyBins2,
+                     "Beta gated gamma gamma cycle gate 1");
+    DeclareSymmetric(betaGated::DD_ENERGY_CGATE2, energyBins2,
+                     "Beta gated gamma gamma cycle gate 2");
+
+    DeclareSymmetric(DD_ADD_ENERGY, energyBins2,
+                     "Gamma gamma addback");
+    DeclareSymmetric(multi::DD_ADD_ENERGY, energyBins2,
+                     "Gamma gamma addback multi-gated");
+    DeclareSymmetric(betaGated::DD_ADD_ENERGY, energyBins2,
+                     "Beta-gated gamma-gamma addback");
+    DeclareSymmetric(multi::betaGated::DD_ADD_ENERGY, energyBins2,
+                     "Beta-gated gamma-gamma addback multi-gated");
+    DeclareSymmetric(betaGated::DD_ADD_ENERGY_PROMPT, energyBins2,
+                     "Beta-gated Gamma gamma addback beta-prompt");
+    DeclareSymmetric(multi::betaGated::DD_ADD_ENERGY_PROMPT, energyBins2,
+                     "Beta-gated gamma-gamma addback multi-gated beta-prompt");
 
     DeclareHistogram2D(
             DD_TDIFF__GAMMA_GAMMA_ENERGY,
@@ -636,62 +701,69 @@ bool GeProcessor::Process(RawEvent &event) {
                                 gEnergy, gEnergy2);
                     }
                 }
+
+                // Triples in three different clovers for the cube
+                if (cube_ != NULL) {
+                    for (vector<ChanEvent*>::const_iterator it3 = it2 + 1;
+                            it3 != geEvents_.end(); it3++) {
+                        double gEnergy3 = (*it3)->GetCalEnergy();
+                        int det3 =
+                            leafToClover[(*it3)->GetChanID().GetLocation()];
+                        if (gEnergy3 < gammaThreshold_ ||
+                            det3 == det || det3 == det2)
+                            continue;
+                        cube_->Fill(gEnergy, gEnergy2, gEnergy3);
+                    }
+                }
             }
 #ifdef GGATES
             /**
             * Gamma-gamma gate
             */
-            unsigned ig = 0;
             double e1 = min(gEnergy, gEnergy2);
             double e2 = max(gEnergy, gEnergy2);
-            for (vector< vector<LineGate> >::iterator it_gate =
-                    gGates.begin();
-                    it_gate != gGates.end(); ++it_gate) {
-                if ((*it_gate).size() != 2)
-                    throw NotImplemented("Gamma gates of size different than 2 are not implemented");
-                if ((*it_gate)[0].IsWithin(e1) &&
-                    (*it_gate)[1].IsWithin(e2)) {
-
-                    double plotResolution = clockInSeconds;
-                    plot(DD_TDIFF__GATEX,
-                         (int)(gg_dtime / plotResolution + 100), ig);
+            gateIndex_.Find(e1, e2, gateHits_);
+            for (vector<unsigned int>::iterator it_gate = gateHits_.begin();
+                    it_gate != gateHits_.end(); ++it_gate) {
+                unsigned ig = *it_gate;
+                double plotResolution = clockInSeconds;
+                plot(DD_TDIFF__GATEX,
+                     (int)(gg_dtime / plotResolution + 100), ig);
+                if (hasBeta && GoodGammaBeta(gb_dtime))
+                    plot(betaGated::DD_TDIFF__GATEX,
+                        (int)(gg_dtime / plotResolution + 100), ig);
+
+                /** Angular corelations:
+                 * 4 clover setup :
+                 *     |0|
+                 * |3|     |1|
+                 *     |2|
+                 *
+                 * bin 0 -> same clover (0 deg), 1 -> 90 deg, 2 -> 180 deg
+                 */
+                if (det == det2) {
+                    plot(DD_ANGLE__GATEX, 0, ig);
                     if (hasBeta && GoodGammaBeta(gb_dtime))
-                        plot(betaGated::DD_TDIFF__GATEX,
-                            (int)(gg_dtime / plotResolution + 100), ig);
-
-                    /** Angular corelations:
-                     * 4 clover setup :
-                     *     |0|
-                     * |3|     |1|
-                     *     |2|
-                     *
-                     * bin 0 -> same clover (0 deg), 1 -> 90 deg, 2 -> 180 deg
-                     */
-                    if (det == det2) {
-                        plot(DD_ANGLE__GATEX, 0, ig);
-                        if (hasBeta && GoodGammaBeta(gb_dtime))
-                            plot(betaGated::DD_ANGLE__GATEX, 0, ig);
-                    } else if (det % 2 != det2 % 2) {
-                        plot(DD_ANGLE__GATEX, 1, ig);
-                        if (hasBeta && GoodGammaBeta(gb_dtime))
-                            plot(betaGated::DD_ANGLE__GATEX, 1, ig);
-                    } else {
-                        plot(DD_ANGLE__GATEX, 2, ig);
-                        if (hasBeta && GoodGammaBeta(gb_dtime))
-                            plot(betaGated::DD_ANGLE__GATEX, 2, ig);
-                    }
+                        plot(betaGated::DD_ANGLE__GATEX, 0, ig);
+                } else if (det % 2 != det2 % 2) {
+                    plot(DD_ANGLE__GATEX, 1, ig);
+                    if (hasBeta && GoodGammaBeta(gb_dtime))
+                        plot(betaGated::DD_ANGLE__GATEX, 1, ig);
+                } else {
+                    plot(DD_ANGLE__GATEX, 2, ig);
+                    if (hasBeta && GoodGammaBeta(gb_dtime))
+                        plot(betaGated::DD_ANGLE__GATEX, 2, ig);
+                }
 
-                    for (vector<ChanEvent*>::const_iterator it3 = it2 + 1;
-                            it3 != geEvents_.end(); it3++) {
-                        double gEnergy3 = (*it3)->GetCalEnergy();
-                        if (gEnergy3 < gammaThreshold_)
-                            continue;
-                        plot(DD_ENERGY__GATEX, gEnergy3, ig);
-                        if (hasBeta && GoodGammaBeta(gb_dtime))
-                            plot(betaGated::DD_ENERGY__GATEX, gEnergy3, ig);
-                    }
+                for (vector<ChanEvent*>::const_iterator it3 = it2 + 1;
+                        it3 != geEvents_.end(); it3++) {
+                    double gEnergy3 = (*it3)->GetCalEnergy();
+                    if (gEnergy3 < gammaThreshold_)
+                        continue;
+                    plot(DD_ENERGY__GATEX, gEnergy3, ig);
+                    if (hasBeta && GoodGammaBeta(gb_dtime))
+                        plot(betaGated::DD_ENERGY__GATEX, gEnergy3, ig);
                 }
-                ++ig;
             }
 #endif
         } // iteration over other gammas
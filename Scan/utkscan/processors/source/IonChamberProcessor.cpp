@@ -5,6 +5,7 @@
 
 #include <cmath>
 
+#include "ColumnFile.h"
 #include "DammPlotIds.hpp"
 #include "Globals.hpp"
 #include "RawEvent.hpp"
@@ -171,6 +172,19 @@ void IonChamberProcessor::Data::Clear(void) {
   mult = 0;
 }
 
+bool IonChamberProcessor::AddColumns(ColumnWriter &writer)
+{
+  return (writer.AddColumn(name + ".raw", data.raw, noDets) &&
+	  writer.AddColumn(name + ".cal", data.cal, noDets) &&
+	  writer.AddColumn(name + ".mult", &data.mult));
+}
+
+void IonChamberProcessor::FillColumns(void)
+{
+  if (!HasEvent())
+    data.Clear();
+}
+
 #ifdef useroot
 bool IonChamberProcessor::AddBranch(TTree *tree)
 {
@@ -12,6 +12,7 @@
 #include <TTree.h>
 #endif
 
+#include "ColumnFile.h"
 #include "DammPlotIds.hpp"
 #include "McpProcessor.hpp"
 #include "RawEvent.hpp"
@@ -112,6 +113,18 @@ bool McpProcessor::Process(RawEvent &event) {
   return (data.mult == 4);
 }
 
+bool McpProcessor::AddColumns(ColumnWriter &writer) {
+  return (writer.AddColumn(name + ".raw", data.raw, nPos) &&
+          writer.AddColumn(name + ".xpos", &data.xpos) &&
+          writer.AddColumn(name + ".ypos", &data.ypos) &&
+          writer.AddColumn(name + ".mult", &data.mult));
+}
+
+void McpProcessor::FillColumns(void) {
+  if (!HasEvent())
+    data.Clear();
+}
+
 #ifdef useroot
 bool McpProcessor::AddBranch(TTree *tree) {
   if (tree) {
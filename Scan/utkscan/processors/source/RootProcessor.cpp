@@ -12,6 +12,7 @@
 #include <TTree.h>
 
 #include "DetectorDriver.hpp"
+#include "OutputFiles.hpp"
 #include "RootProcessor.hpp"
 
 using std::cout;
@@ -22,7 +23,8 @@ RootProcessor::RootProcessor(const char *fileName, const char *treeName)
     : EventProcessor()
 {
     name = "RootProcessor";
-    file = new TFile(fileName, "recreate"); //! overwrite tree for now
+    file = new TFile(OutputFiles::get()->Register(fileName, OUTPUT_KEEP).c_str(),
+                     "recreate"); //! overwrite tree for now
     tree = new TTree(treeName, treeName);
 }
 
@@ -12,6 +12,7 @@
 #include <cmath>
 
 #include "DetectorDriver.hpp"
+#include "OutputFiles.hpp"
 #include "RawEvent.hpp"
 #include "ValidProcessor.hpp"
 
@@ -43,7 +44,8 @@ void ValidProcessor::OutputData(RawEvent &event) {
         GetArgument(1, hisFileName, 32);
         string temp = hisFileName;
         temp = temp.substr(0, temp.find_first_of(" "));
-        fileName << "monaTimeStamps-" << temp << ".dat";
+        fileName << OutputFiles::get()->Register(
+                "monaTimeStamps-" + temp + ".dat", OUTPUT_TEXT_APPEND);
     }
 
     ofstream data;
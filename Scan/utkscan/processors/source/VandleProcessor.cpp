@@ -240,39 +240,47 @@ bool VandleProcessor::Process(RawEvent &event) {
 }
 
 void VandleProcessor::AnalyzeBarStarts(void) {
-    for (BarMap::iterator it = bars_.begin(); it !=  bars_.end(); it++) {
-        TimingDefs::TimingIdentifier barId = (*it).first;
-        BarDetector bar = (*it).second;
+    //Flatten the starts once, so the loop over all of the bar and start
+    // pairs does not walk the map or copy the starts.
+    vector<pair<unsigned int, double> > starts;
+    starts.reserve(barStarts_.size());
+    for(BarMap::const_iterator itStart = barStarts_.begin();
+    itStart != barStarts_.end(); itStart++)
+        starts.push_back(make_pair((*itStart).first.first,
+                                   (*itStart).second.GetCorTimeAve()));
+
+    for (BarMap::const_iterator it = bars_.begin(); it !=  bars_.end(); it++) {
+        const BarDetector &bar = (*it).second;
 
         if(!bar.GetHasEvent())
             continue;
 
         unsigned int histTypeOffset = ReturnOffset(bar.GetType());
-        unsigned int barLoc = barId.first;
+        unsigned int barLoc = (*it).first.first;
         const TimingCalibration cal = bar.GetCalibration();
+        const double timeAve = bar.GetCorTimeAve();
+        const double flightPath = bar.GetFlightPath();
+        const double qdc = bar.GetQdc();
 
-        for(BarMap::iterator itStart = barStarts_.begin();
-        itStart != barStarts_.end(); itStart++) {
-            unsigned int startLoc = (*itStart).first.first;
+        for(vector<pair<unsigned int, double> >::const_iterator itStart =
+                starts.begin(); itStart != starts.end(); itStart++) {
+            unsigned int startLoc = (*itStart).first;
             unsigned int barPlusStartLoc = barLoc*numStarts_ + startLoc;
+            double tofOffset = cal.GetTofOffset(startLoc);
 
-            BarDetector start = (*itStart).second;
-
-            double tof = bar.GetCorTimeAve() -
-                start.GetCorTimeAve() + cal.GetTofOffset(startLoc);
+            double tof = timeAve - (*itStart).second + tofOffset;
 
-            double corTof =
-                CorrectTOF(tof, bar.GetFlightPath(), cal.GetZ0());
+            double corTof = CorrectTOF(tof, flightPath, cal.GetZ0());
 
             plot(DD_TOFBARS+histTypeOffset, tof*plotMult_+plotOffset_,
                  barPlusStartLoc);
             plot(DD_CORTOFBARS, corTof*plotMult_+plotOffset_, barPlusStartLoc);
 
-            if(cal.GetTofOffset(startLoc) != 0) {
+            if(tofOffset != 0) {
                 plot(DD_TQDCAVEVSTOF+histTypeOffset, tof*plotMult_+plotOffset_,
-                     bar.GetQdc());
+                     qdc);
                 plot(DD_TQDCAVEVSCORTOF+histTypeOffset,
-                     corTof*plotMult_+plotOffset_, bar.GetQdc());
+                     corTof*plotMult_+plotOffset_, qdc);
             }
 
             if (geSummary_) {
@@ -284,47 +292,56 @@ void VandleProcessor::AnalyzeBarStarts(void) {
                         plot(DD_GAMMAENERGYVSTOF+histTypeOffset, calEnergy, tof);
                     }
                 } else {
-                    plot(DD_TQDCAVEVSTOF_VETO+histTypeOffset, tof, bar.GetQdc());
+                    plot(DD_TQDCAVEVSTOF_VETO+histTypeOffset, tof, qdc);
                     plot(DD_TOFBARS_VETO+histTypeOffset, tof, barPlusStartLoc);
                 }
             }
-        } // for(TimingMap::iterator itStart
+        } // for(starts
     } //(BarMap::iterator itBar
 } //void VandleProcessor::AnalyzeData
 
 void VandleProcessor::AnalyzeStarts(void) {
-    for (BarMap::iterator it = bars_.begin(); it !=  bars_.end(); it++) {
-        TimingDefs::TimingIdentifier barId = (*it).first;
-        BarDetector bar = (*it).second;
+    //Flatten the starts once, so the loop over all of the bar and start
+    // pairs does not walk the map or copy the starts.
+    vector<pair<unsigned int, double> > starts;
+    starts.reserve(starts_.size());
+    for(TimingMap::const_iterator itStart = starts_.begin();
+    itStart != starts_.end(); itStart++) {
+        if(!(*itStart).second.GetIsValid())
+            continue;
+        starts.push_back(make_pair((*itStart).first.first,
+                                   (*itStart).second.GetCorrectedTime()));
+    }
+
+    for (BarMap::const_iterator it = bars_.begin(); it !=  bars_.end(); it++) {
+        const BarDetector &bar = (*it).second;
 
         if(!bar.GetHasEvent())
             continue;
 
         unsigned int histTypeOffset = ReturnOffset(bar.GetType());
-        unsigned int barLoc = barId.first;
+        unsigned int barLoc = (*it).first.first;
         const TimingCalibration cal = bar.GetCalibration();
+        const double timeAve = bar.GetCorTimeAve();
+        const double flightPath = bar.GetFlightPath();
+        const double qdc = bar.GetQdc();
 
-        for(TimingMap::iterator itStart = starts_.begin();
-        itStart != starts_.end(); itStart++) {
-            if(!(*itStart).second.GetIsValid())
-                continue;
-
-            unsigned int startLoc = (*itStart).first.first;
+        for(vector<pair<unsigned int, double> >::const_iterator itStart =
+                starts.begin(); itStart != starts.end(); itStart++) {
+            unsigned int startLoc = (*itStart).first;
             unsigned int barPlusStartLoc = barLoc*numStarts_ + startLoc;
-            HighResTimingData start = (*itStart).second;
 
-            double tof = bar.GetCorTimeAve() -
-                start.GetCorrectedTime() + cal.GetTofOffset(startLoc);
+            double tof = timeAve - (*itStart).second +
+                cal.GetTofOffset(startLoc);
 
-            double corTof =
-                CorrectTOF(tof, bar.GetFlightPath(), cal.GetZ0());
+            double corTof = CorrectTOF(tof, flightPath, cal.GetZ0());
 
             plot(DD_TOFBARS+histTypeOffset, tof*plotMult_+plotOffset_, barPlusStartLoc);
-            plot(DD_TQDCAVEVSTOF+histTypeOffset, tof*plotMult_+plotOffset_, bar.GetQdc());
+            plot(DD_TQDCAVEVSTOF+histTypeOffset, tof*plotMult_+plotOffset_, qdc);
 
             plot(DD_CORTOFBARS, corTof*plotMult_+plotOffset_, barPlusStartLoc);
             plot(DD_TQDCAVEVSCORTOF+histTypeOffset, corTof*plotMult_+plotOffset_,
-                 bar.GetQdc());
+                 qdc);
 
             if (geSummary_) {
                 if (geSummary_->GetMult() > 0) {
@@ -335,11 +352,11 @@ void VandleProcessor::AnalyzeStarts(void) {
                         plot(DD_GAMMAENERGYVSTOF+histTypeOffset, calEnergy, tof);
                     }
                 } else {
-                    plot(DD_TQDCAVEVSTOF_VETO+histTypeOffset, tof, bar.GetQdc());
+                    plot(DD_TQDCAVEVSTOF_VETO+histTypeOffset, tof, qdc);
                     plot(DD_TOFBARS_VETO+histTypeOffset, tof, barPlusStartLoc);
                 }
             }
-        } // for(TimingMap::iterator itStart
+        } // for(starts
     } //(BarMap::iterator itBar
 } //void VandleProcessor::AnalyzeData
 